@@ -1,5 +1,8 @@
 #include <vm.h>
 #include <interpreter.h>
+#include <bytecode_optimizer.h>
+#include <thread_pool.h>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <thread>
@@ -8,15 +11,23 @@ namespace rumina {
 
 constexpr size_t STACK_SIZE = 128 * 1024 * 1024; // 128 MB
 
-int run_bytecode_file(const std::string& filename) {
+bool read_bytecode_file(const std::string& filename, std::string& contents) {
     std::ifstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error reading file '" << filename << "'\n";
-        return 1;
+        return false;
     }
     
-    std::string contents((std::istreambuf_iterator<char>(file)),
-                          std::istreambuf_iterator<char>());
+    contents.assign((std::istreambuf_iterator<char>(file)),
+                    std::istreambuf_iterator<char>());
+    return true;
+}
+
+int run_bytecode_file(const std::string& filename, const JitOptions* jit = nullptr) {
+    std::string contents;
+    if (!read_bytecode_file(filename, contents)) {
+        return 1;
+    }
     
     try {
         ByteCode bytecode = ByteCode::deserialize(contents);
@@ -24,6 +35,9 @@ int run_bytecode_file(const std::string& filename) {
         Interpreter interpreter;
         auto globals = interpreter.getGlobals();
         VM vm(globals);
+        if (jit && !vm.setJitEnabled(true, *jit)) {
+            std::cerr << "Warning: JIT is not supported on this platform\n";
+        }
         vm.load(std::move(bytecode));
         
         auto result = vm.run();
@@ -39,12 +53,64 @@ int run_bytecode_file(const std::string& filename) {
     }
 }
 
+// 输出字节码文件的操作码 n-gram 频率，用于挑选超级指令（融合过的指令按融合前的形式计数）
+int dump_ngrams(const std::string& filename) {
+    std::string contents;
+    if (!read_bytecode_file(filename, contents)) {
+        return 1;
+    }
+    
+    try {
+        ByteCode bytecode = ByteCode::deserialize(contents);
+        for (size_t n = 2; n <= 4; ++n) {
+            BytecodeOptimizer::dumpNGrams(bytecode, n, 20, std::cout);
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
 } // namespace rumina
 
 int main(int argc, char* argv[]) {
+    // 选项写在文件名之前
+    bool ngrams = false;
+    bool jit = false;
+    rumina::JitOptions jit_options;
+    while (argc > 2 && std::string(argv[1]).rfind("--", 0) == 0) {
+        std::string option = argv[1];
+        if (option == "--ngrams") {
+            ngrams = true;
+        } else if (option == "--threads") {
+            // 共用调度器的线程数
+            long long threads = std::atoll(argv[2]);
+            if (threads <= 0) {
+                std::cerr << "Error: --threads expects a positive integer\n";
+                return 1;
+            }
+            rumina::ThreadPool::setSharedThreads(static_cast<size_t>(threads));
+            argv++;
+            argc--;
+        } else if (option == "--jit" || option == "--jit-perf-map") {
+            jit = true;
+            jit_options.perf_map = jit_options.perf_map || option == "--jit-perf-map";
+        } else {
+            std::cerr << "Error: Unknown option '" << option << "'\n";
+            return 1;
+        }
+        argv++;
+        argc--;
+    }
+    
     if (argc < 2) {
-        std::cerr << "Usage: rmvm <file.rmc>\n";
+        std::cerr << "Usage: rmvm [options] <file.rmc>\n";
         std::cerr << "  Execute Rumina bytecode file\n";
+        std::cerr << "  --ngrams        Dump opcode n-gram frequencies instead of running\n";
+        std::cerr << "  --jit           Run with the baseline JIT (Linux x86-64)\n";
+        std::cerr << "  --jit-perf-map  Same, and write /tmp/perf-<pid>.map\n";
+        std::cerr << "  --threads <n>   Size the shared scheduler (default: RUMINA_THREADS or CPU count)\n";
         return 1;
     }
     
@@ -55,9 +121,13 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    if (ngrams) {
+        return rumina::dump_ngrams(filename);
+    }
+    
     // 在新线程中运行以增加栈大小
     std::thread t([&]() {
-        rumina::run_bytecode_file(filename);
+        rumina::run_bytecode_file(filename, jit ? &jit_options : nullptr);
     });
     
     t.join();
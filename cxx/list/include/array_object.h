@@ -0,0 +1,119 @@
+#pragma once
+
+#include "value.h"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace rumina {
+
+// 数组对象：元素全是 Int 或全是 Float 时连续存放 int64_t / double（紧凑存储），
+// 否则存放 Value（通用存储）。写入不匹配的值时整体转为通用存储，对脚本透明。
+// 读取接口按值返回 Value；写入一律经过 set / push_back，以便在需要时转换存储。
+// 数值内置函数可以通过 ints() / floats() 直接处理连续内存
+class ArrayObject {
+public:
+    enum class Kind : uint8_t { Int64, Float64, Generic };
+
+    // 只读迭代，解引用得到元素的副本
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Value;
+
+        const_iterator(const ArrayObject* owner, size_t index) : owner_(owner), index_(index) {}
+
+        Value operator*() const { return owner_->get(index_); }
+        const_iterator& operator++() { ++index_; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++index_; return old; }
+        bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+
+    private:
+        const ArrayObject* owner_;
+        size_t index_;
+    };
+
+    // 空数组先按 Int 紧凑存储，第一个元素决定之后的存储方式
+    ArrayObject() = default;
+    // 元素同为 Int 或同为 Float 时打包
+    explicit ArrayObject(std::vector<Value> elements);
+    static ArrayObject fromInts(std::vector<int64_t> values);
+    static ArrayObject fromFloats(std::vector<double> values);
+
+    Kind kind() const { return kind_; }
+    bool isPacked() const { return kind_ != Kind::Generic; }
+
+    size_t size() const {
+        switch (kind_) {
+            case Kind::Int64: return ints_.size();
+            case Kind::Float64: return floats_.size();
+            default: return values_.size();
+        }
+    }
+    bool empty() const { return size() == 0; }
+
+    // 不检查下标
+    Value get(size_t index) const {
+        switch (kind_) {
+            case Kind::Int64: return Value(ints_[index]);
+            case Kind::Float64: return Value(floats_[index]);
+            default: return values_[index];
+        }
+    }
+    Value back() const { return get(size() - 1); }
+
+    void set(size_t index, Value value) {
+        if (kind_ == Kind::Int64 && value.getType() == Value::Type::Int) {
+            ints_[index] = *value.get<int64_t>();
+        } else if (kind_ == Kind::Float64 && value.getType() == Value::Type::Float) {
+            floats_[index] = *value.get<double>();
+        } else {
+            generic()[index] = std::move(value);
+        }
+    }
+
+    void push_back(Value value) {
+        if (kind_ == Kind::Int64 && value.getType() == Value::Type::Int) {
+            ints_.push_back(*value.get<int64_t>());
+        } else if (kind_ == Kind::Float64 && value.getType() == Value::Type::Float) {
+            floats_.push_back(*value.get<double>());
+        } else {
+            pushSlow(std::move(value));
+        }
+    }
+
+    void pop_back();
+    void reserve(size_t n);
+    // 删除全部元素回到空的紧凑数组；元素在对象恢复一致之后才析构
+    void clear();
+    // 追加另一个数组的全部元素，两边存储相同时直接复制连续内存
+    void append(const ArrayObject& other);
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    // 连续存储，只在对应的 kind() 下有效
+    const std::vector<int64_t>& ints() const { return ints_; }
+    const std::vector<double>& floats() const { return floats_; }
+    const std::vector<Value>& values() const { return values_; }
+
+    // 转为通用存储后返回可写的元素表（排序、原地修改等）
+    std::vector<Value>& generic();
+    std::vector<Value> toVector() const;
+
+private:
+    void pushSlow(Value value);
+
+    Kind kind_ = Kind::Int64;
+    std::vector<int64_t> ints_;
+    std::vector<double> floats_;
+    std::vector<Value> values_;
+};
+
+} // namespace rumina
@@ -1,10 +1,12 @@
 #pragma once
 
+#include "atom.h"
 #include "fwd.h"
 #include <string>
 #include <vector>
 #include <memory>
 #include <optional>
+#include <unordered_set>
 
 namespace rumina {
 
@@ -93,7 +95,9 @@ public:
 class IdentExpr : public Expr {
 public:
     std::string name;
-    explicit IdentExpr(std::string n) : name(std::move(n)) {}
+    Atom atom;
+    explicit IdentExpr(std::string n) : name(std::move(n)), atom(AtomTable::intern(name)) {}
+    IdentExpr(std::string n, Atom a) : name(std::move(n)), atom(a) {}
     std::string toString() const override;
 };
 
@@ -161,9 +165,12 @@ class MemberExpr : public Expr {
 public:
     std::unique_ptr<Expr> object;
     std::string member;
+    Atom atom;
 
     MemberExpr(std::unique_ptr<Expr> obj, std::string mem)
-        : object(std::move(obj)), member(std::move(mem)) {}
+        : object(std::move(obj)), member(std::move(mem)), atom(AtomTable::intern(member)) {}
+    MemberExpr(std::unique_ptr<Expr> obj, std::string mem, Atom a)
+        : object(std::move(obj)), member(std::move(mem)), atom(a) {}
 
     std::string toString() const override;
 };
@@ -208,6 +215,8 @@ public:
 // 语句基类
 class Stmt {
 public:
+    size_t line = 0;  // 语句起始行号，0 表示未知
+    
     virtual ~Stmt() = default;
     virtual std::string toString() const = 0;
 };
@@ -392,4 +401,8 @@ public:
 std::string binOpToString(BinOp op);
 std::string unaryOpToString(UnaryOp op);
 
+// 收集语句中读写到的变量名（进入嵌套 lambda，不进入嵌套函数定义），用于闭包捕获分析
+void collectReferencedNames(const Stmt* stmt, std::unordered_set<std::string>& names);
+void collectReferencedNames(const Expr* expr, std::unordered_set<std::string>& names);
+
 } // namespace rumina
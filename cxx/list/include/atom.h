@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace rumina {
+
+// 驻留后的标识符 / 成员名：同一个名字在整个进程内只有一个编号，
+// 比较两个名字只需比较整数，哈希表也按编号而不是字符串散列
+using Atom = uint32_t;
+
+constexpr Atom kNoAtom = std::numeric_limits<Atom>::max();
+
+// 全局原子表。词法分析时驻留标识符，之后编译器、VM 和结构体形状都只传递编号。
+// 原子永不释放；名字字符串的地址在进程内保持不变，可以长期持有引用。
+// intern / find 先查线程本地缓存，未命中时才加锁；name 不加锁（只读已发布的编号）
+class AtomTable {
+public:
+    // 返回名字的原子，不存在时创建
+    static Atom intern(std::string_view name);
+    // 只查找不创建（运行时按字符串访问字段时使用，避免表无限增长），不存在时返回 kNoAtom
+    static Atom find(std::string_view name);
+    // 原子对应的名字
+    static const std::string& name(Atom atom);
+    // 已驻留的名字个数
+    static size_t size();
+};
+
+} // namespace rumina
@@ -9,18 +9,27 @@ namespace builtin {
 namespace array {
 
 // 数组函数
-Value foreach(const std::vector<Value>& args);
-Value map(const std::vector<Value>& args);
-Value filter(const std::vector<Value>& args);
-Value reduce(const std::vector<Value>& args);
-Value push(const std::vector<Value>& args);
-Value pop(const std::vector<Value>& args);
-Value range(const std::vector<Value>& args);
-Value concat(const std::vector<Value>& args);
-Value dot(const std::vector<Value>& args);
-Value norm(const std::vector<Value>& args);
-Value cross(const std::vector<Value>& args);
-Value det(const std::vector<Value>& args);
+Value foreach(NativeArgs args);
+Value map(NativeArgs args);
+Value filter(NativeArgs args);
+Value reduce(NativeArgs args);
+// 在线程池上并行执行回调，每个工作线程使用隔离的 VM 上下文（见 VM::fork）。
+// 数组较短或已在并行任务中时退化为 map / reduce；
+// parallel_reduce 的回调须满足结合律，分块归约后再按顺序合并。
+// 输入数组、回调捕获的变量和全局变量中的数组、结构体在各线程间共享同一份内容，
+// 并行期间只读（见 Value::isFrozen）：回调里的成员赋值、push / pop 等报错。
+// 需要累积结果时返回新值，由 parallel_map 的结果数组或 parallel_reduce 的合并收集
+Value parallel_map(NativeArgs args);
+Value parallel_reduce(NativeArgs args);
+Value push(NativeArgs args);
+Value pop(NativeArgs args);
+Value range(NativeArgs args);
+Value concat(NativeArgs args);
+Value dot(NativeArgs args);
+Value norm(NativeArgs args);
+Value cross(NativeArgs args);
+// 同 matrix::det：整数 / 有理数矩阵返回精确的 Int / BigInt / Rational，含 Float 时返回 Float
+Value det(NativeArgs args);
 
 // 辅助函数
 double calculateDeterminant(const std::vector<std::vector<double>>& matrix);
@@ -12,24 +12,24 @@ namespace buffer {
 Value create_buffer_module();
 
 // Buffer操作
-Value buffer_alloc(const std::vector<Value>& args);
-Value buffer_from(const std::vector<Value>& args);
-Value buffer_concat(const std::vector<Value>& args);
-Value buffer_length(const std::vector<Value>& args);
-Value buffer_get(const std::vector<Value>& args);
-Value buffer_set(const std::vector<Value>& args);
-Value buffer_slice(const std::vector<Value>& args);
-Value buffer_to_text(const std::vector<Value>& args);
-Value buffer_to_hex(const std::vector<Value>& args);
-Value buffer_to_base64(const std::vector<Value>& args);
-Value buffer_to_base64_url(const std::vector<Value>& args);
-Value buffer_copy(const std::vector<Value>& args);
-Value buffer_fill(const std::vector<Value>& args);
-Value buffer_index_of(const std::vector<Value>& args);
-Value buffer_includes(const std::vector<Value>& args);
-Value buffer_equals(const std::vector<Value>& args);
-Value buffer_compare(const std::vector<Value>& args);
-Value buffer_subarray(const std::vector<Value>& args);
+Value buffer_alloc(NativeArgs args);
+Value buffer_from(NativeArgs args);
+Value buffer_concat(NativeArgs args);
+Value buffer_length(NativeArgs args);
+Value buffer_get(NativeArgs args);
+Value buffer_set(NativeArgs args);
+Value buffer_slice(NativeArgs args);
+Value buffer_to_text(NativeArgs args);
+Value buffer_to_hex(NativeArgs args);
+Value buffer_to_base64(NativeArgs args);
+Value buffer_to_base64_url(NativeArgs args);
+Value buffer_copy(NativeArgs args);
+Value buffer_fill(NativeArgs args);
+Value buffer_index_of(NativeArgs args);
+Value buffer_includes(NativeArgs args);
+Value buffer_equals(NativeArgs args);
+Value buffer_compare(NativeArgs args);
+Value buffer_subarray(NativeArgs args);
 
 // 辅助函数
 Value new_buffer_from_bytes(const std::vector<uint8_t>& bytes);
@@ -14,15 +14,15 @@ void register_builtins(std::unordered_map<std::string, Value>& globals);
 
 // 类型转换函数（供解释器和VM使用）
 Value convert_to_declared_type(const Value& val, DeclaredType dtype);
-Value convert_to_int(const std::vector<Value>& args);
-Value convert_to_float(const std::vector<Value>& args);
-Value convert_to_bool(const std::vector<Value>& args);
-Value convert_to_string(const std::vector<Value>& args);
-Value convert_to_rational(const std::vector<Value>& args);
-Value convert_to_irrational(const std::vector<Value>& args);
-Value convert_to_complex(const std::vector<Value>& args);
-Value convert_to_array(const std::vector<Value>& args);
-Value convert_to_bigint(const std::vector<Value>& args);
+Value convert_to_int(NativeArgs args);
+Value convert_to_float(NativeArgs args);
+Value convert_to_bool(NativeArgs args);
+Value convert_to_string(NativeArgs args);
+Value convert_to_rational(NativeArgs args);
+Value convert_to_irrational(NativeArgs args);
+Value convert_to_complex(NativeArgs args);
+Value convert_to_array(NativeArgs args);
+Value convert_to_bigint(NativeArgs args);
 
 } // namespace builtin
 } // namespace rumina
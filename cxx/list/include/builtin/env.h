@@ -18,12 +18,12 @@ namespace env {
 Value create_env_module();
 
 // 环境变量操作
-Value env_get(const std::vector<Value>& args);
-Value env_set(const std::vector<Value>& args);
-Value env_has(const std::vector<Value>& args);
-Value env_remove(const std::vector<Value>& args);
-Value env_all(const std::vector<Value>& args);
-Value env_keys(const std::vector<Value>& args);
+Value env_get(NativeArgs args);
+Value env_set(NativeArgs args);
+Value env_has(NativeArgs args);
+Value env_remove(NativeArgs args);
+Value env_all(NativeArgs args);
+Value env_keys(NativeArgs args);
 
 } // namespace env
 } // namespace builtin
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../value.h"
+
+namespace rumina {
+namespace builtin {
+namespace gc {
+
+// 环回收器模块创建
+Value create_gc_module();
+
+// gc.collect()：立即回收，返回释放的对象数
+Value gc_collect(NativeArgs args);
+// gc.stats()：回收统计
+Value gc_stats(NativeArgs args);
+// gc.setThreshold(n)：自动回收阈值，0 关闭自动回收
+Value gc_set_threshold(NativeArgs args);
+
+} // namespace gc
+} // namespace builtin
+} // namespace rumina
@@ -8,24 +8,24 @@ namespace builtin {
 namespace math {
 
 // 数学函数
-Value sqrt(const std::vector<Value>& args);
-Value pi(const std::vector<Value>& args);
-Value e(const std::vector<Value>& args);
-Value sin(const std::vector<Value>& args);
-Value cos(const std::vector<Value>& args);
-Value tan(const std::vector<Value>& args);
-Value exp(const std::vector<Value>& args);
-Value abs_fn(const std::vector<Value>& args);
-Value log(const std::vector<Value>& args);
-Value ln(const std::vector<Value>& args);
-Value logbase(const std::vector<Value>& args);
-Value factorial(const std::vector<Value>& args);
+Value sqrt(NativeArgs args);
+Value pi(NativeArgs args);
+Value e(NativeArgs args);
+Value sin(NativeArgs args);
+Value cos(NativeArgs args);
+Value tan(NativeArgs args);
+Value exp(NativeArgs args);
+Value abs_fn(NativeArgs args);
+Value log(NativeArgs args);
+Value ln(NativeArgs args);
+Value logbase(NativeArgs args);
+Value factorial(NativeArgs args);
 
 // 复数函数
-Value arg(const std::vector<Value>& args);
-Value conj(const std::vector<Value>& args);
-Value re(const std::vector<Value>& args);
-Value im(const std::vector<Value>& args);
+Value arg(NativeArgs args);
+Value conj(NativeArgs args);
+Value re(NativeArgs args);
+Value im(NativeArgs args);
 
 } // namespace math
 } // namespace builtin
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../value.h"
+#include <cstddef>
+#include <vector>
+
+namespace rumina {
+namespace builtin {
+namespace matrix {
+
+// 行主序连续存储的稠密 double 矩阵
+struct DenseMatrix {
+    size_t rows = 0;
+    size_t cols = 0;
+    std::vector<double> data;
+
+    DenseMatrix() = default;
+    DenseMatrix(size_t rows, size_t cols) : rows(rows), cols(cols), data(rows * cols, 0.0) {}
+
+    double& operator()(size_t i, size_t j) { return data[i * cols + j]; }
+    const double& operator()(size_t i, size_t j) const { return data[i * cols + j]; }
+};
+
+// 部分主元 LU 分解 PA = LU：lu 的下三角（不含对角）存 L，上三角存 U，
+// pivot[i] 是第 i 行来自原矩阵的行号。某一列找不到非零主元时 singular 为 true
+struct LUDecomposition {
+    DenseMatrix lu;
+    std::vector<size_t> pivot;
+    int sign = 1;
+    bool singular = false;
+};
+
+LUDecomposition luDecompose(DenseMatrix a);
+double determinant(DenseMatrix a);
+// 分块乘法，规模足够大时按行块提交到共用调度器并行执行
+DenseMatrix multiply(const DenseMatrix& a, const DenseMatrix& b);
+// 无分数 Bareiss 消元求整数矩阵（n×n，行主序）的行列式，除法都是整除
+BigInt bareissDeterminant(std::vector<BigInt> a, size_t n);
+
+// 矩阵函数（matrix:: 命名空间），矩阵写作二维数组。
+// det：元素都是 Int / BigInt / Rational 时用 Bareiss 消元精确求值，返回 Int / BigInt / Rational，
+// 含 Float 时按 LU 分解计算，返回 Float。
+// solve / inverse：元素含 Rational / BigInt 且没有 Float 时走精确路径（无分数 Gauss-Jordan），
+// 否则按 double 计算，结果是 Float 数组
+Value det(NativeArgs args);
+// solve(A, b)：b 可以是向量或矩阵，返回形状与 b 相同
+Value solve(NativeArgs args);
+Value inverse(NativeArgs args);
+Value transpose(NativeArgs args);
+Value matmul(NativeArgs args);
+
+} // namespace matrix
+} // namespace builtin
+} // namespace rumina
@@ -11,16 +11,16 @@ namespace path {
 Value create_path_module();
 
 // 路径操作
-Value path_join(const std::vector<Value>& args);
-Value path_basename(const std::vector<Value>& args);
-Value path_dirname(const std::vector<Value>& args);
-Value path_extname(const std::vector<Value>& args);
-Value path_is_absolute(const std::vector<Value>& args);
-Value path_normalize(const std::vector<Value>& args);
-Value path_resolve(const std::vector<Value>& args);
-Value path_relative(const std::vector<Value>& args);
-Value path_parse(const std::vector<Value>& args);
-Value path_format(const std::vector<Value>& args);
+Value path_join(NativeArgs args);
+Value path_basename(NativeArgs args);
+Value path_dirname(NativeArgs args);
+Value path_extname(NativeArgs args);
+Value path_is_absolute(NativeArgs args);
+Value path_normalize(NativeArgs args);
+Value path_resolve(NativeArgs args);
+Value path_relative(NativeArgs args);
+Value path_parse(NativeArgs args);
+Value path_format(NativeArgs args);
 
 } // namespace path
 } // namespace builtin
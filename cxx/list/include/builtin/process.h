@@ -14,15 +14,15 @@ void init_process_args(int argc, char* argv[]);
 Value create_process_module();
 
 // 进程操作
-Value process_args(const std::vector<Value>& args);
-Value process_cwd(const std::vector<Value>& args);
-Value process_set_cwd(const std::vector<Value>& args);
-Value process_pid(const std::vector<Value>& args);
-Value process_exit(const std::vector<Value>& args);
-Value process_platform(const std::vector<Value>& args);
-Value process_arch(const std::vector<Value>& args);
-Value process_version(const std::vector<Value>& args);
-Value process_exec_path(const std::vector<Value>& args);
+Value process_args(NativeArgs args);
+Value process_cwd(NativeArgs args);
+Value process_set_cwd(NativeArgs args);
+Value process_pid(NativeArgs args);
+Value process_exit(NativeArgs args);
+Value process_platform(NativeArgs args);
+Value process_arch(NativeArgs args);
+Value process_version(NativeArgs args);
+Value process_exec_path(NativeArgs args);
 
 } // namespace process
 } // namespace builtin
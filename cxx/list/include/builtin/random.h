@@ -7,9 +7,9 @@ namespace rumina {
 namespace builtin {
 namespace random_ns {
 // 随机数函数
-Value rand(const std::vector<Value>& args);
-Value randint(const std::vector<Value>& args);
-Value random(const std::vector<Value>& args);
+Value rand(NativeArgs args);
+Value randint(NativeArgs args);
+Value random(NativeArgs args);
 
 } // namespace random_ns
 } // namespace builtin
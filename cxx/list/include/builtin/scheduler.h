@@ -0,0 +1,19 @@
+#pragma once
+
+#include "../value.h"
+
+namespace rumina {
+namespace builtin {
+namespace scheduler {
+
+// 共用调度器模块创建
+Value create_scheduler_module();
+
+// scheduler.stats()：线程数、排队任务数、累计提交/完成的任务数和窃取次数
+Value scheduler_stats(NativeArgs args);
+// scheduler.threads()：工作线程数
+Value scheduler_threads(NativeArgs args);
+
+} // namespace scheduler
+} // namespace builtin
+} // namespace rumina
@@ -11,26 +11,26 @@ namespace stream {
 Value create_stream_module();
 
 // 流操作
-Value stream_open_read(const std::vector<Value>& args);
-Value stream_open_write(const std::vector<Value>& args);
+Value stream_open_read(NativeArgs args);
+Value stream_open_write(NativeArgs args);
 
 // ReadStream方法
-Value read_stream_read_bytes(const std::vector<Value>& args);
-Value read_stream_read_until(const std::vector<Value>& args);
-Value read_stream_read_all(const std::vector<Value>& args);
-Value read_stream_seek(const std::vector<Value>& args);
-Value read_stream_tell(const std::vector<Value>& args);
-Value read_stream_is_closed(const std::vector<Value>& args);
-Value read_stream_close(const std::vector<Value>& args);
+Value read_stream_read_bytes(NativeArgs args);
+Value read_stream_read_until(NativeArgs args);
+Value read_stream_read_all(NativeArgs args);
+Value read_stream_seek(NativeArgs args);
+Value read_stream_tell(NativeArgs args);
+Value read_stream_is_closed(NativeArgs args);
+Value read_stream_close(NativeArgs args);
 
 // WriteStream方法
-Value write_stream_write_bytes(const std::vector<Value>& args);
-Value write_stream_write_text(const std::vector<Value>& args);
-Value write_stream_flush(const std::vector<Value>& args);
-Value write_stream_seek(const std::vector<Value>& args);
-Value write_stream_tell(const std::vector<Value>& args);
-Value write_stream_is_closed(const std::vector<Value>& args);
-Value write_stream_close(const std::vector<Value>& args);
+Value write_stream_write_bytes(NativeArgs args);
+Value write_stream_write_text(NativeArgs args);
+Value write_stream_flush(NativeArgs args);
+Value write_stream_seek(NativeArgs args);
+Value write_stream_tell(NativeArgs args);
+Value write_stream_is_closed(NativeArgs args);
+Value write_stream_close(NativeArgs args);
 
 } // namespace stream
 } // namespace builtin
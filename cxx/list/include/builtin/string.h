@@ -8,14 +8,14 @@ namespace builtin {
 namespace string {
 
 // 字符串函数
-Value concat(const std::vector<Value>& args);
-Value length(const std::vector<Value>& args);
-Value char_at(const std::vector<Value>& args);
-Value at(const std::vector<Value>& args);
-Value find(const std::vector<Value>& args);
-Value sub(const std::vector<Value>& args);
-Value cat(const std::vector<Value>& args);
-Value replace_by_index(const std::vector<Value>& args);
+Value concat(NativeArgs args);
+Value length(NativeArgs args);
+Value char_at(NativeArgs args);
+Value at(NativeArgs args);
+Value find(NativeArgs args);
+Value sub(NativeArgs args);
+Value cat(NativeArgs args);
+Value replace_by_index(NativeArgs args);
 
 } // namespace string
 } // namespace builtin
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../value.h"
+
+namespace rumina {
+namespace builtin {
+namespace string_builder {
+
+// StringBuilder 模块创建
+Value create_string_builder_module();
+
+// StringBuilder.new([initial])：新的构建器对象
+Value builder_new(NativeArgs args);
+
+// 构建器方法（第一个实参是构建器对象本身）
+// builder.append(x...)：追加各实参的字符串形式，返回构建器本身
+Value builder_append(NativeArgs args);
+// builder.appendLine([x...])：追加后再加一个换行，返回构建器本身
+Value builder_append_line(NativeArgs args);
+// builder.length()：当前字节数
+Value builder_length(NativeArgs args);
+// builder.toString()：当前内容（O(1)，之后继续追加不影响已取出的字符串）
+Value builder_to_string(NativeArgs args);
+// builder.clear()：清空内容，返回构建器本身
+Value builder_clear(NativeArgs args);
+
+} // namespace string_builder
+} // namespace builtin
+} // namespace rumina
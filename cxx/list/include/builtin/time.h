@@ -10,14 +10,14 @@ namespace builtin {
 Value create_time_module();
 
 // 时间函数
-Value time_now(const std::vector<Value>& args);
-Value time_hrtime_ms(const std::vector<Value>& args);
-Value time_sleep(const std::vector<Value>& args);
-Value time_start_timer(const std::vector<Value>& args);
+Value time_now(NativeArgs args);
+Value time_hrtime_ms(NativeArgs args);
+Value time_sleep(NativeArgs args);
+Value time_start_timer(NativeArgs args);
 
 // Timer方法
-Value timer_elapsed_ms(const std::vector<Value>& args);
-Value timer_elapsed_sec(const std::vector<Value>& args);
+Value timer_elapsed_ms(NativeArgs args);
+Value timer_elapsed_sec(NativeArgs args);
 
 } // namespace builtin
 } // namespace rumina
@@ -8,28 +8,28 @@ namespace builtin {
 namespace utils {
 
 // 工具函数
-Value print(const std::vector<Value>& args);
-Value input(const std::vector<Value>& args);
-Value typeof_fn(const std::vector<Value>& args);
-Value size(const std::vector<Value>& args);
-Value tostring(const std::vector<Value>& args);
-Value to_string(const std::vector<Value>& args);
-Value exit(const std::vector<Value>& args);
-Value new_fn(const std::vector<Value>& args);
-Value same(const std::vector<Value>& args);
-Value setattr(const std::vector<Value>& args);
-Value update(const std::vector<Value>& args);
-Value fraction(const std::vector<Value>& args);
-Value decimal(const std::vector<Value>& args);
-Value assert_fn(const std::vector<Value>& args);
+Value print(NativeArgs args);
+Value input(NativeArgs args);
+Value typeof_fn(NativeArgs args);
+Value size(NativeArgs args);
+Value tostring(NativeArgs args);
+Value to_string(NativeArgs args);
+Value exit(NativeArgs args);
+Value new_fn(NativeArgs args);
+Value same(NativeArgs args);
+Value setattr(NativeArgs args);
+Value update(NativeArgs args);
+Value fraction(NativeArgs args);
+Value decimal(NativeArgs args);
+Value assert_fn(NativeArgs args);
 
 // 类型转换函数
-Value to_int(const std::vector<Value>& args);
-Value to_float(const std::vector<Value>& args);
-Value to_bool(const std::vector<Value>& args);
-Value to_string_fn(const std::vector<Value>& args);
-Value to_rational(const std::vector<Value>& args);
-Value to_complex(const std::vector<Value>& args);
+Value to_int(NativeArgs args);
+Value to_float(NativeArgs args);
+Value to_bool(NativeArgs args);
+Value to_string_fn(NativeArgs args);
+Value to_rational(NativeArgs args);
+Value to_complex(NativeArgs args);
 
 } // namespace utils
 } // namespace builtin
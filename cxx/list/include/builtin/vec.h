@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../value.h"
+#include <vector>
+
+namespace rumina {
+namespace builtin {
+namespace vec {
+
+// 向量化的数值数组函数（vec:: 命名空间），Float 紧凑数组直接交给 SIMD 内核，
+// 其他数组先按 toFloat 转成 double。逐元素运算的结果总是 Float 数组；
+// Int 紧凑数组的 sum / min / max / cumsum 按整数精确计算
+Value dot(NativeArgs args);
+Value norm(NativeArgs args);
+Value add(NativeArgs args);
+Value sub(NativeArgs args);
+Value mul(NativeArgs args);
+Value div(NativeArgs args);
+Value scale(NativeArgs args);
+Value sum(NativeArgs args);
+Value min(NativeArgs args);
+Value max(NativeArgs args);
+Value cumsum(NativeArgs args);
+// 当前使用的内核："avx2"、"sse2" 或 "scalar"
+Value backend(NativeArgs args);
+
+} // namespace vec
+} // namespace builtin
+} // namespace rumina
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "vm.h"
+#include <ostream>
+#include <string>
+#include <utility>
 #include <vector>
 #include <unordered_set>
 
@@ -14,14 +17,29 @@ public:
     // 优化字节码，返回true如果有任何优化被应用
     bool optimize(ByteCode& bytecode);
 
+    // 是否融合超级指令（默认开启）
+    void setSuperinstructions(bool enabled) { superinstructions_ = enabled; }
+
+    // 统计操作码 n-gram 的静态出现次数，按次数降序。
+    // 超级指令按融合前的形式计数，不跨越跳转目标和无条件跳转
+    static std::vector<std::pair<std::string, size_t>> countNGrams(const ByteCode& bytecode, size_t n);
+    static void dumpNGrams(const ByteCode& bytecode, size_t n, size_t top, std::ostream& out);
+
 private:
     bool modified_;
+    bool superinstructions_ = true;
 
     void eliminateDeadPushPop(ByteCode& bytecode);
     void eliminateRedundantDup(ByteCode& bytecode);
     void mergeConstantOperations(ByteCode& bytecode);
     void optimizeJumpChains(ByteCode& bytecode);
     void eliminateNoopPatterns(ByteCode& bytecode);
+    void fuseSuperinstructions(ByteCode& bytecode);
+
+    // 跳转目标以及函数、lambda 的代码范围边界
+    static std::unordered_set<size_t> collectJumpTargets(const ByteCode& bytecode);
+    // 删除指令并重新映射跳转目标和代码范围
+    static void removeInstructions(ByteCode& bytecode, std::vector<size_t> removals);
 };
 
 } // namespace rumina
@@ -8,6 +8,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <memory>
+#include <optional>
 
 namespace rumina {
 
@@ -15,6 +16,15 @@ namespace rumina {
 struct SymbolInfo {
     std::string name;
     size_t depth;
+    std::optional<size_t> slot;  // 函数局部变量的槽位
+};
+
+// 函数作用域：函数体内的局部变量按名字平铺分配槽位
+struct FunctionScope {
+    std::unordered_map<std::string, size_t> slots;
+    std::vector<std::string> slot_names;
+    std::unordered_set<std::string> immutable;
+    size_t scope_depth;
 };
 
 class SymbolTable {
@@ -26,8 +36,17 @@ public:
     void define(const std::string& name);
     const SymbolInfo* resolve(const std::string& name) const;
 
+    // 函数作用域与槽位分配
+    void enterFunction();
+    FunctionScope exitFunction();
+    bool inFunction() const { return !functions_.empty(); }
+    size_t declareLocal(const std::string& name, bool immutable = false);
+    std::optional<size_t> resolveLocal(const std::string& name) const;
+    bool isImmutableLocal(const std::string& name) const;
+
 private:
     std::vector<std::unordered_map<std::string, SymbolInfo>> scopes_;
+    std::vector<FunctionScope> functions_;
 };
 
 // 循环上下文
@@ -59,8 +78,18 @@ private:
     size_t emitJump(OpCode op);
     void patchJump(size_t address);
 
+    void emitLoadVar(const std::string& name);
+    void emitStoreVar(const std::string& name);
+    void emitDeclare(const std::string& name, bool immutable);
+
+    void collectLocals(const Stmt* stmt);
+    void beginFunction(const std::vector<std::string>& params);
+    void endFunction(FuncDefInfo& info);
+
     void compileStmt(const Stmt* stmt);
     void compileExpr(const Expr* expr);
+    // 函数内 return 的是普通调用时生成 TailCall，返回 false 表示不是尾调用
+    bool compileTailCall(const Expr* expr);
     void compileInclude(const std::string& path);
     
     std::string extractModuleName(const std::vector<std::unique_ptr<Stmt>>& statements, 
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "value.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace rumina {
+
+struct GcStats {
+    size_t collections = 0;      // 回收次数
+    size_t collected = 0;        // 累计释放的容器单元
+    size_t last_collected = 0;   // 最近一次释放的容器单元
+    size_t tracked = 0;          // 当前存活的容器单元
+    size_t allocated = 0;        // 累计创建的容器单元
+    uint64_t total_pause_us = 0;
+    uint64_t last_pause_us = 0;
+};
+
+// 引用计数之外的环回收器，回收数组、结构体、模块和闭包之间的循环引用。
+// 所有容器单元挂在一条链表上，回收时做试探删除：
+// 先从每个单元的引用计数里减去来自其他容器的引用，剩下的就是外部引用；
+// 从有外部引用的单元出发标记可达，其余单元只被环引用，清空它们的载荷后由引用计数释放。
+// 经 std::shared_ptr 间接持有的值（被多个 lambda 共享的闭包表等）只在独占时遍历，
+// 否则按外部引用处理，宁可漏收也不会误删。
+// 回收必须在没有其他线程修改值的时候进行；自动回收由 VM 在回跳和调用处检查 pending() 触发
+class CycleCollector {
+public:
+    static constexpr size_t kDefaultThreshold = 10000;
+
+    // 立即回收，返回释放的容器单元数；持有 ConcurrentScope 期间不回收，返回 0，
+    // 回收推迟到最后一个 ConcurrentScope 结束
+    static size_t collect();
+
+    // 新建的容器单元数超过 max(threshold, 上次回收后的存活数) 时置 pending；0 关闭自动回收
+    static void setThreshold(size_t threshold);
+    static size_t threshold();
+
+    static bool pending() { return pending_.load(std::memory_order_relaxed); }
+    // 是否有 ConcurrentScope 存活，即其他线程可能同时在运行脚本
+    static bool concurrent() { return concurrent_.load(std::memory_order_acquire) != 0; }
+
+    static GcStats stats();
+
+    // 其他线程可能同时创建或释放值的期间（如并行任务运行时）持有一个 ConcurrentScope，
+    // 容器单元的登记才加锁；单线程运行时不付出加锁的代价。
+    // 期间 pending() 保持为假，到达阈值的回收在最后一个 scope 结束时重新置位
+    class ConcurrentScope {
+    public:
+        ConcurrentScope() { concurrent_.fetch_add(1, std::memory_order_acq_rel); }
+        ~ConcurrentScope() {
+            if (concurrent_.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+                deferred_.exchange(false, std::memory_order_relaxed)) {
+                pending_.store(true, std::memory_order_relaxed);
+            }
+        }
+        ConcurrentScope(const ConcurrentScope&) = delete;
+        ConcurrentScope& operator=(const ConcurrentScope&) = delete;
+    };
+
+private:
+    friend struct detail::ContainerCell;
+    friend class Jit;  // 本地代码在回跳处直接读 pending_
+
+    static void track(detail::ContainerCell* cell);
+    static void untrack(detail::ContainerCell* cell);
+
+    static std::atomic<bool> pending_;
+    static std::atomic<int> concurrent_;
+    static std::atomic<bool> deferred_;  // 并行期间到达阈值，等 scope 结束再置 pending
+};
+
+} // namespace rumina
@@ -51,5 +51,10 @@ enum class UnaryOp;
 
 // 类型别名
 using NativeFunction = std::function<Value(const std::vector<Value>&)>;
+// 原生函数 ABI：实参以视图形式传入（定义见 value.h），调用不复制、不分配
+class NativeArgs;
+using NativeFn = Value (*)(NativeArgs args);
+// 带上下文指针的原生函数
+using NativeContextFn = Value (*)(void* context, NativeArgs args);
 
 } // namespace rumina
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "atom.h"
+#include "value.h"
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rumina {
+
+// 全局变量槽位表
+// 存储仍然是 Interpreter、VM 和内置函数共享的名字映射；
+// 每个名字（原子）在程序加载时分配一个稳定的下标，槽位缓存映射节点的地址，
+// 之后按下标读写不再计算字符串哈希（unordered_map 插入不会使节点地址失效）
+class GlobalTable {
+public:
+    explicit GlobalTable(std::shared_ptr<std::unordered_map<std::string, Value>> storage);
+
+    // 槽位编号和不可变标记相同、改为读写另一份存储的表（VM::fork 使用）
+    GlobalTable rebind(std::shared_ptr<std::unordered_map<std::string, Value>> storage) const;
+
+    // 为名字分配槽位，已分配过则返回原下标
+    size_t resolve(Atom name);
+    size_t resolve(const std::string& name) { return resolve(AtomTable::intern(name)); }
+    // 按名字查找已分配的槽位（动态访问、REPL）
+    std::optional<size_t> find(Atom name) const;
+    std::optional<size_t> find(const std::string& name) const;
+
+    // 读取槽位，名字尚未定义时返回 nullptr
+    Value* get(size_t slot) {
+        Slot& s = slots_[slot];
+        if (!s.value) bind(s);
+        return s.value;
+    }
+    void set(size_t slot, const Value& value);
+    // 按名字读取而不分配槽位（动态访问、出错路径），名字尚未定义时返回 nullptr
+    const Value* lookup(Atom name) const;
+
+    Atom atomOf(size_t slot) const { return slots_[slot].name; }
+    const std::string& nameOf(size_t slot) const { return AtomTable::name(slots_[slot].name); }
+    bool isImmutable(size_t slot) const { return slots_[slot].immutable; }
+    void markImmutable(size_t slot) { slots_[slot].immutable = true; }
+    size_t size() const { return slots_.size(); }
+
+private:
+    struct Slot {
+        Atom name;
+        Value* value = nullptr;
+        bool immutable = false;
+    };
+
+    void bind(Slot& slot);
+
+    std::shared_ptr<std::unordered_map<std::string, Value>> storage_;
+    std::unordered_map<Atom, size_t> index_;
+    std::vector<Slot> slots_;
+};
+
+} // namespace rumina
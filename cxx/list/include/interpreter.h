@@ -37,6 +37,9 @@ private:
     std::vector<std::shared_ptr<std::unordered_map<std::string, Value>>> locals_;
     std::vector<std::unordered_set<std::string>> immutable_locals_;
     
+    // 每个 lambda 表达式引用到的变量名（捕获分析结果），按表达式缓存
+    std::unordered_map<const LambdaExpr*, std::vector<std::string>> lambda_captures_;
+    
     std::optional<Value> return_value_;
     bool break_flag_ = false;
     bool continue_flag_ = false;
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "fwd.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 基线 JIT 只支持 Linux x86-64，其他平台编译为空实现（setJitEnabled 返回 false）。
+// 编译时定义 RUMINA_JIT=0 可在 x86-64 上同样关闭
+#ifndef RUMINA_JIT
+#if defined(__linux__) && defined(__x86_64__)
+#define RUMINA_JIT 1
+#else
+#define RUMINA_JIT 0
+#endif
+#endif
+
+namespace rumina {
+
+class VM;
+struct Instruction;
+enum class OpCodeType : uint8_t;
+
+struct JitOptions {
+    // 函数被调用或在函数内回跳的次数达到阈值后编译
+    uint32_t threshold = 1000;
+    // 每编译一个函数向 /tmp/perf-<pid>.map 追加一行，供 perf 显示函数名
+    bool perf_map = false;
+};
+
+struct JitStats {
+    size_t compiled_functions = 0;
+    size_t code_bytes = 0;
+    size_t native_entries = 0;  // 从解释器进入本地代码的次数
+};
+
+// 模板式基线 JIT：把热点函数的字节码逐条翻译成机器码。
+// 整数算术、比较、局部变量读写、常量入栈和跳转直接生成本地代码，
+// 类型守卫失败和其余指令调用辅助函数执行原指令，语义与解释器完全一致。
+// 算术只有 Int × Int 的快速路径：value_binary_op 没有 Float 运算分支，
+// 本地代码若直接做浮点运算会与解释器的结果（报错）不一致，Float 操作数走辅助函数。
+// 函数内回跳和解释器一样检查 CycleCollector::pending() 和 tracer，
+// 热点循环录制成 trace 后由 trace 接手。
+// 函数入口、调用返回点和循环头的指令被改写为 JitEntry，解释器执行到它们时
+// 转入本地代码；本地代码遇到调用、返回、跳出函数范围时写回 ip_ 交还解释器
+class Jit {
+public:
+    // 当前平台或标准库布局不支持时返回 nullptr
+    static std::unique_ptr<Jit> create(VM& vm, const JitOptions& options);
+    ~Jit();
+
+    Jit(const Jit&) = delete;
+    Jit& operator=(const Jit&) = delete;
+
+    // 新程序载入后丢弃全部本地代码
+    void reset();
+
+    // 解释器在调用和函数内回跳时计数，达到阈值时编译对应原型（只编译一次）
+    void countHot(size_t proto_index) {
+        uint32_t& hotness = hotnessAt(proto_index);
+        if (hotness < options_.threshold && ++hotness == options_.threshold) {
+            compile(proto_index);
+        }
+    }
+
+    // 执行 ip 处 JitEntry 对应的本地代码，出错时返回 false（错误已写入 VM）
+    bool enter(size_t ip);
+    // ip 处的 JitEntry 改写前的操作码（复制指令流给没有 JIT 的 VM 时还原用）
+    OpCodeType originalOpCode(size_t ip) const;
+
+    const JitStats& stats() const { return stats_; }
+
+private:
+    struct Function;
+    struct Entry;
+
+    Jit(VM& vm, const JitOptions& options);
+
+    uint32_t& hotnessAt(size_t proto_index) {
+        if (proto_index >= hotness_.size()) hotness_.resize(proto_index + 1, 0);
+        return hotness_[proto_index];
+    }
+    void compile(size_t proto_index);
+    void writePerfMap(const void* code, size_t size, const std::string& name);
+
+    // 本地代码调用的辅助函数，返回 0 继续、1 退出到解释器、2 出错
+    static int stepGeneric(VM* vm, const Instruction* op, size_t ip);
+    // 弹出栈顶并返回其真假（0 / 1），栈空时返回 2
+    static int popTruthy(VM* vm, size_t ip);
+    // ip 处回跳到 header：处理待回收的环和 tracer 计数，交给 trace 时返回 1
+    static int backEdge(VM* vm, size_t header, size_t ip);
+
+    VM& vm_;
+    JitOptions options_;
+    JitStats stats_;
+    std::vector<uint32_t> hotness_;
+    std::vector<std::unique_ptr<Function>> functions_;
+    // 以指令下标索引，只在改写为 JitEntry 的位置有效
+    std::vector<Entry> entries_;
+};
+
+} // namespace rumina
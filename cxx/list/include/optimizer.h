@@ -22,6 +22,8 @@ private:
 
     std::optional<std::unique_ptr<Stmt>> optimizeStmt(
         std::unique_ptr<Stmt> stmt);
+    std::optional<std::unique_ptr<Stmt>> rewriteStmt(
+        std::unique_ptr<Stmt> stmt);
 
     std::unique_ptr<Expr> optimizeExpr(std::unique_ptr<Expr> expr);
 
@@ -26,6 +26,7 @@ private:
     Token previous() const;
 
     std::unique_ptr<Stmt> parseStatement();
+    std::unique_ptr<Stmt> parseStatementBody();
     std::unique_ptr<Stmt> parseVarDeclWithType(std::optional<DeclaredType> declared_type, bool immutable);
     std::unique_ptr<Stmt> parseStructDecl();
     std::unique_ptr<Stmt> parseDecoratedFuncDef();
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "atom.h"
+#include "value.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rumina {
+
+// 隐藏类（形状）：描述结构体的字段名到槽位下标的映射，字段名以原子保存
+// 共享形状组成一棵从空形状出发的转换树，按相同顺序添加相同字段的对象共享同一个形状，
+// 因此内联缓存可以用形状指针比较代替字符串查找。共享形状创建后不可变、永不释放。
+// 字段数超过 kMaxSharedFields 的对象进入字典模式，使用自己独占的可变形状，不参与缓存。
+// 运行时按字符串加入、尚未驻留的键（环境变量名、数据里的键等）不创建原子，
+// 对象同样转为字典模式，键以字符串保存在独占形状里
+class Shape {
+public:
+    static constexpr size_t kMaxSharedFields = 64;
+
+    // 空形状（转换树的根）
+    static const Shape* root();
+
+    // 追加一个字段后的共享形状，转换结果会被缓存
+    const Shape* withField(Atom name) const;
+
+    // 字段槽位，不存在时返回 -1
+    int32_t slotOf(Atom name) const {
+        auto it = index_.find(name);
+        if (it != index_.end()) return static_cast<int32_t>(it->second);
+        // 字符串键加入时还没有这个原子
+        return keys_.empty() ? -1 : keySlot(AtomTable::name(name));
+    }
+    // 按字符串查找（内置函数、嵌入接口），不驻留名字
+    int32_t slotOf(const std::string& name) const {
+        Atom atom = AtomTable::find(name);
+        if (atom != kNoAtom) return slotOf(atom);
+        return keys_.empty() ? -1 : keySlot(name);
+    }
+
+    size_t size() const { return names_.size(); }
+    // 字符串键的槽位返回 kNoAtom
+    Atom atomAt(size_t slot) const { return names_[slot]; }
+    const std::string& nameAt(size_t slot) const {
+        return names_[slot] != kNoAtom ? AtomTable::name(names_[slot]) : strings_[slot];
+    }
+
+    // 共享形状可以作为内联缓存的键
+    bool isShared() const { return shared_; }
+
+    // 字典模式使用的独占形状
+    static std::unique_ptr<Shape> makeDictionary(const Shape& from);
+    void appendField(Atom name);
+    // 追加不驻留的字符串键（只用于字典模式）
+    void appendKey(const std::string& name);
+
+private:
+    Shape() = default;
+
+    int32_t keySlot(const std::string& name) const {
+        auto it = keys_.find(name);
+        return it == keys_.end() ? -1 : static_cast<int32_t>(it->second);
+    }
+
+    std::vector<Atom> names_;
+    std::unordered_map<Atom, uint32_t> index_;
+    // 字典模式：与 names_ 等长，字符串键的槽位保存名字，其余为空串
+    std::vector<std::string> strings_;
+    std::unordered_map<std::string, uint32_t> keys_;
+    bool shared_ = true;
+    mutable std::unordered_map<Atom, std::unique_ptr<Shape>> transitions_;
+};
+
+// 结构体 / 模块对象：形状 + 字段槽位数组
+// 提供与 std::unordered_map<std::string, Value> 相近的接口（find、operator[]、迭代），
+// 迭代按字段添加顺序进行
+class StructObject {
+public:
+    template<bool Const>
+    class Iterator {
+    public:
+        using Owner = std::conditional_t<Const, const StructObject, StructObject>;
+        using ValueRef = std::conditional_t<Const, const Value&, Value&>;
+        using reference = std::pair<const std::string&, ValueRef>;
+
+        struct ArrowProxy {
+            reference ref;
+            reference* operator->() { return &ref; }
+        };
+
+        Iterator(Owner* owner, size_t slot) : owner_(owner), slot_(slot) {}
+
+        reference operator*() const {
+            return reference(owner_->shape_->nameAt(slot_), owner_->slots_[slot_]);
+        }
+        ArrowProxy operator->() const { return ArrowProxy{**this}; }
+
+        Iterator& operator++() { ++slot_; return *this; }
+        bool operator==(const Iterator& other) const { return slot_ == other.slot_; }
+        bool operator!=(const Iterator& other) const { return slot_ != other.slot_; }
+
+        size_t slot() const { return slot_; }
+
+    private:
+        Owner* owner_;
+        size_t slot_;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    StructObject() : shape_(Shape::root()) {}
+    // 按键排序建立形状，使同一组键总是得到同一个形状
+    explicit StructObject(const std::unordered_map<std::string, Value>& fields);
+    StructObject(const StructObject& other);
+    StructObject& operator=(const StructObject& other);
+
+    const Shape* shape() const { return shape_; }
+    Value& slot(size_t index) { return slots_[index]; }
+    const Value& slot(size_t index) const { return slots_[index]; }
+
+    // 已知目标形状时追加字段（内联缓存命中转换时使用）
+    void appendWithShape(const Shape* shape, Value value) {
+        shape_ = shape;
+        slots_.push_back(std::move(value));
+    }
+
+    // 设置字段，不存在时追加，返回槽位。
+    // 按字符串设置时名字已驻留则与原子等价，否则对象转为字典模式
+    size_t set(Atom name, Value value);
+    size_t set(const std::string& name, Value value);
+
+    // 查找接口同时接受原子和字符串
+    template<typename Name>
+    iterator find(const Name& name) {
+        int32_t slot = shape_->slotOf(name);
+        return iterator(this, slot < 0 ? slots_.size() : static_cast<size_t>(slot));
+    }
+    template<typename Name>
+    const_iterator find(const Name& name) const {
+        int32_t slot = shape_->slotOf(name);
+        return const_iterator(this, slot < 0 ? slots_.size() : static_cast<size_t>(slot));
+    }
+    template<typename Name>
+    size_t count(const Name& name) const { return shape_->slotOf(name) < 0 ? 0 : 1; }
+    Value& operator[](Atom name);
+    Value& operator[](const std::string& name);
+    size_t erase(Atom name);
+    size_t erase(const std::string& name) { return eraseSlot(shape_->slotOf(name)); }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, slots_.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, slots_.size()); }
+
+    size_t size() const { return slots_.size(); }
+    bool empty() const { return slots_.empty(); }
+
+    // 删除全部字段回到空形状；字段值在对象恢复一致之后才析构
+    void clear() {
+        std::vector<Value> slots = std::move(slots_);
+        slots_.clear();
+        own_shape_.reset();
+        shape_ = Shape::root();
+    }
+
+private:
+    void appendField(Atom name);
+    void appendKey(const std::string& name);
+    size_t eraseSlot(int32_t slot);
+
+    const Shape* shape_;
+    std::unique_ptr<Shape> own_shape_;  // 字典模式下独占的形状
+    std::vector<Value> slots_;
+};
+
+} // namespace rumina
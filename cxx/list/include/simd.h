@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+namespace rumina {
+
+// double 向量运算内核。x86-64 上按 CPU 在 AVX2 / SSE2 实现之间选择（运行时检测一次），
+// 其他平台使用标量实现。归约按向量宽度分组累加，结果与逐个累加可能有舍入误差级别的差异。
+// 所有指针都不要求对齐；输出可以与输入重叠在同一位置（out == a），但不能错位重叠
+namespace simd {
+
+enum class Level { Scalar, SSE2, AVX2 };
+
+// 当前使用的实现
+Level level();
+const char* levelName(Level level);
+// 改用不高于 CPU 支持的实现（测试和排查问题时使用），返回实际生效的级别
+Level setLevel(Level level);
+
+double dot(const double* a, const double* b, size_t n);
+double sumSquares(const double* a, size_t n);
+double sum(const double* a, size_t n);
+// n 必须大于 0；含 NaN 时结果未定义
+double min(const double* a, size_t n);
+double max(const double* a, size_t n);
+
+void add(const double* a, const double* b, double* out, size_t n);
+void sub(const double* a, const double* b, double* out, size_t n);
+void mul(const double* a, const double* b, double* out, size_t n);
+void div(const double* a, const double* b, double* out, size_t n);
+void scale(const double* a, double k, double* out, size_t n);
+// out[i] = a[0] + ... + a[i]
+void prefixSum(const double* a, double* out, size_t n);
+
+} // namespace simd
+} // namespace rumina
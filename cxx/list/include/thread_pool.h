@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rumina {
+
+struct SchedulerStats {
+    size_t threads = 0;    // 工作线程数（不含帮忙执行任务的等待线程）
+    size_t queued = 0;     // 当前排队的任务数
+    size_t submitted = 0;  // 累计提交的任务
+    size_t completed = 0;  // 累计执行完的任务
+    size_t steals = 0;     // 从其他工作线程队列窃取的次数
+};
+
+// 工作窃取线程池：每个工作线程有自己的双端队列，
+// 工作线程提交的任务压入自己队列的尾部并从尾部取（后进先出，数据还在缓存里），
+// 其他线程提交的任务进入注入队列；自己的队列空了再取注入队列，最后从其他线程队列的头部窃取
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 进程共用的调度器，大数幂、矩阵乘法和并行数组函数都提交到这里，第一次使用时创建。
+    // 线程数依次取 setSharedThreads 的设置、环境变量 RUMINA_THREADS、硬件线程数
+    static ThreadPool& shared();
+    // 设置共用调度器的线程数（命令行 --threads），调度器已创建时不再生效，返回 false
+    static bool setSharedThreads(size_t threads);
+
+    // 任务不能抛出异常，需要把异常传回等待者时用 TaskGroup
+    void submit(Task task);
+    // 在调用线程上执行一个排队的任务，没有任务时返回 false。
+    // 等待任务组的线程借此帮忙，嵌套的并行任务不会因为所有线程都在等待而死锁
+    bool runOne();
+
+    size_t size() const { return workers_.size(); }
+    // 当前线程在本池中的工作线程编号，池外的线程返回 size()
+    size_t currentIndex() const;
+    SchedulerStats stats() const;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool take(size_t self, Task& task);
+    bool popFront(Queue& queue, Task& task);
+    void execute(Task& task);
+    void workerLoop(size_t index);
+
+    std::vector<std::unique_ptr<Queue>> queues_;  // 最后一个是注入队列
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> submitted_{0};
+    std::atomic<size_t> completed_{0};
+    std::atomic<size_t> steals_{0};
+    bool stopping_ = false;
+};
+
+// 一组任务：wait() 等全部完成并重新抛出第一个异常，等待期间调用线程也执行排队的任务
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool_(pool) {}
+    ~TaskGroup();
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> task);
+    void wait();
+
+private:
+    ThreadPool& pool_;
+    std::atomic<size_t> remaining_{0};
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::exception_ptr error_;
+};
+
+} // namespace rumina
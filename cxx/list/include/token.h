@@ -1,5 +1,6 @@
 #pragma once
 
+#include "atom.h"
 #include <string>
 #include <variant>
 #include <cstdint>
@@ -108,6 +109,7 @@ struct Token {
     TokenValue value;
     size_t line;
     size_t column;
+    Atom atom = kNoAtom;  // 标识符在词法分析时驻留的原子
 
     Token(TokenType t, size_t l, size_t c) : type(t), line(l), column(c) {}
     
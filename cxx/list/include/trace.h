@@ -0,0 +1,73 @@
+#pragma once
+
+#include "fwd.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rumina {
+
+class VM;
+
+struct TraceStats {
+    size_t recorded = 0;    // 录制成功的 trace
+    size_t aborted = 0;     // 录制中止（遇到不支持的指令、类型或离开循环）
+    size_t entries = 0;     // 进入 trace 的次数
+    size_t side_exits = 0;  // 守卫失败回到解释器的次数（包括循环正常结束）
+    size_t guards_removed = 0;  // 录制时因与前面的守卫重复而省掉的守卫
+};
+
+// 热点循环的 trace 录制与执行。
+// 回跳指令按循环头计数，达到 kHotLoop 后在解释器执行下一次迭代的同时录制
+// 一条线性 trace：分支变成守卫，Int / Bool 局部变量和全局变量拆箱到寄存器，
+// 常量在录制时折叠并提到循环外，类型守卫只在进入时检查一次，
+// 同一寄存器上重复的分支和除数守卫在录制时省掉。
+// 之后回跳到该循环头时直接执行 trace，守卫失败时把寄存器写回变量、
+// 按快照恢复操作数栈并从对应的字节码继续解释执行
+class Tracer {
+public:
+    static constexpr uint32_t kHotLoop = 50;        // 开始录制前的回跳次数
+    static constexpr uint32_t kMaxAttempts = 3;     // 录制失败多少次后不再尝试
+    static constexpr size_t kMaxTraceLength = 512;  // 一次迭代最多录制的指令数
+
+    explicit Tracer(VM& vm);
+    ~Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    // 新程序载入后丢弃全部 trace 和计数
+    void reset();
+
+    // 回跳的快速检查，分发循环每次回跳调用：返回 false 时不必进入 onBackEdge。
+    // 尚未变热的循环只递减计数，放弃录制的循环一直返回 false，
+    // 这样只有热点循环的候选离开 threaded 分发的快速路径
+    bool needsBackEdge(size_t header) {
+        if (header >= countdown_.size()) return true;
+        uint32_t& left = countdown_[header];
+        return left == 0 || --left == 0;
+    }
+
+    // 回跳到循环头 header 时调用（ip_ 已指向 header）。
+    // 可能录制或执行 trace，之后 ip_ 指向继续解释执行的位置；出错时返回 false
+    bool onBackEdge(size_t header);
+
+    const TraceStats& stats() const { return stats_; }
+
+private:
+    struct Trace;
+    struct Loop;
+    class Recorder;
+
+    bool record(Loop& loop, size_t header);
+    void run(Trace& trace);
+
+    VM& vm_;
+    TraceStats stats_;
+    std::vector<Loop> loops_;  // 以循环头的指令下标索引
+    // 距离下一次需要进入 onBackEdge 的回跳次数，与 loops_ 同下标；0 表示已有 trace
+    std::vector<uint32_t> countdown_;
+};
+
+} // namespace rumina
@@ -2,11 +2,17 @@
 
 #include "fwd.h"
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <functional>
+#include <stdexcept>
 #include <variant>
+#include <atomic>
+#include <utility>
+#include <type_traits>
 #include <cstdint>
 #include <cmath>
 #include <iostream>
@@ -18,6 +24,15 @@ namespace rumina {
 using BigInt = mpz_class;
 using BigRational = mpq_class;
 
+// 结构体对象（定义见 shape.h）
+class StructObject;
+// 数组对象（定义见 array_object.h）
+class ArrayObject;
+// lambda 捕获的变量（定义在 Value 之后）
+struct Upvalue;
+// 原生函数实参视图（定义在 Value 之后）
+class NativeArgs;
+
 // 函数指针类型 - 已经在 fwd.h 中声明
 // using NativeFunction = std::function<Value(const std::vector<Value>&)>;
 
@@ -71,10 +86,175 @@ public:
     bool operator==(const IrrationalValue& other) const;
 };
 
+namespace detail {
+
+// 引用计数的堆单元，Value 的非立即数载荷都放在这里，Value 本身只保存一个指针。
+// 计数默认用普通加减；标记为 shared 之后（见 Value::share）改用原子操作，
+// 所以只有真正交给其他线程的对象才付出原子指令的代价
+struct HeapCell {
+    // 未共享时只用 relaxed 的读和写，编译出来与普通整数加减相同
+    std::atomic<uint32_t> refs{1};
+    bool shared = false;
+    
+    HeapCell() = default;
+    HeapCell(const HeapCell&) = delete;
+    HeapCell& operator=(const HeapCell&) = delete;
+    virtual ~HeapCell() = default;
+    virtual HeapCell* clone() const = 0;
+    
+    void retain() {
+        if (shared) refs.fetch_add(1, std::memory_order_relaxed);
+        else refs.store(refs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    void release() {
+        if (shared) {
+            if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+            return;
+        }
+        uint32_t remaining = refs.load(std::memory_order_relaxed) - 1;
+        if (remaining == 0) {
+            delete this;
+        } else {
+            refs.store(remaining, std::memory_order_relaxed);
+        }
+    }
+    uint32_t count() const {
+        return refs.load(shared ? std::memory_order_acquire : std::memory_order_relaxed);
+    }
+};
+
+template<typename T>
+struct Boxed final : HeapCell {
+    T value;
+    
+    template<typename... Args>
+    explicit Boxed(Args&&... args) : value(std::forward<Args>(args)...) {}
+    HeapCell* clone() const override { return new Boxed<T>(value); }
+};
+
+// 字符串堆单元，创建后不可变，所以值的副本之间总是共享同一个单元。
+// 平坦字符串持有自己的 std::string（短串放在 std::string 的内联缓冲里，只分配一次）；
+// 切片持有底层平坦单元的引用和一段范围，创建是 O(1)，第一次需要 std::string 时才复制出来。
+// 哈希在第一次使用时计算并缓存。
+// 拼接结果放在预留了容量的构建缓冲里（本身不作为值出现，只被切片引用）：
+// 左操作数正好结束在缓冲末尾时直接在后面追加，已有切片看到的字节不变，
+// 因此 s = s + x 的循环每次追加是均摊 O(1)
+struct StringCell final : HeapCell {
+    explicit StringCell(std::string text);
+    // 切片：base 必须是平坦单元或构建缓冲，构造时增加它的计数
+    StringCell(StringCell* base, size_t offset, size_t length);
+    ~StringCell() override;
+    HeapCell* clone() const override { return new StringCell(std::string(view_)); }
+    
+    // 新的构建缓冲，内容为 head + tail，预留 capacity 字节
+    static StringCell* makeBuffer(std::string_view head, std::string_view tail, size_t capacity);
+    // view 是本缓冲末尾的一段且剩余容量足够时原地追加 tail，返回是否成功
+    bool tryAppend(std::string_view view, std::string_view tail);
+    
+    std::string_view view() const { return view_; }
+    const std::string& str() const;
+    size_t hash() const;
+    StringCell* base() const { return base_; }
+    // 字节在 base 中的偏移
+    size_t offsetIn(const StringCell* base) const {
+        return static_cast<size_t>(view_.data() - base->text_.data());
+    }
+    
+private:
+    StringCell() = default;
+    
+    mutable std::string text_;
+    std::string_view view_;
+    StringCell* base_ = nullptr;
+    bool buffer_ = false;      // 构建缓冲：text_ 只在末尾追加，view_ 不使用
+    mutable std::atomic<size_t> hash_{0};  // 0 表示尚未计算；共享的字符串可能被多个线程同时算
+    mutable std::once_flag flatten_;
+};
+
+struct ContainerCell;
+using CellList = std::vector<ContainerCell*>;
+
+// 能引用其他值、可能参与循环引用的堆单元（数组、结构体、lambda 等）。
+// 构造时登记到环回收器的链表，析构时摘除（见 cycle_collector.h）
+struct ContainerCell : HeapCell {
+    ContainerCell* gc_prev = nullptr;
+    ContainerCell* gc_next = nullptr;
+    int64_t gc_refs = 0;  // 回收过程中使用的临时计数
+    
+    ContainerCell();
+    ~ContainerCell() override;
+    
+    // 载荷每引用一次容器单元就向 out 追加一次
+    virtual void visitChildren(CellList& out) const = 0;
+    // 丢弃载荷持有的全部值，用来打断环
+    virtual void clearChildren() = 0;
+};
+
+template<typename T>
+struct Traced final : ContainerCell {
+    T value;
+    
+    template<typename... Args>
+    explicit Traced(Args&&... args) : value(std::forward<Args>(args)...) {}
+    HeapCell* clone() const override { return new Traced<T>(value); }
+    void visitChildren(CellList& out) const override { traceChildren(value, out); }
+    void clearChildren() override { clearPayload(value); }
+};
+
+} // namespace detail
+
+// 指向 Value 堆单元的侵入式引用计数指针，数组和结构体这类引用语义的载荷通过它传递。
+// 对象和计数在同一次分配里，与持有它的 Value 共用一个计数
+template<typename T>
+class Ref {
+public:
+    Ref() = default;
+    Ref(std::nullptr_t) {}
+    Ref(const Ref& other) : cell_(other.cell_) { if (cell_) cell_->retain(); }
+    Ref(Ref&& other) noexcept : cell_(other.cell_) { other.cell_ = nullptr; }
+    Ref& operator=(Ref other) noexcept {
+        std::swap(cell_, other.cell_);
+        return *this;
+    }
+    ~Ref() { if (cell_) cell_->release(); }
+
+    T* get() const { return cell_ ? &cell_->value : nullptr; }
+    T& operator*() const { return cell_->value; }
+    T* operator->() const { return &cell_->value; }
+    explicit operator bool() const { return cell_ != nullptr; }
+    uint32_t use_count() const { return cell_ ? cell_->count() : 0; }
+
+    friend bool operator==(const Ref& a, const Ref& b) { return a.cell_ == b.cell_; }
+
+    template<typename U, typename... Args>
+    friend Ref<U> makeRef(Args&&... args);
+
+private:
+    friend class Value;
+    
+    // 接管一个已计数的引用
+    explicit Ref(detail::Traced<T>* cell) : cell_(cell) {}
+    
+    detail::Traced<T>* cell_ = nullptr;
+};
+
+template<typename T, typename... Args>
+Ref<T> makeRef(Args&&... args) {
+    return Ref<T>(new detail::Traced<T>(std::forward<Args>(args)...));
+}
+
+using ArrayRef = Ref<ArrayObject>;
+using StructRef = Ref<StructObject>;
+
 // Lamina运行时值类型
+// 布局：1 字节类型标记 + 8 字节载荷（共 16 字节）。
+// Int、Float、Bool、Null 直接存放；其余类型存放一个指向堆单元的引用计数指针，
+// 能引用其他值的载荷放在 detail::Traced<T> 里由环回收器跟踪，其余放在 detail::Boxed<T>。
+// 数组（ArrayObject）和结构体（StructObject）是引用语义，副本共享同一个对象；
+// 其余堆载荷是值语义，可写访问前按需复制
 class Value {
 public:
-    enum class Type {
+    enum class Type : uint8_t {
         Int, Float, BigInt, Rational, Irrational, Complex,
         Bool, String, Null, Array, Struct,
         Lambda, Function, Module, NativeFunction,
@@ -86,9 +266,15 @@ public:
         std::vector<std::string> params;
         std::shared_ptr<Stmt> body;
         std::shared_ptr<std::unordered_map<std::string, Value>> closure;
+        // VM 按捕获分析得到的变量，创建后不再修改；lambda 值的副本共享同一个堆单元
+        std::vector<Upvalue> upvalues;
+        uint32_t proto = 0;    // VM 函数原型下标
+        uint32_t program = 0;  // 创建它的 VM 程序编号，0 表示不是 VM 编译的
         LambdaData() = default;
         LambdaData(const LambdaData&) = default;
         LambdaData& operator=(const LambdaData&) = default;
+        LambdaData(LambdaData&&) = default;
+        LambdaData& operator=(LambdaData&&) = default;
     };
 
     struct FunctionData {
@@ -96,17 +282,29 @@ public:
         std::vector<std::string> params;
         std::shared_ptr<Stmt> body;
         std::vector<std::string> decorators;
+        uint32_t proto = 0;    // VM 函数原型下标
+        uint32_t program = 0;  // 创建它的 VM 程序编号，0 表示不是 VM 编译的
         FunctionData() = default;
         FunctionData(const FunctionData&) = default;
         FunctionData& operator=(const FunctionData&) = default;
+        FunctionData(FunctionData&&) = default;
+        FunctionData& operator=(FunctionData&&) = default;
     };
 
+    // 原生函数：优先走函数指针；func 只用于旧的 std::function 签名，调用时需复制实参
     struct NativeFunctionData {
         std::string name;
+        NativeFn fn = nullptr;
+        NativeContextFn context_fn = nullptr;
+        std::shared_ptr<void> context;
         NativeFunction func;
         NativeFunctionData() = default;
         NativeFunctionData(const NativeFunctionData&) = default;
         NativeFunctionData& operator=(const NativeFunctionData&) = default;
+        NativeFunctionData(NativeFunctionData&&) = default;
+        NativeFunctionData& operator=(NativeFunctionData&&) = default;
+        
+        Value call(NativeArgs args) const;
     };
 
     struct CurriedFunctionData {
@@ -116,6 +314,8 @@ public:
         CurriedFunctionData() = default;
         CurriedFunctionData(const CurriedFunctionData&) = default;
         CurriedFunctionData& operator=(const CurriedFunctionData&) = default;
+        CurriedFunctionData(CurriedFunctionData&&) = default;
+        CurriedFunctionData& operator=(CurriedFunctionData&&) = default;
     };
 
     struct MemoizedFunctionData {
@@ -124,127 +324,266 @@ public:
         MemoizedFunctionData() = default;
         MemoizedFunctionData(const MemoizedFunctionData&) = default;
         MemoizedFunctionData& operator=(const MemoizedFunctionData&) = default;
+        MemoizedFunctionData(MemoizedFunctionData&&) = default;
+        MemoizedFunctionData& operator=(MemoizedFunctionData&&) = default;
     };
 
+    using ComplexData = std::pair<std::shared_ptr<Value>, std::shared_ptr<Value>>;
+
+    // 载荷类型与 T 不匹配时返回 nullptr
     template<typename T>
     const T* get() const {
-        return std::get_if<T>(&data_);
+        if constexpr (std::is_same_v<T, int64_t>) {
+            return type_ == Type::Int ? &int_ : nullptr;
+        } else if constexpr (std::is_same_v<T, double>) {
+            return type_ == Type::Float ? &float_ : nullptr;
+        } else if constexpr (std::is_same_v<T, bool>) {
+            return type_ == Type::Bool ? &bool_ : nullptr;
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            return type_ == Type::String ? &stringCell()->str() : nullptr;
+        } else {
+            return holds<T>() ? &static_cast<const CellOf<T>*>(heap_)->value : nullptr;
+        }
     }
 
+    // 值语义的载荷在可写访问前先把共享的堆单元复制一份，避免影响其他副本
     template<typename T>
     T* get() {
-        return std::get_if<T>(&data_);
+        static_assert(!std::is_same_v<T, std::string>, "strings are immutable");
+        if constexpr (std::is_same_v<T, int64_t> || std::is_same_v<T, double> ||
+                      std::is_same_v<T, bool>) {
+            return const_cast<T*>(static_cast<const Value*>(this)->get<T>());
+        } else {
+            if (!holds<T>()) return nullptr;
+            if (!isReference<T>() && heap_->count() != 1) {
+                detail::HeapCell* copy = heap_->clone();
+                heap_->release();
+                heap_ = copy;
+            }
+            return &static_cast<CellOf<T>*>(heap_)->value;
+        }
+    }
+
+    // 数组、结构体、模块和各种闭包由环回收器跟踪，其余类型返回 nullptr
+    detail::ContainerCell* containerCell() const {
+        return isTraced(type_) ? static_cast<detail::ContainerCell*>(heap_) : nullptr;
     }
 
 private:
     Type type_;
-    
-    using Data = std::variant<
-        std::monostate,
-        int64_t,
-        double,
-        bool,
-        std::string,
-        BigInt,
-        BigRational,
-        IrrationalValue,
-        std::pair<std::shared_ptr<Value>, std::shared_ptr<Value>>,
-        std::shared_ptr<std::vector<Value>>,
-        std::shared_ptr<std::unordered_map<std::string, Value>>,
-        LambdaData,
-        FunctionData,
-        NativeFunctionData,
-        CurriedFunctionData,
-        MemoizedFunctionData
-    >;
-    
-    Data data_;
+    union {
+        int64_t int_;
+        double float_;
+        bool bool_;
+        detail::HeapCell* heap_;
+    };
+
+    static constexpr bool isImmediate(Type t) {
+        return t == Type::Int || t == Type::Float || t == Type::Bool || t == Type::Null;
+    }
+
+    template<typename T>
+    static constexpr bool isReference() {
+        return std::is_same_v<T, ArrayObject> || std::is_same_v<T, StructObject>;
+    }
+
+    static constexpr bool isTraced(Type t) {
+        return t == Type::Array || t == Type::Struct || t == Type::Module || t == Type::Lambda ||
+               t == Type::CurriedFunction || t == Type::MemoizedFunction;
+    }
+
+    template<typename T>
+    static constexpr bool isTraced() {
+        return isReference<T>() || std::is_same_v<T, LambdaData> ||
+               std::is_same_v<T, CurriedFunctionData> || std::is_same_v<T, MemoizedFunctionData>;
+    }
+
+    template<typename T>
+    using CellOf = std::conditional_t<isTraced<T>(), detail::Traced<T>, detail::Boxed<T>>;
+
+    // 各类型对应的堆载荷
+    template<typename T>
+    bool holds() const {
+        if constexpr (std::is_same_v<T, std::string>) return type_ == Type::String;
+        else if constexpr (std::is_same_v<T, BigInt>) return type_ == Type::BigInt;
+        else if constexpr (std::is_same_v<T, BigRational>) return type_ == Type::Rational;
+        else if constexpr (std::is_same_v<T, IrrationalValue>) return type_ == Type::Irrational;
+        else if constexpr (std::is_same_v<T, ComplexData>) return type_ == Type::Complex;
+        else if constexpr (std::is_same_v<T, ArrayObject>) return type_ == Type::Array;
+        else if constexpr (std::is_same_v<T, StructObject>) 
+            return type_ == Type::Struct || type_ == Type::Module;
+        else if constexpr (std::is_same_v<T, LambdaData>) return type_ == Type::Lambda;
+        else if constexpr (std::is_same_v<T, FunctionData>) return type_ == Type::Function;
+        else if constexpr (std::is_same_v<T, NativeFunctionData>) return type_ == Type::NativeFunction;
+        else if constexpr (std::is_same_v<T, CurriedFunctionData>) return type_ == Type::CurriedFunction;
+        else if constexpr (std::is_same_v<T, MemoizedFunctionData>) return type_ == Type::MemoizedFunction;
+        else return false;
+    }
+
+    template<typename T>
+    const T& payload() const {
+        return static_cast<const CellOf<T>*>(heap_)->value;
+    }
+
+    template<typename T, typename... Args>
+    static Value boxed(Type type, Args&&... args) {
+        Value v;
+        v.type_ = type;
+        v.heap_ = new CellOf<T>(std::forward<Args>(args)...);
+        return v;
+    }
+
+    // 借出自己持有的堆单元（计数加一）
+    template<typename T>
+    Ref<T> ref() const {
+        heap_->retain();
+        return Ref<T>(static_cast<detail::Traced<T>*>(heap_));
+    }
+
+    // 接管 Ref 持有的那次计数
+    template<typename T>
+    static Value adopt(Type type, Ref<T>&& ref) {
+        Value v;
+        v.type_ = type;
+        v.heap_ = std::exchange(ref.cell_, nullptr);
+        return v;
+    }
+
+    void releaseHeap() {
+        if (!isImmediate(type_)) heap_->release();
+    }
+
+    const detail::StringCell* stringCell() const {
+        return static_cast<const detail::StringCell*>(heap_);
+    }
+
+    static Value fromStringCell(detail::StringCell* cell) {
+        Value v;
+        v.type_ = Type::String;
+        v.heap_ = cell;
+        return v;
+    }
 
 public:
     // 构造函数
-    Value() : type_(Type::Null), data_(std::monostate{}) {}
+    Value() : type_(Type::Null), int_(0) {}
     
     // 基本类型构造函数
-    Value(int64_t i) : type_(Type::Int), data_(i) {}
-    Value(double f) : type_(Type::Float), data_(f) {}
-    Value(bool b) : type_(Type::Bool), data_(b) {}
-    Value(const std::string& s) : type_(Type::String), data_(s) {}
-    Value(const char* s) : type_(Type::String), data_(std::string(s)) {}
-    Value(const BigInt& bi) : type_(Type::BigInt), data_(bi) {}
-    Value(const BigRational& br) : type_(Type::Rational), data_(br) {}
-    Value(const IrrationalValue& irr) : type_(Type::Irrational), data_(irr) {}
+    Value(int64_t i) : type_(Type::Int), int_(i) {}
+    Value(double f) : type_(Type::Float), float_(f) {}
+    Value(bool b) : type_(Type::Bool), int_(0) { bool_ = b; }
+    Value(const std::string& s) : Value(fromStringCell(new detail::StringCell(s))) {}
+    Value(std::string&& s) : Value(fromStringCell(new detail::StringCell(std::move(s)))) {}
+    Value(const char* s) : Value(fromStringCell(new detail::StringCell(s))) {}
+    Value(std::string_view s) : Value(fromStringCell(new detail::StringCell(std::string(s)))) {}
+    Value(const BigInt& bi) : Value(boxed<BigInt>(Type::BigInt, bi)) {}
+    Value(const BigRational& br) : Value(boxed<BigRational>(Type::Rational, br)) {}
+    Value(const IrrationalValue& irr) : Value(boxed<IrrationalValue>(Type::Irrational, irr)) {}
     
     // 复数构造函数
     Value(std::shared_ptr<Value> re, std::shared_ptr<Value> im) 
-        : type_(Type::Complex), data_(std::make_pair(re, im)) {}
+        : Value(boxed<ComplexData>(Type::Complex, std::move(re), std::move(im))) {}
+
+    // 字符串 s 中 [offset, offset + length) 的子串，范围必须在 s 之内。
+    // 单字节子串来自预先建好的表，不分配；短子串直接复制；长子串是共享底层字节的切片
+    static Value makeSlice(const Value& s, size_t offset, size_t length);
+    // 单字节字符串（不分配）
+    static Value makeChar(unsigned char c);
+    // 字符串 s 后接 tail；s 是构建缓冲的末尾时原地追加（均摊 O(1)）
+    static Value appendString(const Value& s, std::string_view tail);
 
     // 静态工厂方法（用于复杂类型）
-    static Value makeArray(std::shared_ptr<std::vector<Value>> arr) {
-        Value v;
-        v.type_ = Type::Array;
-        v.data_ = arr;
-        return v;
-    }
+    // 元素全是 Int 或全是 Float 时使用紧凑存储（见 array_object.h）
+    static Value makeArray(std::vector<Value> elements = {});
+    static Value makeArray(ArrayObject array);
     
-    static Value makeStruct(std::shared_ptr<std::unordered_map<std::string, Value>> s) {
-        Value v;
-        v.type_ = Type::Struct;
-        v.data_ = s;
-        return v;
+    static Value makeArray(ArrayRef arr) {
+        return adopt(Type::Array, std::move(arr));
     }
     
-    static Value makeModule(std::shared_ptr<std::unordered_map<std::string, Value>> module) {
-        Value v;
-        v.type_ = Type::Module;
-        v.data_ = module;
-        return v;
+    static Value makeStruct(StructRef s);
+    static Value makeModule(StructRef module);
+
+    // 从普通映射构建（按键排序确定字段顺序）
+    static Value makeStruct(const std::shared_ptr<std::unordered_map<std::string, Value>>& s);
+    static Value makeModule(const std::shared_ptr<std::unordered_map<std::string, Value>>& module);
+    
+    static Value makeLambda(LambdaData data);
+    
+    static Value makeFunction(const FunctionData& data) {
+        return boxed<FunctionData>(Type::Function, data);
     }
     
-    static Value makeLambda(const LambdaData& data) {
-        Value v;
-        v.type_ = Type::Lambda;
-        v.data_ = data;
-        return v;
+    static Value makeNativeFunction(const std::string& name, NativeFn fn) {
+        NativeFunctionData data;
+        data.name = name;
+        data.fn = fn;
+        return boxed<NativeFunctionData>(Type::NativeFunction, std::move(data));
     }
     
-    static Value makeFunction(const FunctionData& data) {
-        Value v;
-        v.type_ = Type::Function;
-        v.data_ = data;
-        return v;
+    // context 随函数值一起保存，调用时作为第一个参数传回
+    static Value makeNativeFunction(const std::string& name, NativeContextFn fn,
+                                    std::shared_ptr<void> context) {
+        NativeFunctionData data;
+        data.name = name;
+        data.context_fn = fn;
+        data.context = std::move(context);
+        return boxed<NativeFunctionData>(Type::NativeFunction, std::move(data));
     }
     
+    // 旧签名适配：每次调用把实参复制到 std::vector
     static Value makeNativeFunction(const std::string& name, NativeFunction func) {
-        Value v;
-        v.type_ = Type::NativeFunction;
-        v.data_ = NativeFunctionData{name, func};
-        return v;
+        NativeFunctionData data;
+        data.name = name;
+        data.func = std::move(func);
+        return boxed<NativeFunctionData>(Type::NativeFunction, std::move(data));
     }
     
     static Value makeCurriedFunction(std::shared_ptr<Value> original,
                                      std::vector<Value> args,
                                      size_t total) {
-        Value v;
-        v.type_ = Type::CurriedFunction;
-        v.data_ = CurriedFunctionData{original, std::move(args), total};
-        return v;
+        CurriedFunctionData data;
+        data.original = std::move(original);
+        data.collected_args = std::move(args);
+        data.total_params = total;
+        return boxed<CurriedFunctionData>(Type::CurriedFunction, std::move(data));
     }
     
     static Value makeMemoizedFunction(std::shared_ptr<Value> original) {
-        Value v;
-        v.type_ = Type::MemoizedFunction;
-        v.data_ = MemoizedFunctionData{
-            original,
-            std::make_shared<std::unordered_map<std::string, Value>>()
-        };
-        return v;
+        MemoizedFunctionData data;
+        data.original = std::move(original);
+        data.cache = std::make_shared<std::unordered_map<std::string, Value>>();
+        return boxed<MemoizedFunctionData>(Type::MemoizedFunction, std::move(data));
     }
 
-    // 拷贝和移动
-    Value(const Value&) = default;
-    Value(Value&&) = default;
-    Value& operator=(const Value&) = default;
-    Value& operator=(Value&&) = default;
+    // 拷贝和移动：立即数按位复制，堆单元只增减引用计数
+    Value(const Value& other) : type_(other.type_), int_(other.int_) {
+        if (!isImmediate(type_)) heap_->retain();
+    }
+    
+    Value(Value&& other) noexcept : type_(other.type_), int_(other.int_) {
+        other.type_ = Type::Null;
+    }
+    
+    Value& operator=(const Value& other) {
+        if (!isImmediate(other.type_)) other.heap_->retain();
+        releaseHeap();
+        type_ = other.type_;
+        int_ = other.int_;
+        return *this;
+    }
+    
+    Value& operator=(Value&& other) noexcept {
+        if (this != &other) {
+            releaseHeap();
+            type_ = other.type_;
+            int_ = other.int_;
+            other.type_ = Type::Null;
+        }
+        return *this;
+    }
+    
+    ~Value() { releaseHeap(); }
 
     // 类型检查
     Type getType() const { return type_; }
@@ -253,83 +592,92 @@ public:
     // 值访问
     int64_t getInt() const { 
         if (type_ != Type::Int) throw std::runtime_error("Not an int");
-        return std::get<int64_t>(data_); 
+        return int_; 
     }
     
     double getFloat() const { 
         if (type_ != Type::Float) throw std::runtime_error("Not a float");
-        return std::get<double>(data_); 
+        return float_; 
     }
     
     bool getBool() const { 
         if (type_ != Type::Bool) throw std::runtime_error("Not a bool");
-        return std::get<bool>(data_); 
+        return bool_; 
     }
     
+    // 切片在第一次调用时才生成 std::string，只读字节时优先用 getStringView
     const std::string& getString() const { 
         if (type_ != Type::String) throw std::runtime_error("Not a string");
-        return std::get<std::string>(data_); 
+        return stringCell()->str(); 
+    }
+    
+    std::string_view getStringView() const {
+        if (type_ != Type::String) throw std::runtime_error("Not a string");
+        return stringCell()->view();
+    }
+    
+    // 缓存的字符串哈希
+    size_t stringHash() const {
+        if (type_ != Type::String) throw std::runtime_error("Not a string");
+        return stringCell()->hash();
     }
     
     const BigInt& getBigInt() const { 
         if (type_ != Type::BigInt) throw std::runtime_error("Not a bigint");
-        return std::get<BigInt>(data_); 
+        return payload<BigInt>(); 
     }
     
     const BigRational& getRational() const { 
         if (type_ != Type::Rational) throw std::runtime_error("Not a rational");
-        return std::get<BigRational>(data_); 
+        return payload<BigRational>(); 
     }
     
     const IrrationalValue& getIrrational() const { 
         if (type_ != Type::Irrational) throw std::runtime_error("Not an irrational");
-        return std::get<IrrationalValue>(data_); 
+        return payload<IrrationalValue>(); 
     }
 
-    std::shared_ptr<std::vector<Value>> getArray() const {
+    ArrayRef getArray() const {
         if (type_ != Type::Array) throw std::runtime_error("Not an array");
-        return std::get<std::shared_ptr<std::vector<Value>>>(data_);
+        return ref<ArrayObject>();
     }
 
-    std::shared_ptr<std::unordered_map<std::string, Value>> getStruct() const {
+    StructRef getStruct() const {
         if (type_ != Type::Struct && type_ != Type::Module) 
             throw std::runtime_error("Not a struct or module");
-        return std::get<std::shared_ptr<std::unordered_map<std::string, Value>>>(data_);
+        return ref<StructObject>();
     }
 
     std::pair<std::shared_ptr<Value>, std::shared_ptr<Value>> getComplex() const {
         if (type_ != Type::Complex) throw std::runtime_error("Not a complex");
-        return std::get<std::pair<std::shared_ptr<Value>, std::shared_ptr<Value>>>(data_);
+        return payload<ComplexData>();
     }
 
-    LambdaData getLambda() const {
-        if (type_ != Type::Lambda) throw std::runtime_error("Not a lambda");
-        return std::get<LambdaData>(data_);
-    }
+    LambdaData getLambda() const;
 
     FunctionData getFunction() const {
         if (type_ != Type::Function) throw std::runtime_error("Not a function");
-        return std::get<FunctionData>(data_);
+        return payload<FunctionData>();
     }
 
-    std::shared_ptr<std::unordered_map<std::string, Value>> getModule() const {
+    StructRef getModule() const {
         if (type_ != Type::Module) throw std::runtime_error("Not a module");
-        return std::get<std::shared_ptr<std::unordered_map<std::string, Value>>>(data_);
+        return ref<StructObject>();
     }
 
     NativeFunctionData getNativeFunction() const {
         if (type_ != Type::NativeFunction) throw std::runtime_error("Not a native function");
-        return std::get<NativeFunctionData>(data_);
+        return payload<NativeFunctionData>();
     }
 
     CurriedFunctionData getCurriedFunction() const {
         if (type_ != Type::CurriedFunction) throw std::runtime_error("Not a curried function");
-        return std::get<CurriedFunctionData>(data_);
+        return payload<CurriedFunctionData>();
     }
 
     MemoizedFunctionData getMemoizedFunction() const {
         if (type_ != Type::MemoizedFunction) throw std::runtime_error("Not a memoized function");
-        return std::get<MemoizedFunctionData>(data_);
+        return payload<MemoizedFunctionData>();
     }
 
     // 操作
@@ -344,11 +692,69 @@ public:
     // 字符串表示
     std::string toString() const;
 
-    // 获取数据（用于value.cc中的辅助函数）
-    const Data& getData() const { return data_; }
-    Data& getData() { return data_; }
+    // 把这个值能到达的所有堆单元改为原子计数，交给其他线程之前调用
+    void share() const;
+
+    // 并行回调运行期间（持有 CycleCollector::ConcurrentScope）交给了其他线程的堆单元只读。
+    // 数组和结构体的原地修改（push / pop、成员赋值等）先检查，为真时报错而不是修改
+    bool isFrozen() const;
+};
+
+// 捕获值：调用 lambda 时直接写入其帧的 slot 槽位
+struct Upvalue {
+    uint32_t slot;
+    Value value;
+};
+
+// 原生函数的实参：指向 VM 栈或调用方数组中连续存放的值，只在调用期间有效
+class NativeArgs {
+public:
+    NativeArgs() = default;
+    NativeArgs(const Value* data, size_t size) : data_(data), size_(size) {}
+    NativeArgs(const std::vector<Value>& args) : data_(args.data()), size_(args.size()) {}
+    
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const Value& operator[](size_t i) const { return data_[i]; }
+    const Value& at(size_t i) const {
+        if (i >= size_) throw std::out_of_range("NativeArgs::at");
+        return data_[i];
+    }
+    const Value& front() const { return data_[0]; }
+    const Value& back() const { return data_[size_ - 1]; }
+    const Value* begin() const { return data_; }
+    const Value* end() const { return data_ + size_; }
+    const Value* data() const { return data_; }
+    
+    // 去掉前 offset 个实参（如方法的 self）
+    NativeArgs subspan(size_t offset) const {
+        return offset >= size_ ? NativeArgs() : NativeArgs(data_ + offset, size_ - offset);
+    }
+    std::vector<Value> toVector() const { return std::vector<Value>(begin(), end()); }
+
+private:
+    const Value* data_ = nullptr;
+    size_t size_ = 0;
 };
 
+// 环回收器遍历和清空容器载荷（定义在 cycle_collector.cc）
+void traceChildren(const ArrayObject& array, detail::CellList& out);
+void traceChildren(const StructObject& object, detail::CellList& out);
+void traceChildren(const Value::LambdaData& lambda, detail::CellList& out);
+void traceChildren(const Value::CurriedFunctionData& curried, detail::CellList& out);
+void traceChildren(const Value::MemoizedFunctionData& memoized, detail::CellList& out);
+void clearPayload(ArrayObject& array);
+void clearPayload(StructObject& object);
+void clearPayload(Value::LambdaData& lambda);
+void clearPayload(Value::CurriedFunctionData& curried);
+void clearPayload(Value::MemoizedFunctionData& memoized);
+
+inline Value Value::NativeFunctionData::call(NativeArgs args) const {
+    if (fn) return fn(args);
+    if (context_fn) return context_fn(context.get(), args);
+    return func(args.toVector());
+}
+
 // 全局辅助函数
 double irrationalToFloat(const IrrationalValue& irr);
 std::string formatIrrational(const IrrationalValue& irr);
@@ -360,7 +766,12 @@ namespace std {
     template<>
     struct hash<rumina::Value> {
         size_t operator()(const rumina::Value& v) const {
+            if (v.getType() == rumina::Value::Type::String) return v.stringHash();
             return hash<string>()(v.toString());
         }
     };
 }
+
+// StructObject 和 ArrayObject 需要完整的 Value 定义
+#include "shape.h"
+#include "array_object.h"
@@ -1,15 +1,31 @@
 #pragma once
 
+#include "atom.h"
 #include "fwd.h"
 #include "value.h"
 #include "ast.h"
 #include "result.h"
+#include "global_table.h"
+#include "shape.h"
+#include "jit.h"
+#include "trace.h"
 #include <vector>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <memory>
 #include <optional>
+#include <stdexcept>
+
+// 指令分发方式：GCC/Clang 下默认使用 computed goto 的线程化分发，
+// 编译时定义 RUMINA_THREADED_DISPATCH=0 只保留可移植的 switch 分发
+#ifndef RUMINA_THREADED_DISPATCH
+#if defined(__GNUC__) || defined(__clang__)
+#define RUMINA_THREADED_DISPATCH 1
+#else
+#define RUMINA_THREADED_DISPATCH 0
+#endif
+#endif
 
 namespace rumina {
 
@@ -20,6 +36,7 @@ struct FuncDefInfo {
     size_t body_start;
     size_t body_end;
     std::vector<std::string> decorators;
+    std::vector<Atom> locals;  // 局部变量槽位名，参数占据前 params.size() 个
     
     FuncDefInfo() = default;
     FuncDefInfo(const FuncDefInfo& other) = default;
@@ -28,11 +45,19 @@ struct FuncDefInfo {
     FuncDefInfo& operator=(FuncDefInfo&& other) = default;
 };
 
+// lambda 捕获的外层变量：创建时读取外层帧的 from 槽位，调用时写入 lambda 帧的 to 槽位
+struct LambdaCapture {
+    uint32_t from;
+    uint32_t to;
+};
+
 // Lambda信息
 struct LambdaInfo {
     std::vector<std::string> params;
     size_t body_start;
     size_t body_end;
+    std::vector<LambdaCapture> captures;
+    uint32_t function = 0;  // lambda 体的函数原型下标（ByteCode::getFunction）
     
     LambdaInfo() = default;
     LambdaInfo(const LambdaInfo& other) = default;
@@ -42,19 +67,68 @@ struct LambdaInfo {
 };
 
 // 操作码类型
-enum class OpCodeType {
-    PushConst, PushConstPooled, PushVar, PopVar, MarkImmutable, Dup, Pop,
+enum class OpCodeType : uint8_t {
+    PushConst, PushConstPooled, PushVar, PopVar, LoadLocal, StoreLocal, LoadGlobal, StoreGlobal, MarkImmutable, Dup, Pop,
     Add, Sub, Mul, Div, Mod, Pow, Neg, Factorial,
     Not, And, Or, Eq, Neq, Gt, Gte, Lt, Lte,
     Jump, JumpIfFalse, JumpIfTrue,
     CallVar, Call, CallMethod, Return,
+    // 尾调用：复用当前调用帧，后面总跟着一条 Return（原生函数时由它返回结果）
+    TailCall,
     MakeArray, MakeStruct, Index, Member, IndexAssign, MemberAssign, MemberAssignVar,
     DefineFunc, MakeLambda,
     Break, Continue, Halt,
+    // 特化（quickened）形式：只由 VM 在运行时观察操作数类型后就地改写产生，
+    // 类型守卫失败时改回通用指令
+    AddIntInt, SubIntInt, MulIntInt, ModIntInt,
+    EqIntInt, NeqIntInt, GtIntInt, GteIntInt, LtIntInt, LteIntInt,
+    // 超级指令：由 BytecodeOptimizer 融合常见序列得到。只改写序列的首条指令，
+    // 其余指令原样保留（操作数从中读取，跳到序列中间依然正确），
+    // 快速路径一次执行完整个序列，守卫失败时按首条指令的原始形式执行
+    IncLocal,             // LoadLocal s; PushConstPooled c; Add; StoreLocal s
+    IncGlobal,            // LoadGlobal g; PushConstPooled c; Add; StoreGlobal g
+    AddLocalLocal,        // LoadLocal a; LoadLocal b; Add
+    ArithConst,           // PushConstPooled c; Add/Sub/Mul/Mod
+    CmpConstJumpIfFalse,  // PushConstPooled c; Eq/Neq/Lt/Lte/Gt/Gte; JumpIfFalse t
+    CmpLocalJumpIfFalse,  // LoadLocal s; Eq/Neq/Lt/Lte/Gt/Gte; JumpIfFalse t
+    // 只由 JIT 在运行时改写产生：转入该位置的本地代码，原操作码和操作数保存在 JIT 中
+    JitEntry,
     ConvertType
 };
 
-// 操作码
+// 特化指令对应的通用指令，非特化指令原样返回
+OpCodeType genericOpCode(OpCodeType type);
+// 超级指令融合前的首条指令，非超级指令原样返回
+OpCodeType fusedHeadOpCode(OpCodeType type);
+// 超级指令覆盖的指令条数，非超级指令为 1
+size_t fusedLength(OpCodeType type);
+// 操作码名字（反汇编、n-gram 统计用）
+const char* opCodeName(OpCodeType type);
+
+// 操作码数量（ConvertType 保持为最后一个），用于分发表
+inline constexpr size_t kOpCodeCount = static_cast<size_t>(OpCodeType::ConvertType) + 1;
+
+// 紧凑指令：1 字节操作码 + 32 位操作数（对齐后 8 字节）
+// 跳转目标、参数个数、槽位、声明类型直接存放在操作数里；
+// 常量、名字、调用点、函数和 lambda 描述符存放在 ByteCode 侧表中，操作数为下标
+struct Instruction {
+    OpCodeType type;
+    uint32_t operand;
+};
+
+// CallVar 的侧表项
+struct CallSite {
+    uint32_t name;
+    uint32_t argc;
+};
+
+// MemberAssignVar 的侧表项
+struct MemberTarget {
+    uint32_t var;
+    uint32_t member;
+};
+
+// 编译期的指令构造形式，由 ByteCode::emit 编码为 Instruction
 struct OpCode {
     OpCodeType type;
     
@@ -200,39 +274,101 @@ public:
     ByteCode(ByteCode&&) = default;
     ByteCode& operator=(ByteCode&&) = default;
 
+    // 把载荷放入侧表后追加一条紧凑指令
     void emit(OpCode op, std::optional<size_t> line);
     size_t currentAddress() const;
     void patchJump(size_t address, size_t target);
     
     size_t addConstant(const Value& value);
+    // 名字表按原子去重，返回名字下标
+    size_t addName(Atom name);
+    size_t addName(const std::string& name) { return addName(AtomTable::intern(name)); }
+    // 只登记函数原型而不生成 DefineFunc（lambda 体），返回原型下标
+    size_t addFunction(FuncDefInfo info);
+    // 显式复制（拷贝构造被禁用以免无意中复制整个程序）
+    ByteCode clone() const;
     
     std::string serialize() const;
     static ByteCode deserialize(const std::string& input);
 
-    const std::vector<OpCode>& getInstructions() const { return instructions_; }
-    std::vector<OpCode>& getInstructions() { return instructions_; }
+    const std::vector<Instruction>& getInstructions() const { return instructions_; }
+    std::vector<Instruction>& getInstructions() { return instructions_; }
     const std::vector<std::optional<size_t>>& getLineNumbers() const { return line_numbers_; }
     std::vector<std::optional<size_t>>& getLineNumbers() { return line_numbers_; }
     const std::vector<Value>& getConstants() const { return constants_; }
     std::vector<Value>& getConstants() { return constants_; }
+    const std::vector<Atom>& getNames() const { return names_; }
+    
+    // 侧表访问，下标来自 Instruction::operand
+    const Value& getConstant(size_t index) const { return constants_[index]; }
+    Atom getAtom(size_t index) const { return names_[index]; }
+    const std::string& getName(size_t index) const { return AtomTable::name(names_[index]); }
+    const CallSite& getCallSite(size_t index) const { return call_sites_[index]; }
+    size_t getCallSiteCount() const { return call_sites_.size(); }
+    const MemberTarget& getMemberTarget(size_t index) const { return member_targets_[index]; }
+    const FuncDefInfo& getFunction(size_t index) const { return functions_[index]; }
+    const LambdaInfo& getLambda(size_t index) const { return lambdas_[index]; }
+    // 优化器删除指令后需要重新映射代码范围
+    const std::vector<FuncDefInfo>& getFunctions() const { return functions_; }
+    std::vector<FuncDefInfo>& getFunctions() { return functions_; }
+    const std::vector<LambdaInfo>& getLambdas() const { return lambdas_; }
+    std::vector<LambdaInfo>& getLambdas() { return lambdas_; }
 
 private:
-    std::vector<OpCode> instructions_;
+    std::vector<Instruction> instructions_;
     std::vector<std::optional<size_t>> line_numbers_;
     std::vector<Value> constants_;
+    std::vector<Atom> names_;
+    std::unordered_map<Atom, uint32_t> name_index_;
+    std::vector<CallSite> call_sites_;
+    std::vector<MemberTarget> member_targets_;
+    std::vector<FuncDefInfo> functions_;
+    std::vector<LambdaInfo> lambdas_;
     static bool valuesEqual(const Value& a, const Value& b);
+    static uint32_t toOperand(size_t value);
     
     // 不使用 std::unordered_map 来避免哈希问题，改用线性搜索
     // 因为常量池通常很小
 };
 
+// 局部变量槽位
+struct LocalSlot {
+    Value value;
+    bool assigned = false;  // 未赋值的槽位读取时回退到按名字查找
+};
+
 // 调用帧
 struct CallFrame {
     size_t return_address;
     size_t base_pointer;
-    std::string function_name;
-    std::unordered_map<std::string, Value> locals;
-    std::unordered_set<std::string> immutable_locals;
+    size_t slot_base;
+    const FuncDefInfo* function;
+    std::unordered_map<Atom, Value> locals;
+    std::unordered_set<Atom> immutable_locals;
+};
+
+// 分发循环
+enum class DispatchMode {
+    Switch,    // 逐条调用 executeInstructionAt
+    Threaded   // computed goto，热点指令内联处理
+};
+
+// 运行时错误：出错指令的地址和它所在的源码行
+struct VMError {
+    std::string message;
+    size_t ip = 0;
+    std::optional<size_t> line;
+    
+    std::string toString() const {
+        return line ? message + " (line " + std::to_string(*line) + ")" : message;
+    }
+};
+
+// 原生函数回调脚本函数出错时抛出，带着被调用者出错的位置穿过原生函数（以及任务组），
+// 外层 VM 报告回调里出错的行，而不是发起回调的原生函数所在的行
+struct ScriptError : std::runtime_error {
+    explicit ScriptError(VMError error) : std::runtime_error(error.message), error(std::move(error)) {}
+    VMError error;
 };
 
 // 虚拟机
@@ -242,8 +378,45 @@ public:
 
     void load(ByteCode bytecode);
     Result<std::optional<Value>> run();
+    
+    // 当前线程上正在 run / call 的 VM，原生函数借此回调脚本函数；没有时为 nullptr
+    static VM* current();
+    
+    // 调用函数、lambda 或原生函数并返回结果。可以在原生函数内部重入：
+    // 被调用者在当前调用栈之上执行，返回后 VM 状态恢复原样，出错时同样恢复。
+    // 原生函数收到的实参可能是栈上的视图，调用会让栈扩容，之后还要用的实参需先复制
+    Result<Value> call(const Value& callee, NativeArgs args);
+    
+    // 为其他线程创建隔离的执行上下文：沿用已载入程序的函数原型、常量和全局槽位编号，
+    // 因此本 VM 创建的函数和 lambda 值可以直接在其中调用。全局变量是当前绑定的快照
+    // （值已 share），重新赋值不会影响本 VM；数组、结构体仍是引用，并行修改需由脚本自行避免。
+    // 特化会原地改写指令，所以指令流各复制一份，新上下文不开 JIT。
+    // 只能在本 VM 所在的线程上调用
+    std::unique_ptr<VM> fork() const;
+    bool isWorker() const { return worker_; }
 
     std::pair<size_t, size_t> getCacheStats() const;
+    
+    // 最近一次 run 或 call 失败时的错误
+    const VMError& getLastError() const { return error_; }
+    
+    // 不支持 computed goto 的编译器上 Threaded 退回 Switch
+    void setDispatchMode(DispatchMode mode) { dispatch_mode_ = mode; }
+    DispatchMode getDispatchMode() const { return dispatch_mode_; }
+    
+    // 是否在运行时把算术/比较指令改写为类型特化形式
+    void setQuickening(bool enabled) { quickening_ = enabled; }
+    bool getQuickening() const { return quickening_; }
+    
+    // 开启基线 JIT，平台不支持时返回 false 并继续解释执行
+    bool setJitEnabled(bool enabled, const JitOptions& options = JitOptions());
+    bool getJitEnabled() const { return jit_ != nullptr; }
+    JitStats getJitStats() const { return jit_ ? jit_->stats() : JitStats(); }
+    
+    // 是否录制并执行热点循环的 trace（默认开启）
+    void setTracing(bool enabled);
+    bool getTracing() const { return tracer_ != nullptr; }
+    TraceStats getTraceStats() const { return tracer_ ? tracer_->stats() : TraceStats(); }
 
 private:
     ByteCode bytecode_;
@@ -252,33 +425,131 @@ private:
     std::vector<CallFrame> call_stack_;
     
     std::shared_ptr<std::unordered_map<std::string, Value>> globals_;
-    std::unordered_map<std::string, Value> locals_;
-    std::unordered_set<std::string> immutable_globals_;
-    std::unordered_set<std::string> immutable_locals_;
+    GlobalTable global_table_;
+    // 按名字绑定的局部变量（闭包、方法的 self），以原子为键
+    std::unordered_map<Atom, Value> locals_;
+    
+    // 所有调用帧共享的连续槽位数组，当前帧从 slot_base_ 开始
+    std::vector<LocalSlot> slots_;
+    size_t slot_base_ = 0;
+    const FuncDefInfo* current_func_ = nullptr;
+    std::unordered_set<Atom> immutable_locals_;
     
     std::vector<std::pair<size_t, size_t>> loop_stack_;
-    std::unordered_map<std::string, FuncDefInfo> functions_;
     
+    // 函数原型表，与 bytecode_.getFunctions() 同下标；函数和 lambda 值记录下标，
+    // 调用时直接取原型，不再按名字查找
+    struct FunctionProto {
+        const FuncDefInfo* info;
+        uint32_t arity;
+        uint32_t slot_count;
+        size_t body_start;
+        size_t body_end;
+    };
+    std::vector<FunctionProto> protos_;
+    // 每次 load 分配的程序编号，其他程序创建的函数值不能按下标调用
+    uint32_t program_id_ = 0;
+    // CallVar 调用点在全局表中的槽位，与 bytecode_ 的调用点同下标
+    std::vector<uint32_t> call_site_globals_;
+    
+    // 成员访问指令的内联缓存，load 时把 Member / MemberAssign / MemberAssignVar
+    // 的操作数改写为缓存下标。按形状指针命中，最多记录 kMaxEntries 个形状（多态），
+    // 超过后标记为超多态，不再记录
     struct InlineCache {
-        std::string member;
+        static constexpr size_t kMaxEntries = 4;
+        struct Entry {
+            const Shape* shape;
+            const Shape* next;  // 写入新字段后的形状；读取或覆盖已有字段时为 nullptr
+            uint32_t slot;
+        };
+        uint32_t name = 0;     // 成员名下标
+        uint32_t operand = 0;  // 原操作数（MemberAssignVar 的侧表下标）
+        uint8_t size = 0;
+        bool megamorphic = false;
+        Entry entries[kMaxEntries];
         size_t hits = 0;
         size_t misses = 0;
+        
+        const Entry* find(const Shape* shape) const {
+            for (uint8_t i = 0; i < size; ++i) {
+                if (entries[i].shape == shape) return &entries[i];
+            }
+            return nullptr;
+        }
+        void add(const Shape* shape, const Shape* next, uint32_t slot);
     };
-    std::unordered_map<size_t, InlineCache> member_cache_;
+    std::vector<InlineCache> inline_caches_;
     
     bool halted_ = false;
+    bool worker_ = false;  // fork 出来的上下文，其他线程可能同时在运行
+#if RUMINA_THREADED_DISPATCH
+    DispatchMode dispatch_mode_ = DispatchMode::Threaded;
+#else
+    DispatchMode dispatch_mode_ = DispatchMode::Switch;
+#endif
+    bool quickening_ = true;
     size_t recursion_depth_ = 0;
     static constexpr size_t MAX_RECURSION_DEPTH = 4000;
+    VMError error_;
+    bool fault_located_ = false;  // error_ 的位置已由更内层（JIT 辅助函数）记录
+    std::unique_ptr<Tracer> tracer_;
+    std::unique_ptr<Jit> jit_;    // 最后声明，先于 bytecode_ 析构以便还原改写的指令
 
-    void executeInstructionAt(size_t ip);
+    friend class Jit;
+    friend class Tracer;
+
+    // 执行指令出错时写入 error_ 并返回 false，不抛出异常
+    bool executeInstructionAt(size_t ip);
+    bool executeInstruction(const Instruction& op, size_t ip);
+    
+    // 记录错误信息并返回 false；出错位置由分发循环用 recordFault 补上，
+    // 已记录过位置时保留最内层的位置
+    bool fail(std::string message);
+    // 宿主代码抛出的异常转为错误；ScriptError 带有位置时直接沿用
+    bool fail(const std::exception& e);
+    void recordFault(size_t ip);
+    
+    // 按 dispatch_mode_ 从 ip_ 开始执行，出错时返回 false，错误在 error_ 中
+    bool dispatch();
+    bool dispatchSwitch();
+#if RUMINA_THREADED_DISPATCH
+    bool dispatchThreaded();
+#endif
+    
+    // 调用 VM 编译的函数或 lambda：实参是栈顶的 argc 个值，返回时栈恢复到 base。
+    // self 非空时按方法调用绑定 self
+    bool invoke(const Value& callee, size_t argc, size_t base, const Value* self);
+    // 在当前帧中执行尾调用：丢弃当前函数的槽位和临时值，不增加调用深度
+    bool tailInvoke(const Value& callee, size_t argc);
+    // 查找被调用者的原型并检查实参个数，lambda 时写入 lambda；失败返回 nullptr
+    const FunctionProto* resolveCallee(const Value& callee, size_t argc, bool method,
+                                       const Value::LambdaData*& lambda);
+    // 把 lambda 的捕获值写入新帧
+    void bindCaptures(const Value::LambdaData& lambda);
+    LocalSlot* findLocalSlot(Atom name);
+    // 当前函数在原型表中的下标（JIT 计数用）
+    size_t protoIndex(const FuncDefInfo* info) const {
+        return static_cast<size_t>(info - bytecode_.getFunctions().data());
+    }
+    const LocalSlot* findLocalSlot(Atom name) const;
+    
+    bool binaryOp(BinOp op);
+    
+    // 根据栈顶两个操作数的类型改写 ip 处的通用指令
+    void quicken(size_t ip);
+    // 执行特化指令，守卫失败时改回通用指令并返回 false
+    bool quickenedOp(size_t ip);
+    // 超级指令的快速路径，成功时把 ip_ 移到序列之后；守卫失败返回 false
+    bool superinstruction(size_t ip);
     
-    template<typename F>
-    void binaryOp(F&& f);
+    // 经内联缓存读取 / 写入结构体字段
+    bool loadMember(InlineCache& cache, const Value& object, Value& out);
+    void storeMember(InlineCache& cache, StructObject& object, Value value);
     
-    Value getVariable(const std::string& name) const;
-    void setVariable(const std::string& name, const Value& value);
-    void ensureMutable(const std::string& name) const;
-    void setVariableChecked(const std::string& name, const Value& value);
+    bool getVariable(Atom name, Value& out);
+    void setVariable(Atom name, const Value& value);
+    bool ensureMutable(Atom name);
+    bool setVariableChecked(Atom name, const Value& value);
     
     Value convertToType(const Value& val, DeclaredType dtype) const;
 };
@@ -0,0 +1,126 @@
+#include "array_object.h"
+
+namespace rumina {
+
+ArrayObject::ArrayObject(std::vector<Value> elements) {
+    bool all_int = true;
+    bool all_float = true;
+    for (const Value& element : elements) {
+        all_int = all_int && element.getType() == Value::Type::Int;
+        all_float = all_float && element.getType() == Value::Type::Float;
+        if (!all_int && !all_float) break;
+    }
+
+    if (all_int) {
+        ints_.reserve(elements.size());
+        for (const Value& element : elements) ints_.push_back(*element.get<int64_t>());
+    } else if (all_float) {
+        kind_ = Kind::Float64;
+        floats_.reserve(elements.size());
+        for (const Value& element : elements) floats_.push_back(*element.get<double>());
+    } else {
+        kind_ = Kind::Generic;
+        values_ = std::move(elements);
+    }
+}
+
+ArrayObject ArrayObject::fromInts(std::vector<int64_t> values) {
+    ArrayObject array;
+    array.ints_ = std::move(values);
+    return array;
+}
+
+ArrayObject ArrayObject::fromFloats(std::vector<double> values) {
+    ArrayObject array;
+    array.kind_ = Kind::Float64;
+    array.floats_ = std::move(values);
+    return array;
+}
+
+void ArrayObject::pop_back() {
+    switch (kind_) {
+        case Kind::Int64: ints_.pop_back(); break;
+        case Kind::Float64: floats_.pop_back(); break;
+        default: {
+            Value last = std::move(values_.back());
+            values_.pop_back();
+            break;
+        }
+    }
+}
+
+void ArrayObject::reserve(size_t n) {
+    switch (kind_) {
+        case Kind::Int64: ints_.reserve(n); break;
+        case Kind::Float64: floats_.reserve(n); break;
+        default: values_.reserve(n); break;
+    }
+}
+
+void ArrayObject::clear() {
+    std::vector<Value> values = std::move(values_);
+    values_.clear();
+    ints_.clear();
+    floats_.clear();
+    kind_ = Kind::Int64;
+}
+
+void ArrayObject::append(const ArrayObject& other) {
+    if (this == &other) {
+        ArrayObject copy = other;
+        append(copy);
+        return;
+    }
+    if (empty() && other.kind_ != kind_) {
+        clear();
+        kind_ = other.kind_;
+    }
+    if (kind_ == other.kind_) {
+        switch (kind_) {
+            case Kind::Int64: ints_.insert(ints_.end(), other.ints_.begin(), other.ints_.end()); break;
+            case Kind::Float64: floats_.insert(floats_.end(), other.floats_.begin(), other.floats_.end()); break;
+            default: values_.insert(values_.end(), other.values_.begin(), other.values_.end()); break;
+        }
+        return;
+    }
+    std::vector<Value>& values = generic();
+    values.reserve(values.size() + other.size());
+    for (Value element : other) values.push_back(std::move(element));
+}
+
+std::vector<Value>& ArrayObject::generic() {
+    if (kind_ != Kind::Generic) {
+        values_ = toVector();
+        ints_ = {};
+        floats_ = {};
+        kind_ = Kind::Generic;
+    }
+    return values_;
+}
+
+std::vector<Value> ArrayObject::toVector() const {
+    switch (kind_) {
+        case Kind::Int64: return std::vector<Value>(ints_.begin(), ints_.end());
+        case Kind::Float64: return std::vector<Value>(floats_.begin(), floats_.end());
+        default: return values_;
+    }
+}
+
+void ArrayObject::pushSlow(Value value) {
+    if (kind_ != Kind::Generic && empty()) {
+        // 空数组按第一个元素选择存储方式
+        if (value.getType() == Value::Type::Int) {
+            kind_ = Kind::Int64;
+            ints_.push_back(*value.get<int64_t>());
+            return;
+        }
+        if (value.getType() == Value::Type::Float) {
+            kind_ = Kind::Float64;
+            floats_.push_back(*value.get<double>());
+            return;
+        }
+    }
+    generic().push_back(std::move(value));
+}
+
+} // namespace rumina
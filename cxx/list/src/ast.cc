@@ -308,4 +308,75 @@ std::string unaryOpToString(UnaryOp op) {
     return "unknown";
 }
 
+// collectReferencedNames
+void collectReferencedNames(const Expr* expr, std::unordered_set<std::string>& names) {
+    if (!expr) return;
+    if (auto ident = dynamic_cast<const IdentExpr*>(expr)) {
+        names.insert(ident->name);
+    } else if (auto binary = dynamic_cast<const BinaryExpr*>(expr)) {
+        collectReferencedNames(binary->left.get(), names);
+        collectReferencedNames(binary->right.get(), names);
+    } else if (auto unary = dynamic_cast<const UnaryExpr*>(expr)) {
+        collectReferencedNames(unary->expr.get(), names);
+    } else if (auto array = dynamic_cast<const ArrayExpr*>(expr)) {
+        for (const auto& e : array->elements) collectReferencedNames(e.get(), names);
+    } else if (auto struct_expr = dynamic_cast<const StructExpr*>(expr)) {
+        for (const auto& [_, e] : struct_expr->fields) collectReferencedNames(e.get(), names);
+    } else if (auto call = dynamic_cast<const CallExpr*>(expr)) {
+        collectReferencedNames(call->func.get(), names);
+        for (const auto& e : call->args) collectReferencedNames(e.get(), names);
+    } else if (auto member = dynamic_cast<const MemberExpr*>(expr)) {
+        collectReferencedNames(member->object.get(), names);
+    } else if (auto index = dynamic_cast<const IndexExpr*>(expr)) {
+        collectReferencedNames(index->object.get(), names);
+        collectReferencedNames(index->index.get(), names);
+    } else if (auto lambda = dynamic_cast<const LambdaExpr*>(expr)) {
+        // 嵌套 lambda 引用的外层变量也要经由本层捕获
+        collectReferencedNames(lambda->body.get(), names);
+    } else if (auto ns = dynamic_cast<const NamespaceExpr*>(expr)) {
+        names.insert(ns->module);
+    }
+}
+
+void collectReferencedNames(const Stmt* stmt, std::unordered_set<std::string>& names) {
+    if (!stmt) return;
+    auto collectBlock = [&names](const std::vector<std::unique_ptr<Stmt>>& stmts) {
+        for (const auto& s : stmts) collectReferencedNames(s.get(), names);
+    };
+    
+    if (auto var_decl = dynamic_cast<const VarDeclStmt*>(stmt)) {
+        names.insert(var_decl->name);
+        collectReferencedNames(var_decl->value.get(), names);
+    } else if (auto let_decl = dynamic_cast<const LetDeclStmt*>(stmt)) {
+        names.insert(let_decl->name);
+        collectReferencedNames(let_decl->value.get(), names);
+    } else if (auto assign = dynamic_cast<const AssignStmt*>(stmt)) {
+        names.insert(assign->name);
+        collectReferencedNames(assign->value.get(), names);
+    } else if (auto member_assign = dynamic_cast<const MemberAssignStmt*>(stmt)) {
+        collectReferencedNames(member_assign->object.get(), names);
+        collectReferencedNames(member_assign->value.get(), names);
+    } else if (auto expr_stmt = dynamic_cast<const ExprStmt*>(stmt)) {
+        collectReferencedNames(expr_stmt->expr.get(), names);
+    } else if (auto ret = dynamic_cast<const ReturnStmt*>(stmt)) {
+        if (ret->expr.has_value()) collectReferencedNames(ret->expr.value().get(), names);
+    } else if (auto if_stmt = dynamic_cast<const IfStmt*>(stmt)) {
+        collectReferencedNames(if_stmt->condition.get(), names);
+        collectBlock(if_stmt->then_branch);
+        if (if_stmt->else_branch.has_value()) collectBlock(if_stmt->else_branch.value());
+    } else if (auto while_stmt = dynamic_cast<const WhileStmt*>(stmt)) {
+        collectReferencedNames(while_stmt->condition.get(), names);
+        collectBlock(while_stmt->body);
+    } else if (auto for_stmt = dynamic_cast<const ForStmt*>(stmt)) {
+        if (for_stmt->init.has_value()) collectReferencedNames(for_stmt->init.value().get(), names);
+        if (for_stmt->condition.has_value()) collectReferencedNames(for_stmt->condition.value().get(), names);
+        if (for_stmt->update.has_value()) collectReferencedNames(for_stmt->update.value().get(), names);
+        collectBlock(for_stmt->body);
+    } else if (auto loop_stmt = dynamic_cast<const LoopStmt*>(stmt)) {
+        collectBlock(loop_stmt->body);
+    } else if (auto block = dynamic_cast<const BlockStmt*>(stmt)) {
+        collectBlock(block->statements);
+    }
+}
+
 } // namespace rumina
@@ -0,0 +1,98 @@
+#include "atom.h"
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace rumina {
+
+namespace {
+
+// 名字按块存放，块一旦分配就不再移动，name() 可以不加锁直接下标访问
+constexpr size_t kChunkBits = 10;
+constexpr size_t kChunkSize = size_t(1) << kChunkBits;
+constexpr size_t kMaxChunks = 4096;
+
+struct State {
+    std::mutex mutex;
+    std::unordered_map<std::string_view, Atom> index;  // 键指向块内的字符串
+    std::array<std::atomic<std::string*>, kMaxChunks> chunks{};
+    std::atomic<size_t> count{0};
+};
+
+State& state() {
+    static State* s = new State();  // 原子表在进程退出前一直有效
+    return *s;
+}
+
+// 每个线程缓存已查到的原子，命中时不加锁；键同样指向块内的字符串
+std::unordered_map<std::string_view, Atom>& localCache() {
+    thread_local std::unordered_map<std::string_view, Atom> cache;
+    return cache;
+}
+
+} // namespace
+
+Atom AtomTable::intern(std::string_view name) {
+    auto& cache = localCache();
+    auto cached = cache.find(name);
+    if (cached != cache.end()) {
+        return cached->second;
+    }
+
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.index.find(name);
+    if (it != s.index.end()) {
+        cache.emplace(it->first, it->second);
+        return it->second;
+    }
+
+    size_t id = s.count.load(std::memory_order_relaxed);
+    size_t chunk = id >> kChunkBits;
+    if (chunk >= kMaxChunks) {
+        throw std::runtime_error("Too many distinct identifiers");
+    }
+    std::string* block = s.chunks[chunk].load(std::memory_order_relaxed);
+    if (!block) {
+        block = new std::string[kChunkSize];
+        s.chunks[chunk].store(block, std::memory_order_release);
+    }
+    std::string& stored = block[id & (kChunkSize - 1)];
+    stored.assign(name);
+    Atom atom = static_cast<Atom>(id);
+    s.index.emplace(std::string_view(stored), atom);
+    s.count.store(id + 1, std::memory_order_release);
+    cache.emplace(std::string_view(stored), atom);
+    return atom;
+}
+
+Atom AtomTable::find(std::string_view name) {
+    auto& cache = localCache();
+    auto cached = cache.find(name);
+    if (cached != cache.end()) {
+        return cached->second;
+    }
+
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.index.find(name);
+    if (it == s.index.end()) {
+        return kNoAtom;
+    }
+    cache.emplace(it->first, it->second);
+    return it->second;
+}
+
+const std::string& AtomTable::name(Atom atom) {
+    State& s = state();
+    std::string* block = s.chunks[atom >> kChunkBits].load(std::memory_order_acquire);
+    return block[atom & (kChunkSize - 1)];
+}
+
+size_t AtomTable::size() {
+    return state().count.load(std::memory_order_acquire);
+}
+
+} // namespace rumina
@@ -1,50 +1,230 @@
 #include <builtin/array.h>
+#include <builtin/matrix.h>
+#include <builtin/vec.h>
+#include <cycle_collector.h>
+#include <thread_pool.h>
+#include <vm.h>
 
 #include <cmath>
 #include <numeric>
 #include <algorithm>
+#include <atomic>
+#include <optional>
 
 namespace rumina {
 namespace builtin {
 namespace array {
 
-Value foreach(const std::vector<Value>& args) {
+namespace {
+
+// 数组不小于这个长度时 parallel_map / parallel_reduce 才分给线程池
+constexpr size_t kParallelThreshold = 1024;
+
+ArrayRef expect_array(NativeArgs args, const char* name) {
+    if (args[0].getType() != Value::Type::Array) {
+        throw std::runtime_error(std::string(name) + " expects array, got " + args[0].typeName());
+    }
+    return args[0].getArray();
+}
+
+// 调用回调：脚本函数经当前线程上的 VM 执行，没有 VM 时只能是原生函数。
+// 实参视图可能指向 VM 的栈，回调会让栈扩容，所以调用方先把回调和初始值复制出来
+Value call_callback(VM* vm, const Value& callback, NativeArgs args) {
+    if (vm) {
+        auto result = vm->call(callback, args);
+        if (result.is_error()) throw ScriptError(vm->getLastError());
+        return result.value();
+    }
+    if (callback.getType() == Value::Type::NativeFunction) {
+        return callback.getNativeFunction().call(args);
+    }
+    throw std::runtime_error("Cannot call " + callback.typeName() + " outside the VM");
+}
+
+Value reduce_range(VM* vm, const ArrayObject& array, const Value& callback, Value acc, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        Value argv[2] = {acc, array.get(i)};
+        acc = call_callback(vm, callback, NativeArgs(argv, 2));
+    }
+    return acc;
+}
+
+// 把 [0, n) 切成若干块并行执行 body(context, begin, end, chunk)。
+// 每个池任务独占一个 fork 出来的上下文，从共享计数器领取下一块，先做完的任务接着领，
+// 调用线程用自己的 VM 一起领；分块数多于线程数，回调耗时不均时也能摊平
+template<typename Body>
+void for_each_chunk(VM& vm, size_t n, size_t chunks, Body body) {
+    ThreadPool& pool = ThreadPool::shared();
+    size_t tasks = std::min(pool.size(), chunks - 1);
+    std::vector<std::unique_ptr<VM>> contexts;
+    contexts.reserve(tasks);
+    for (size_t i = 0; i < tasks; ++i) {
+        contexts.push_back(vm.fork());
+    }
+    
+    std::atomic<size_t> next{0};
+    auto drain = [&](VM& context) {
+        for (size_t chunk; (chunk = next.fetch_add(1, std::memory_order_relaxed)) < chunks;) {
+            try {
+                body(context, n * chunk / chunks, n * (chunk + 1) / chunks, chunk);
+            } catch (...) {
+                // 其他任务不再领取新块
+                next.store(chunks, std::memory_order_relaxed);
+                throw;
+            }
+        }
+    };
+    
+    CycleCollector::ConcurrentScope concurrent;
+    TaskGroup group(pool);
+    for (auto& context : contexts) {
+        VM* worker = context.get();
+        group.run([&drain, worker] { drain(*worker); });
+    }
+    std::exception_ptr error;
+    try {
+        drain(vm);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    group.wait();
+    if (error) std::rethrow_exception(error);
+}
+
+// 是否值得并行：fork 出来的上下文里嵌套调用时串行执行
+VM* parallel_vm(size_t n) {
+    VM* vm = VM::current();
+    if (!vm || vm->isWorker() || n < kParallelThreshold) return nullptr;
+    return vm;
+}
+
+} // namespace
+
+Value foreach(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("foreach expects 2 arguments (array, function)");
     }
     
-    throw std::runtime_error("foreach not yet fully implemented - use in interpreter");
+    ArrayRef array = expect_array(args, "foreach");
+    const Value callback = args[1];
+    VM* vm = VM::current();
+    for (size_t i = 0; i < array->size(); ++i) {
+        Value argv[2] = {Value(static_cast<int64_t>(i)), array->get(i)};
+        call_callback(vm, callback, NativeArgs(argv, 2));
+    }
+    return Value();
 }
 
-Value map(const std::vector<Value>& args) {
+Value map(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("map expects 2 arguments (array, function)");
     }
     
-    throw std::runtime_error("map not yet implemented");
+    ArrayRef array = expect_array(args, "map");
+    const Value callback = args[1];
+    VM* vm = VM::current();
+    std::vector<Value> result;
+    result.reserve(array->size());
+    for (size_t i = 0; i < array->size(); ++i) {
+        Value argv[1] = {array->get(i)};
+        result.push_back(call_callback(vm, callback, NativeArgs(argv, 1)));
+    }
+    return Value::makeArray(std::move(result));
 }
 
-Value filter(const std::vector<Value>& args) {
+Value filter(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("filter expects 2 arguments (array, function)");
     }
     
-    throw std::runtime_error("filter implemented in interpreter");
+    ArrayRef array = expect_array(args, "filter");
+    const Value callback = args[1];
+    VM* vm = VM::current();
+    std::vector<Value> result;
+    for (size_t i = 0; i < array->size(); ++i) {
+        Value element = array->get(i);
+        if (call_callback(vm, callback, NativeArgs(&element, 1)).isTruthy()) {
+            result.push_back(std::move(element));
+        }
+    }
+    return Value::makeArray(std::move(result));
 }
 
-Value reduce(const std::vector<Value>& args) {
+Value reduce(NativeArgs args) {
     if (args.size() < 2 || args.size() > 3) {
         throw std::runtime_error("reduce expects 2 or 3 arguments (array, function, [initial])");
     }
     
-    if (args[0].getType() != Value::Type::Array) {
-        throw std::runtime_error("reduce expects array, got " + args[0].typeName());
+    ArrayRef array = expect_array(args, "reduce");
+    if (array->empty()) {
+        if (args.size() == 3) return args[2];
+        throw std::runtime_error("reduce of empty array with no initial value");
     }
     
-    return Value();
+    const Value callback = args[1];
+    VM* vm = VM::current();
+    if (args.size() == 3) {
+        return reduce_range(vm, *array, callback, args[2], 0, array->size());
+    }
+    return reduce_range(vm, *array, callback, array->get(0), 1, array->size());
+}
+
+Value parallel_map(NativeArgs args) {
+    if (args.size() != 2) {
+        throw std::runtime_error("parallel_map expects 2 arguments (array, function)");
+    }
+    
+    ArrayRef array = expect_array(args, "parallel_map");
+    const size_t n = array->size();
+    VM* vm = parallel_vm(n);
+    if (!vm) return map(args);
+    
+    // 其他线程会复制这两个值，改为原子计数
+    args[0].share();
+    const Value callback = args[1];
+    callback.share();
+    std::vector<Value> result(n);
+    size_t chunks = std::min(n, (ThreadPool::shared().size() + 1) * 8);
+    for_each_chunk(*vm, n, chunks, [&](VM& context, size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            Value argv[1] = {array->get(i)};
+            result[i] = call_callback(&context, callback, NativeArgs(argv, 1));
+        }
+    });
+    return Value::makeArray(std::move(result));
+}
+
+Value parallel_reduce(NativeArgs args) {
+    if (args.size() < 2 || args.size() > 3) {
+        throw std::runtime_error("parallel_reduce expects 2 or 3 arguments (array, function, [initial])");
+    }
+    
+    ArrayRef array = expect_array(args, "parallel_reduce");
+    const size_t n = array->size();
+    VM* vm = parallel_vm(n);
+    if (!vm) return reduce(args);
+    
+    // 每块从自己的第一个元素开始归约，最后按块的顺序与初始值合并，
+    // 所以回调必须满足结合律，初始值只参与一次
+    args[0].share();
+    const Value callback = args[1];
+    callback.share();
+    const std::optional<Value> initial = args.size() == 3 ? std::optional<Value>(args[2]) : std::nullopt;
+    size_t chunks = std::min(n, (ThreadPool::shared().size() + 1) * 4);
+    std::vector<Value> partial(chunks);
+    for_each_chunk(*vm, n, chunks, [&](VM& context, size_t begin, size_t end, size_t chunk) {
+        partial[chunk] = reduce_range(&context, *array, callback, array->get(begin), begin + 1, end);
+    });
+    
+    Value acc = initial ? *initial : partial[0];
+    for (size_t chunk = initial ? 0 : 1; chunk < chunks; ++chunk) {
+        Value argv[2] = {acc, partial[chunk]};
+        acc = call_callback(vm, callback, NativeArgs(argv, 2));
+    }
+    return acc;
 }
 
-Value push(const std::vector<Value>& args) {
+Value push(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("push expects 2 arguments (array, value)");
     }
@@ -52,12 +232,15 @@ Value push(const std::vector<Value>& args) {
     if (args[0].getType() != Value::Type::Array) {
         throw std::runtime_error("push expects array, got " + args[0].typeName());
     }
+    if (args[0].isFrozen()) {
+        throw std::runtime_error("cannot mutate shared array inside parallel callback");
+    }
     
     args[0].getArray()->push_back(args[1]);
     return Value();
 }
 
-Value pop(const std::vector<Value>& args) {
+Value pop(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("pop expects 1 argument (array)");
     }
@@ -65,6 +248,9 @@ Value pop(const std::vector<Value>& args) {
     if (args[0].getType() != Value::Type::Array) {
         throw std::runtime_error("pop expects array, got " + args[0].typeName());
     }
+    if (args[0].isFrozen()) {
+        throw std::runtime_error("cannot mutate shared array inside parallel callback");
+    }
     
     auto arr = args[0].getArray();
     if (arr->empty()) {
@@ -76,7 +262,7 @@ Value pop(const std::vector<Value>& args) {
     return result;
 }
 
-Value range(const std::vector<Value>& args) {
+Value range(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("range expects 1 argument (length)");
     }
@@ -90,35 +276,30 @@ Value range(const std::vector<Value>& args) {
         throw std::runtime_error("range expects non-negative integer");
     }
     
-    std::vector<Value> result;
-    result.reserve(static_cast<size_t>(n));
-    for (int64_t i = 0; i < n; ++i) {
-        result.push_back(Value(i));
-    }
-    
-    return Value::makeArray(std::make_shared<std::vector<Value>>(std::move(result)));
+    std::vector<int64_t> result(static_cast<size_t>(n));
+    std::iota(result.begin(), result.end(), int64_t(0));
+    return Value::makeArray(ArrayObject::fromInts(std::move(result)));
 }
 
-Value concat(const std::vector<Value>& args) {
+Value concat(NativeArgs args) {
     if (args.empty()) {
-        return Value::makeArray(std::make_shared<std::vector<Value>>());
+        return Value::makeArray();
     }
     
-    std::vector<Value> result;
+    ArrayObject result;
     
     for (const auto& arg : args) {
         if (arg.getType() != Value::Type::Array) {
             throw std::runtime_error("concat expects only arrays, got " + arg.typeName());
         }
         
-        const auto& arr = *arg.getArray();
-        result.insert(result.end(), arr.begin(), arr.end());
+        result.append(*arg.getArray());
     }
     
-    return Value::makeArray(std::make_shared<std::vector<Value>>(std::move(result)));
+    return Value::makeArray(std::move(result));
 }
 
-Value dot(const std::vector<Value>& args) {
+Value dot(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("dot expects 2 arguments (vector1, vector2)");
     }
@@ -134,17 +315,10 @@ Value dot(const std::vector<Value>& args) {
         throw std::runtime_error("Vectors must have same length");
     }
     
-    double result = 0.0;
-    for (size_t i = 0; i < v1.size(); ++i) {
-        double a = v1[i].toFloat();
-        double b = v2[i].toFloat();
-        result += a * b;
-    }
-    
-    return Value(result);
+    return vec::dot(args);
 }
 
-Value norm(const std::vector<Value>& args) {
+Value norm(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("norm expects 1 argument (vector)");
     }
@@ -153,18 +327,10 @@ Value norm(const std::vector<Value>& args) {
         throw std::runtime_error("norm expects array");
     }
     
-    const auto& v = *args[0].getArray();
-    double sum = 0.0;
-    
-    for (const auto& val : v) {
-        double f = val.toFloat();
-        sum += f * f;
-    }
-    
-    return Value(std::sqrt(sum));
+    return vec::norm(args);
 }
 
-Value cross(const std::vector<Value>& args) {
+Value cross(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("cross expects 2 arguments (vector1, vector2)");
     }
@@ -180,58 +346,30 @@ Value cross(const std::vector<Value>& args) {
         throw std::runtime_error("cross expects 3D vectors");
     }
     
-    double x1 = v1[0].toFloat();
-    double y1 = v1[1].toFloat();
-    double z1 = v1[2].toFloat();
+    double x1 = v1.get(0).toFloat();
+    double y1 = v1.get(1).toFloat();
+    double z1 = v1.get(2).toFloat();
     
-    double x2 = v2[0].toFloat();
-    double y2 = v2[1].toFloat();
-    double z2 = v2[2].toFloat();
-    
-    std::vector<Value> result;
-    result.reserve(3);
-    result.push_back(Value(y1 * z2 - z1 * y2));
-    result.push_back(Value(z1 * x2 - x1 * z2));
-    result.push_back(Value(x1 * y2 - y1 * x2));
+    double x2 = v2.get(0).toFloat();
+    double y2 = v2.get(1).toFloat();
+    double z2 = v2.get(2).toFloat();
     
-    return Value::makeArray(std::make_shared<std::vector<Value>>(std::move(result)));
+    return Value::makeArray(ArrayObject::fromFloats({
+        y1 * z2 - z1 * y2,
+        z1 * x2 - x1 * z2,
+        x1 * y2 - y1 * x2,
+    }));
 }
 
 double calculateDeterminant(const std::vector<std::vector<double>>& matrix) {
-    size_t n = matrix.size();
-    
-    if (n == 1) {
-        return matrix[0][0];
-    }
-    
-    if (n == 2) {
-        return matrix[0][0] * matrix[1][1] - matrix[0][1] * matrix[1][0];
-    }
-    
-    double det = 0.0;
-    for (size_t col = 0; col < n; ++col) {
-        std::vector<std::vector<double>> submatrix;
-        submatrix.reserve(n - 1);
-        
-        for (size_t i = 1; i < n; ++i) {
-            std::vector<double> row;
-            row.reserve(n - 1);
-            for (size_t j = 0; j < n; ++j) {
-                if (j != col) {
-                    row.push_back(matrix[i][j]);
-                }
-            }
-            submatrix.push_back(std::move(row));
-        }
-        
-        double sign = (col % 2 == 0) ? 1.0 : -1.0;
-        det += sign * matrix[0][col] * calculateDeterminant(submatrix);
+    matrix::DenseMatrix dense(matrix.size(), matrix.size());
+    for (size_t i = 0; i < matrix.size(); ++i) {
+        std::copy(matrix[i].begin(), matrix[i].end(), &dense(i, 0));
     }
-    
-    return det;
+    return matrix::determinant(std::move(dense));
 }
 
-Value det(const std::vector<Value>& args) {
+Value det(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("det expects 1 argument (matrix)");
     }
@@ -240,36 +378,7 @@ Value det(const std::vector<Value>& args) {
         throw std::runtime_error("det expects array, got " + args[0].typeName());
     }
     
-    const auto& matrix_val = *args[0].getArray();
-    size_t n = matrix_val.size();
-    
-    if (n == 0) {
-        throw std::runtime_error("Cannot compute determinant of empty matrix");
-    }
-    
-    std::vector<std::vector<double>> matrix;
-    matrix.reserve(n);
-    
-    for (const auto& row_val : matrix_val) {
-        if (row_val.getType() != Value::Type::Array) {
-            throw std::runtime_error("det expects a matrix (2D array)");
-        }
-        
-        const auto& row = *row_val.getArray();
-        if (row.size() != n) {
-            throw std::runtime_error("Matrix must be square");
-        }
-        
-        std::vector<double> float_row;
-        float_row.reserve(n);
-        for (const auto& elem : row) {
-            float_row.push_back(elem.toFloat());
-        }
-        matrix.push_back(std::move(float_row));
-    }
-    
-    double result = calculateDeterminant(matrix);
-    return Value(result);
+    return matrix::det(args);
 }
 
 } // namespace array
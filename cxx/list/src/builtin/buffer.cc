@@ -31,8 +31,7 @@ Value new_buffer_from_bytes(const std::vector<uint8_t>& bytes) {
         byte_values.push_back(Value(static_cast<int64_t>(b)));
     }
     
-    (*fields)[BUFFER_DATA_KEY] = Value::makeArray(
-        std::make_shared<std::vector<Value>>(std::move(byte_values)));
+    (*fields)[BUFFER_DATA_KEY] = Value::makeArray(std::move(byte_values));
     
     (*fields)["length"] = Value::makeNativeFunction("Buffer::length", buffer_length);
     (*fields)["get"] = Value::makeNativeFunction("Buffer::get", buffer_get);
@@ -84,7 +83,7 @@ std::vector<uint8_t> buffer_to_bytes(const Value& value) {
 }
 
 // 获取Buffer的内部数组
-static std::shared_ptr<std::vector<Value>> get_buffer_array(const Value& value) {
+static ArrayRef get_buffer_array(const Value& value) {
     if (value.getType() != Value::Type::Struct) {
         throw std::runtime_error("Expected Buffer object");
     }
@@ -111,7 +110,7 @@ static uint8_t value_to_u8(const Value& v) {
 }
 
 // 获取索引参数
-static size_t get_index(const std::vector<Value>& args, size_t pos) {
+static size_t get_index(NativeArgs args, size_t pos) {
     if (pos >= args.size()) {
         throw std::runtime_error("Missing index argument");
     }
@@ -284,7 +283,7 @@ static std::optional<std::string> parse_encoding_arg(const std::optional<Value>&
 }
 
 // Buffer.alloc(size)
-Value buffer_alloc(const std::vector<Value>& args) {
+Value buffer_alloc(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("Buffer.alloc expects 1 argument (size)");
     }
@@ -298,7 +297,7 @@ Value buffer_alloc(const std::vector<Value>& args) {
 }
 
 // Buffer.from(data, [encoding])
-Value buffer_from(const std::vector<Value>& args) {
+Value buffer_from(NativeArgs args) {
     if (args.size() < 1 || args.size() > 2) {
         throw std::runtime_error("Buffer.from expects 1 or 2 arguments (data, [encoding])");
     }
@@ -347,7 +346,7 @@ Value buffer_from(const std::vector<Value>& args) {
 }
 
 // Buffer.concat(buffers)
-Value buffer_concat(const std::vector<Value>& args) {
+Value buffer_concat(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("Buffer.concat expects 1 argument (buffers)");
     }
@@ -368,7 +367,7 @@ Value buffer_concat(const std::vector<Value>& args) {
 }
 
 // buffer.length
-Value buffer_length(const std::vector<Value>& args) {
+Value buffer_length(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("Buffer.length expects no arguments");
     }
@@ -378,7 +377,7 @@ Value buffer_length(const std::vector<Value>& args) {
 }
 
 // buffer.get(index)
-Value buffer_get(const std::vector<Value>& args) {
+Value buffer_get(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("Buffer.get expects 1 argument (index)");
     }
@@ -390,11 +389,11 @@ Value buffer_get(const std::vector<Value>& args) {
         throw std::runtime_error("Buffer index out of bounds: " + std::to_string(idx));
     }
     
-    return (*arr)[idx];
+    return arr->get(idx);
 }
 
 // buffer.set(index, value)
-Value buffer_set(const std::vector<Value>& args) {
+Value buffer_set(NativeArgs args) {
     if (args.size() != 3) {
         throw std::runtime_error("Buffer.set expects 2 arguments (index, value)");
     }
@@ -407,12 +406,12 @@ Value buffer_set(const std::vector<Value>& args) {
         throw std::runtime_error("Buffer index out of bounds: " + std::to_string(idx));
     }
     
-    (*arr)[idx] = Value(static_cast<int64_t>(value));
+    arr->set(idx, Value(static_cast<int64_t>(value)));
     return Value();
 }
 
 // buffer.slice(start, end)
-Value buffer_slice(const std::vector<Value>& args) {
+Value buffer_slice(NativeArgs args) {
     if (args.size() != 3) {
         throw std::runtime_error("Buffer.slice expects 2 arguments (start, end)");
     }
@@ -430,14 +429,14 @@ Value buffer_slice(const std::vector<Value>& args) {
     std::vector<uint8_t> out;
     out.reserve(end - start);
     for (size_t i = start; i < end; ++i) {
-        out.push_back(value_to_u8((*arr)[i]));
+        out.push_back(value_to_u8(arr->get(i)));
     }
     
     return new_buffer_from_bytes(out);
 }
 
 // buffer.toText()
-Value buffer_to_text(const std::vector<Value>& args) {
+Value buffer_to_text(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("Buffer.toText expects no arguments");
     }
@@ -448,7 +447,7 @@ Value buffer_to_text(const std::vector<Value>& args) {
 }
 
 // buffer.toHex()
-Value buffer_to_hex(const std::vector<Value>& args) {
+Value buffer_to_hex(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("Buffer.toHex expects no arguments");
     }
@@ -467,7 +466,7 @@ Value buffer_to_hex(const std::vector<Value>& args) {
 }
 
 // buffer.toBase64()
-Value buffer_to_base64(const std::vector<Value>& args) {
+Value buffer_to_base64(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("Buffer.toBase64 expects no arguments");
     }
@@ -503,7 +502,7 @@ Value buffer_to_base64(const std::vector<Value>& args) {
 }
 
 // buffer.toBase64Url()
-Value buffer_to_base64_url(const std::vector<Value>& args) {
+Value buffer_to_base64_url(NativeArgs args) {
     Value base64 = buffer_to_base64(args);
     std::string result = base64.getString();
     
@@ -520,7 +519,7 @@ Value buffer_to_base64_url(const std::vector<Value>& args) {
 }
 
 // buffer.copy(target, [targetStart], [sourceStart], [sourceEnd])
-Value buffer_copy(const std::vector<Value>& args) {
+Value buffer_copy(NativeArgs args) {
     if (args.size() < 2 || args.size() > 5) {
         throw std::runtime_error("Buffer.copy expects 1-4 arguments (target, [targetStart], [sourceStart], [sourceEnd])");
     }
@@ -545,7 +544,7 @@ Value buffer_copy(const std::vector<Value>& args) {
     
     size_t copied = 0;
     for (size_t i = source_start; i < source_end && target_start + copied < target_arr->size(); ++i) {
-        (*target_arr)[target_start + copied] = (*source_arr)[i];
+        target_arr->set(target_start + copied, source_arr->get(i));
         ++copied;
     }
     
@@ -553,7 +552,7 @@ Value buffer_copy(const std::vector<Value>& args) {
 }
 
 // buffer.fill(value, [start], [end])
-Value buffer_fill(const std::vector<Value>& args) {
+Value buffer_fill(NativeArgs args) {
     if (args.size() < 2 || args.size() > 4) {
         throw std::runtime_error("Buffer.fill expects 1-3 arguments (value, [start], [end])");
     }
@@ -572,14 +571,14 @@ Value buffer_fill(const std::vector<Value>& args) {
     }
     
     for (size_t i = start; i < end; ++i) {
-        (*arr)[i] = Value(static_cast<int64_t>(value));
+        arr->set(i, Value(static_cast<int64_t>(value)));
     }
     
     return Value();
 }
 
 // buffer.indexOf(pattern, [offset], [encoding])
-Value buffer_index_of(const std::vector<Value>& args) {
+Value buffer_index_of(NativeArgs args) {
     if (args.size() < 2 || args.size() > 4) {
         throw std::runtime_error("Buffer.indexOf expects 1-3 arguments (pattern, [offset], [encoding])");
     }
@@ -602,13 +601,13 @@ Value buffer_index_of(const std::vector<Value>& args) {
 }
 
 // buffer.includes(pattern, [offset], [encoding])
-Value buffer_includes(const std::vector<Value>& args) {
+Value buffer_includes(NativeArgs args) {
     Value idx = buffer_index_of(args);
     return Value(idx.getInt() >= 0);
 }
 
 // buffer.equals(other)
-Value buffer_equals(const std::vector<Value>& args) {
+Value buffer_equals(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("Buffer.equals expects 1 argument (other)");
     }
@@ -620,7 +619,7 @@ Value buffer_equals(const std::vector<Value>& args) {
 }
 
 // buffer.compare(other, [targetStart], [targetEnd], [sourceStart], [sourceEnd])
-Value buffer_compare(const std::vector<Value>& args) {
+Value buffer_compare(NativeArgs args) {
     if (args.size() < 2 || args.size() > 6) {
         throw std::runtime_error("Buffer.compare expects 1-5 arguments (other, [targetStart], [targetEnd], [sourceStart], [sourceEnd])");
     }
@@ -668,7 +667,7 @@ static size_t normalize_range_index(size_t len, int64_t idx) {
 }
 
 // buffer.subarray(start, [end])
-Value buffer_subarray(const std::vector<Value>& args) {
+Value buffer_subarray(NativeArgs args) {
     if (args.size() != 2 && args.size() != 3) {
         throw std::runtime_error("Buffer.subarray expects 1 or 2 arguments (start, [end])");
     }
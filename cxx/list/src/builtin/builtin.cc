@@ -13,6 +13,11 @@
 #include <builtin/cas.h>
 #include <builtin/random.h>
 #include <builtin/time.h>
+#include <builtin/gc.h>
+#include <builtin/scheduler.h>
+#include <builtin/string_builder.h>
+#include <builtin/vec.h>
+#include <builtin/matrix.h>
 
 #include <algorithm>
 #include <numeric>
@@ -80,6 +85,8 @@ void register_builtins(std::unordered_map<std::string, Value>& globals) {
     globals["filter"] = Value::makeNativeFunction("filter", array::filter);
     globals["reduce"] = Value::makeNativeFunction("reduce", array::reduce);
     globals["fold"] = Value::makeNativeFunction("fold", array::reduce);
+    globals["parallel_map"] = Value::makeNativeFunction("parallel_map", array::parallel_map);
+    globals["parallel_reduce"] = Value::makeNativeFunction("parallel_reduce", array::parallel_reduce);
     globals["push"] = Value::makeNativeFunction("push", array::push);
     globals["pop"] = Value::makeNativeFunction("pop", array::pop);
     globals["range"] = Value::makeNativeFunction("range", array::range);
@@ -130,6 +137,31 @@ void register_builtins(std::unordered_map<std::string, Value>& globals) {
     (*string_ns)["replace_by_index"] = Value::makeNativeFunction("string::replace_by_index", string::replace_by_index);
     globals["string"] = Value::makeModule(string_ns);
 
+    // 向量化数值数组命名空间
+    auto vec_ns = std::make_shared<std::unordered_map<std::string, Value>>();
+    (*vec_ns)["dot"] = Value::makeNativeFunction("vec::dot", vec::dot);
+    (*vec_ns)["norm"] = Value::makeNativeFunction("vec::norm", vec::norm);
+    (*vec_ns)["add"] = Value::makeNativeFunction("vec::add", vec::add);
+    (*vec_ns)["sub"] = Value::makeNativeFunction("vec::sub", vec::sub);
+    (*vec_ns)["mul"] = Value::makeNativeFunction("vec::mul", vec::mul);
+    (*vec_ns)["div"] = Value::makeNativeFunction("vec::div", vec::div);
+    (*vec_ns)["scale"] = Value::makeNativeFunction("vec::scale", vec::scale);
+    (*vec_ns)["sum"] = Value::makeNativeFunction("vec::sum", vec::sum);
+    (*vec_ns)["min"] = Value::makeNativeFunction("vec::min", vec::min);
+    (*vec_ns)["max"] = Value::makeNativeFunction("vec::max", vec::max);
+    (*vec_ns)["cumsum"] = Value::makeNativeFunction("vec::cumsum", vec::cumsum);
+    (*vec_ns)["backend"] = Value::makeNativeFunction("vec::backend", vec::backend);
+    globals["vec"] = Value::makeModule(vec_ns);
+
+    // 稠密矩阵命名空间
+    auto matrix_ns = std::make_shared<std::unordered_map<std::string, Value>>();
+    (*matrix_ns)["det"] = Value::makeNativeFunction("matrix::det", matrix::det);
+    (*matrix_ns)["solve"] = Value::makeNativeFunction("matrix::solve", matrix::solve);
+    (*matrix_ns)["inverse"] = Value::makeNativeFunction("matrix::inverse", matrix::inverse);
+    (*matrix_ns)["transpose"] = Value::makeNativeFunction("matrix::transpose", matrix::transpose);
+    (*matrix_ns)["matmul"] = Value::makeNativeFunction("matrix::matmul", matrix::matmul);
+    globals["matrix"] = Value::makeModule(matrix_ns);
+
     // 虚拟include模块
     globals["rumina:buffer"] = buffer::create_buffer_module();
     globals["rumina:fs"] = fs::create_fs_module();
@@ -138,6 +170,9 @@ void register_builtins(std::unordered_map<std::string, Value>& globals) {
     globals["rumina:process"] = process::create_process_module();
     globals["rumina:time"] = create_time_module();
     globals["rumina:stream"] = stream::create_stream_module();
+    globals["rumina:gc"] = gc::create_gc_module();
+    globals["rumina:scheduler"] = scheduler::create_scheduler_module();
+    globals["rumina:string_builder"] = string_builder::create_string_builder_module();
 
     // 带命名空间前缀的字符串函数
     globals["string::cat"] = Value::makeNativeFunction("string::cat", string::cat);
@@ -148,6 +183,16 @@ void register_builtins(std::unordered_map<std::string, Value>& globals) {
     globals["string::char_at"] = Value::makeNativeFunction("string::char_at", string::char_at);
     globals["string::replace_by_index"] = Value::makeNativeFunction("string::replace_by_index", string::replace_by_index);
 
+    // 带命名空间前缀的向量函数
+    for (const auto& [name, fn] : *vec_ns) {
+        globals["vec::" + name] = fn;
+    }
+
+    // 带命名空间前缀的矩阵函数
+    for (const auto& [name, fn] : *matrix_ns) {
+        globals["matrix::" + name] = fn;
+    }
+
     // 物理/化学常量
     globals["EARTH_GRAVITY"] = Value(9.80665);
     globals["MOON_GRAVITY"] = Value(1.625);
@@ -171,7 +216,7 @@ void register_builtins(std::unordered_map<std::string, Value>& globals) {
     globals["ROOM_TEMPERATURE"] = Value(297.15);
 }
 
-Value convert_to_bigint(const std::vector<Value>& args) {
+Value convert_to_bigint(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("convert_to_bigint expects 1 argument");
     }
@@ -198,29 +243,29 @@ Value convert_to_bigint(const std::vector<Value>& args) {
 Value convert_to_declared_type(const Value& val, DeclaredType dtype) {
     switch (dtype) {
         case DeclaredType::Int:
-            return convert_to_int({val});
+            return convert_to_int(NativeArgs(&val, 1));
         case DeclaredType::Float:
-            return convert_to_float({val});
+            return convert_to_float(NativeArgs(&val, 1));
         case DeclaredType::Bool:
-            return convert_to_bool({val});
+            return convert_to_bool(NativeArgs(&val, 1));
         case DeclaredType::String:
-            return convert_to_string({val});
+            return convert_to_string(NativeArgs(&val, 1));
         case DeclaredType::Rational:
-            return convert_to_rational({val});
+            return convert_to_rational(NativeArgs(&val, 1));
         case DeclaredType::Irrational:
-            return convert_to_irrational({val});
+            return convert_to_irrational(NativeArgs(&val, 1));
         case DeclaredType::Complex:
-            return convert_to_complex({val});
+            return convert_to_complex(NativeArgs(&val, 1));
         case DeclaredType::Array:
-            return convert_to_array({val});
+            return convert_to_array(NativeArgs(&val, 1));
         case DeclaredType::BigInt:
-            return convert_to_bigint({val});
+            return convert_to_bigint(NativeArgs(&val, 1));
         default:
             return val;
     }
 }
 
-Value convert_to_int(const std::vector<Value>& args) {
+Value convert_to_int(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("convert_to_int expects 1 argument");
     }
@@ -260,7 +305,7 @@ Value convert_to_int(const std::vector<Value>& args) {
     }
 }
 
-Value convert_to_float(const std::vector<Value>& args) {
+Value convert_to_float(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("convert_to_float expects 1 argument");
     }
@@ -298,7 +343,7 @@ Value convert_to_float(const std::vector<Value>& args) {
     }
 }
 
-Value convert_to_bool(const std::vector<Value>& args) {
+Value convert_to_bool(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("convert_to_bool expects 1 argument");
     }
@@ -306,7 +351,7 @@ Value convert_to_bool(const std::vector<Value>& args) {
     return Value(args[0].isTruthy());
 }
 
-Value convert_to_string(const std::vector<Value>& args) {
+Value convert_to_string(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("convert_to_string expects 1 argument");
     }
@@ -314,7 +359,7 @@ Value convert_to_string(const std::vector<Value>& args) {
     return Value(args[0].toString());
 }
 
-Value convert_to_rational(const std::vector<Value>& args) {
+Value convert_to_rational(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("convert_to_rational expects 1 argument");
     }
@@ -342,7 +387,7 @@ Value convert_to_rational(const std::vector<Value>& args) {
     }
 }
 
-Value convert_to_irrational(const std::vector<Value>& args) {
+Value convert_to_irrational(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("convert_to_irrational expects 1 argument");
     }
@@ -362,7 +407,7 @@ Value convert_to_irrational(const std::vector<Value>& args) {
     }
 }
 
-Value convert_to_complex(const std::vector<Value>& args) {
+Value convert_to_complex(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("convert_to_complex expects 1 argument");
     }
@@ -385,7 +430,7 @@ Value convert_to_complex(const std::vector<Value>& args) {
     }
 }
 
-Value convert_to_array(const std::vector<Value>& args) {
+Value convert_to_array(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("convert_to_array expects 1 argument");
     }
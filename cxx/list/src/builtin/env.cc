@@ -40,7 +40,7 @@ static std::string get_str(const Value& v, const std::string& fn_name) {
 }
 
 // env.get(key)
-Value env_get(const std::vector<Value>& args) {
+Value env_get(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("env.get expects 1 argument (key)");
     }
@@ -56,7 +56,7 @@ Value env_get(const std::vector<Value>& args) {
 }
 
 // env.set(key, value)
-Value env_set(const std::vector<Value>& args) {
+Value env_set(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("env.set expects 2 arguments (key, value)");
     }
@@ -74,7 +74,7 @@ Value env_set(const std::vector<Value>& args) {
 }
 
 // env.has(key)
-Value env_has(const std::vector<Value>& args) {
+Value env_has(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("env.has expects 1 argument (key)");
     }
@@ -86,7 +86,7 @@ Value env_has(const std::vector<Value>& args) {
 }
 
 // env.remove(key)
-Value env_remove(const std::vector<Value>& args) {
+Value env_remove(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("env.remove expects 1 argument (key)");
     }
@@ -103,7 +103,7 @@ Value env_remove(const std::vector<Value>& args) {
 }
 
 // env.all()
-Value env_all(const std::vector<Value>& args) {
+Value env_all(NativeArgs args) {
     if (!args.empty()) {
         throw std::runtime_error("env.all expects no arguments");
     }
@@ -141,7 +141,7 @@ Value env_all(const std::vector<Value>& args) {
 }
 
 // env.keys()
-Value env_keys(const std::vector<Value>& args) {
+Value env_keys(NativeArgs args) {
     if (!args.empty()) {
         throw std::runtime_error("env.keys expects no arguments");
     }
@@ -171,7 +171,7 @@ Value env_keys(const std::vector<Value>& args) {
     }
 #endif
     
-    return Value::makeArray(std::make_shared<std::vector<Value>>(std::move(keys)));
+    return Value::makeArray(std::move(keys));
 }
 
 } // namespace env
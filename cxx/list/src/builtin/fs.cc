@@ -61,7 +61,7 @@ static std::string as_path(const Value& arg, const std::string& fn_name) {
 }
 
 // 检查参数数量
-static void expect_arity(const std::vector<Value>& args, size_t expected, const std::string& sig) {
+static void expect_arity(NativeArgs args, size_t expected, const std::string& sig) {
     if (args.size() != expected) {
         throw std::runtime_error(sig + " expects " + std::to_string(expected - 1) + " arguments");
     }
@@ -180,7 +180,7 @@ static void write_with_flag(const std::string& path, const std::vector<uint8_t>&
 }
 
 // fs.readText(path, [options])
-Value fs_read_text(const std::vector<Value>& args) {
+Value fs_read_text(NativeArgs args) {
     if (args.size() < 1 || args.size() > 2) {
         throw std::runtime_error("fs.readText(path, [options]) expects 1 or 2 arguments");
     }
@@ -205,7 +205,7 @@ Value fs_read_text(const std::vector<Value>& args) {
 }
 
 // fs.readBytes(path, [options])
-Value fs_read_bytes(const std::vector<Value>& args) {
+Value fs_read_bytes(NativeArgs args) {
     if (args.size() < 1 || args.size() > 2) {
         throw std::runtime_error("fs.readBytes(path, [options]) expects 1 or 2 arguments");
     }
@@ -228,7 +228,7 @@ Value fs_read_bytes(const std::vector<Value>& args) {
 }
 
 // fs.writeText(path, text, [options])
-Value fs_write_text(const std::vector<Value>& args) {
+Value fs_write_text(NativeArgs args) {
     if (args.size() < 2 || args.size() > 3) {
         throw std::runtime_error("fs.writeText(path, text, [options]) expects 2 or 3 arguments");
     }
@@ -257,7 +257,7 @@ Value fs_write_text(const std::vector<Value>& args) {
 }
 
 // fs.writeBytes(path, data, [options])
-Value fs_write_bytes(const std::vector<Value>& args) {
+Value fs_write_bytes(NativeArgs args) {
     if (args.size() < 2 || args.size() > 3) {
         throw std::runtime_error("fs.writeBytes(path, data, [options]) expects 2 or 3 arguments");
     }
@@ -281,7 +281,7 @@ Value fs_write_bytes(const std::vector<Value>& args) {
 }
 
 // fs.append(path, data)
-Value fs_append(const std::vector<Value>& args) {
+Value fs_append(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("fs.append(path, data) expects 2 arguments");
     }
@@ -318,7 +318,7 @@ Value fs_append(const std::vector<Value>& args) {
 }
 
 // fs.exists(path)
-Value fs_exists(const std::vector<Value>& args) {
+Value fs_exists(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("fs.exists(path) expects 1 argument");
     }
@@ -328,7 +328,7 @@ Value fs_exists(const std::vector<Value>& args) {
 }
 
 // fs.isFile(path)
-Value fs_is_file(const std::vector<Value>& args) {
+Value fs_is_file(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("fs.isFile(path) expects 1 argument");
     }
@@ -338,7 +338,7 @@ Value fs_is_file(const std::vector<Value>& args) {
 }
 
 // fs.isDir(path)
-Value fs_is_dir(const std::vector<Value>& args) {
+Value fs_is_dir(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("fs.isDir(path) expects 1 argument");
     }
@@ -348,7 +348,7 @@ Value fs_is_dir(const std::vector<Value>& args) {
 }
 
 // fs.stat(path)
-Value fs_stat(const std::vector<Value>& args) {
+Value fs_stat(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("fs.stat(path) expects 1 argument");
     }
@@ -392,7 +392,7 @@ Value fs_stat(const std::vector<Value>& args) {
 }
 
 // fs.makeDir(path)
-Value fs_make_dir(const std::vector<Value>& args) {
+Value fs_make_dir(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("fs.makeDir(path) expects 1 argument");
     }
@@ -407,7 +407,7 @@ Value fs_make_dir(const std::vector<Value>& args) {
 }
 
 // fs.makeDirAll(path)
-Value fs_make_dir_all(const std::vector<Value>& args) {
+Value fs_make_dir_all(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("fs.makeDirAll(path) expects 1 argument");
     }
@@ -422,7 +422,7 @@ Value fs_make_dir_all(const std::vector<Value>& args) {
 }
 
 // fs.readDir(path, [withTypes])
-Value fs_read_dir(const std::vector<Value>& args) {
+Value fs_read_dir(NativeArgs args) {
     if (args.size() < 1 || args.size() > 2) {
         throw std::runtime_error("fs.readDir(path, [withTypes]) expects 1 or 2 arguments");
     }
@@ -454,11 +454,11 @@ Value fs_read_dir(const std::vector<Value>& args) {
         }
     }
     
-    return Value::makeArray(std::make_shared<std::vector<Value>>(std::move(entries)));
+    return Value::makeArray(std::move(entries));
 }
 
 // fs.remove(path)
-Value fs_remove(const std::vector<Value>& args) {
+Value fs_remove(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("fs.remove(path) expects 1 argument");
     }
@@ -473,7 +473,7 @@ Value fs_remove(const std::vector<Value>& args) {
 }
 
 // fs.removeAll(path)
-Value fs_remove_all(const std::vector<Value>& args) {
+Value fs_remove_all(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("fs.removeAll(path) expects 1 argument");
     }
@@ -489,7 +489,7 @@ Value fs_remove_all(const std::vector<Value>& args) {
 }
 
 // fs.rename(oldPath, newPath)
-Value fs_rename(const std::vector<Value>& args) {
+Value fs_rename(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("fs.rename(oldPath, newPath) expects 2 arguments");
     }
@@ -507,7 +507,7 @@ Value fs_rename(const std::vector<Value>& args) {
 }
 
 // fs.copy(srcPath, destPath)
-Value fs_copy(const std::vector<Value>& args) {
+Value fs_copy(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("fs.copy(srcPath, destPath) expects 2 arguments");
     }
@@ -525,7 +525,7 @@ Value fs_copy(const std::vector<Value>& args) {
 }
 
 // fs.realpath(path)
-Value fs_realpath(const std::vector<Value>& args) {
+Value fs_realpath(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("fs.realpath(path) expects 1 argument");
     }
@@ -542,7 +542,7 @@ Value fs_realpath(const std::vector<Value>& args) {
 }
 
 // fs.readLink(path)
-Value fs_read_link(const std::vector<Value>& args) {
+Value fs_read_link(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("fs.readLink(path) expects 1 argument");
     }
@@ -559,7 +559,7 @@ Value fs_read_link(const std::vector<Value>& args) {
 }
 
 // fs.link(existingPath, newPath)
-Value fs_link(const std::vector<Value>& args) {
+Value fs_link(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("fs.link(existingPath, newPath) expects 2 arguments");
     }
@@ -577,7 +577,7 @@ Value fs_link(const std::vector<Value>& args) {
 }
 
 // fs.symlink(target, path)
-Value fs_symlink(const std::vector<Value>& args) {
+Value fs_symlink(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("fs.symlink(target, path) expects 2 arguments");
     }
@@ -595,7 +595,7 @@ Value fs_symlink(const std::vector<Value>& args) {
 }
 
 // fs.chmod(path, mode)
-Value fs_chmod(const std::vector<Value>& args) {
+Value fs_chmod(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("fs.chmod(path, mode) expects 2 arguments");
     }
@@ -0,0 +1,69 @@
+#include <builtin/gc.h>
+#include <cycle_collector.h>
+
+namespace rumina {
+namespace builtin {
+namespace gc {
+
+// VM 按方法调用时把模块本身作为第一个实参传入
+static NativeArgs without_self(NativeArgs args) {
+    if (!args.empty() && args[0].getType() == Value::Type::Module) return args.subspan(1);
+    return args;
+}
+
+Value create_gc_module() {
+    auto ns = std::make_shared<std::unordered_map<std::string, Value>>();
+    
+    (*ns)["collect"] = Value::makeNativeFunction("gc::collect", gc_collect);
+    (*ns)["stats"] = Value::makeNativeFunction("gc::stats", gc_stats);
+    (*ns)["setThreshold"] = Value::makeNativeFunction("gc::setThreshold", gc_set_threshold);
+    
+    return Value::makeModule(ns);
+}
+
+// gc.collect()
+Value gc_collect(NativeArgs args) {
+    args = without_self(args);
+    if (!args.empty()) {
+        throw std::runtime_error("gc.collect expects no arguments");
+    }
+    return Value(static_cast<int64_t>(CycleCollector::collect()));
+}
+
+// gc.stats()
+Value gc_stats(NativeArgs args) {
+    args = without_self(args);
+    if (!args.empty()) {
+        throw std::runtime_error("gc.stats expects no arguments");
+    }
+    
+    GcStats stats = CycleCollector::stats();
+    auto fields = std::make_shared<std::unordered_map<std::string, Value>>();
+    (*fields)["collections"] = Value(static_cast<int64_t>(stats.collections));
+    (*fields)["collected"] = Value(static_cast<int64_t>(stats.collected));
+    (*fields)["lastCollected"] = Value(static_cast<int64_t>(stats.last_collected));
+    (*fields)["tracked"] = Value(static_cast<int64_t>(stats.tracked));
+    (*fields)["allocated"] = Value(static_cast<int64_t>(stats.allocated));
+    (*fields)["totalPauseUs"] = Value(static_cast<int64_t>(stats.total_pause_us));
+    (*fields)["lastPauseUs"] = Value(static_cast<int64_t>(stats.last_pause_us));
+    (*fields)["threshold"] = Value(static_cast<int64_t>(CycleCollector::threshold()));
+    return Value::makeStruct(fields);
+}
+
+// gc.setThreshold(n)
+Value gc_set_threshold(NativeArgs args) {
+    args = without_self(args);
+    if (args.size() != 1) {
+        throw std::runtime_error("gc.setThreshold expects 1 argument (threshold)");
+    }
+    int64_t threshold = args[0].toInt();
+    if (threshold < 0) {
+        throw std::runtime_error("gc.setThreshold expects a non-negative threshold");
+    }
+    CycleCollector::setThreshold(static_cast<size_t>(threshold));
+    return Value();
+}
+
+} // namespace gc
+} // namespace builtin
+} // namespace rumina
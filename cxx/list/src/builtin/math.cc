@@ -6,7 +6,7 @@ namespace rumina {
 namespace builtin {
 namespace math {
 
-Value sqrt(const std::vector<Value>& args) {
+Value sqrt(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("sqrt expects 1 argument");
     }
@@ -56,21 +56,21 @@ Value sqrt(const std::vector<Value>& args) {
     throw std::runtime_error("sqrt expects number, got " + val.typeName());
 }
 
-Value pi(const std::vector<Value>& args) {
+Value pi(NativeArgs args) {
     if (args.size() != 0) {
         throw std::runtime_error("pi expects 0 arguments");
     }
     return Value(IrrationalValue::makePi());
 }
 
-Value e(const std::vector<Value>& args) {
+Value e(NativeArgs args) {
     if (args.size() != 0) {
         throw std::runtime_error("e expects 0 arguments");
     }
     return Value(IrrationalValue::makeE());
 }
 
-Value sin(const std::vector<Value>& args) {
+Value sin(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("sin expects 1 argument");
     }
@@ -79,7 +79,7 @@ Value sin(const std::vector<Value>& args) {
     return Value(std::sin(val));
 }
 
-Value cos(const std::vector<Value>& args) {
+Value cos(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("cos expects 1 argument");
     }
@@ -88,7 +88,7 @@ Value cos(const std::vector<Value>& args) {
     return Value(std::cos(val));
 }
 
-Value tan(const std::vector<Value>& args) {
+Value tan(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("tan expects 1 argument");
     }
@@ -97,7 +97,7 @@ Value tan(const std::vector<Value>& args) {
     return Value(std::tan(val));
 }
 
-Value exp(const std::vector<Value>& args) {
+Value exp(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("exp expects 1 argument");
     }
@@ -106,7 +106,7 @@ Value exp(const std::vector<Value>& args) {
     return Value(std::exp(val));
 }
 
-Value abs_fn(const std::vector<Value>& args) {
+Value abs_fn(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("abs expects 1 argument");
     }
@@ -143,7 +143,7 @@ Value abs_fn(const std::vector<Value>& args) {
     }
 }
 
-Value arg(const std::vector<Value>& args) {
+Value arg(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("arg expects 1 argument");
     }
@@ -174,7 +174,7 @@ Value arg(const std::vector<Value>& args) {
     throw std::runtime_error("arg expects complex or real number, got " + val.typeName());
 }
 
-Value conj(const std::vector<Value>& args) {
+Value conj(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("conj expects 1 argument");
     }
@@ -199,7 +199,7 @@ Value conj(const std::vector<Value>& args) {
     return val;
 }
 
-Value re(const std::vector<Value>& args) {
+Value re(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("re expects 1 argument");
     }
@@ -214,7 +214,7 @@ Value re(const std::vector<Value>& args) {
     return val;
 }
 
-Value im(const std::vector<Value>& args) {
+Value im(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("im expects 1 argument");
     }
@@ -229,7 +229,7 @@ Value im(const std::vector<Value>& args) {
     return Value(static_cast<int64_t>(0)); // return Value(0);
 }
 
-Value log(const std::vector<Value>& args) {
+Value log(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("log expects 1 argument");
     }
@@ -241,7 +241,7 @@ Value log(const std::vector<Value>& args) {
     return Value(std::log10(val));
 }
 
-Value ln(const std::vector<Value>& args) {
+Value ln(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("ln expects 1 argument");
     }
@@ -253,7 +253,7 @@ Value ln(const std::vector<Value>& args) {
     return Value(std::log(val));
 }
 
-Value logbase(const std::vector<Value>& args) {
+Value logbase(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("logBASE expects 2 arguments (base, value)");
     }
@@ -271,7 +271,7 @@ Value logbase(const std::vector<Value>& args) {
     return Value(std::log(val) / std::log(base));
 }
 
-Value factorial(const std::vector<Value>& args) {
+Value factorial(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("factorial expects 1 argument");
     }
@@ -0,0 +1,535 @@
+#include <builtin/matrix.h>
+#include <thread_pool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <numeric>
+#include <string>
+#include <utility>
+
+namespace rumina {
+namespace builtin {
+namespace matrix {
+
+namespace {
+
+// 分块边长：三块 64×64 的 double 正好放进 L2
+constexpr size_t kBlock = 64;
+// 乘加次数超过这个值才按行块分给调度器
+constexpr size_t kParallelWork = size_t(1) << 22;
+
+void expect_args(NativeArgs args, size_t count, const char* name, const char* usage) {
+    if (args.size() != count) {
+        throw std::runtime_error(std::string(name) + " expects " + std::to_string(count) +
+                                 (count == 1 ? " argument (" : " arguments (") + usage + ")");
+    }
+}
+
+bool is_matrix_value(const Value& value) {
+    if (value.getType() != Value::Type::Array) return false;
+    const ArrayObject& rows = *value.get<ArrayObject>();
+    return !rows.isPacked() && !rows.empty() && rows.get(0).getType() == Value::Type::Array;
+}
+
+// 检查二维数组：非空、每行都是数组且长度相同，返回列数
+size_t expect_matrix(const Value& value, const char* name) {
+    if (value.getType() != Value::Type::Array) {
+        throw std::runtime_error(std::string(name) + " expects a matrix (2D array), got " + value.typeName());
+    }
+    const ArrayObject& rows = *value.get<ArrayObject>();
+    if (rows.empty()) {
+        throw std::runtime_error(std::string(name) + " expects a non-empty matrix");
+    }
+    size_t cols = 0;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        Value row = rows.get(i);
+        if (row.getType() != Value::Type::Array) {
+            throw std::runtime_error(std::string(name) + " expects a matrix (2D array)");
+        }
+        size_t width = row.get<ArrayObject>()->size();
+        if (i == 0) {
+            cols = width;
+        } else if (width != cols) {
+            throw std::runtime_error(std::string(name) + " expects rows of the same length");
+        }
+    }
+    if (cols == 0) {
+        throw std::runtime_error(std::string(name) + " expects a non-empty matrix");
+    }
+    return cols;
+}
+
+void read_row(const ArrayObject& row, double* out) {
+    switch (row.kind()) {
+        case ArrayObject::Kind::Float64:
+            std::copy(row.floats().begin(), row.floats().end(), out);
+            break;
+        case ArrayObject::Kind::Int64:
+            std::copy(row.ints().begin(), row.ints().end(), out);
+            break;
+        default:
+            for (const Value& element : row.values()) *out++ = element.toFloat();
+            break;
+    }
+}
+
+DenseMatrix to_dense(const Value& value, const char* name) {
+    size_t cols = expect_matrix(value, name);
+    const ArrayObject& rows = *value.get<ArrayObject>();
+    DenseMatrix m(rows.size(), cols);
+    for (size_t i = 0; i < m.rows; ++i) {
+        read_row(*rows.get(i).get<ArrayObject>(), &m(i, 0));
+    }
+    return m;
+}
+
+// 向量按 n×1 矩阵读取
+DenseMatrix column_to_dense(const ArrayObject& vector) {
+    DenseMatrix m(vector.size(), 1);
+    read_row(vector, m.data.data());
+    return m;
+}
+
+Value from_dense(const DenseMatrix& m) {
+    std::vector<Value> rows;
+    rows.reserve(m.rows);
+    for (size_t i = 0; i < m.rows; ++i) {
+        const double* row = &m(i, 0);
+        rows.push_back(Value::makeArray(ArrayObject::fromFloats(std::vector<double>(row, row + m.cols))));
+    }
+    return Value::makeArray(std::move(rows));
+}
+
+// ---- 精确路径 ----
+
+// 元素里有 Float 或非数值时返回 false；遇到 Rational / BigInt 时置 has_exact
+bool scan_exact(const ArrayObject& values, bool& has_exact) {
+    switch (values.kind()) {
+        case ArrayObject::Kind::Int64: return true;
+        case ArrayObject::Kind::Float64: return false;
+        default: break;
+    }
+    for (const Value& element : values.values()) {
+        switch (element.getType()) {
+            case Value::Type::Int:
+                break;
+            case Value::Type::BigInt:
+            case Value::Type::Rational:
+                has_exact = true;
+                break;
+            case Value::Type::Array:
+                if (!scan_exact(*element.get<ArrayObject>(), has_exact)) return false;
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+bool wants_exact(std::initializer_list<const Value*> values) {
+    bool has_exact = false;
+    for (const Value* value : values) {
+        if (!scan_exact(*value->get<ArrayObject>(), has_exact)) return false;
+    }
+    return has_exact;
+}
+
+BigRational to_rational(const Value& value) {
+    switch (value.getType()) {
+        case Value::Type::BigInt: return BigRational(value.getBigInt());
+        case Value::Type::Rational: {
+            // 除法运算产生的有理数不一定是约分后的形式
+            BigRational r = value.getRational();
+            r.canonicalize();
+            return r;
+        }
+        default: return BigRational(static_cast<long>(value.getInt()));
+    }
+}
+
+// 行主序读出全部元素；value 可以是矩阵，也可以是按列向量处理的一维数组
+std::vector<BigRational> to_rationals(const Value& value) {
+    std::vector<BigRational> out;
+    const ArrayObject& outer = *value.get<ArrayObject>();
+    for (const Value& element : outer) {
+        if (element.getType() == Value::Type::Array) {
+            for (const Value& x : *element.get<ArrayObject>()) out.push_back(to_rational(x));
+        } else {
+            out.push_back(to_rational(element));
+        }
+    }
+    return out;
+}
+
+// 整数结果还原成 Int / BigInt，避免出现 "3/1"
+Value exact_value(const BigRational& r) {
+    if (r.get_den() != 1) return Value(r);
+    if (r.get_num().fits_slong_p()) return Value(static_cast<int64_t>(r.get_num().get_si()));
+    return Value(BigInt(r.get_num()));
+}
+
+Value from_rationals(const std::vector<BigRational>& data, size_t rows, size_t cols) {
+    std::vector<Value> out;
+    out.reserve(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        std::vector<Value> row;
+        row.reserve(cols);
+        for (size_t j = 0; j < cols; ++j) row.push_back(exact_value(data[i * cols + j]));
+        out.push_back(Value::makeArray(std::move(row)));
+    }
+    return Value::makeArray(std::move(out));
+}
+
+// 每行乘以分母的最小公倍数化成整数矩阵，Bareiss 求值后再除回去
+BigRational exact_determinant(const std::vector<BigRational>& a, size_t n) {
+    std::vector<BigInt> ints(n * n);
+    BigInt scale = 1;
+    for (size_t i = 0; i < n; ++i) {
+        BigInt lcm = 1;
+        for (size_t j = 0; j < n; ++j) {
+            mpz_lcm(lcm.get_mpz_t(), lcm.get_mpz_t(), a[i * n + j].get_den_mpz_t());
+        }
+        for (size_t j = 0; j < n; ++j) {
+            const BigRational& x = a[i * n + j];
+            ints[i * n + j] = x.get_num() * (lcm / x.get_den());
+        }
+        scale *= lcm;
+    }
+    BigRational result(bareissDeterminant(std::move(ints), n), scale);
+    result.canonicalize();
+    return result;
+}
+
+// 解 A X = B（A 为 n×n，B 为 n×m），结果写回 b。
+// [A | B] 每行乘以分母的最小公倍数化成整数后做无分数的 Gauss-Jordan 消元（Bareiss 形式）：
+// 每步的除法都是整除，结束时左半部分是 d·I、右半部分是 d·X（d = ±det A），最后各除一次 d
+void exact_solve(std::vector<BigRational> a, std::vector<BigRational>& b, size_t n, size_t m, const char* name) {
+    const size_t w = n + m;
+    std::vector<BigInt> t(n * w);
+    for (size_t i = 0; i < n; ++i) {
+        BigInt lcm = 1;
+        for (size_t j = 0; j < n; ++j) mpz_lcm(lcm.get_mpz_t(), lcm.get_mpz_t(), a[i * n + j].get_den_mpz_t());
+        for (size_t j = 0; j < m; ++j) mpz_lcm(lcm.get_mpz_t(), lcm.get_mpz_t(), b[i * m + j].get_den_mpz_t());
+        for (size_t j = 0; j < n; ++j) {
+            const BigRational& x = a[i * n + j];
+            t[i * w + j] = x.get_num() * (lcm / x.get_den());
+        }
+        for (size_t j = 0; j < m; ++j) {
+            const BigRational& x = b[i * m + j];
+            t[i * w + n + j] = x.get_num() * (lcm / x.get_den());
+        }
+    }
+
+    BigInt prev = 1;
+    for (size_t k = 0; k < n; ++k) {
+        size_t p = k;
+        while (p < n && t[p * w + k] == 0) ++p;
+        if (p == n) {
+            throw std::runtime_error(std::string(name) + ": matrix is singular");
+        }
+        if (p != k) {
+            std::swap_ranges(t.begin() + k * w, t.begin() + (k + 1) * w, t.begin() + p * w);
+        }
+        const BigInt pivot = t[k * w + k];
+        for (size_t i = 0; i < n; ++i) {
+            if (i == k) continue;
+            const BigInt f = t[i * w + k];
+            for (size_t j = k + 1; j < w; ++j) {
+                BigInt& x = t[i * w + j];
+                x *= pivot;
+                x -= f * t[k * w + j];
+                mpz_divexact(x.get_mpz_t(), x.get_mpz_t(), prev.get_mpz_t());
+            }
+            t[i * w + k] = 0;
+            // 已消元的列只剩对角线，随主元同步更新
+            if (i < k) t[i * w + i] = pivot;
+        }
+        prev = pivot;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            BigRational x(t[i * w + n + j], prev);
+            x.canonicalize();
+            b[i * m + j] = std::move(x);
+        }
+    }
+}
+
+// ---- double 路径 ----
+
+// 用分解结果解 A X = B，B 为 n×m
+DenseMatrix lu_solve(const LUDecomposition& lu, const DenseMatrix& b) {
+    const size_t n = lu.lu.rows;
+    const size_t m = b.cols;
+    DenseMatrix x(n, m);
+    for (size_t i = 0; i < n; ++i) {
+        std::copy_n(&b(lu.pivot[i], 0), m, &x(i, 0));
+    }
+    // 前代：L 的对角为 1
+    for (size_t i = 0; i < n; ++i) {
+        double* xi = &x(i, 0);
+        for (size_t k = 0; k < i; ++k) {
+            double f = lu.lu(i, k);
+            if (f == 0.0) continue;
+            const double* xk = &x(k, 0);
+            for (size_t j = 0; j < m; ++j) xi[j] -= f * xk[j];
+        }
+    }
+    // 回代
+    for (size_t i = n; i-- > 0;) {
+        double* xi = &x(i, 0);
+        for (size_t k = i + 1; k < n; ++k) {
+            double f = lu.lu(i, k);
+            if (f == 0.0) continue;
+            const double* xk = &x(k, 0);
+            for (size_t j = 0; j < m; ++j) xi[j] -= f * xk[j];
+        }
+        double inv = 1.0 / lu.lu(i, i);
+        for (size_t j = 0; j < m; ++j) xi[j] *= inv;
+    }
+    return x;
+}
+
+LUDecomposition factor_square(const Value& value, const char* name) {
+    DenseMatrix a = to_dense(value, name);
+    if (a.rows != a.cols) {
+        throw std::runtime_error(std::string(name) + " expects a square matrix");
+    }
+    LUDecomposition lu = luDecompose(std::move(a));
+    if (lu.singular) {
+        throw std::runtime_error(std::string(name) + ": matrix is singular");
+    }
+    return lu;
+}
+
+// C[begin, end) += A[begin, end) * B，按块遍历让 B 的块留在缓存里
+void multiply_rows(const DenseMatrix& a, const DenseMatrix& b, DenseMatrix& c, size_t begin, size_t end) {
+    const size_t inner = a.cols;
+    for (size_t ii = begin; ii < end; ii += kBlock) {
+        size_t i_end = std::min(ii + kBlock, end);
+        for (size_t kk = 0; kk < inner; kk += kBlock) {
+            size_t k_end = std::min(kk + kBlock, inner);
+            for (size_t jj = 0; jj < b.cols; jj += kBlock) {
+                size_t j_end = std::min(jj + kBlock, b.cols);
+                for (size_t i = ii; i < i_end; ++i) {
+                    double* ci = &c(i, 0);
+                    for (size_t k = kk; k < k_end; ++k) {
+                        double aik = a(i, k);
+                        const double* bk = &b(k, 0);
+                        for (size_t j = jj; j < j_end; ++j) ci[j] += aik * bk[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+LUDecomposition luDecompose(DenseMatrix a) {
+    const size_t n = a.rows;
+    LUDecomposition result;
+    result.pivot.resize(n);
+    std::iota(result.pivot.begin(), result.pivot.end(), size_t(0));
+
+    for (size_t k = 0; k < n; ++k) {
+        size_t p = k;
+        double best = std::abs(a(k, k));
+        for (size_t i = k + 1; i < n; ++i) {
+            double v = std::abs(a(i, k));
+            if (v > best) {
+                best = v;
+                p = i;
+            }
+        }
+        if (best == 0.0) {
+            result.singular = true;
+            continue;
+        }
+        if (p != k) {
+            std::swap_ranges(&a(k, 0), &a(k, 0) + n, &a(p, 0));
+            std::swap(result.pivot[k], result.pivot[p]);
+            result.sign = -result.sign;
+        }
+        const double* rk = &a(k, 0);
+        double inv = 1.0 / rk[k];
+        for (size_t i = k + 1; i < n; ++i) {
+            double* ri = &a(i, 0);
+            double f = ri[k] * inv;
+            ri[k] = f;
+            if (f == 0.0) continue;
+            for (size_t j = k + 1; j < n; ++j) ri[j] -= f * rk[j];
+        }
+    }
+    result.lu = std::move(a);
+    return result;
+}
+
+double determinant(DenseMatrix a) {
+    LUDecomposition lu = luDecompose(std::move(a));
+    if (lu.singular) return 0.0;
+    double det = lu.sign;
+    for (size_t i = 0; i < lu.lu.rows; ++i) det *= lu.lu(i, i);
+    return det;
+}
+
+DenseMatrix multiply(const DenseMatrix& a, const DenseMatrix& b) {
+    DenseMatrix c(a.rows, b.cols);
+    size_t work = a.rows * a.cols * b.cols;
+    size_t blocks = (a.rows + kBlock - 1) / kBlock;
+    if (work < kParallelWork || blocks < 2) {
+        multiply_rows(a, b, c, 0, a.rows);
+        return c;
+    }
+
+    // 每个任务负责一个行块，互不写同一行；由共用调度器的工作线程窃取执行
+    TaskGroup group(ThreadPool::shared());
+    for (size_t block = 0; block < blocks; ++block) {
+        size_t begin = block * kBlock;
+        size_t end = std::min(a.rows, begin + kBlock);
+        group.run([&a, &b, &c, begin, end]() { multiply_rows(a, b, c, begin, end); });
+    }
+    group.wait();
+    return c;
+}
+
+BigInt bareissDeterminant(std::vector<BigInt> a, size_t n) {
+    if (n == 0) return 1;
+    bool negate = false;
+    BigInt prev = 1;
+    for (size_t k = 0; k < n; ++k) {
+        if (a[k * n + k] == 0) {
+            size_t p = k + 1;
+            while (p < n && a[p * n + k] == 0) ++p;
+            if (p == n) return 0;
+            std::swap_ranges(a.begin() + k * n, a.begin() + (k + 1) * n, a.begin() + p * n);
+            negate = !negate;
+        }
+        const BigInt& pivot = a[k * n + k];
+        for (size_t i = k + 1; i < n; ++i) {
+            for (size_t j = k + 1; j < n; ++j) {
+                BigInt& x = a[i * n + j];
+                x *= pivot;
+                x -= a[i * n + k] * a[k * n + j];
+                mpz_divexact(x.get_mpz_t(), x.get_mpz_t(), prev.get_mpz_t());
+            }
+        }
+        prev = pivot;
+    }
+    BigInt det = a[n * n - 1];
+    return negate ? BigInt(-det) : det;
+}
+
+Value det(NativeArgs args) {
+    expect_args(args, 1, "matrix::det", "matrix");
+    size_t cols = expect_matrix(args[0], "matrix::det");
+    size_t n = args[0].get<ArrayObject>()->size();
+    if (n != cols) {
+        throw std::runtime_error("matrix::det expects a square matrix");
+    }
+    // 整数矩阵同样走 Bareiss，结果是精确的 Int / BigInt
+    bool has_exact = false;
+    if (scan_exact(*args[0].get<ArrayObject>(), has_exact)) {
+        return exact_value(exact_determinant(to_rationals(args[0]), n));
+    }
+    return Value(determinant(to_dense(args[0], "matrix::det")));
+}
+
+Value solve(NativeArgs args) {
+    expect_args(args, 2, "matrix::solve", "matrix, vector");
+    size_t n = expect_matrix(args[0], "matrix::solve");
+    if (args[0].get<ArrayObject>()->size() != n) {
+        throw std::runtime_error("matrix::solve expects a square matrix");
+    }
+    if (args[1].getType() != Value::Type::Array) {
+        throw std::runtime_error("matrix::solve expects array, got " + args[1].typeName());
+    }
+    bool rhs_matrix = is_matrix_value(args[1]);
+    size_t m = rhs_matrix ? expect_matrix(args[1], "matrix::solve") : 1;
+    if (args[1].get<ArrayObject>()->size() != n) {
+        throw std::runtime_error("matrix::solve: right-hand side must have " + std::to_string(n) + " rows");
+    }
+
+    if (wants_exact({&args[0], &args[1]})) {
+        std::vector<BigRational> x = to_rationals(args[1]);
+        exact_solve(to_rationals(args[0]), x, n, m, "matrix::solve");
+        if (rhs_matrix) return from_rationals(x, n, m);
+        std::vector<Value> out;
+        out.reserve(n);
+        for (const BigRational& r : x) out.push_back(exact_value(r));
+        return Value::makeArray(std::move(out));
+    }
+
+    LUDecomposition lu = factor_square(args[0], "matrix::solve");
+    if (rhs_matrix) {
+        return from_dense(lu_solve(lu, to_dense(args[1], "matrix::solve")));
+    }
+    DenseMatrix x = lu_solve(lu, column_to_dense(*args[1].get<ArrayObject>()));
+    return Value::makeArray(ArrayObject::fromFloats(std::move(x.data)));
+}
+
+Value inverse(NativeArgs args) {
+    expect_args(args, 1, "matrix::inverse", "matrix");
+    size_t n = expect_matrix(args[0], "matrix::inverse");
+    if (args[0].get<ArrayObject>()->size() != n) {
+        throw std::runtime_error("matrix::inverse expects a square matrix");
+    }
+
+    if (wants_exact({&args[0]})) {
+        std::vector<BigRational> x(n * n, BigRational(0));
+        for (size_t i = 0; i < n; ++i) x[i * n + i] = 1;
+        exact_solve(to_rationals(args[0]), x, n, n, "matrix::inverse");
+        return from_rationals(x, n, n);
+    }
+
+    LUDecomposition lu = factor_square(args[0], "matrix::inverse");
+    DenseMatrix identity(n, n);
+    for (size_t i = 0; i < n; ++i) identity(i, i) = 1.0;
+    return from_dense(lu_solve(lu, identity));
+}
+
+Value transpose(NativeArgs args) {
+    expect_args(args, 1, "matrix::transpose", "matrix");
+    size_t cols = expect_matrix(args[0], "matrix::transpose");
+    const ArrayObject& rows = *args[0].get<ArrayObject>();
+
+    // 按元素搬运，保留原来的类型；同类的行会重新打包
+    std::vector<std::vector<Value>> columns(cols);
+    for (auto& column : columns) column.reserve(rows.size());
+    for (const Value& row : rows) {
+        const ArrayObject& r = *row.get<ArrayObject>();
+        for (size_t j = 0; j < cols; ++j) columns[j].push_back(r.get(j));
+    }
+    std::vector<Value> out;
+    out.reserve(cols);
+    for (auto& column : columns) out.push_back(Value::makeArray(std::move(column)));
+    return Value::makeArray(std::move(out));
+}
+
+Value matmul(NativeArgs args) {
+    expect_args(args, 2, "matrix::matmul", "matrix, matrix");
+    DenseMatrix a = to_dense(args[0], "matrix::matmul");
+    if (args[1].getType() != Value::Type::Array) {
+        throw std::runtime_error("matrix::matmul expects array, got " + args[1].typeName());
+    }
+
+    // 右边是一维数组时按列向量相乘，结果也是一维数组
+    bool rhs_matrix = is_matrix_value(args[1]);
+    DenseMatrix b = rhs_matrix ? to_dense(args[1], "matrix::matmul")
+                               : column_to_dense(*args[1].get<ArrayObject>());
+    if (a.cols != b.rows) {
+        throw std::runtime_error("matrix::matmul: dimension mismatch (" + std::to_string(a.rows) + "x" +
+                                 std::to_string(a.cols) + " times " + std::to_string(b.rows) + "x" +
+                                 std::to_string(b.cols) + ")");
+    }
+    DenseMatrix c = multiply(a, b);
+    if (rhs_matrix) return from_dense(c);
+    return Value::makeArray(ArrayObject::fromFloats(std::move(c.data)));
+}
+
+} // namespace matrix
+} // namespace builtin
+} // namespace rumina
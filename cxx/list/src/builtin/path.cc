@@ -44,7 +44,7 @@ static std::string as_string(const Value& v, const std::string& name) {
 }
 
 // path.join(paths)
-Value path_join(const std::vector<Value>& args) {
+Value path_join(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("path.join expects 1 argument (paths)");
     }
@@ -67,7 +67,7 @@ Value path_join(const std::vector<Value>& args) {
 }
 
 // path.basename(path)
-Value path_basename(const std::vector<Value>& args) {
+Value path_basename(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("path.basename expects 1 argument (path)");
     }
@@ -84,7 +84,7 @@ Value path_basename(const std::vector<Value>& args) {
 }
 
 // path.dirname(path)
-Value path_dirname(const std::vector<Value>& args) {
+Value path_dirname(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("path.dirname expects 1 argument (path)");
     }
@@ -101,7 +101,7 @@ Value path_dirname(const std::vector<Value>& args) {
 }
 
 // path.extname(path)
-Value path_extname(const std::vector<Value>& args) {
+Value path_extname(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("path.extname expects 1 argument (path)");
     }
@@ -114,7 +114,7 @@ Value path_extname(const std::vector<Value>& args) {
 }
 
 // path.isAbsolute(path)
-Value path_is_absolute(const std::vector<Value>& args) {
+Value path_is_absolute(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("path.isAbsolute expects 1 argument (path)");
     }
@@ -146,7 +146,7 @@ static fs::path normalize_path(const fs::path& path) {
 }
 
 // path.normalize(path)
-Value path_normalize(const std::vector<Value>& args) {
+Value path_normalize(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("path.normalize expects 1 argument (path)");
     }
@@ -159,7 +159,7 @@ Value path_normalize(const std::vector<Value>& args) {
 }
 
 // path.resolve(paths)
-Value path_resolve(const std::vector<Value>& args) {
+Value path_resolve(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("path.resolve expects 1 argument (paths)");
     }
@@ -190,7 +190,7 @@ Value path_resolve(const std::vector<Value>& args) {
 }
 
 // path.relative(from, to)
-Value path_relative(const std::vector<Value>& args) {
+Value path_relative(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("path.relative expects 2 arguments (from, to)");
     }
@@ -206,7 +206,7 @@ Value path_relative(const std::vector<Value>& args) {
 }
 
 // path.parse(path)
-Value path_parse(const std::vector<Value>& args) {
+Value path_parse(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("path.parse expects 1 argument (path)");
     }
@@ -240,7 +240,7 @@ Value path_parse(const std::vector<Value>& args) {
 }
 
 // path.format(parts)
-Value path_format(const std::vector<Value>& args) {
+Value path_format(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("path.format expects 1 argument (parts)");
     }
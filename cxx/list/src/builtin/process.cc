@@ -57,7 +57,7 @@ static std::string as_string(const Value& v, const std::string& fn_name) {
     return v.getString();
 }
 
-Value process_args(const std::vector<Value>& args) {
+Value process_args(NativeArgs args) {
     if (!args.empty()) {
         throw std::runtime_error("process.args expects no arguments");
     }
@@ -96,10 +96,10 @@ Value process_args(const std::vector<Value>& args) {
     }
 #endif
     
-    return Value::makeArray(std::make_shared<std::vector<Value>>(std::move(result)));
+    return Value::makeArray(std::move(result));
 }
 
-Value process_cwd(const std::vector<Value>& args) {
+Value process_cwd(NativeArgs args) {
     if (!args.empty()) {
         throw std::runtime_error("process.cwd expects no arguments");
     }
@@ -113,7 +113,7 @@ Value process_cwd(const std::vector<Value>& args) {
     return Value(cwd.string());
 }
 
-Value process_set_cwd(const std::vector<Value>& args) {
+Value process_set_cwd(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("process.setCwd expects 1 argument (path)");
     }
@@ -129,7 +129,7 @@ Value process_set_cwd(const std::vector<Value>& args) {
     return Value();
 }
 
-Value process_pid(const std::vector<Value>& args) {
+Value process_pid(NativeArgs args) {
     if (!args.empty()) {
         throw std::runtime_error("process.pid expects no arguments");
     }
@@ -143,7 +143,7 @@ Value process_pid(const std::vector<Value>& args) {
     return Value(static_cast<int64_t>(pid));
 }
 
-Value process_exit(const std::vector<Value>& args) {
+Value process_exit(NativeArgs args) {
     int code = 0;
     if (args.size() == 1) {
         code = static_cast<int>(args[0].toInt());
@@ -155,7 +155,7 @@ Value process_exit(const std::vector<Value>& args) {
     return Value();
 }
 
-Value process_platform(const std::vector<Value>& args) {
+Value process_platform(NativeArgs args) {
     if (!args.empty()) {
         throw std::runtime_error("process.platform expects no arguments");
     }
@@ -179,7 +179,7 @@ Value process_platform(const std::vector<Value>& args) {
 #endif
 }
 
-Value process_arch(const std::vector<Value>& args) {
+Value process_arch(NativeArgs args) {
     if (!args.empty()) {
         throw std::runtime_error("process.arch expects no arguments");
     }
@@ -205,7 +205,7 @@ Value process_arch(const std::vector<Value>& args) {
 #endif
 }
 
-Value process_version(const std::vector<Value>& args) {
+Value process_version(NativeArgs args) {
     if (!args.empty()) {
         throw std::runtime_error("process.version expects no arguments");
     }
@@ -217,7 +217,7 @@ Value process_version(const std::vector<Value>& args) {
 #endif
 }
 
-Value process_exec_path(const std::vector<Value>& args) {
+Value process_exec_path(NativeArgs args) {
     if (!args.empty()) {
         throw std::runtime_error("process.execPath expects no arguments");
     }
@@ -11,7 +11,7 @@ namespace random_ns {
         return rng;
     }
 
-Value rand(const std::vector<Value>& args) {
+Value rand(NativeArgs args) {
     if (!args.empty()) {
         throw std::runtime_error("random::rand expects 0 arguments");
     }
@@ -20,7 +20,7 @@ Value rand(const std::vector<Value>& args) {
     return Value(dist(random_ns::get_rng()));
 }
 
-Value randint(const std::vector<Value>& args) {
+Value randint(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("random::randint expects 2 arguments (start, end)");
     }
@@ -32,7 +32,7 @@ Value randint(const std::vector<Value>& args) {
     return Value(dist(random_ns::get_rng()));
 }
 
-Value random(const std::vector<Value>& args) {
+Value random(NativeArgs args) {
     return rand(args);
 }
 
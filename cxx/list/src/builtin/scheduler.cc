@@ -0,0 +1,51 @@
+#include <builtin/scheduler.h>
+#include <thread_pool.h>
+
+namespace rumina {
+namespace builtin {
+namespace scheduler {
+
+// VM 按方法调用时把模块本身作为第一个实参传入
+static NativeArgs without_self(NativeArgs args) {
+    if (!args.empty() && args[0].getType() == Value::Type::Module) return args.subspan(1);
+    return args;
+}
+
+Value create_scheduler_module() {
+    auto ns = std::make_shared<std::unordered_map<std::string, Value>>();
+    
+    (*ns)["stats"] = Value::makeNativeFunction("scheduler::stats", scheduler_stats);
+    (*ns)["threads"] = Value::makeNativeFunction("scheduler::threads", scheduler_threads);
+    
+    return Value::makeModule(ns);
+}
+
+// scheduler.stats()
+Value scheduler_stats(NativeArgs args) {
+    args = without_self(args);
+    if (!args.empty()) {
+        throw std::runtime_error("scheduler.stats expects no arguments");
+    }
+    
+    SchedulerStats stats = ThreadPool::shared().stats();
+    auto fields = std::make_shared<std::unordered_map<std::string, Value>>();
+    (*fields)["threads"] = Value(static_cast<int64_t>(stats.threads));
+    (*fields)["queued"] = Value(static_cast<int64_t>(stats.queued));
+    (*fields)["submitted"] = Value(static_cast<int64_t>(stats.submitted));
+    (*fields)["completed"] = Value(static_cast<int64_t>(stats.completed));
+    (*fields)["steals"] = Value(static_cast<int64_t>(stats.steals));
+    return Value::makeStruct(fields);
+}
+
+// scheduler.threads()
+Value scheduler_threads(NativeArgs args) {
+    args = without_self(args);
+    if (!args.empty()) {
+        throw std::runtime_error("scheduler.threads expects no arguments");
+    }
+    return Value(static_cast<int64_t>(ThreadPool::shared().size()));
+}
+
+} // namespace scheduler
+} // namespace builtin
+} // namespace rumina
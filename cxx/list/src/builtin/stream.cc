@@ -116,7 +116,7 @@ static Value build_write_stream(int64_t id) {
 }
 
 // stream.openRead(path)
-Value stream_open_read(const std::vector<Value>& args) {
+Value stream_open_read(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("stream.openRead expects 1 argument (path)");
     }
@@ -139,7 +139,7 @@ Value stream_open_read(const std::vector<Value>& args) {
 }
 
 // stream.openWrite(path, append)
-Value stream_open_write(const std::vector<Value>& args) {
+Value stream_open_write(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("stream.openWrite expects 2 arguments (path, append)");
     }
@@ -182,7 +182,7 @@ static std::vector<uint8_t> delimiter_bytes(const Value& value) {
 }
 
 // readStream.readBytes(size)
-Value read_stream_read_bytes(const std::vector<Value>& args) {
+Value read_stream_read_bytes(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("readStream.readBytes expects 1 argument (size)");
     }
@@ -216,7 +216,7 @@ Value read_stream_read_bytes(const std::vector<Value>& args) {
 }
 
 // readStream.readUntil(delimiter, maxBytes?)
-Value read_stream_read_until(const std::vector<Value>& args) {
+Value read_stream_read_until(NativeArgs args) {
     if (args.size() < 2 || args.size() > 3) {
         throw std::runtime_error("readStream.readUntil expects 1 or 2 arguments (delimiter, maxBytes?)");
     }
@@ -287,7 +287,7 @@ Value read_stream_read_until(const std::vector<Value>& args) {
 }
 
 // readStream.readAll()
-Value read_stream_read_all(const std::vector<Value>& args) {
+Value read_stream_read_all(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("readStream.readAll expects no arguments");
     }
@@ -314,7 +314,7 @@ Value read_stream_read_all(const std::vector<Value>& args) {
 }
 
 // readStream.seek(offset)
-Value read_stream_seek(const std::vector<Value>& args) {
+Value read_stream_seek(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("readStream.seek expects 1 argument (offset)");
     }
@@ -345,7 +345,7 @@ Value read_stream_seek(const std::vector<Value>& args) {
 }
 
 // readStream.tell()
-Value read_stream_tell(const std::vector<Value>& args) {
+Value read_stream_tell(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("readStream.tell expects no arguments");
     }
@@ -367,7 +367,7 @@ Value read_stream_tell(const std::vector<Value>& args) {
 }
 
 // readStream.isClosed()
-Value read_stream_is_closed(const std::vector<Value>& args) {
+Value read_stream_is_closed(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("readStream.isClosed expects no arguments");
     }
@@ -379,7 +379,7 @@ Value read_stream_is_closed(const std::vector<Value>& args) {
 }
 
 // readStream.close()
-Value read_stream_close(const std::vector<Value>& args) {
+Value read_stream_close(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("readStream.close expects no arguments");
     }
@@ -393,7 +393,7 @@ Value read_stream_close(const std::vector<Value>& args) {
 }
 
 // writeStream.writeBytes(data)
-Value write_stream_write_bytes(const std::vector<Value>& args) {
+Value write_stream_write_bytes(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("writeStream.writeBytes expects 1 argument (data)");
     }
@@ -420,7 +420,7 @@ Value write_stream_write_bytes(const std::vector<Value>& args) {
 }
 
 // writeStream.writeText(text)
-Value write_stream_write_text(const std::vector<Value>& args) {
+Value write_stream_write_text(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("writeStream.writeText expects 1 argument (text)");
     }
@@ -447,7 +447,7 @@ Value write_stream_write_text(const std::vector<Value>& args) {
 }
 
 // writeStream.flush()
-Value write_stream_flush(const std::vector<Value>& args) {
+Value write_stream_flush(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("writeStream.flush expects no arguments");
     }
@@ -473,7 +473,7 @@ Value write_stream_flush(const std::vector<Value>& args) {
 }
 
 // writeStream.seek(offset)
-Value write_stream_seek(const std::vector<Value>& args) {
+Value write_stream_seek(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("writeStream.seek expects 1 argument (offset)");
     }
@@ -504,7 +504,7 @@ Value write_stream_seek(const std::vector<Value>& args) {
 }
 
 // writeStream.tell()
-Value write_stream_tell(const std::vector<Value>& args) {
+Value write_stream_tell(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("writeStream.tell expects no arguments");
     }
@@ -526,7 +526,7 @@ Value write_stream_tell(const std::vector<Value>& args) {
 }
 
 // writeStream.isClosed()
-Value write_stream_is_closed(const std::vector<Value>& args) {
+Value write_stream_is_closed(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("writeStream.isClosed expects no arguments");
     }
@@ -538,7 +538,7 @@ Value write_stream_is_closed(const std::vector<Value>& args) {
 }
 
 // writeStream.close()
-Value write_stream_close(const std::vector<Value>& args) {
+Value write_stream_close(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("writeStream.close expects no arguments");
     }
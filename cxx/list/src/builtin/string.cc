@@ -5,15 +5,25 @@ namespace rumina {
 namespace builtin {
 namespace string {
 
-Value concat(const std::vector<Value>& args) {
+Value concat(NativeArgs args) {
+    // 字符串实参直接读字节，先算出总长度一次分配
+    size_t total = 0;
+    for (const auto& arg : args) {
+        if (arg.getType() == Value::Type::String) total += arg.getStringView().size();
+    }
     std::string result;
+    result.reserve(total);
     for (const auto& arg : args) {
-        result += arg.toString();
+        if (arg.getType() == Value::Type::String) {
+            result.append(arg.getStringView());
+        } else {
+            result += arg.toString();
+        }
     }
-    return Value(result);
+    return Value(std::move(result));
 }
 
-Value length(const std::vector<Value>& args) {
+Value length(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("string::length expects 1 argument");
     }
@@ -22,10 +32,10 @@ Value length(const std::vector<Value>& args) {
         throw std::runtime_error("string::length expects string, got " + args[0].typeName());
     }
     
-    return Value(static_cast<int64_t>(args[0].getString().length()));
+    return Value(static_cast<int64_t>(args[0].getStringView().length()));
 }
 
-Value char_at(const std::vector<Value>& args) {
+Value char_at(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("string::char_at expects 2 arguments (string, index)");
     }
@@ -34,7 +44,7 @@ Value char_at(const std::vector<Value>& args) {
         throw std::runtime_error("string::char_at expects (string, int)");
     }
     
-    const std::string& s = args[0].getString();
+    std::string_view s = args[0].getStringView();
     int64_t idx = args[1].getInt();
     
     if (idx < 0) idx = s.length() + idx;
@@ -46,7 +56,7 @@ Value char_at(const std::vector<Value>& args) {
     return Value(static_cast<int64_t>(static_cast<unsigned char>(s[idx])));
 }
 
-Value at(const std::vector<Value>& args) {
+Value at(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("string::at expects 2 arguments (string, index)");
     }
@@ -55,7 +65,7 @@ Value at(const std::vector<Value>& args) {
         throw std::runtime_error("string::at expects (string, int)");
     }
     
-    const std::string& s = args[0].getString();
+    std::string_view s = args[0].getStringView();
     int64_t idx = args[1].getInt();
     
     if (idx < 0) idx = s.length() + idx;
@@ -64,10 +74,10 @@ Value at(const std::vector<Value>& args) {
         throw std::runtime_error("String index out of bounds: " + std::to_string(idx));
     }
     
-    return Value(std::string(1, s[idx]));
+    return Value::makeChar(static_cast<unsigned char>(s[idx]));
 }
 
-Value find(const std::vector<Value>& args) {
+Value find(NativeArgs args) {
     if (args.size() != 3) {
         throw std::runtime_error("string::find expects 3 arguments (string, start, substring)");
     }
@@ -94,7 +104,7 @@ Value find(const std::vector<Value>& args) {
     return Value(static_cast<int64_t>(pos));
 }
 
-Value sub(const std::vector<Value>& args) {
+Value sub(NativeArgs args) {
     if (args.size() != 3) {
         throw std::runtime_error("string::sub expects 3 arguments (string, start, length)");
     }
@@ -105,7 +115,7 @@ Value sub(const std::vector<Value>& args) {
         throw std::runtime_error("string::sub expects (string, int, int)");
     }
     
-    const std::string& s = args[0].getString();
+    std::string_view s = args[0].getStringView();
     int64_t start = args[1].getInt();
     int64_t len = args[2].getInt();
     
@@ -117,18 +127,18 @@ Value sub(const std::vector<Value>& args) {
     
     size_t start_pos = static_cast<size_t>(start);
     size_t end_pos = start_pos + static_cast<size_t>(len);
-    if (end_pos > s.length()) {
+    if (len < 0 || end_pos > s.length()) {
         end_pos = s.length();
     }
     
-    return Value(s.substr(start_pos, end_pos - start_pos));
+    return Value::makeSlice(args[0], start_pos, end_pos - start_pos);
 }
 
-Value cat(const std::vector<Value>& args) {
+Value cat(NativeArgs args) {
     return concat(args);
 }
 
-Value replace_by_index(const std::vector<Value>& args) {
+Value replace_by_index(NativeArgs args) {
     if (args.size() != 3) {
         throw std::runtime_error("string::replace_by_index expects 3 arguments (string, start, replacement)");
     }
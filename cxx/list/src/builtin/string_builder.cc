@@ -0,0 +1,115 @@
+#include <builtin/string_builder.h>
+
+namespace rumina {
+namespace builtin {
+namespace string_builder {
+
+// 内容保存在这个隐藏字段里；字符串值本身是构建缓冲的切片，
+// 追加时由 Value::appendString 在缓冲末尾原地写入
+constexpr const char* BUILDER_TEXT_KEY = "__text";
+
+// VM 按方法调用时把模块本身作为第一个实参传入
+static NativeArgs without_self(NativeArgs args) {
+    if (!args.empty() && args[0].getType() == Value::Type::Module) return args.subspan(1);
+    return args;
+}
+
+static Value& builder_text(const Value& self, const char* method) {
+    if (self.getType() != Value::Type::Struct) {
+        throw std::runtime_error(std::string("StringBuilder.") + method + " expects a StringBuilder");
+    }
+    auto fields = self.getStruct();
+    auto it = fields->find(BUILDER_TEXT_KEY);
+    if (it == fields->end() || it->second.getType() != Value::Type::String) {
+        throw std::runtime_error(std::string("StringBuilder.") + method + " expects a StringBuilder");
+    }
+    return it->second;
+}
+
+static void append_args(Value& text, NativeArgs args) {
+    for (const Value& arg : args) {
+        if (arg.getType() == Value::Type::String) {
+            text = Value::appendString(text, arg.getStringView());
+        } else {
+            text = Value::appendString(text, arg.toString());
+        }
+    }
+}
+
+Value create_string_builder_module() {
+    auto ns = std::make_shared<std::unordered_map<std::string, Value>>();
+    
+    (*ns)["new"] = Value::makeNativeFunction("StringBuilder::new", builder_new);
+    
+    return Value::makeModule(ns);
+}
+
+// StringBuilder.new([initial])
+Value builder_new(NativeArgs args) {
+    args = without_self(args);
+    if (args.size() > 1) {
+        throw std::runtime_error("StringBuilder.new expects at most 1 argument (initial)");
+    }
+    
+    Value text("");
+    append_args(text, args);
+    
+    auto fields = std::make_shared<std::unordered_map<std::string, Value>>();
+    (*fields)[BUILDER_TEXT_KEY] = text;
+    (*fields)["append"] = Value::makeNativeFunction("StringBuilder::append", builder_append);
+    (*fields)["appendLine"] = Value::makeNativeFunction("StringBuilder::appendLine", builder_append_line);
+    (*fields)["length"] = Value::makeNativeFunction("StringBuilder::length", builder_length);
+    (*fields)["toString"] = Value::makeNativeFunction("StringBuilder::toString", builder_to_string);
+    (*fields)["clear"] = Value::makeNativeFunction("StringBuilder::clear", builder_clear);
+    
+    return Value::makeStruct(fields);
+}
+
+// builder.append(x...)
+Value builder_append(NativeArgs args) {
+    if (args.empty()) {
+        throw std::runtime_error("StringBuilder.append expects a StringBuilder");
+    }
+    append_args(builder_text(args[0], "append"), args.subspan(1));
+    return args[0];
+}
+
+// builder.appendLine([x...])
+Value builder_append_line(NativeArgs args) {
+    if (args.empty()) {
+        throw std::runtime_error("StringBuilder.appendLine expects a StringBuilder");
+    }
+    Value& text = builder_text(args[0], "appendLine");
+    append_args(text, args.subspan(1));
+    text = Value::appendString(text, "\n");
+    return args[0];
+}
+
+// builder.length()
+Value builder_length(NativeArgs args) {
+    if (args.size() != 1) {
+        throw std::runtime_error("StringBuilder.length expects no arguments");
+    }
+    return Value(static_cast<int64_t>(builder_text(args[0], "length").getStringView().size()));
+}
+
+// builder.toString()
+Value builder_to_string(NativeArgs args) {
+    if (args.size() != 1) {
+        throw std::runtime_error("StringBuilder.toString expects no arguments");
+    }
+    return builder_text(args[0], "toString");
+}
+
+// builder.clear()
+Value builder_clear(NativeArgs args) {
+    if (args.size() != 1) {
+        throw std::runtime_error("StringBuilder.clear expects no arguments");
+    }
+    builder_text(args[0], "clear") = Value("");
+    return args[0];
+}
+
+} // namespace string_builder
+} // namespace builtin
+} // namespace rumina
@@ -63,7 +63,7 @@ static std::chrono::duration<double> elapsed(int64_t id) {
 }
 
 // time.now()
-Value time_now(const std::vector<Value>& args) {
+Value time_now(NativeArgs args) {
     if (!args.empty()) {
         throw std::runtime_error("time.now expects no arguments");
     }
@@ -76,7 +76,7 @@ Value time_now(const std::vector<Value>& args) {
 }
 
 // time.hrtimeMs()
-Value time_hrtime_ms(const std::vector<Value>& args) {
+Value time_hrtime_ms(NativeArgs args) {
     if (!args.empty()) {
         throw std::runtime_error("time.hrtimeMs expects no arguments");
     }
@@ -87,7 +87,7 @@ Value time_hrtime_ms(const std::vector<Value>& args) {
 }
 
 // time.sleep(ms)
-Value time_sleep(const std::vector<Value>& args) {
+Value time_sleep(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("time.sleep expects 1 argument (ms)");
     }
@@ -102,7 +102,7 @@ Value time_sleep(const std::vector<Value>& args) {
 }
 
 // time.startTimer()
-Value time_start_timer(const std::vector<Value>& args) {
+Value time_start_timer(NativeArgs args) {
     if (!args.empty()) {
         throw std::runtime_error("time.startTimer expects no arguments");
     }
@@ -118,7 +118,7 @@ Value time_start_timer(const std::vector<Value>& args) {
 }
 
 // timer.elapsedMs()
-Value timer_elapsed_ms(const std::vector<Value>& args) {
+Value timer_elapsed_ms(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("timer.elapsedMs expects no arguments");
     }
@@ -129,7 +129,7 @@ Value timer_elapsed_ms(const std::vector<Value>& args) {
 }
 
 // timer.elapsedSec()
-Value timer_elapsed_sec(const std::vector<Value>& args) {
+Value timer_elapsed_sec(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("timer.elapsedSec expects no arguments");
     }
@@ -39,7 +39,7 @@ static std::optional<std::string> float_to_rational(double f) {
     return std::nullopt;
 }
 
-Value print(const std::vector<Value>& args) {
+Value print(NativeArgs args) {
     for (size_t i = 0; i < args.size(); ++i) {
         if (i > 0) std::cout << " ";
         
@@ -59,7 +59,7 @@ Value print(const std::vector<Value>& args) {
     return Value();
 }
 
-Value input(const std::vector<Value>& args) {
+Value input(NativeArgs args) {
     if (!args.empty()) {
         std::cout << args[0].toString();
         std::cout.flush();
@@ -96,14 +96,14 @@ Value input(const std::vector<Value>& args) {
     return Value(input);
 }
 
-Value typeof_fn(const std::vector<Value>& args) {
+Value typeof_fn(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("typeof expects 1 argument");
     }
     return Value(args[0].typeName());
 }
 
-Value size(const std::vector<Value>& args) {
+Value size(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("size expects 1 argument");
     }
@@ -122,18 +122,18 @@ Value size(const std::vector<Value>& args) {
     }
 }
 
-Value tostring(const std::vector<Value>& args) {
+Value tostring(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("tostring expects 1 argument");
     }
     return Value(args[0].toString());
 }
 
-Value to_string(const std::vector<Value>& args) {
+Value to_string(NativeArgs args) {
     return tostring(args);
 }
 
-Value exit(const std::vector<Value>& args) {
+Value exit(NativeArgs args) {
     int64_t code = 0;
     if (!args.empty()) {
         code = args[0].toInt();
@@ -141,7 +141,7 @@ Value exit(const std::vector<Value>& args) {
     std::exit(static_cast<int>(code));
 }
 
-Value new_fn(const std::vector<Value>& args) {
+Value new_fn(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("new expects 1 argument (struct)");
     }
@@ -153,14 +153,14 @@ Value new_fn(const std::vector<Value>& args) {
     }
     
     auto original = val.getStruct();
-    auto new_struct = std::make_shared<std::unordered_map<std::string, Value>>(*original);
+    auto new_struct = makeRef<StructObject>(*original);
     
     (*new_struct)["__parent__"] = val;
     
     return Value::makeStruct(new_struct);
 }
 
-Value same(const std::vector<Value>& args) {
+Value same(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("same expects 2 arguments");
     }
@@ -177,7 +177,7 @@ Value same(const std::vector<Value>& args) {
     return Value(result);
 }
 
-Value setattr(const std::vector<Value>& args) {
+Value setattr(NativeArgs args) {
     if (args.size() != 3) {
         throw std::runtime_error("setattr expects 3 arguments (object, key, value)");
     }
@@ -193,12 +193,15 @@ Value setattr(const std::vector<Value>& args) {
     if (key.getType() != Value::Type::String) {
         throw std::runtime_error("setattr expects string key");
     }
+    if (obj.isFrozen()) {
+        throw std::runtime_error("cannot mutate shared struct inside parallel callback");
+    }
     
     (*obj.getStruct())[key.getString()] = value;
     return Value();
 }
 
-Value update(const std::vector<Value>& args) {
+Value update(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("update expects 2 arguments (target, source)");
     }
@@ -210,6 +213,9 @@ Value update(const std::vector<Value>& args) {
         source.getType() != Value::Type::Struct) {
         throw std::runtime_error("update expects two structs");
     }
+    if (target.isFrozen()) {
+        throw std::runtime_error("cannot mutate shared struct inside parallel callback");
+    }
     
     auto target_map = target.getStruct();
     auto source_map = source.getStruct();
@@ -221,7 +227,7 @@ Value update(const std::vector<Value>& args) {
     return Value();
 }
 
-Value fraction(const std::vector<Value>& args) {
+Value fraction(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("fraction expects 1 argument");
     }
@@ -270,7 +276,7 @@ Value fraction(const std::vector<Value>& args) {
     throw std::runtime_error("Cannot convert " + val.typeName() + " to fraction");
 }
 
-Value decimal(const std::vector<Value>& args) {
+Value decimal(NativeArgs args) {
     if (args.empty() || args.size() > 2) {
         throw std::runtime_error("decimal expects 1 or 2 arguments");
     }
@@ -323,7 +329,7 @@ Value decimal(const std::vector<Value>& args) {
     throw std::runtime_error("Cannot convert " + val.typeName() + " to decimal");
 }
 
-Value assert_fn(const std::vector<Value>& args) {
+Value assert_fn(NativeArgs args) {
     if (args.empty()) {
         throw std::runtime_error("assert expects at least 1 argument");
     }
@@ -352,7 +358,7 @@ Value assert_fn(const std::vector<Value>& args) {
     return Value();
 }
 
-Value to_int(const std::vector<Value>& args) {
+Value to_int(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("int expects 1 argument");
     }
@@ -392,7 +398,7 @@ Value to_int(const std::vector<Value>& args) {
     }
 }
 
-Value to_float(const std::vector<Value>& args) {
+Value to_float(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("float expects 1 argument");
     }
@@ -430,7 +436,7 @@ Value to_float(const std::vector<Value>& args) {
     }
 }
 
-Value to_bool(const std::vector<Value>& args) {
+Value to_bool(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("bool expects 1 argument");
     }
@@ -438,7 +444,7 @@ Value to_bool(const std::vector<Value>& args) {
     return Value(args[0].isTruthy());
 }
 
-Value to_string_fn(const std::vector<Value>& args) {
+Value to_string_fn(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("string expects 1 argument");
     }
@@ -446,7 +452,7 @@ Value to_string_fn(const std::vector<Value>& args) {
     return Value(args[0].toString());
 }
 
-Value to_rational(const std::vector<Value>& args) {
+Value to_rational(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("rational expects 1 argument");
     }
@@ -538,7 +544,7 @@ Value to_rational(const std::vector<Value>& args) {
 
 /*
 
-Value to_rational(const std::vector<Value>& args) {
+Value to_rational(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("rational expects 1 argument");
     }
@@ -566,7 +572,7 @@ Value to_rational(const std::vector<Value>& args) {
 }
 */
 
-Value to_complex(const std::vector<Value>& args) {
+Value to_complex(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("complex expects 1 argument");
     }
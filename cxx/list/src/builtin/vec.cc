@@ -0,0 +1,191 @@
+#include <builtin/vec.h>
+#include <simd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+
+namespace rumina {
+namespace builtin {
+namespace vec {
+
+namespace {
+
+using Kernel = void (*)(const double*, const double*, double*, size_t);
+
+const ArrayObject& expect_array(const Value& value, const char* name) {
+    if (value.getType() != Value::Type::Array) {
+        throw std::runtime_error(std::string(name) + " expects array, got " + value.typeName());
+    }
+    return *value.get<ArrayObject>();
+}
+
+void expect_args(NativeArgs args, size_t count, const char* name, const char* usage) {
+    if (args.size() != count) {
+        throw std::runtime_error(std::string(name) + " expects " + std::to_string(count) +
+                                 (count == 1 ? " argument (" : " arguments (") + usage + ")");
+    }
+}
+
+void expect_same_length(const ArrayObject& a, const ArrayObject& b, const char* name) {
+    if (a.size() != b.size()) {
+        throw std::runtime_error(std::string(name) + " expects arrays of the same length");
+    }
+}
+
+// 按 double 读取数组：Float 紧凑数组直接返回自己的缓冲区，其余转换到 scratch
+const double* as_doubles(const ArrayObject& array, std::vector<double>& scratch) {
+    switch (array.kind()) {
+        case ArrayObject::Kind::Float64:
+            return array.floats().data();
+        case ArrayObject::Kind::Int64:
+            scratch.assign(array.ints().begin(), array.ints().end());
+            return scratch.data();
+        default:
+            scratch.clear();
+            scratch.reserve(array.size());
+            for (const Value& element : array.values()) scratch.push_back(element.toFloat());
+            return scratch.data();
+    }
+}
+
+Value float_array(std::vector<double> values) {
+    return Value::makeArray(ArrayObject::fromFloats(std::move(values)));
+}
+
+Value elementwise(NativeArgs args, const char* name, Kernel kernel) {
+    expect_args(args, 2, name, "array, array");
+    const ArrayObject& a = expect_array(args[0], name);
+    const ArrayObject& b = expect_array(args[1], name);
+    expect_same_length(a, b, name);
+
+    std::vector<double> scratch_a;
+    std::vector<double> scratch_b;
+    const double* pa = as_doubles(a, scratch_a);
+    const double* pb = as_doubles(b, scratch_b);
+    // 左边已经转换过时直接在转换结果上原地计算
+    if (!scratch_a.empty() && pa == scratch_a.data()) {
+        kernel(pa, pb, scratch_a.data(), a.size());
+        return float_array(std::move(scratch_a));
+    }
+    std::vector<double> out(a.size());
+    kernel(pa, pb, out.data(), out.size());
+    return float_array(std::move(out));
+}
+
+const ArrayObject& expect_non_empty(NativeArgs args, const char* name) {
+    expect_args(args, 1, name, "array");
+    const ArrayObject& array = expect_array(args[0], name);
+    if (array.empty()) {
+        throw std::runtime_error(std::string(name) + " expects a non-empty array");
+    }
+    return array;
+}
+
+} // namespace
+
+Value dot(NativeArgs args) {
+    expect_args(args, 2, "vec::dot", "array, array");
+    const ArrayObject& a = expect_array(args[0], "vec::dot");
+    const ArrayObject& b = expect_array(args[1], "vec::dot");
+    expect_same_length(a, b, "vec::dot");
+
+    std::vector<double> scratch_a;
+    std::vector<double> scratch_b;
+    const double* pa = as_doubles(a, scratch_a);
+    const double* pb = &a == &b ? pa : as_doubles(b, scratch_b);
+    return Value(simd::dot(pa, pb, a.size()));
+}
+
+Value norm(NativeArgs args) {
+    expect_args(args, 1, "vec::norm", "array");
+    const ArrayObject& a = expect_array(args[0], "vec::norm");
+    std::vector<double> scratch;
+    return Value(std::sqrt(simd::sumSquares(as_doubles(a, scratch), a.size())));
+}
+
+Value add(NativeArgs args) { return elementwise(args, "vec::add", simd::add); }
+Value sub(NativeArgs args) { return elementwise(args, "vec::sub", simd::sub); }
+Value mul(NativeArgs args) { return elementwise(args, "vec::mul", simd::mul); }
+Value div(NativeArgs args) { return elementwise(args, "vec::div", simd::div); }
+
+Value scale(NativeArgs args) {
+    expect_args(args, 2, "vec::scale", "array, number");
+    const ArrayObject& a = expect_array(args[0], "vec::scale");
+    double k = args[1].toFloat();
+
+    std::vector<double> scratch;
+    const double* pa = as_doubles(a, scratch);
+    if (!scratch.empty() && pa == scratch.data()) {
+        simd::scale(pa, k, scratch.data(), a.size());
+        return float_array(std::move(scratch));
+    }
+    std::vector<double> out(a.size());
+    simd::scale(pa, k, out.data(), out.size());
+    return float_array(std::move(out));
+}
+
+Value sum(NativeArgs args) {
+    expect_args(args, 1, "vec::sum", "array");
+    const ArrayObject& a = expect_array(args[0], "vec::sum");
+    if (a.kind() == ArrayObject::Kind::Int64) {
+        // 与脚本里的整数加法一样按 64 位回绕
+        uint64_t total = 0;
+        for (int64_t n : a.ints()) total += static_cast<uint64_t>(n);
+        return Value(static_cast<int64_t>(total));
+    }
+    std::vector<double> scratch;
+    return Value(simd::sum(as_doubles(a, scratch), a.size()));
+}
+
+Value min(NativeArgs args) {
+    const ArrayObject& a = expect_non_empty(args, "vec::min");
+    if (a.kind() == ArrayObject::Kind::Int64) {
+        return Value(*std::min_element(a.ints().begin(), a.ints().end()));
+    }
+    std::vector<double> scratch;
+    return Value(simd::min(as_doubles(a, scratch), a.size()));
+}
+
+Value max(NativeArgs args) {
+    const ArrayObject& a = expect_non_empty(args, "vec::max");
+    if (a.kind() == ArrayObject::Kind::Int64) {
+        return Value(*std::max_element(a.ints().begin(), a.ints().end()));
+    }
+    std::vector<double> scratch;
+    return Value(simd::max(as_doubles(a, scratch), a.size()));
+}
+
+Value cumsum(NativeArgs args) {
+    expect_args(args, 1, "vec::cumsum", "array");
+    const ArrayObject& a = expect_array(args[0], "vec::cumsum");
+    if (a.kind() == ArrayObject::Kind::Int64) {
+        std::vector<int64_t> out(a.size());
+        uint64_t running = 0;
+        for (size_t i = 0; i < out.size(); ++i) {
+            running += static_cast<uint64_t>(a.ints()[i]);
+            out[i] = static_cast<int64_t>(running);
+        }
+        return Value::makeArray(ArrayObject::fromInts(std::move(out)));
+    }
+
+    std::vector<double> scratch;
+    const double* pa = as_doubles(a, scratch);
+    if (!scratch.empty() && pa == scratch.data()) {
+        simd::prefixSum(pa, scratch.data(), a.size());
+        return float_array(std::move(scratch));
+    }
+    std::vector<double> out(a.size());
+    simd::prefixSum(pa, out.data(), out.size());
+    return float_array(std::move(out));
+}
+
+Value backend(NativeArgs args) {
+    expect_args(args, 0, "vec::backend", "");
+    return Value(simd::levelName(simd::level()));
+}
+
+} // namespace vec
+} // namespace builtin
+} // namespace rumina
@@ -2,12 +2,13 @@
 #include <value_ops.h>
 
 #include <algorithm>
+#include <map>
 
 namespace rumina {
 
 struct Change {
     size_t index;
-    OpCode new_op;
+    Instruction new_op;
     size_t remove_count;
 };
 
@@ -28,13 +29,98 @@ bool BytecodeOptimizer::optimize(ByteCode& bytecode) {
         }
     }
 
+    // 融合要在其它模式匹配之后进行，否则会挡住它们
+    if (superinstructions_) {
+        fuseSuperinstructions(bytecode);
+    }
+
     return modified_;
 }
 
-void BytecodeOptimizer::eliminateDeadPushPop(ByteCode& bytecode) {
+std::unordered_set<size_t> BytecodeOptimizer::collectJumpTargets(const ByteCode& bytecode) {
+    std::unordered_set<size_t> targets;
+    
+    for (const auto& op : bytecode.getInstructions()) {
+        if (op.type == OpCodeType::Jump ||
+            op.type == OpCodeType::JumpIfFalse ||
+            op.type == OpCodeType::JumpIfTrue) {
+            targets.insert(op.operand);
+        }
+    }
+    for (const auto& info : bytecode.getFunctions()) {
+        targets.insert(info.body_start);
+        targets.insert(info.body_end);
+    }
+    for (const auto& info : bytecode.getLambdas()) {
+        targets.insert(info.body_start);
+        targets.insert(info.body_end);
+    }
+    
+    return targets;
+}
+
+void BytecodeOptimizer::removeInstructions(ByteCode& bytecode, std::vector<size_t> removals) {
+    if (removals.empty()) return;
+    
     auto& instructions = bytecode.getInstructions();
     auto& line_numbers = bytecode.getLineNumbers();
     
+    std::sort(removals.begin(), removals.end());
+    removals.erase(std::unique(removals.begin(), removals.end()), removals.end());
+    
+    // new_index[i]：旧地址 i 之前保留下来的指令数。
+    // 指向被删除指令的跳转落到其后第一条保留的指令上
+    const size_t count = instructions.size();
+    std::vector<size_t> new_index(count + 1);
+    size_t removed = 0;
+    size_t next = 0;
+    for (size_t i = 0; i <= count; ++i) {
+        new_index[i] = i - removed;
+        if (next < removals.size() && removals[next] == i) {
+            removed++;
+            next++;
+        }
+    }
+    
+    auto remap = [&](size_t target) {
+        return target <= count ? new_index[target] : target - removed;
+    };
+    
+    for (auto& op : instructions) {
+        if (op.type == OpCodeType::Jump ||
+            op.type == OpCodeType::JumpIfFalse ||
+            op.type == OpCodeType::JumpIfTrue) {
+            op.operand = static_cast<uint32_t>(remap(op.operand));
+        }
+    }
+    for (auto& info : bytecode.getFunctions()) {
+        info.body_start = remap(info.body_start);
+        info.body_end = remap(info.body_end);
+    }
+    for (auto& info : bytecode.getLambdas()) {
+        info.body_start = remap(info.body_start);
+        info.body_end = remap(info.body_end);
+    }
+    
+    size_t write = 0;
+    next = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (next < removals.size() && removals[next] == i) {
+            next++;
+            continue;
+        }
+        instructions[write] = instructions[i];
+        line_numbers[write] = line_numbers[i];
+        write++;
+    }
+    instructions.resize(write);
+    line_numbers.resize(write);
+}
+
+void BytecodeOptimizer::eliminateDeadPushPop(ByteCode& bytecode) {
+    auto& instructions = bytecode.getInstructions();
+    auto targets = collectJumpTargets(bytecode);
+    
     std::vector<size_t> removals;
     
     for (size_t i = 0; i + 1 < instructions.size(); ++i) {
@@ -45,7 +131,8 @@ void BytecodeOptimizer::eliminateDeadPushPop(ByteCode& bytecode) {
                         current.type == OpCodeType::PushConstPooled);
         bool is_pop = (next.type == OpCodeType::Pop);
         
-        if (is_push && is_pop) {
+        // 跳到 Pop 上的路径需要它弹出别的值
+        if (is_push && is_pop && !targets.count(i + 1)) {
             removals.push_back(i);
             removals.push_back(i + 1);
             modified_ = true;
@@ -53,16 +140,12 @@ void BytecodeOptimizer::eliminateDeadPushPop(ByteCode& bytecode) {
         }
     }
     
-    std::sort(removals.begin(), removals.end(), std::greater<size_t>());
-    for (size_t idx : removals) {
-        instructions.erase(instructions.begin() + idx);
-        line_numbers.erase(line_numbers.begin() + idx);
-    }
+    removeInstructions(bytecode, std::move(removals));
 }
 
 void BytecodeOptimizer::eliminateRedundantDup(ByteCode& bytecode) {
     auto& instructions = bytecode.getInstructions();
-    auto& line_numbers = bytecode.getLineNumbers();
+    auto targets = collectJumpTargets(bytecode);
     
     std::vector<size_t> removals;
     
@@ -71,37 +154,26 @@ void BytecodeOptimizer::eliminateRedundantDup(ByteCode& bytecode) {
         const auto& second = instructions[i + 1];
         const auto& third = instructions[i + 2];
         
+        // 名字在名字表中去重，下标相同即同一个变量
         if (first.type == OpCodeType::PushVar && 
             second.type == OpCodeType::Dup && 
-            third.type == OpCodeType::PopVar) {
+            third.type == OpCodeType::PopVar &&
+            first.operand == third.operand &&
+            !targets.count(i + 1) && !targets.count(i + 2)) {
             
-            if (first.payload_type == OpCode::PAYLOAD_STRING &&
-                third.payload_type == OpCode::PAYLOAD_STRING) {
-                
-                const std::string& name1 = first.payload.str;
-                const std::string& name2 = third.payload.str;
-                
-                if (name1 == name2) {
-                    removals.push_back(i + 1);
-                    removals.push_back(i + 2);
-                    modified_ = true;
-                    i += 2;
-                }
-            }
+            removals.push_back(i + 1);
+            removals.push_back(i + 2);
+            modified_ = true;
+            i += 2;
         }
     }
     
-    std::sort(removals.begin(), removals.end(), std::greater<size_t>());
-    for (size_t idx : removals) {
-        instructions.erase(instructions.begin() + idx);
-        line_numbers.erase(line_numbers.begin() + idx);
-    }
+    removeInstructions(bytecode, std::move(removals));
 }
 
 void BytecodeOptimizer::mergeConstantOperations(ByteCode& bytecode) {
     auto& instructions = bytecode.getInstructions();
-    auto& line_numbers = bytecode.getLineNumbers();
-    auto& constants = bytecode.getConstants();
+    auto targets = collectJumpTargets(bytecode);
     
     std::vector<Change> changes;
     
@@ -112,11 +184,11 @@ void BytecodeOptimizer::mergeConstantOperations(ByteCode& bytecode) {
         
         if (first.type == OpCodeType::PushConstPooled &&
             second.type == OpCodeType::PushConstPooled &&
-            first.payload_type == OpCode::PAYLOAD_SIZE &&
-            second.payload_type == OpCode::PAYLOAD_SIZE) {
+            !targets.count(i + 1) && !targets.count(i + 2)) {
+            const auto& constants = bytecode.getConstants();
             
-            size_t idx1 = first.payload.size;
-            size_t idx2 = second.payload.size;
+            size_t idx1 = first.operand;
+            size_t idx2 = second.operand;
             
             if (idx1 < constants.size() && idx2 < constants.size()) {
                 const Value& val1 = constants[idx1];
@@ -142,7 +214,8 @@ void BytecodeOptimizer::mergeConstantOperations(ByteCode& bytecode) {
                     }
                     
                     if (can_merge) {
-                        changes.push_back({i, OpCode(OpCodeType::PushConst, Value(static_cast<int64_t>(result))), 3});
+                        size_t idx = bytecode.addConstant(Value(static_cast<int64_t>(result)));
+                        changes.push_back({i, Instruction{OpCodeType::PushConstPooled, static_cast<uint32_t>(idx)}, 3});
                         modified_ = true;
                         i += 2;
                     }
@@ -151,13 +224,14 @@ void BytecodeOptimizer::mergeConstantOperations(ByteCode& bytecode) {
         }
     }
     
-    for (auto it = changes.rbegin(); it != changes.rend(); ++it) {
-        instructions[it->index] = it->new_op;
-        for (size_t j = 1; j < it->remove_count; ++j) {
-            instructions.erase(instructions.begin() + it->index + 1);
-            line_numbers.erase(line_numbers.begin() + it->index + 1);
+    std::vector<size_t> removals;
+    for (const auto& change : changes) {
+        instructions[change.index] = change.new_op;
+        for (size_t j = 1; j < change.remove_count; ++j) {
+            removals.push_back(change.index + j);
         }
     }
+    removeInstructions(bytecode, std::move(removals));
 }
 
 void BytecodeOptimizer::optimizeJumpChains(ByteCode& bytecode) {
@@ -166,12 +240,11 @@ void BytecodeOptimizer::optimizeJumpChains(ByteCode& bytecode) {
     for (size_t i = 0; i < instructions.size(); ++i) {
         auto& op = instructions[i];
         
-        if ((op.type == OpCodeType::Jump ||
-             op.type == OpCodeType::JumpIfFalse ||
-             op.type == OpCodeType::JumpIfTrue) &&
-            op.payload_type == OpCode::PAYLOAD_SIZE) {
+        if (op.type == OpCodeType::Jump ||
+            op.type == OpCodeType::JumpIfFalse ||
+            op.type == OpCodeType::JumpIfTrue) {
             
-            size_t target = op.payload.size;
+            size_t target = op.operand;
             std::unordered_set<size_t> visited;
             size_t final_target = target;
             
@@ -180,9 +253,8 @@ void BytecodeOptimizer::optimizeJumpChains(ByteCode& bytecode) {
                 visited.insert(final_target);
                 
                 const auto& target_op = instructions[final_target];
-                if (target_op.type == OpCodeType::Jump &&
-                    target_op.payload_type == OpCode::PAYLOAD_SIZE) {
-                    final_target = target_op.payload.size;
+                if (target_op.type == OpCodeType::Jump) {
+                    final_target = target_op.operand;
                     modified_ = true;
                 } else {
                     break;
@@ -190,7 +262,7 @@ void BytecodeOptimizer::optimizeJumpChains(ByteCode& bytecode) {
             }
             
             if (final_target != target) {
-                op.payload.size = final_target;
+                op.operand = static_cast<uint32_t>(final_target);
             }
         }
     }
@@ -198,7 +270,7 @@ void BytecodeOptimizer::optimizeJumpChains(ByteCode& bytecode) {
 
 void BytecodeOptimizer::eliminateNoopPatterns(ByteCode& bytecode) {
     auto& instructions = bytecode.getInstructions();
-    auto& line_numbers = bytecode.getLineNumbers();
+    auto targets = collectJumpTargets(bytecode);
     
     std::vector<size_t> removals;
     
@@ -208,25 +280,137 @@ void BytecodeOptimizer::eliminateNoopPatterns(ByteCode& bytecode) {
         
         if (current.type == OpCodeType::PushVar && 
             next.type == OpCodeType::PopVar &&
-            current.payload_type == OpCode::PAYLOAD_STRING &&
-            next.payload_type == OpCode::PAYLOAD_STRING) {
+            current.operand == next.operand &&
+            !targets.count(i + 1)) {
             
-            const std::string& name1 = current.payload.str;
-            const std::string& name2 = next.payload.str;
+            removals.push_back(i);
+            removals.push_back(i + 1);
+            modified_ = true;
+            i += 1;
+        }
+    }
+    
+    removeInstructions(bytecode, std::move(removals));
+}
+
+void BytecodeOptimizer::fuseSuperinstructions(ByteCode& bytecode) {
+    auto& instructions = bytecode.getInstructions();
+    const auto& constants = bytecode.getConstants();
+    
+    auto is_int_const = [&](const Instruction& op) {
+        return op.type == OpCodeType::PushConstPooled &&
+               op.operand < constants.size() &&
+               constants[op.operand].getType() == Value::Type::Int;
+    };
+    auto is_compare = [](OpCodeType type) {
+        return type == OpCodeType::Eq || type == OpCodeType::Neq ||
+               type == OpCodeType::Lt || type == OpCodeType::Lte ||
+               type == OpCodeType::Gt || type == OpCodeType::Gte;
+    };
+    auto is_arith = [](OpCodeType type) {
+        return type == OpCodeType::Add || type == OpCodeType::Sub ||
+               type == OpCodeType::Mul || type == OpCodeType::Mod;
+    };
+    
+    // 只改写序列首条指令，其余指令保留，因此不需要重新映射跳转
+    const size_t count = instructions.size();
+    size_t i = 0;
+    while (i < count) {
+        Instruction& op = instructions[i];
+        OpCodeType fused = op.type;
+        
+        if (i + 3 < count &&
+            op.type == OpCodeType::LoadLocal &&
+            is_int_const(instructions[i + 1]) &&
+            instructions[i + 2].type == OpCodeType::Add &&
+            instructions[i + 3].type == OpCodeType::StoreLocal &&
+            instructions[i + 3].operand == op.operand) {
+            fused = OpCodeType::IncLocal;
+        } else if (i + 3 < count &&
+                   op.type == OpCodeType::LoadGlobal &&
+                   is_int_const(instructions[i + 1]) &&
+                   instructions[i + 2].type == OpCodeType::Add &&
+                   instructions[i + 3].type == OpCodeType::StoreGlobal &&
+                   instructions[i + 3].operand == op.operand) {
+            fused = OpCodeType::IncGlobal;
+        } else if (i + 2 < count &&
+                   is_int_const(op) &&
+                   is_compare(instructions[i + 1].type) &&
+                   instructions[i + 2].type == OpCodeType::JumpIfFalse) {
+            fused = OpCodeType::CmpConstJumpIfFalse;
+        } else if (i + 2 < count &&
+                   op.type == OpCodeType::LoadLocal &&
+                   is_compare(instructions[i + 1].type) &&
+                   instructions[i + 2].type == OpCodeType::JumpIfFalse) {
+            fused = OpCodeType::CmpLocalJumpIfFalse;
+        } else if (i + 2 < count &&
+                   op.type == OpCodeType::LoadLocal &&
+                   instructions[i + 1].type == OpCodeType::LoadLocal &&
+                   instructions[i + 2].type == OpCodeType::Add) {
+            fused = OpCodeType::AddLocalLocal;
+        } else if (i + 1 < count &&
+                   is_int_const(op) &&
+                   is_arith(instructions[i + 1].type)) {
+            fused = OpCodeType::ArithConst;
+        }
+        
+        if (fused != op.type) {
+            op.type = fused;
+            modified_ = true;
+        }
+        i += fusedLength(op.type);
+    }
+}
+
+std::vector<std::pair<std::string, size_t>> BytecodeOptimizer::countNGrams(const ByteCode& bytecode, size_t n) {
+    const auto& instructions = bytecode.getInstructions();
+    auto targets = collectJumpTargets(bytecode);
+    std::map<std::string, size_t> counts;
+    
+    if (n == 0) return {};
+    
+    for (size_t i = 0; i + n <= instructions.size(); ++i) {
+        std::string key;
+        bool sequential = true;
+        
+        for (size_t j = 0; j < n; ++j) {
+            OpCodeType type = fusedHeadOpCode(instructions[i + j].type);
+            if (j > 0) {
+                if (targets.count(i + j)) {
+                    sequential = false;
+                    break;
+                }
+                key += ' ';
+            }
+            key += opCodeName(type);
             
-            if (name1 == name2) {
-                removals.push_back(i);
-                removals.push_back(i + 1);
-                modified_ = true;
-                i += 1;
+            // 无条件转移之后的指令不会顺序执行
+            if (j + 1 < n &&
+                (type == OpCodeType::Jump || type == OpCodeType::Return ||
+                 type == OpCodeType::Halt || type == OpCodeType::Break ||
+                 type == OpCodeType::Continue)) {
+                sequential = false;
+                break;
             }
         }
+        
+        if (sequential) {
+            counts[key]++;
+        }
     }
     
-    std::sort(removals.begin(), removals.end(), std::greater<size_t>());
-    for (size_t idx : removals) {
-        instructions.erase(instructions.begin() + idx);
-        line_numbers.erase(line_numbers.begin() + idx);
+    std::vector<std::pair<std::string, size_t>> result(counts.begin(), counts.end());
+    std::stable_sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
+        return a.second > b.second;
+    });
+    return result;
+}
+
+void BytecodeOptimizer::dumpNGrams(const ByteCode& bytecode, size_t n, size_t top, std::ostream& out) {
+    auto grams = countNGrams(bytecode, n);
+    out << n << "-grams (" << grams.size() << " distinct):\n";
+    for (size_t i = 0; i < grams.size() && i < top; ++i) {
+        out << "  " << grams[i].second << "\t" << grams[i].first << "\n";
     }
 }
 
@@ -891,7 +891,7 @@ std::string value_to_expr_string(const Value& value) {
 }
 
 // CAS内置函数接口
-Value cas_parse(const std::vector<Value>& args) {
+Value cas_parse(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("parse expects 1 argument");
     }
@@ -918,7 +918,7 @@ Value cas_parse(const std::vector<Value>& args) {
     }
 }
 
-Value cas_differentiate(const std::vector<Value>& args) {
+Value cas_differentiate(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("differentiate expects 2 arguments (expr, var)");
     }
@@ -948,7 +948,7 @@ Value cas_differentiate(const std::vector<Value>& args) {
     }
 }
 
-Value cas_solve_linear(const std::vector<Value>& args) {
+Value cas_solve_linear(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("solve_linear expects 2 arguments (expr, var)");
     }
@@ -1017,7 +1017,7 @@ Value cas_solve_linear(const std::vector<Value>& args) {
     }
 }
 
-Value cas_evaluate_at(const std::vector<Value>& args) {
+Value cas_evaluate_at(NativeArgs args) {
     if (args.size() != 3) {
         throw std::runtime_error("evaluate_at expects 3 arguments (expr, var, value)");
     }
@@ -1050,7 +1050,7 @@ Value cas_evaluate_at(const std::vector<Value>& args) {
     }
 }
 
-Value cas_store(const std::vector<Value>& args) {
+Value cas_store(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("store expects 2 arguments (name, expr)");
     }
@@ -1083,7 +1083,7 @@ Value cas_store(const std::vector<Value>& args) {
     return Value();
 }
 
-Value cas_load(const std::vector<Value>& args) {
+Value cas_load(NativeArgs args) {
     if (args.size() != 1) {
         throw std::runtime_error("load expects 1 argument (name)");
     }
@@ -1102,7 +1102,7 @@ Value cas_load(const std::vector<Value>& args) {
     throw std::runtime_error("Expression '" + name + "' not found in storage");
 }
 
-Value cas_numerical_derivative(const std::vector<Value>& args) {
+Value cas_numerical_derivative(NativeArgs args) {
     if (args.size() != 3) {
         throw std::runtime_error("numerical_derivative expects 3 arguments (expr, var, point)");
     }
@@ -1142,7 +1142,7 @@ Value cas_numerical_derivative(const std::vector<Value>& args) {
     }
 }
 
-Value cas_integrate(const std::vector<Value>& args) {
+Value cas_integrate(NativeArgs args) {
     if (args.size() != 2) {
         throw std::runtime_error("integrate expects 2 arguments (expr, var)");
     }
@@ -1172,7 +1172,7 @@ Value cas_integrate(const std::vector<Value>& args) {
     }
 }
 
-Value cas_definite_integral(const std::vector<Value>& args) {
+Value cas_definite_integral(NativeArgs args) {
     if (args.size() != 4) {
         throw std::runtime_error("definite_integral expects 4 arguments (expr, var, lower, upper)");
     }
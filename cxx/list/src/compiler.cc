@@ -2,6 +2,7 @@
 #include <lexer.h>
 #include <parser.h>
 
+#include <algorithm>
 #include <fstream>
 #include <filesystem>
 
@@ -25,7 +26,7 @@ void SymbolTable::exitScope() {
 
 void SymbolTable::define(const std::string& name) {
     size_t depth = scopes_.size() - 1;
-    scopes_.back()[name] = SymbolInfo{name, depth};
+    scopes_.back()[name] = SymbolInfo{name, depth, resolveLocal(name)};
 }
 
 const SymbolInfo* SymbolTable::resolve(const std::string& name) const {
@@ -38,6 +39,53 @@ const SymbolInfo* SymbolTable::resolve(const std::string& name) const {
     return nullptr;
 }
 
+void SymbolTable::enterFunction() {
+    enterScope();
+    FunctionScope scope;
+    scope.scope_depth = scopes_.size() - 1;
+    functions_.push_back(std::move(scope));
+}
+
+FunctionScope SymbolTable::exitFunction() {
+    FunctionScope scope = std::move(functions_.back());
+    functions_.pop_back();
+    while (scopes_.size() > scope.scope_depth) {
+        exitScope();
+    }
+    return scope;
+}
+
+size_t SymbolTable::declareLocal(const std::string& name, bool immutable) {
+    FunctionScope& scope = functions_.back();
+    auto it = scope.slots.find(name);
+    size_t slot;
+    if (it != scope.slots.end()) {
+        slot = it->second;
+    } else {
+        slot = scope.slot_names.size();
+        scope.slots[name] = slot;
+        scope.slot_names.push_back(name);
+    }
+    if (immutable) {
+        scope.immutable.insert(name);
+    }
+    return slot;
+}
+
+std::optional<size_t> SymbolTable::resolveLocal(const std::string& name) const {
+    if (functions_.empty()) return std::nullopt;
+    
+    const FunctionScope& scope = functions_.back();
+    auto it = scope.slots.find(name);
+    if (it == scope.slots.end()) return std::nullopt;
+    return it->second;
+}
+
+bool SymbolTable::isImmutableLocal(const std::string& name) const {
+    if (functions_.empty()) return false;
+    return functions_.back().immutable.count(name) > 0;
+}
+
 // Compiler implementation
 
 Compiler::Compiler() : current_dir_(std::nullopt) {}
@@ -63,6 +111,82 @@ void Compiler::patchJump(size_t address) {
     bytecode_.patchJump(address, target);
 }
 
+void Compiler::emitLoadVar(const std::string& name) {
+    if (auto slot = symbols_.resolveLocal(name)) {
+        emit(OpCode(OpCodeType::LoadLocal, *slot));
+    } else {
+        emit(OpCode(OpCodeType::LoadGlobal, bytecode_.addName(name)));
+    }
+}
+
+void Compiler::emitStoreVar(const std::string& name) {
+    // let 绑定的赋值走按名字的路径，由 VM 在运行时报告不可变错误
+    auto slot = symbols_.resolveLocal(name);
+    if (slot && !symbols_.isImmutableLocal(name)) {
+        emit(OpCode(OpCodeType::StoreLocal, *slot));
+    } else if (!symbols_.inFunction()) {
+        emit(OpCode(OpCodeType::StoreGlobal, bytecode_.addName(name)));
+    } else {
+        emit(OpCode(OpCodeType::PopVar, name));
+    }
+}
+
+void Compiler::emitDeclare(const std::string& name, bool immutable) {
+    if (auto slot = symbols_.resolveLocal(name)) {
+        emit(OpCode(OpCodeType::StoreLocal, *slot));
+    } else if (!symbols_.inFunction()) {
+        emit(OpCode(OpCodeType::StoreGlobal, bytecode_.addName(name)));
+    } else {
+        emit(OpCode(OpCodeType::PopVar, name));
+    }
+    if (immutable) {
+        emit(OpCode(OpCodeType::MarkImmutable, name));
+    }
+    symbols_.define(name);
+}
+
+// 预扫描函数体，为所有会在函数内写入的名字分配槽位（不进入嵌套函数和 lambda）
+void Compiler::collectLocals(const Stmt* stmt) {
+    if (auto var_decl = dynamic_cast<const VarDeclStmt*>(stmt)) {
+        symbols_.declareLocal(var_decl->name);
+    } else if (auto let_decl = dynamic_cast<const LetDeclStmt*>(stmt)) {
+        symbols_.declareLocal(let_decl->name, true);
+    } else if (auto assign = dynamic_cast<const AssignStmt*>(stmt)) {
+        symbols_.declareLocal(assign->name);
+    } else if (auto block = dynamic_cast<const BlockStmt*>(stmt)) {
+        for (const auto& s : block->statements) collectLocals(s.get());
+    } else if (auto if_stmt = dynamic_cast<const IfStmt*>(stmt)) {
+        for (const auto& s : if_stmt->then_branch) collectLocals(s.get());
+        if (if_stmt->else_branch.has_value()) {
+            for (const auto& s : if_stmt->else_branch.value()) collectLocals(s.get());
+        }
+    } else if (auto while_stmt = dynamic_cast<const WhileStmt*>(stmt)) {
+        for (const auto& s : while_stmt->body) collectLocals(s.get());
+    } else if (auto for_stmt = dynamic_cast<const ForStmt*>(stmt)) {
+        if (for_stmt->init.has_value()) collectLocals(for_stmt->init.value().get());
+        if (for_stmt->update.has_value()) collectLocals(for_stmt->update.value().get());
+        for (const auto& s : for_stmt->body) collectLocals(s.get());
+    } else if (auto loop_stmt = dynamic_cast<const LoopStmt*>(stmt)) {
+        for (const auto& s : loop_stmt->body) collectLocals(s.get());
+    }
+}
+
+void Compiler::beginFunction(const std::vector<std::string>& params) {
+    symbols_.enterFunction();
+    for (const auto& param : params) {
+        symbols_.declareLocal(param);
+        symbols_.define(param);
+    }
+}
+
+void Compiler::endFunction(FuncDefInfo& info) {
+    FunctionScope scope = symbols_.exitFunction();
+    info.locals.reserve(scope.slot_names.size());
+    for (const std::string& name : scope.slot_names) {
+        info.locals.push_back(AtomTable::intern(name));
+    }
+}
+
 Result<ByteCode> Compiler::compile(const std::vector<std::unique_ptr<Stmt>>& statements) {
     try {
         for (const auto& stmt : statements) {
@@ -77,6 +201,10 @@ Result<ByteCode> Compiler::compile(const std::vector<std::unique_ptr<Stmt>>& sta
 }
 
 void Compiler::compileStmt(const Stmt* stmt) {
+    if (stmt->line) {
+        current_line_ = stmt->line;
+    }
+    
     if (auto expr_stmt = dynamic_cast<const ExprStmt*>(stmt)) {
         compileExpr(expr_stmt->expr.get());
     }
@@ -90,8 +218,7 @@ void Compiler::compileStmt(const Stmt* stmt) {
             emit(OpCode(OpCodeType::ConvertType, DeclaredType::BigInt));
         }
         
-        emit(OpCode(OpCodeType::PopVar, var_decl->name));
-        symbols_.define(var_decl->name);
+        emitDeclare(var_decl->name, false);
     }
     
     else if (auto let_decl = dynamic_cast<const LetDeclStmt*>(stmt)) {
@@ -103,14 +230,12 @@ void Compiler::compileStmt(const Stmt* stmt) {
             emit(OpCode(OpCodeType::ConvertType, DeclaredType::BigInt));
         }
         
-        emit(OpCode(OpCodeType::PopVar, let_decl->name));
-        emit(OpCode(OpCodeType::MarkImmutable, let_decl->name));
-        symbols_.define(let_decl->name);
+        emitDeclare(let_decl->name, true);
     }
     
     else if (auto assign = dynamic_cast<const AssignStmt*>(stmt)) {
         compileExpr(assign->value.get());
-        emit(OpCode(OpCodeType::PopVar, assign->name));
+        emitStoreVar(assign->name);
     }
     
     else if (auto member_assign = dynamic_cast<const MemberAssignStmt*>(stmt)) {
@@ -258,7 +383,10 @@ void Compiler::compileStmt(const Stmt* stmt) {
     
     else if (auto return_stmt = dynamic_cast<const ReturnStmt*>(stmt)) {
         if (return_stmt->expr.has_value()) {
-            compileExpr(return_stmt->expr.value().get());
+            // TailCall 复用当前帧；调用原生函数时结果留在栈上，由后面的 Return 返回
+            if (!compileTailCall(return_stmt->expr.value().get())) {
+                compileExpr(return_stmt->expr.value().get());
+            }
         } else {
             size_t idx = bytecode_.addConstant(Value());
             emit(OpCode(OpCodeType::PushConstPooled, idx));
@@ -289,9 +417,9 @@ void Compiler::compileStmt(const Stmt* stmt) {
         
         size_t body_start = currentAddress();
         
-        symbols_.enterScope();
-        for (const auto& param : func_def->params) {
-            symbols_.define(param);
+        beginFunction(func_def->params);
+        for (const auto& s : func_def->body) {
+            collectLocals(s.get());
         }
         
         for (const auto& s : func_def->body) {
@@ -302,13 +430,13 @@ void Compiler::compileStmt(const Stmt* stmt) {
         emit(OpCode(OpCodeType::PushConstPooled, idx));
         emit(OpCode(OpCodeType::Return));
         
-        symbols_.exitScope();
+        FuncDefInfo info;
+        endFunction(info);
         
         size_t body_end = currentAddress();
         
         patchJump(skip_jump);
         
-        FuncDefInfo info;
         info.name = func_def->name;
         info.params = func_def->params;
         info.body_start = body_start;
@@ -333,6 +461,22 @@ void Compiler::compileStmt(const Stmt* stmt) {
     }
 }
 
+bool Compiler::compileTailCall(const Expr* expr) {
+    auto call = dynamic_cast<const CallExpr*>(expr);
+    if (!call || !symbols_.inFunction() ||
+        dynamic_cast<const NamespaceExpr*>(call->func.get()) ||
+        dynamic_cast<const MemberExpr*>(call->func.get())) {
+        return false;
+    }
+    
+    compileExpr(call->func.get());
+    for (const auto& arg : call->args) {
+        compileExpr(arg.get());
+    }
+    emit(OpCode(OpCodeType::TailCall, call->args.size()));
+    return true;
+}
+
 void Compiler::compileInclude(const std::string& path) {
     // Handle built-in modules - 使用明确的字符串构造函数
     if (path == "rumina:fs") {
@@ -377,6 +521,27 @@ void Compiler::compileInclude(const std::string& path) {
         return;
     }
     
+    if (path == "rumina:gc") {
+        emit(OpCode(OpCodeType::PushVar, std::string("rumina:gc")));
+        emit(OpCode(OpCodeType::PopVar, std::string("gc")));
+        symbols_.define("gc");
+        return;
+    }
+    
+    if (path == "rumina:scheduler") {
+        emit(OpCode(OpCodeType::PushVar, std::string("rumina:scheduler")));
+        emit(OpCode(OpCodeType::PopVar, std::string("scheduler")));
+        symbols_.define("scheduler");
+        return;
+    }
+    
+    if (path == "rumina:string_builder") {
+        emit(OpCode(OpCodeType::PushVar, std::string("rumina:string_builder")));
+        emit(OpCode(OpCodeType::PopVar, std::string("StringBuilder")));
+        symbols_.define("StringBuilder");
+        return;
+    }
+    
     if (path == "rumina:buffer") {
         emit(OpCode(OpCodeType::PushVar, std::string("rumina:buffer")));
         emit(OpCode(OpCodeType::PopVar, std::string("Buffer")));
@@ -541,9 +706,9 @@ void Compiler::compileStmtWithNamespace(const Stmt* stmt, const std::string& nam
         
         size_t body_start = currentAddress();
         
-        symbols_.enterScope();
-        for (const auto& param : func_def->params) {
-            symbols_.define(param);
+        beginFunction(func_def->params);
+        for (const auto& s : func_def->body) {
+            collectLocals(s.get());
         }
         
         for (const auto& s : func_def->body) {
@@ -554,13 +719,13 @@ void Compiler::compileStmtWithNamespace(const Stmt* stmt, const std::string& nam
         emit(OpCode(OpCodeType::PushConstPooled, idx));
         emit(OpCode(OpCodeType::Return));
         
-        symbols_.exitScope();
+        FuncDefInfo info;
+        endFunction(info);
         
         size_t body_end = currentAddress();
         
         patchJump(skip_jump);
         
-        FuncDefInfo info;
         info.name = prefixed_name;
         info.params = func_def->params;
         info.body_start = body_start;
@@ -603,7 +768,7 @@ void Compiler::compileExpr(const Expr* expr) {
     }
     
     else if (auto ident = dynamic_cast<const IdentExpr*>(expr)) {
-        emit(OpCode(OpCodeType::PushVar, ident->name));
+        emitLoadVar(ident->name);
     }
     
     else if (auto binary = dynamic_cast<const BinaryExpr*>(expr)) {
@@ -664,10 +829,20 @@ void Compiler::compileExpr(const Expr* expr) {
     
     else if (auto call = dynamic_cast<const CallExpr*>(expr)) {
         if (auto ident = dynamic_cast<const IdentExpr*>(call->func.get())) {
-            for (const auto& arg : call->args) {
-                compileExpr(arg.get());
+            if (symbols_.resolveLocal(ident->name)) {
+                // 局部槽位里的被调用者取出后走通用 Call
+                emitLoadVar(ident->name);
+                for (const auto& arg : call->args) {
+                    compileExpr(arg.get());
+                }
+                emit(OpCode(OpCodeType::Call, call->args.size()));
+            } else {
+                // 全局函数走 CallVar：VM 载入时把调用点解析到全局槽位，调用时直接读槽
+                for (const auto& arg : call->args) {
+                    compileExpr(arg.get());
+                }
+                emit(OpCode(OpCodeType::CallVar, std::make_pair(ident->name, call->args.size())));
             }
-            emit(OpCode(OpCodeType::CallVar, std::make_pair(ident->name, call->args.size())));
         } else if (auto ns = dynamic_cast<const NamespaceExpr*>(call->func.get())) {
             for (const auto& arg : call->args) {
                 compileExpr(arg.get());
@@ -709,37 +884,56 @@ void Compiler::compileExpr(const Expr* expr) {
         
         size_t body_start = currentAddress();
         
-        symbols_.enterScope();
-        for (const auto& param : lambda->params) {
-            symbols_.define(param);
+        // 捕获分析：只捕获 lambda（含嵌套 lambda）中引用到的外层函数槽位
+        std::vector<std::pair<std::string, size_t>> outer;
+        if (symbols_.inFunction()) {
+            std::unordered_set<std::string> names;
+            collectReferencedNames(lambda->body.get(), names);
+            for (const auto& name : names) {
+                if (std::find(lambda->params.begin(), lambda->params.end(), name) != lambda->params.end()) {
+                    continue;
+                }
+                if (auto slot = symbols_.resolveLocal(name)) {
+                    outer.emplace_back(name, *slot);
+                }
+            }
+            std::sort(outer.begin(), outer.end(),
+                      [](const auto& a, const auto& b) { return a.second < b.second; });
+        }
+        
+        beginFunction(lambda->params);
+        std::vector<LambdaCapture> captures;
+        for (const auto& [name, from] : outer) {
+            size_t to = symbols_.declareLocal(name);
+            symbols_.define(name);
+            captures.push_back({static_cast<uint32_t>(from), static_cast<uint32_t>(to)});
         }
+        collectLocals(lambda->body.get());
         
         compileStmt(lambda->body.get());
         
         emit(OpCode(OpCodeType::Return));
         
-        symbols_.exitScope();
+        FuncDefInfo func_info;
+        endFunction(func_info);
         
         size_t body_end = currentAddress();
         
         patchJump(skip_jump);
         
-        FuncDefInfo func_info;
         func_info.name = lambda_id;
         func_info.params = lambda->params;
         func_info.body_start = body_start;
         func_info.body_end = body_end;
         func_info.decorators = {};
         
-        emit(OpCode(OpCodeType::DefineFunc, func_info));
-        
-        size_t id_idx = bytecode_.addConstant(Value(lambda_id));
-        emit(OpCode(OpCodeType::PushConstPooled, id_idx));
-        
+        // lambda 体只登记原型，MakeLambda 按原型下标引用
         LambdaInfo lambda_info;
         lambda_info.params = lambda->params;
         lambda_info.body_start = body_start;
         lambda_info.body_end = body_end;
+        lambda_info.captures = std::move(captures);
+        lambda_info.function = static_cast<uint32_t>(bytecode_.addFunction(std::move(func_info)));
         
         emit(OpCode(OpCodeType::MakeLambda, lambda_info));
     }
@@ -0,0 +1,226 @@
+#include <cycle_collector.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+namespace rumina {
+
+std::atomic<bool> CycleCollector::pending_{false};
+std::atomic<int> CycleCollector::concurrent_{0};
+std::atomic<bool> CycleCollector::deferred_{false};
+
+namespace {
+
+struct CollectorState {
+    std::mutex mutex;
+    detail::ContainerCell* head = nullptr;
+    size_t threshold = CycleCollector::kDefaultThreshold;
+    size_t trigger = CycleCollector::kDefaultThreshold;  // 本轮的触发阈值
+    size_t since_collect = 0;
+    bool collecting = false;
+    GcStats stats;
+};
+
+CollectorState& state() {
+    // 不析构：静态对象析构之后仍可能有全局值释放容器单元
+    static CollectorState* s = new CollectorState();
+    return *s;
+}
+
+void push(detail::CellList& out, const Value& value) {
+    if (detail::ContainerCell* cell = value.containerCell()) out.push_back(cell);
+}
+
+} // namespace
+
+detail::ContainerCell::ContainerCell() {
+    CycleCollector::track(this);
+}
+
+detail::ContainerCell::~ContainerCell() {
+    CycleCollector::untrack(this);
+}
+
+void CycleCollector::track(detail::ContainerCell* cell) {
+    CollectorState& s = state();
+    std::unique_lock<std::mutex> lock(s.mutex, std::defer_lock);
+    bool concurrent = concurrent_.load(std::memory_order_acquire) != 0;
+    if (concurrent) lock.lock();
+    cell->gc_next = s.head;
+    if (s.head) s.head->gc_prev = cell;
+    s.head = cell;
+    s.stats.tracked++;
+    s.stats.allocated++;
+    if (s.threshold != 0 && ++s.since_collect >= s.trigger) {
+        // 并行期间回收不了，置 pending 只会让每个回跳都走慢路径，推迟到 scope 结束
+        (concurrent ? deferred_ : pending_).store(true, std::memory_order_relaxed);
+    }
+}
+
+void CycleCollector::untrack(detail::ContainerCell* cell) {
+    CollectorState& s = state();
+    std::unique_lock<std::mutex> lock(s.mutex, std::defer_lock);
+    if (concurrent_.load(std::memory_order_acquire) != 0) lock.lock();
+    if (cell->gc_prev) cell->gc_prev->gc_next = cell->gc_next;
+    else s.head = cell->gc_next;
+    if (cell->gc_next) cell->gc_next->gc_prev = cell->gc_prev;
+    s.stats.tracked--;
+}
+
+size_t CycleCollector::collect() {
+    // 其他线程还在修改值：清掉 pending，最后一个 ConcurrentScope 结束时再置位
+    if (concurrent_.load(std::memory_order_acquire) != 0) {
+        if (pending_.exchange(false, std::memory_order_relaxed)) {
+            deferred_.store(true, std::memory_order_relaxed);
+        }
+        return 0;
+    }
+    CollectorState& s = state();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<detail::ContainerCell*> garbage;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        // 清空载荷时析构的值可能触发嵌套的回收请求，直接忽略
+        if (s.collecting) return 0;
+        s.collecting = true;
+
+        // 1. 每个单元的计数减去来自其他容器的引用
+        std::vector<detail::ContainerCell*> cells;
+        cells.reserve(s.stats.tracked);
+        for (detail::ContainerCell* cell = s.head; cell; cell = cell->gc_next) {
+            cell->gc_refs = cell->count();
+            cells.push_back(cell);
+        }
+        detail::CellList children;
+        for (detail::ContainerCell* cell : cells) {
+            children.clear();
+            cell->visitChildren(children);
+            for (detail::ContainerCell* child : children) child->gc_refs--;
+        }
+
+        // 2. 从仍有外部引用的单元出发标记可达（gc_refs = -1）
+        std::vector<detail::ContainerCell*> worklist;
+        for (detail::ContainerCell* cell : cells) {
+            if (cell->gc_refs > 0) worklist.push_back(cell);
+        }
+        while (!worklist.empty()) {
+            detail::ContainerCell* cell = worklist.back();
+            worklist.pop_back();
+            if (cell->gc_refs < 0) continue;
+            cell->gc_refs = -1;
+            children.clear();
+            cell->visitChildren(children);
+            for (detail::ContainerCell* child : children) {
+                if (child->gc_refs >= 0) worklist.push_back(child);
+            }
+        }
+
+        // 3. 其余单元只被环引用
+        for (detail::ContainerCell* cell : cells) {
+            if (cell->gc_refs >= 0) garbage.push_back(cell);
+        }
+    }
+
+    // 先持有全部垃圾单元，清空载荷时它们不会在中途被释放；最后一次 release 时析构
+    for (detail::ContainerCell* cell : garbage) cell->retain();
+    for (detail::ContainerCell* cell : garbage) cell->clearChildren();
+    for (detail::ContainerCell* cell : garbage) cell->release();
+
+    auto pause = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.collecting = false;
+    s.since_collect = 0;
+    s.trigger = std::max(s.threshold, s.stats.tracked);
+    pending_.store(false, std::memory_order_relaxed);
+    s.stats.collections++;
+    s.stats.collected += garbage.size();
+    s.stats.last_collected = garbage.size();
+    s.stats.last_pause_us = static_cast<uint64_t>(pause);
+    s.stats.total_pause_us += static_cast<uint64_t>(pause);
+    return garbage.size();
+}
+
+void CycleCollector::setThreshold(size_t threshold) {
+    CollectorState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.threshold = threshold;
+    s.trigger = threshold;
+    if (threshold == 0) {
+        pending_.store(false, std::memory_order_relaxed);
+        deferred_.store(false, std::memory_order_relaxed);
+    }
+}
+
+size_t CycleCollector::threshold() {
+    CollectorState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.threshold;
+}
+
+GcStats CycleCollector::stats() {
+    CollectorState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.stats;
+}
+
+// 各容器载荷的遍历：只报告自己持有计数的引用
+
+void traceChildren(const ArrayObject& array, detail::CellList& out) {
+    // 紧凑数组只有数值
+    if (array.kind() != ArrayObject::Kind::Generic) return;
+    for (const Value& element : array.values()) push(out, element);
+}
+
+void traceChildren(const StructObject& object, detail::CellList& out) {
+    for (const auto& [key, value] : object) push(out, value);
+}
+
+void traceChildren(const Value::LambdaData& lambda, detail::CellList& out) {
+    for (const Upvalue& upvalue : lambda.upvalues) push(out, upvalue.value);
+    // 共享的闭包表（如解释器的全局表）不属于这个 lambda
+    if (lambda.closure && lambda.closure.use_count() == 1) {
+        for (const auto& [name, value] : *lambda.closure) push(out, value);
+    }
+}
+
+void traceChildren(const Value::CurriedFunctionData& curried, detail::CellList& out) {
+    if (curried.original && curried.original.use_count() == 1) push(out, *curried.original);
+    for (const Value& arg : curried.collected_args) push(out, arg);
+}
+
+void traceChildren(const Value::MemoizedFunctionData& memoized, detail::CellList& out) {
+    if (memoized.original && memoized.original.use_count() == 1) push(out, *memoized.original);
+    if (memoized.cache && memoized.cache.use_count() == 1) {
+        for (const auto& [key, value] : *memoized.cache) push(out, value);
+    }
+}
+
+void clearPayload(ArrayObject& array) {
+    array.clear();
+}
+
+void clearPayload(StructObject& object) {
+    object.clear();
+}
+
+void clearPayload(Value::LambdaData& lambda) {
+    std::vector<Upvalue> upvalues = std::move(lambda.upvalues);
+    lambda.upvalues.clear();
+    lambda.closure.reset();
+}
+
+void clearPayload(Value::CurriedFunctionData& curried) {
+    std::vector<Value> args = std::move(curried.collected_args);
+    curried.collected_args.clear();
+    curried.original.reset();
+}
+
+void clearPayload(Value::MemoizedFunctionData& memoized) {
+    memoized.original.reset();
+    memoized.cache.reset();
+}
+
+} // namespace rumina
@@ -0,0 +1,66 @@
+#include <global_table.h>
+
+namespace rumina {
+
+GlobalTable::GlobalTable(std::shared_ptr<std::unordered_map<std::string, Value>> storage)
+    : storage_(std::move(storage)) {}
+
+GlobalTable GlobalTable::rebind(std::shared_ptr<std::unordered_map<std::string, Value>> storage) const {
+    GlobalTable table(std::move(storage));
+    table.index_ = index_;
+    table.slots_ = slots_;
+    for (Slot& slot : table.slots_) {
+        slot.value = nullptr;
+    }
+    return table;
+}
+
+size_t GlobalTable::resolve(Atom name) {
+    auto it = index_.find(name);
+    if (it != index_.end()) {
+        return it->second;
+    }
+
+    size_t slot = slots_.size();
+    Slot s;
+    s.name = name;
+    slots_.push_back(std::move(s));
+    index_.emplace(name, slot);
+    return slot;
+}
+
+std::optional<size_t> GlobalTable::find(Atom name) const {
+    auto it = index_.find(name);
+    if (it == index_.end()) return std::nullopt;
+    return it->second;
+}
+
+std::optional<size_t> GlobalTable::find(const std::string& name) const {
+    Atom atom = AtomTable::find(name);
+    if (atom == kNoAtom) return std::nullopt;
+    return find(atom);
+}
+
+void GlobalTable::set(size_t slot, const Value& value) {
+    Slot& s = slots_[slot];
+    if (!s.value) {
+        s.value = &(*storage_)[AtomTable::name(s.name)];
+    }
+    *s.value = value;
+}
+
+const Value* GlobalTable::lookup(Atom name) const {
+    auto slot = index_.find(name);
+    if (slot != index_.end() && slots_[slot->second].value) return slots_[slot->second].value;
+    auto it = storage_->find(AtomTable::name(name));
+    return it != storage_->end() ? &it->second : nullptr;
+}
+
+void GlobalTable::bind(Slot& slot) {
+    auto it = storage_->find(AtomTable::name(slot.name));
+    if (it != storage_->end()) {
+        slot.value = &it->second;
+    }
+}
+
+} // namespace rumina
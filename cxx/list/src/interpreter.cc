@@ -195,16 +195,16 @@ Result<Value> Interpreter::eval_expr_impl(const Expr* expr) {
                 if (val.is_error()) return Err<Value>(val.error());
                 elements.push_back(val.value());
             }
-            return Ok(Value::makeArray(
-                std::make_shared<std::vector<Value>>(std::move(elements))));
+            return Ok(Value::makeArray(std::move(elements)));
         }
         
         else if (auto struct_expr = dynamic_cast<const StructExpr*>(expr)) {
-            auto fields = std::make_shared<std::unordered_map<std::string, Value>>();
+            // 按字面量顺序添加字段，相同写法的结构体共享同一个形状
+            auto fields = makeRef<StructObject>();
             for (const auto& [key, value] : struct_expr->fields) {
                 auto val = eval_expr_impl(value.get());
                 if (val.is_error()) return Err<Value>(val.error());
-                (*fields)[key] = val.value();
+                fields->set(key, val.value());
             }
             return Ok(Value::makeStruct(fields));
         }
@@ -262,7 +262,7 @@ Result<Value> Interpreter::eval_expr_impl(const Expr* expr) {
                     auto struct_map = (obj.value().getType() == Value::Type::Struct) 
                         ? obj.value().getStruct() : obj.value().getModule();
                     
-                    auto it = struct_map->find(member->member);
+                    auto it = struct_map->find(member->atom);
                     if (it == struct_map->end()) {
                         return Err<Value>(obj.value().typeName() + 
                             " does not have member '" + member->member + "'");
@@ -305,7 +305,7 @@ Result<Value> Interpreter::eval_expr_impl(const Expr* expr) {
                 auto struct_map = (obj.value().getType() == Value::Type::Struct) 
                     ? obj.value().getStruct() : obj.value().getModule();
                 
-                auto it = struct_map->find(member->member);
+                auto it = struct_map->find(member->atom);
                 if (it == struct_map->end()) {
                     return Err<Value>(obj.value().typeName() + 
                         " does not have member '" + member->member + "'");
@@ -337,9 +337,9 @@ Result<Value> Interpreter::eval_expr_impl(const Expr* expr) {
                     return Err<Value>("Array index out of bounds: " + std::to_string(i));
                 }
                 
-                return Ok((*arr)[i]);
+                return Ok(arr->get(static_cast<size_t>(i)));
             } else if (obj.value().getType() == Value::Type::String) {
-                const std::string& s = obj.value().getString();
+                std::string_view s = obj.value().getStringView();
                 if (idx.value().getType() != Value::Type::Int) {
                     return Err<Value>("String index must be an integer");
                 }
@@ -353,16 +353,34 @@ Result<Value> Interpreter::eval_expr_impl(const Expr* expr) {
                     return Err<Value>("String index out of bounds: " + std::to_string(i));
                 }
                 
-                return Ok(Value(std::string(1, s[i])));
+                return Ok(Value::makeChar(static_cast<unsigned char>(s[i])));
             } else {
                 return Err<Value>("Invalid indexing operation");
             }
         }
         
         else if (auto lambda = dynamic_cast<const LambdaExpr*>(expr)) {
-            auto closure = locals_.empty() 
-                ? globals_ 
-                : std::make_shared<std::unordered_map<std::string, Value>>(*locals_.back());
+            auto closure = globals_;
+            if (!locals_.empty()) {
+                // 只捕获 lambda 体中引用到的局部变量
+                auto it = lambda_captures_.find(lambda);
+                if (it == lambda_captures_.end()) {
+                    std::unordered_set<std::string> names;
+                    collectReferencedNames(lambda->body.get(), names);
+                    it = lambda_captures_.emplace(
+                        lambda, std::vector<std::string>(names.begin(), names.end())).first;
+                }
+                
+                const auto& scope = *locals_.back();
+                closure = std::make_shared<std::unordered_map<std::string, Value>>();
+                closure->reserve(it->second.size());
+                for (const auto& name : it->second) {
+                    auto found = scope.find(name);
+                    if (found != scope.end()) {
+                        closure->emplace(name, found->second);
+                    }
+                }
+            }
             
             Value::LambdaData data;
             data.params = lambda->params;
@@ -405,7 +423,8 @@ void Interpreter::execute_stmt(const Stmt* stmt) {
             setVariable(var_decl->name, converted, false);
         } else if (var_decl->is_bigint) {
             // Convert to bigint
-            auto result = builtin::convert_to_bigint({val.value()});
+            Value arg = val.value();
+            auto result = builtin::convert_to_bigint(NativeArgs(&arg, 1));
             setVariable(var_decl->name, result, false);
         } else {
             setVariable(var_decl->name, val.value(), false);
@@ -420,7 +439,8 @@ void Interpreter::execute_stmt(const Stmt* stmt) {
             Value converted = builtin::convert_to_declared_type(val.value(), let_decl->declared_type.value());
             setVariable(let_decl->name, converted, true);
         } else if (let_decl->is_bigint) {
-            auto result = builtin::convert_to_bigint({val.value()});
+            Value arg = val.value();
+            auto result = builtin::convert_to_bigint(NativeArgs(&arg, 1));
             setVariable(let_decl->name, result, true);
         } else {
             setVariable(let_decl->name, val.value(), true);
@@ -659,6 +679,33 @@ void Interpreter::execute_stmt(const Stmt* stmt) {
             throw std::runtime_error("Built-in module 'rumina:stream' is not registered");
         }
         
+        if (include_stmt->path == "rumina:gc") {
+            auto it = globals_->find("rumina:gc");
+            if (it != globals_->end()) {
+                (*globals_)["gc"] = it->second;
+                return;
+            }
+            throw std::runtime_error("Built-in module 'rumina:gc' is not registered");
+        }
+        
+        if (include_stmt->path == "rumina:scheduler") {
+            auto it = globals_->find("rumina:scheduler");
+            if (it != globals_->end()) {
+                (*globals_)["scheduler"] = it->second;
+                return;
+            }
+            throw std::runtime_error("Built-in module 'rumina:scheduler' is not registered");
+        }
+        
+        if (include_stmt->path == "rumina:string_builder") {
+            auto it = globals_->find("rumina:string_builder");
+            if (it != globals_->end()) {
+                (*globals_)["StringBuilder"] = it->second;
+                return;
+            }
+            throw std::runtime_error("Built-in module 'rumina:string_builder' is not registered");
+        }
+        
         if (include_stmt->path == "rumina:buffer") {
             auto it = globals_->find("rumina:buffer");
             if (it != globals_->end()) {
@@ -874,15 +921,16 @@ Result<Value> Interpreter::call_function(const Value& func, std::vector<Value> a
             
             if (nf.name == "foreach") {
                 return handle_foreach(args);
-            } else if (nf.name == "map") {
+            } else if (nf.name == "map" || nf.name == "parallel_map") {
+                // 树遍历解释器不能跨线程执行，并行版本在这里按顺序执行
                 return handle_map(args);
             } else if (nf.name == "filter") {
                 return handle_filter(args);
-            } else if (nf.name == "reduce" || nf.name == "fold") {
+            } else if (nf.name == "reduce" || nf.name == "fold" || nf.name == "parallel_reduce") {
                 return handle_reduce(args);
             }
             
-            return Ok(nf.func(args));
+            return Ok(nf.call(args));
         }
         
         return Err<Value>("Cannot call " + func.typeName());
@@ -954,7 +1002,7 @@ Result<Value> Interpreter::call_method(const Value& func, const Value& self_obj,
             native_args.reserve(args.size() + 1);
             native_args.push_back(self_obj);
             native_args.insert(native_args.end(), args.begin(), args.end());
-            return Ok(nf.func(native_args));
+            return Ok(nf.call(native_args));
         }
         
         return Err<Value>("Cannot call method on " + func.typeName());
@@ -978,7 +1026,7 @@ Result<Value> Interpreter::handle_foreach(const std::vector<Value>& args) {
     for (size_t i = 0; i < array->size(); ++i) {
         std::vector<Value> callback_args;
         callback_args.push_back(Value(static_cast<int64_t>(i)));
-        callback_args.push_back((*array)[i]);
+        callback_args.push_back(array->get(i));
         auto result = call_function(callback, callback_args);
         if (result.is_error()) return result;
     }
@@ -1008,7 +1056,7 @@ Result<Value> Interpreter::handle_map(const std::vector<Value>& args) {
         result.push_back(mapped.value());
     }
     
-    return Ok(Value::makeArray(std::make_shared<std::vector<Value>>(std::move(result))));
+    return Ok(Value::makeArray(std::move(result)));
 }
 
 Result<Value> Interpreter::handle_filter(const std::vector<Value>& args) {
@@ -1034,7 +1082,7 @@ Result<Value> Interpreter::handle_filter(const std::vector<Value>& args) {
         }
     }
     
-    return Ok(Value::makeArray(std::make_shared<std::vector<Value>>(std::move(result))));
+    return Ok(Value::makeArray(std::move(result)));
 }
 
 Result<Value> Interpreter::handle_reduce(const std::vector<Value>& args) {
@@ -1064,12 +1112,12 @@ Result<Value> Interpreter::handle_reduce(const std::vector<Value>& args) {
         accumulator = args[2];
         start_index = 0;
     } else {
-        accumulator = (*array)[0];
+        accumulator = array->get(0);
         start_index = 1;
     }
     
     for (size_t i = start_index; i < array->size(); ++i) {
-        std::vector<Value> callback_args = {accumulator, (*array)[i]};
+        std::vector<Value> callback_args = {accumulator, array->get(i)};
         auto result = call_function(callback, callback_args);
         if (result.is_error()) return result;
         accumulator = result.value();
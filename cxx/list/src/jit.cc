@@ -0,0 +1,743 @@
+#include "jit.h"
+#include "cycle_collector.h"
+#include "vm.h"
+
+#if RUMINA_JIT
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <type_traits>
+
+namespace rumina {
+
+// 被改写为 JitEntry 的指令：所属的本地代码、目标基本块地址和原来的操作码
+struct Jit::Entry {
+    const Function* fn = nullptr;
+    const uint8_t* target = nullptr;
+    OpCodeType original = OpCodeType::Halt;
+};
+
+#if RUMINA_JIT
+
+// 一个已编译函数：规范化后的指令副本（辅助函数执行它们）和可执行内存
+struct Jit::Function {
+    std::string name;
+    size_t start = 0;
+    size_t end = 0;
+    std::vector<Instruction> ops;
+    uint8_t* code = nullptr;
+    size_t size = 0;
+    size_t mapped = 0;
+
+    ~Function() {
+        if (code) munmap(code, mapped);
+    }
+};
+
+namespace {
+
+// 辅助函数的返回值
+constexpr int kContinue = 0;
+constexpr int kExit = 1;
+constexpr int kError = 2;
+
+enum Reg : uint8_t {
+    RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7,
+    R8 = 8, R9 = 9, R10 = 10, R11 = 11, R12 = 12, R13 = 13, R14 = 14, R15 = 15
+};
+
+enum Cond : uint8_t {
+    B = 0x2, AE = 0x3, E = 0x4, NE = 0x5, BE = 0x6, A = 0x7,
+    L = 0xC, GE = 0xD, LE = 0xE, G = 0xF
+};
+
+// 只包含模板用到的 x86-64 指令；内存操作数统一用 [base + disp32]
+class Assembler {
+public:
+    const std::vector<uint8_t>& bytes() const { return code_; }
+    size_t size() const { return code_.size(); }
+
+    void movImm64(Reg r, uint64_t imm) { rex(true, 0, r); byte(0xB8 + (r & 7)); u64(imm); }
+    void movImm32(Reg r, uint32_t imm) { rex(false, 0, r); byte(0xB8 + (r & 7)); u32(imm); }
+    void mov(Reg dst, Reg src) { rex(true, src, dst); byte(0x89); direct(src, dst); }
+    void load(Reg dst, Reg base, int32_t disp) { rex(true, dst, base); byte(0x8B); mem(dst, base, disp); }
+    void store(Reg base, int32_t disp, Reg src) { rex(true, src, base); byte(0x89); mem(src, base, disp); }
+    void storeByte(Reg base, int32_t disp, uint8_t imm) {
+        rex(false, 0, base); byte(0xC6); mem(0, base, disp); byte(imm);
+    }
+    void loadByte(Reg dst, Reg base, int32_t disp) {
+        rex(false, dst, base); byte(0x0F); byte(0xB6); mem(dst, base, disp);
+    }
+    void cmpByte(Reg base, int32_t disp, uint8_t imm) {
+        rex(false, 0, base); byte(0x80); mem(7, base, disp); byte(imm);
+    }
+    // cmp a, b / cmp a, [base + disp]
+    void cmp(Reg a, Reg b) { rex(true, b, a); byte(0x39); direct(b, a); }
+    void cmpMem(Reg a, Reg base, int32_t disp) { rex(true, a, base); byte(0x3B); mem(a, base, disp); }
+    void cmpImm(Reg r, int32_t imm, bool wide) { rex(wide, 0, r); byte(0x81); direct(7, r); u32(imm); }
+    void addImm(Reg r, int32_t imm) { rex(true, 0, r); byte(0x81); direct(0, r); u32(imm); }
+    void addMem(Reg dst, Reg base, int32_t disp) { rex(true, dst, base); byte(0x03); mem(dst, base, disp); }
+    void subMem(Reg dst, Reg base, int32_t disp) { rex(true, dst, base); byte(0x2B); mem(dst, base, disp); }
+    void imulMem(Reg dst, Reg base, int32_t disp) {
+        rex(true, dst, base); byte(0x0F); byte(0xAF); mem(dst, base, disp);
+    }
+    void imulImm(Reg dst, Reg src, int32_t imm) { rex(true, dst, src); byte(0x69); direct(dst, src); u32(imm); }
+    void test32(Reg a, Reg b) { rex(false, b, a); byte(0x85); direct(b, a); }
+    // setcc / movzx 只用于 RAX、RCX、RDX 的低字节
+    void setcc(Cond c, Reg r) { byte(0x0F); byte(0x90 | c); direct(0, r); }
+    void movzx8(Reg dst, Reg src) { byte(0x0F); byte(0xB6); direct(dst, src); }
+    void cqo() { byte(0x48); byte(0x99); }
+    void idiv(Reg r) { rex(true, 0, r); byte(0xF7); direct(7, r); }
+    void push(Reg r) { rex(false, 0, r); byte(0x50 + (r & 7)); }
+    void pop(Reg r) { rex(false, 0, r); byte(0x58 + (r & 7)); }
+    void call(Reg r) { rex(false, 0, r); byte(0xFF); direct(2, r); }
+    void jmp(Reg r) { rex(false, 0, r); byte(0xFF); direct(4, r); }
+    void ret() { byte(0xC3); }
+
+    // 相对跳转，返回待回填的 rel32 位置
+    size_t jmp() { byte(0xE9); u32(0); return code_.size() - 4; }
+    size_t jcc(Cond c) { byte(0x0F); byte(0x80 | c); u32(0); return code_.size() - 4; }
+    void bind(size_t fixup, size_t target) {
+        int32_t rel = static_cast<int32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(fixup + 4));
+        std::memcpy(&code_[fixup], &rel, sizeof(rel));
+    }
+    void bindHere(size_t fixup) { bind(fixup, code_.size()); }
+
+private:
+    void byte(uint8_t b) { code_.push_back(b); }
+    void u32(uint32_t v) { for (int i = 0; i < 4; ++i) byte(static_cast<uint8_t>(v >> (8 * i))); }
+    void u64(uint64_t v) { for (int i = 0; i < 8; ++i) byte(static_cast<uint8_t>(v >> (8 * i))); }
+    void rex(bool wide, int reg, int base) {
+        uint8_t prefix = 0x40 | (wide ? 0x08 : 0) | ((reg >> 3) & 1) << 2 | ((base >> 3) & 1);
+        if (prefix != 0x40) byte(prefix);
+    }
+    void direct(int reg, int rm) { byte(static_cast<uint8_t>(0xC0 | (reg & 7) << 3 | (rm & 7))); }
+    void mem(int reg, int base, int32_t disp) {
+        byte(static_cast<uint8_t>(0x80 | (reg & 7) << 3 | (base & 7)));
+        if ((base & 7) == RSP) byte(0x24);
+        u32(static_cast<uint32_t>(disp));
+    }
+
+    std::vector<uint8_t> code_;
+};
+
+// 生成代码需要的 VM 地址和数据布局
+struct Target {
+    uint64_t vm;
+    uint64_t stack;      // std::vector<Value>：begin / end / capacity 三个指针
+    uint64_t slots;      // std::vector<LocalSlot>
+    uint64_t slot_base;
+    uint64_t ip;
+    uint64_t step_generic;
+    uint64_t pop_truthy;
+    uint64_t back_edge;
+    uint64_t gc_pending;  // CycleCollector::pending_
+    uint64_t tracer;      // VM::tracer_（std::unique_ptr，只有一个指针）
+    int32_t slot_size;
+    int32_t slot_assigned;
+};
+
+constexpr uint8_t typeByte(Value::Type type) { return static_cast<uint8_t>(type); }
+
+constexpr int32_t kValueSize = 16;
+constexpr int32_t kPayload = 8;
+
+// 寄存器约定：rbx = VM*，r12 = &stack_，r13 = &slots_，r14 = &slot_base_。
+// 入口的 5 次 push 使调用辅助函数时栈保持 16 字节对齐
+class Translator {
+public:
+    Translator(const Target& target, const std::vector<Value>& constants)
+        : t_(target), constants_(constants) {}
+
+    // 翻译 [start, start + ops.size()) 的指令，blocks 返回每条指令的代码偏移
+    std::vector<uint8_t> translate(const std::vector<Instruction>& ops, size_t start,
+                                   std::vector<size_t>& blocks) {
+        start_ = start;
+        end_ = start + ops.size();
+
+        a_.push(RBX);
+        a_.push(R12);
+        a_.push(R13);
+        a_.push(R14);
+        a_.push(R15);
+        a_.movImm64(RBX, t_.vm);
+        a_.movImm64(R12, t_.stack);
+        a_.movImm64(R13, t_.slots);
+        a_.movImm64(R14, t_.slot_base);
+        a_.jmp(RDI);
+
+        blocks.resize(ops.size());
+        for (size_t i = 0; i < ops.size(); ++i) {
+            blocks[i] = a_.size();
+            emit(ops[i], start + i);
+        }
+        // 执行到函数范围末尾
+        exitTo(end_);
+
+        for (const auto& [fixup, ip] : branches_) {
+            if (ip >= start_ && ip < end_) {
+                a_.bind(fixup, blocks[ip - start_]);
+                continue;
+            }
+            auto stub = stubs_.find(ip);
+            if (stub == stubs_.end()) {
+                stub = stubs_.emplace(ip, a_.size()).first;
+                exitTo(ip);
+            }
+            a_.bind(fixup, stub->second);
+        }
+
+        for (size_t fixup : exits_) {
+            a_.bind(fixup, a_.size());
+        }
+        a_.pop(R15);
+        a_.pop(R14);
+        a_.pop(R13);
+        a_.pop(R12);
+        a_.pop(RBX);
+        a_.ret();
+        return a_.bytes();
+    }
+
+private:
+    void emit(const Instruction& op, size_t ip) {
+        switch (op.type) {
+            case OpCodeType::PushConst:
+            case OpCodeType::PushConstPooled:
+                if (op.operand < constants_.size() && isImmediate(constants_[op.operand].getType())) {
+                    pushConst(op, ip, constants_[op.operand]);
+                    return;
+                }
+                break;
+            case OpCodeType::LoadLocal:
+                loadLocal(op, ip);
+                return;
+            case OpCodeType::StoreLocal:
+                storeLocal(op, ip);
+                return;
+            case OpCodeType::Add:
+            case OpCodeType::Sub:
+            case OpCodeType::Mul:
+            case OpCodeType::Mod:
+            case OpCodeType::Eq:
+            case OpCodeType::Neq:
+            case OpCodeType::Lt:
+            case OpCodeType::Lte:
+            case OpCodeType::Gt:
+            case OpCodeType::Gte:
+                intBinary(op, ip);
+                return;
+            case OpCodeType::Jump:
+                if (op.operand >= start_ && op.operand <= ip) {
+                    backEdge(op, ip);
+                    return;
+                }
+                branches_.emplace_back(a_.jmp(), op.operand);
+                return;
+            case OpCodeType::JumpIfFalse:
+            case OpCodeType::JumpIfTrue:
+                conditional(op, ip);
+                return;
+            default:
+                break;
+        }
+        step(op, ip);
+    }
+
+    static bool isImmediate(Value::Type type) {
+        return type == Value::Type::Int || type == Value::Type::Float ||
+               type == Value::Type::Bool || type == Value::Type::Null;
+    }
+
+    // 调用 stepGeneric 执行原指令，需要回到解释器时跳到出口
+    void step(const Instruction& op, size_t ip) {
+        a_.mov(RDI, RBX);
+        a_.movImm64(RSI, reinterpret_cast<uint64_t>(&op));
+        a_.movImm64(RDX, ip);
+        a_.movImm64(RAX, t_.step_generic);
+        a_.call(RAX);
+        a_.test32(RAX, RAX);
+        exits_.push_back(a_.jcc(NE));
+    }
+
+    // 慢路径：守卫失败的跳转都落到这里
+    void slowPath(const Instruction& op, size_t ip, const std::vector<size_t>& guards) {
+        size_t done = a_.jmp();
+        for (size_t fixup : guards) {
+            a_.bindHere(fixup);
+        }
+        step(op, ip);
+        a_.bindHere(done);
+    }
+
+    void exitTo(size_t ip) {
+        a_.movImm64(RAX, t_.ip);
+        a_.movImm64(RCX, ip);
+        a_.store(RAX, 0, RCX);
+        a_.movImm32(RAX, kExit);
+        exits_.push_back(a_.jmp());
+    }
+
+    // rax = &slots_[slot_base_]
+    void loadFrame() {
+        a_.load(RAX, R14, 0);
+        a_.imulImm(RAX, RAX, t_.slot_size);
+        a_.addMem(RAX, R13, 0);
+    }
+
+    // [base + disp] 处的值不是立即数类型时跳到慢路径（立即数不需要引用计数）
+    void guardImmediate(Reg base, int32_t disp, std::vector<size_t>& guards) {
+        a_.loadByte(RDX, base, disp);
+        std::vector<size_t> ok;
+        for (Value::Type type : {Value::Type::Int, Value::Type::Float, Value::Type::Bool}) {
+            a_.cmpImm(RDX, typeByte(type), false);
+            ok.push_back(a_.jcc(E));
+        }
+        a_.cmpImm(RDX, typeByte(Value::Type::Null), false);
+        guards.push_back(a_.jcc(NE));
+        for (size_t fixup : ok) {
+            a_.bindHere(fixup);
+        }
+    }
+
+    void pushConst(const Instruction& op, size_t ip, const Value& constant) {
+        uint64_t words[2];
+        std::memcpy(words, static_cast<const void*>(&constant), sizeof(words));
+
+        std::vector<size_t> guards;
+        a_.load(RCX, R12, 8);
+        a_.cmpMem(RCX, R12, 16);
+        guards.push_back(a_.jcc(AE));
+        a_.movImm64(RDX, words[0]);
+        a_.store(RCX, 0, RDX);
+        a_.movImm64(RDX, words[1]);
+        a_.store(RCX, kPayload, RDX);
+        a_.addImm(RCX, kValueSize);
+        a_.store(R12, 8, RCX);
+        slowPath(op, ip, guards);
+    }
+
+    void loadLocal(const Instruction& op, size_t ip) {
+        int32_t disp = static_cast<int32_t>(op.operand) * t_.slot_size;
+        std::vector<size_t> guards;
+        loadFrame();
+        a_.cmpByte(RAX, disp + t_.slot_assigned, 0);
+        guards.push_back(a_.jcc(E));
+        guardImmediate(RAX, disp, guards);
+        a_.load(RCX, R12, 8);
+        a_.cmpMem(RCX, R12, 16);
+        guards.push_back(a_.jcc(AE));
+        a_.load(RDX, RAX, disp);
+        a_.store(RCX, 0, RDX);
+        a_.load(RDX, RAX, disp + kPayload);
+        a_.store(RCX, kPayload, RDX);
+        a_.addImm(RCX, kValueSize);
+        a_.store(R12, 8, RCX);
+        slowPath(op, ip, guards);
+    }
+
+    // 栈顶按位移入槽位（等同于移动），槽位原值必须是立即数，不需要释放
+    void storeLocal(const Instruction& op, size_t ip) {
+        int32_t disp = static_cast<int32_t>(op.operand) * t_.slot_size;
+        std::vector<size_t> guards;
+        loadFrame();
+        a_.load(RCX, R12, 8);
+        a_.cmpMem(RCX, R12, 0);
+        guards.push_back(a_.jcc(BE));
+        guardImmediate(RAX, disp, guards);
+        a_.load(RDX, RCX, -kValueSize);
+        a_.store(RAX, disp, RDX);
+        a_.load(RDX, RCX, -kValueSize + kPayload);
+        a_.store(RAX, disp + kPayload, RDX);
+        a_.storeByte(RAX, disp + t_.slot_assigned, 1);
+        a_.addImm(RCX, -kValueSize);
+        a_.store(R12, 8, RCX);
+        slowPath(op, ip, guards);
+    }
+
+    // 两个 Int 操作数的算术和比较，结果与 value_binary_op 的整数分支一致
+    void intBinary(const Instruction& op, size_t ip) {
+        constexpr int32_t lhs = -2 * kValueSize;
+        constexpr int32_t rhs = -kValueSize;
+        std::vector<size_t> guards;
+        a_.load(RAX, R12, 8);
+        a_.load(RCX, R12, 0);
+        a_.addImm(RCX, 2 * kValueSize);
+        a_.cmp(RAX, RCX);
+        guards.push_back(a_.jcc(B));
+        a_.cmpByte(RAX, lhs, typeByte(Value::Type::Int));
+        guards.push_back(a_.jcc(NE));
+        a_.cmpByte(RAX, rhs, typeByte(Value::Type::Int));
+        guards.push_back(a_.jcc(NE));
+        a_.load(RCX, RAX, lhs + kPayload);
+
+        switch (op.type) {
+            case OpCodeType::Add:
+                a_.addMem(RCX, RAX, rhs + kPayload);
+                a_.store(RAX, lhs + kPayload, RCX);
+                break;
+            case OpCodeType::Sub:
+                a_.subMem(RCX, RAX, rhs + kPayload);
+                a_.store(RAX, lhs + kPayload, RCX);
+                break;
+            case OpCodeType::Mul:
+                a_.imulMem(RCX, RAX, rhs + kPayload);
+                a_.store(RAX, lhs + kPayload, RCX);
+                break;
+            case OpCodeType::Mod:
+                // 除数为 0（报错）和 -1（可能溢出）交给通用实现
+                a_.load(R8, RAX, rhs + kPayload);
+                a_.cmpImm(R8, 0, true);
+                guards.push_back(a_.jcc(E));
+                a_.cmpImm(R8, -1, true);
+                guards.push_back(a_.jcc(E));
+                a_.mov(R9, RAX);
+                a_.mov(RAX, RCX);
+                a_.cqo();
+                a_.idiv(R8);
+                a_.store(R9, lhs + kPayload, RDX);
+                a_.mov(RAX, R9);
+                break;
+            default: {
+                Cond cond = E;
+                switch (op.type) {
+                    case OpCodeType::Neq: cond = NE; break;
+                    case OpCodeType::Lt: cond = L; break;
+                    case OpCodeType::Lte: cond = LE; break;
+                    case OpCodeType::Gt: cond = G; break;
+                    case OpCodeType::Gte: cond = GE; break;
+                    default: break;
+                }
+                a_.cmpMem(RCX, RAX, rhs + kPayload);
+                a_.setcc(cond, RDX);
+                a_.movzx8(RDX, RDX);
+                a_.storeByte(RAX, lhs, typeByte(Value::Type::Bool));
+                a_.store(RAX, lhs + kPayload, RDX);
+                break;
+            }
+        }
+        a_.addImm(RAX, -kValueSize);
+        a_.store(R12, 8, RAX);
+        slowPath(op, ip, guards);
+    }
+
+    // 栈顶是 Bool 时直接判断，否则由 popTruthy 求真假
+    void conditional(const Instruction& op, size_t ip) {
+        Cond taken = op.type == OpCodeType::JumpIfFalse ? E : NE;
+        std::vector<size_t> guards;
+        a_.load(RAX, R12, 8);
+        a_.cmpMem(RAX, R12, 0);
+        guards.push_back(a_.jcc(BE));
+        a_.cmpByte(RAX, -kValueSize, typeByte(Value::Type::Bool));
+        guards.push_back(a_.jcc(NE));
+        a_.loadByte(RCX, RAX, -kValueSize + kPayload);
+        a_.addImm(RAX, -kValueSize);
+        a_.store(R12, 8, RAX);
+        a_.test32(RCX, RCX);
+        branches_.emplace_back(a_.jcc(taken), op.operand);
+        size_t done = a_.jmp();
+
+        for (size_t fixup : guards) {
+            a_.bindHere(fixup);
+        }
+        a_.mov(RDI, RBX);
+        a_.movImm64(RSI, ip);
+        a_.movImm64(RAX, t_.pop_truthy);
+        a_.call(RAX);
+        a_.cmpImm(RAX, kError, false);
+        exits_.push_back(a_.jcc(E));
+        a_.test32(RAX, RAX);
+        branches_.emplace_back(a_.jcc(taken), op.operand);
+        a_.bindHere(done);
+    }
+
+    // 函数内回跳，和解释器的 Jump 一样是环回收和 trace 的检查点：
+    // 没有待回收的环、也没有 tracer 时直接跳回循环头，否则交给 backEdge
+    void backEdge(const Instruction& op, size_t ip) {
+        std::vector<size_t> polls;
+        a_.movImm64(RAX, t_.gc_pending);
+        a_.cmpByte(RAX, 0, 0);
+        polls.push_back(a_.jcc(NE));
+        a_.movImm64(RAX, t_.tracer);
+        a_.load(RAX, RAX, 0);
+        a_.cmpImm(RAX, 0, true);
+        polls.push_back(a_.jcc(NE));
+        branches_.emplace_back(a_.jmp(), op.operand);
+
+        for (size_t fixup : polls) {
+            a_.bindHere(fixup);
+        }
+        a_.mov(RDI, RBX);
+        a_.movImm64(RSI, op.operand);
+        a_.movImm64(RDX, ip);
+        a_.movImm64(RAX, t_.back_edge);
+        a_.call(RAX);
+        a_.test32(RAX, RAX);
+        exits_.push_back(a_.jcc(NE));
+        branches_.emplace_back(a_.jmp(), op.operand);
+    }
+
+    const Target& t_;
+    const std::vector<Value>& constants_;
+    Assembler a_;
+    size_t start_ = 0;
+    size_t end_ = 0;
+    std::vector<std::pair<size_t, size_t>> branches_;  // (rel32 位置, 目标指令)
+    std::vector<size_t> exits_;
+    std::map<size_t, size_t> stubs_;  // 跳出函数范围的目标 -> 退出桩偏移
+};
+
+// 生成的代码按位读写 Value 和 std::vector，先确认当前编译器和标准库的布局
+bool layoutSupported() {
+    if (sizeof(Value) != kValueSize) return false;
+
+    unsigned char bytes[kValueSize];
+    int64_t payload = 0;
+    Value number(static_cast<int64_t>(0x0123456789abcdefLL));
+    std::memcpy(bytes, static_cast<const void*>(&number), sizeof(bytes));
+    std::memcpy(&payload, bytes + kPayload, sizeof(payload));
+    if (bytes[0] != typeByte(Value::Type::Int) || payload != 0x0123456789abcdefLL) return false;
+
+    Value flag(true);
+    std::memcpy(bytes, static_cast<const void*>(&flag), sizeof(bytes));
+    std::memcpy(&payload, bytes + kPayload, sizeof(payload));
+    if (bytes[0] != typeByte(Value::Type::Bool) || payload != 1) return false;
+
+    auto vectorMatches = [](auto& vec) {
+        using Element = typename std::remove_reference_t<decltype(vec)>::value_type;
+        if (sizeof(vec) != 3 * sizeof(void*)) return false;
+        Element* words[3];
+        std::memcpy(words, static_cast<const void*>(&vec), sizeof(words));
+        return words[0] == vec.data() && words[1] == vec.data() + vec.size() &&
+               words[2] == vec.data() + vec.capacity();
+    };
+    std::vector<Value> values(2);
+    values.reserve(5);
+    std::vector<LocalSlot> slots(3);
+    slots.reserve(7);
+    if (!vectorMatches(values) || !vectorMatches(slots)) return false;
+
+    std::unique_ptr<int> owner(new int(0));
+    void* pointer = nullptr;
+    if (sizeof(owner) != sizeof(pointer)) return false;
+    std::memcpy(&pointer, static_cast<const void*>(&owner), sizeof(pointer));
+    if (pointer != owner.get()) return false;
+    if (sizeof(std::atomic<bool>) != 1 || !std::atomic<bool>().is_lock_free()) return false;
+
+    LocalSlot slot;
+    return static_cast<const void*>(&slot.value) == static_cast<const void*>(&slot);
+}
+
+} // namespace
+
+std::unique_ptr<Jit> Jit::create(VM& vm, const JitOptions& options) {
+    if (!layoutSupported()) return nullptr;
+    return std::unique_ptr<Jit>(new Jit(vm, options));
+}
+
+Jit::Jit(VM& vm, const JitOptions& options) : vm_(vm), options_(options) {
+    if (options_.threshold == 0) options_.threshold = 1;
+}
+
+Jit::~Jit() {
+    reset();
+}
+
+void Jit::reset() {
+    // 还原改写过的指令，之后旧的本地代码不再可达
+    auto& code = vm_.bytecode_.getInstructions();
+    for (size_t ip = 0; ip < entries_.size() && ip < code.size(); ++ip) {
+        if (entries_[ip].fn && code[ip].type == OpCodeType::JitEntry) {
+            code[ip].type = entries_[ip].original;
+        }
+    }
+    entries_.clear();
+    functions_.clear();
+    hotness_.clear();
+}
+
+bool Jit::enter(size_t ip) {
+    if (ip >= entries_.size() || !entries_[ip].fn) {
+        return vm_.fail("Invalid JIT entry");
+    }
+    const Entry& entry = entries_[ip];
+    stats_.native_entries++;
+    auto native = reinterpret_cast<int (*)(const uint8_t*)>(entry.fn->code);
+    return native(entry.target) != kError;
+}
+
+OpCodeType Jit::originalOpCode(size_t ip) const {
+    return ip < entries_.size() && entries_[ip].fn ? entries_[ip].original : OpCodeType::JitEntry;
+}
+
+int Jit::stepGeneric(VM* vm, const Instruction* op, size_t ip) {
+    vm->ip_ = ip + 1;
+    bool ok;
+    // 异常不能穿过本地代码的栈帧展开，在这里转成错误
+    try {
+        ok = vm->executeInstruction(*op, ip);
+    } catch (const std::exception& e) {
+        ok = vm->fail(e);
+    } catch (...) {
+        ok = vm->fail("Unknown error in native call");
+    }
+    if (!ok) {
+        vm->recordFault(ip);
+        return kError;
+    }
+    return (vm->halted_ || vm->ip_ != ip + 1) ? kExit : kContinue;
+}
+
+int Jit::popTruthy(VM* vm, size_t ip) {
+    if (vm->stack_.empty()) {
+        vm->fail("Stack underflow");
+        vm->recordFault(ip);
+        return kError;
+    }
+    bool truthy = vm->stack_.back().isTruthy();
+    vm->stack_.pop_back();
+    return truthy ? 1 : 0;
+}
+
+int Jit::backEdge(VM* vm, size_t header, size_t ip) {
+    if (CycleCollector::pending()) CycleCollector::collect();
+    Tracer* tracer = vm->tracer_.get();
+    if (!tracer || !tracer->needsBackEdge(header)) return kContinue;
+    // trace 录制或执行时由解释器接着跑，之后从 ip_ 继续（回到循环头时重新进入本地代码）
+    vm->ip_ = header;
+    if (!tracer->onBackEdge(header)) {
+        vm->recordFault(ip);
+        return kError;
+    }
+    return kExit;
+}
+
+void Jit::compile(size_t proto_index) {
+    if (proto_index >= vm_.protos_.size()) return;
+    const auto& proto = vm_.protos_[proto_index];
+    auto& code = vm_.bytecode_.getInstructions();
+    size_t start = proto.body_start;
+    size_t end = std::min(proto.body_end, code.size());
+    if (start >= end) return;
+    if (entries_.size() < code.size()) entries_.resize(code.size());
+
+    // 辅助函数执行的指令副本：已改写的入口还原，特化指令和超级指令还原为通用首条指令
+    auto fn = std::make_unique<Function>();
+    fn->name = proto.info->name;
+    fn->start = start;
+    fn->end = end;
+    fn->ops.reserve(end - start);
+    for (size_t ip = start; ip < end; ++ip) {
+        Instruction op = code[ip];
+        if (op.type == OpCodeType::JitEntry) op.type = entries_[ip].original;
+        op.type = genericOpCode(fusedHeadOpCode(op.type));
+        fn->ops.push_back(op);
+    }
+
+    Target target;
+    target.vm = reinterpret_cast<uint64_t>(&vm_);
+    target.stack = reinterpret_cast<uint64_t>(&vm_.stack_);
+    target.slots = reinterpret_cast<uint64_t>(&vm_.slots_);
+    target.slot_base = reinterpret_cast<uint64_t>(&vm_.slot_base_);
+    target.ip = reinterpret_cast<uint64_t>(&vm_.ip_);
+    target.step_generic = reinterpret_cast<uint64_t>(&Jit::stepGeneric);
+    target.pop_truthy = reinterpret_cast<uint64_t>(&Jit::popTruthy);
+    target.back_edge = reinterpret_cast<uint64_t>(&Jit::backEdge);
+    target.gc_pending = reinterpret_cast<uint64_t>(&CycleCollector::pending_);
+    target.tracer = reinterpret_cast<uint64_t>(&vm_.tracer_);
+    LocalSlot probe;
+    target.slot_size = static_cast<int32_t>(sizeof(LocalSlot));
+    target.slot_assigned = static_cast<int32_t>(reinterpret_cast<const char*>(&probe.assigned) -
+                                                reinterpret_cast<const char*>(&probe));
+
+    std::vector<size_t> blocks;
+    Translator translator(target, vm_.bytecode_.getConstants());
+    std::vector<uint8_t> bytes = translator.translate(fn->ops, start, blocks);
+
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t mapped = (bytes.size() + page - 1) / page * page;
+    void* memory = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return;
+    std::memcpy(memory, bytes.data(), bytes.size());
+    if (mprotect(memory, mapped, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, mapped);
+        return;
+    }
+    fn->code = static_cast<uint8_t*>(memory);
+    fn->size = bytes.size();
+    fn->mapped = mapped;
+
+    // 入口：函数开头、调用返回点和回跳目标（循环头）。
+    // 范围重叠（嵌套函数）时保留先编译的入口，两份代码的语义相同
+    std::vector<size_t> entry_points{start};
+    for (size_t ip = start; ip < end; ++ip) {
+        const Instruction& op = fn->ops[ip - start];
+        switch (op.type) {
+            case OpCodeType::Call:
+            case OpCodeType::CallVar:
+            case OpCodeType::CallMethod:
+                if (ip + 1 < end) entry_points.push_back(ip + 1);
+                break;
+            case OpCodeType::Jump:
+            case OpCodeType::JumpIfFalse:
+            case OpCodeType::JumpIfTrue:
+                if (op.operand >= start && op.operand <= ip) entry_points.push_back(op.operand);
+                break;
+            default:
+                break;
+        }
+    }
+    for (size_t ip : entry_points) {
+        Entry& entry = entries_[ip];
+        if (entry.fn) continue;
+        entry.fn = fn.get();
+        entry.target = fn->code + blocks[ip - start];
+        entry.original = code[ip].type;
+        code[ip].type = OpCodeType::JitEntry;
+    }
+
+    stats_.compiled_functions++;
+    stats_.code_bytes += fn->size;
+    if (options_.perf_map) {
+        writePerfMap(fn->code, fn->size, fn->name);
+    }
+    functions_.push_back(std::move(fn));
+}
+
+void Jit::writePerfMap(const void* code, size_t size, const std::string& name) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "/tmp/perf-%d.map", static_cast<int>(getpid()));
+    FILE* file = std::fopen(path, "a");
+    if (!file) return;
+    std::fprintf(file, "%lx %zx rumina::%s\n",
+                 static_cast<unsigned long>(reinterpret_cast<uintptr_t>(code)), size, name.c_str());
+    std::fclose(file);
+}
+
+#else // !RUMINA_JIT
+
+struct Jit::Function {};
+
+std::unique_ptr<Jit> Jit::create(VM&, const JitOptions&) {
+    return nullptr;
+}
+
+Jit::Jit(VM& vm, const JitOptions& options) : vm_(vm), options_(options) {}
+Jit::~Jit() = default;
+void Jit::reset() {}
+bool Jit::enter(size_t) { return vm_.fail("JIT is not supported on this platform"); }
+OpCodeType Jit::originalOpCode(size_t) const { return OpCodeType::JitEntry; }
+int Jit::stepGeneric(VM*, const Instruction*, size_t) { return 2; }
+int Jit::popTruthy(VM*, size_t) { return 2; }
+int Jit::backEdge(VM*, size_t, size_t) { return 2; }
+void Jit::compile(size_t) {}
+void Jit::writePerfMap(const void*, size_t, const std::string&) {}
+
+#endif // RUMINA_JIT
+
+} // namespace rumina
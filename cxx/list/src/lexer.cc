@@ -242,7 +242,9 @@ Token Lexer::readIdentifier() {
     if (ident == "complex") return Token(TokenType::TypeComplex, start_line, start_col);
     if (ident == "array") return Token(TokenType::TypeArray, start_line, start_col);
 
-    return Token(TokenType::Ident, ident, start_line, start_col);
+    Token token(TokenType::Ident, ident, start_line, start_col);
+    token.atom = AtomTable::intern(ident);
+    return token;
 }
 
 Token Lexer::nextToken() {
@@ -6,7 +6,9 @@
 #include <bytecode_optimizer.h>
 #include <optimizer.h>
 #include <builtin/process.h>
+#include <thread_pool.h>
 
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -77,7 +79,7 @@ void check_semicolons(const std::string& contents, const std::string& filename)
     }
 }
 
-int run_file(const std::string& filename) {
+int run_file(const std::string& filename, const JitOptions* jit = nullptr) {
     std::ifstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error reading file '" << filename << "'\n";
@@ -120,6 +122,9 @@ int run_file(const std::string& filename) {
         Interpreter interpreter;
         auto globals = interpreter.getGlobals();
         VM vm(globals);
+        if (jit && !vm.setJitEnabled(true, *jit)) {
+            std::cerr << "Warning: JIT is not supported on this platform\n";
+        }
         vm.load(std::move(bytecode));
         
         auto result = vm.run();
@@ -135,6 +140,54 @@ int run_file(const std::string& filename) {
     }
 }
 
+// 输出优化后字节码的操作码 n-gram 频率，用于挑选超级指令
+int dump_ngrams(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error reading file '" << filename << "'\n";
+        return 1;
+    }
+    
+    std::string contents((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+    std::string file_dir = std::filesystem::path(filename).parent_path().string();
+    
+    try {
+        Lexer lexer(contents);
+        auto tokens = lexer.tokenize();
+        
+        Parser parser(tokens);
+        auto statements = parser.parse();
+        
+        ASTOptimizer ast_optimizer;
+        auto optimized_result = ast_optimizer.optimize(std::move(statements));
+        if (optimized_result.is_error()) {
+            std::cerr << "AST optimization error: " << optimized_result.error() << "\n";
+            return 1;
+        }
+        
+        Compiler compiler(file_dir);
+        auto compile_result = compiler.compile(optimized_result.value());
+        if (compile_result.is_error()) {
+            std::cerr << "Compilation error: " << compile_result.error() << "\n";
+            return 1;
+        }
+        auto bytecode = std::move(compile_result.value());
+        
+        BytecodeOptimizer bytecode_optimizer;
+        bytecode_optimizer.setSuperinstructions(false);
+        bytecode_optimizer.optimize(bytecode);
+        
+        for (size_t n = 2; n <= 4; ++n) {
+            BytecodeOptimizer::dumpNGrams(bytecode, n, 20, std::cout);
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
 void run_repl() {
     std::cout << "Rumina\n";
     std::cout << "Type 'exit' to quit, or enter Lamina code to execute.\n\n";
@@ -215,6 +268,19 @@ void run_repl() {
 } // namespace rumina
 
 int main(int argc, char* argv[]) {
+    // --threads <n> 设置共用调度器的线程数，写在其他参数之前，不计入脚本看到的命令行参数
+    if (argc > 1 && std::string(argv[1]) == "--threads") {
+        long long threads = argc > 2 ? std::atoll(argv[2]) : 0;
+        if (threads <= 0) {
+            std::cerr << "Error: --threads expects a positive integer\n";
+            return 1;
+        }
+        rumina::ThreadPool::setSharedThreads(static_cast<size_t>(threads));
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
+    
     // 初始化 process 模块的命令行参数
     rumina::builtin::process::init_process_args(argc, argv);
     
@@ -222,11 +288,21 @@ int main(int argc, char* argv[]) {
         std::string arg = argv[1];
         if (arg.size() >= 3 && arg.substr(arg.size() - 3) == ".lm") {
             return rumina::run_file(arg);
+        } else if (arg == "--ngrams" && argc > 2) {
+            return rumina::dump_ngrams(argv[2]);
+        } else if ((arg == "--jit" || arg == "--jit-perf-map") && argc > 2) {
+            rumina::JitOptions options;
+            options.perf_map = arg == "--jit-perf-map";
+            return rumina::run_file(argv[2], &options);
         } else {
             std::cerr << "Error: No .lm file specified\n";
             std::cerr << "Usage:\n";
-            std::cerr << "  rumina              - Start REPL\n";
-            std::cerr << "  rumina <file.lm>    - Run Lamina file\n";
+            std::cerr << "  rumina                    - Start REPL\n";
+            std::cerr << "  rumina <file.lm>          - Run Lamina file\n";
+            std::cerr << "  rumina --ngrams <file.lm> - Dump opcode n-gram frequencies\n";
+            std::cerr << "  rumina --jit <file.lm>    - Run with the baseline JIT (Linux x86-64)\n";
+            std::cerr << "  rumina --jit-perf-map <file.lm> - Same, and write /tmp/perf-<pid>.map\n";
+            std::cerr << "  rumina --threads <n> ...  - Size the shared scheduler (default: RUMINA_THREADS or CPU count)\n";
             return 1;
         }
     } else {
@@ -19,8 +19,19 @@ Result<std::vector<std::unique_ptr<Stmt>>> ASTOptimizer::optimize(
     return Ok(std::move(optimized));
 }
 
+// 改写后的语句保留原语句的行号
 std::optional<std::unique_ptr<Stmt>> ASTOptimizer::optimizeStmt(
     std::unique_ptr<Stmt> stmt) {
+    size_t line = stmt->line;
+    auto result = rewriteStmt(std::move(stmt));
+    if (result.has_value() && result.value() && !result.value()->line) {
+        result.value()->line = line;
+    }
+    return result;
+}
+
+std::optional<std::unique_ptr<Stmt>> ASTOptimizer::rewriteStmt(
+    std::unique_ptr<Stmt> stmt) {
     
     if (auto expr_stmt = dynamic_cast<ExprStmt*>(stmt.get())) {
         auto opt_expr = optimizeExpr(std::move(expr_stmt->expr));
@@ -181,7 +192,7 @@ std::unique_ptr<Expr> ASTOptimizer::optimizeExpr(std::unique_ptr<Expr> expr) {
                 case BinOp::Mod:
                     if (b != 0) {
                         modified_ = true;
-                        return std::make_unique<IntExpr>(a % b);
+                        return std::make_unique<IntExpr>(b == -1 ? 0 : a % b);
                     }
                     break;
                 case BinOp::Equal:
@@ -92,7 +92,17 @@ std::vector<std::unique_ptr<Stmt>> Parser::parse() {
     return statements;
 }
 
+// 记录语句起始行号，编译器据此填写字节码的行号表
 std::unique_ptr<Stmt> Parser::parseStatement() {
+    size_t line = currentToken().line;
+    auto stmt = parseStatementBody();
+    if (stmt) {
+        stmt->line = line;
+    }
+    return stmt;
+}
+
+std::unique_ptr<Stmt> Parser::parseStatementBody() {
     switch (currentToken().type) {
         case TokenType::Var:
             return parseVarDeclWithType(std::nullopt, false);
@@ -633,8 +643,9 @@ std::unique_ptr<Expr> Parser::parsePostfix() {
                 throw std::runtime_error("Expected member name");
             }
             std::string member = std::get<std::string>(currentToken().value);
+            Atom atom = currentToken().atom;
             advance();
-            expr = std::make_unique<MemberExpr>(std::move(expr), member);
+            expr = std::make_unique<MemberExpr>(std::move(expr), member, atom);
         } else if (match(TokenType::Bang)) {
             expr = std::make_unique<UnaryExpr>(UnaryOp::Factorial, std::move(expr));
         } else {
@@ -691,6 +702,7 @@ std::unique_ptr<Expr> Parser::parsePrimary() {
             
         case TokenType::Ident: {
             std::string name = std::get<std::string>(tok.value);
+            Atom atom = tok.atom;
             advance();
             
             if (match(TokenType::DoubleColon)) {
@@ -701,7 +713,7 @@ std::unique_ptr<Expr> Parser::parsePrimary() {
                 advance();
                 return std::make_unique<NamespaceExpr>(name, member);
             }
-            return std::make_unique<IdentExpr>(name);
+            return std::make_unique<IdentExpr>(name, atom);
         }
         
         case TokenType::TypeInt:
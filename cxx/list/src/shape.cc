@@ -0,0 +1,191 @@
+#include "shape.h"
+#include <algorithm>
+#include <mutex>
+
+namespace rumina {
+
+namespace {
+// 保护共享形状的转换表（多线程运行时可能同时创建形状）
+std::mutex& transitionMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+} // namespace
+
+const Shape* Shape::root() {
+    static Shape* empty = new Shape();  // 共享形状永不释放
+    return empty;
+}
+
+const Shape* Shape::withField(Atom name) const {
+    std::lock_guard<std::mutex> lock(transitionMutex());
+    auto it = transitions_.find(name);
+    if (it != transitions_.end()) {
+        return it->second.get();
+    }
+
+    std::unique_ptr<Shape> next(new Shape());
+    next->names_ = names_;
+    next->index_ = index_;
+    next->appendField(name);
+    const Shape* result = next.get();
+    transitions_.emplace(name, std::move(next));
+    return result;
+}
+
+std::unique_ptr<Shape> Shape::makeDictionary(const Shape& from) {
+    std::unique_ptr<Shape> dict(new Shape());
+    dict->names_ = from.names_;
+    dict->index_ = from.index_;
+    dict->strings_ = from.strings_;
+    dict->strings_.resize(from.names_.size());
+    dict->keys_ = from.keys_;
+    dict->shared_ = false;
+    return dict;
+}
+
+void Shape::appendField(Atom name) {
+    index_.emplace(name, static_cast<uint32_t>(names_.size()));
+    names_.push_back(name);
+    if (!shared_) strings_.emplace_back();
+}
+
+void Shape::appendKey(const std::string& name) {
+    keys_.emplace(name, static_cast<uint32_t>(names_.size()));
+    names_.push_back(kNoAtom);
+    strings_.push_back(name);
+}
+
+StructObject::StructObject(const std::unordered_map<std::string, Value>& fields)
+    : shape_(Shape::root()) {
+    std::vector<const std::pair<const std::string, Value>*> entries;
+    entries.reserve(fields.size());
+    for (const auto& entry : fields) {
+        entries.push_back(&entry);
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    slots_.reserve(entries.size());
+    for (const auto* entry : entries) {
+        appendKey(entry->first);
+        slots_.push_back(entry->second);
+    }
+}
+
+StructObject::StructObject(const StructObject& other)
+    : shape_(other.shape_), slots_(other.slots_) {
+    if (other.own_shape_) {
+        own_shape_ = Shape::makeDictionary(*other.own_shape_);
+        shape_ = own_shape_.get();
+    }
+}
+
+StructObject& StructObject::operator=(const StructObject& other) {
+    if (this != &other) {
+        StructObject copy(other);
+        shape_ = copy.shape_;
+        own_shape_ = std::move(copy.own_shape_);
+        slots_ = std::move(copy.slots_);
+    }
+    return *this;
+}
+
+void StructObject::appendField(Atom name) {
+    if (own_shape_) {
+        own_shape_->appendField(name);
+    } else if (shape_->size() >= Shape::kMaxSharedFields) {
+        // 字段过多，转为字典模式
+        own_shape_ = Shape::makeDictionary(*shape_);
+        own_shape_->appendField(name);
+        shape_ = own_shape_.get();
+    } else {
+        shape_ = shape_->withField(name);
+    }
+}
+
+void StructObject::appendKey(const std::string& name) {
+    Atom atom = AtomTable::find(name);
+    if (atom != kNoAtom) {
+        appendField(atom);
+        return;
+    }
+    // 运行时拼出的键不驻留（原子永不释放），对象转为字典模式按字符串保存
+    if (!own_shape_) {
+        own_shape_ = Shape::makeDictionary(*shape_);
+        shape_ = own_shape_.get();
+    }
+    own_shape_->appendKey(name);
+}
+
+size_t StructObject::set(Atom name, Value value) {
+    int32_t slot = shape_->slotOf(name);
+    if (slot >= 0) {
+        slots_[slot] = std::move(value);
+        return static_cast<size_t>(slot);
+    }
+    appendField(name);
+    slots_.push_back(std::move(value));
+    return slots_.size() - 1;
+}
+
+size_t StructObject::set(const std::string& name, Value value) {
+    int32_t slot = shape_->slotOf(name);
+    if (slot >= 0) {
+        slots_[slot] = std::move(value);
+        return static_cast<size_t>(slot);
+    }
+    appendKey(name);
+    slots_.push_back(std::move(value));
+    return slots_.size() - 1;
+}
+
+Value& StructObject::operator[](Atom name) {
+    int32_t slot = shape_->slotOf(name);
+    if (slot >= 0) {
+        return slots_[slot];
+    }
+    appendField(name);
+    slots_.emplace_back();
+    return slots_.back();
+}
+
+Value& StructObject::operator[](const std::string& name) {
+    int32_t slot = shape_->slotOf(name);
+    if (slot >= 0) {
+        return slots_[slot];
+    }
+    appendKey(name);
+    slots_.emplace_back();
+    return slots_.back();
+}
+
+size_t StructObject::erase(Atom name) {
+    return eraseSlot(shape_->slotOf(name));
+}
+
+size_t StructObject::eraseSlot(int32_t slot) {
+    if (slot < 0) {
+        return 0;
+    }
+
+    // 删除字段后从空形状重新建立
+    const Shape* old_shape = shape_;
+    std::unique_ptr<Shape> old_own = std::move(own_shape_);
+    std::vector<Value> slots = std::move(slots_);
+    shape_ = Shape::root();
+    slots_.clear();
+    for (size_t i = 0; i < old_shape->size(); ++i) {
+        if (static_cast<int32_t>(i) == slot) continue;
+        Atom atom = old_shape->atomAt(i);
+        if (atom != kNoAtom) {
+            appendField(atom);
+        } else {
+            appendKey(old_shape->nameAt(i));
+        }
+        slots_.push_back(std::move(slots[i]));
+    }
+    return 1;
+}
+
+} // namespace rumina
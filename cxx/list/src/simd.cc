@@ -0,0 +1,343 @@
+#include "simd.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RUMINA_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace rumina {
+namespace simd {
+
+namespace {
+
+struct Kernels {
+    double (*dot)(const double*, const double*, size_t);
+    double (*sumSquares)(const double*, size_t);
+    double (*sum)(const double*, size_t);
+    double (*min)(const double*, size_t);
+    double (*max)(const double*, size_t);
+    void (*add)(const double*, const double*, double*, size_t);
+    void (*sub)(const double*, const double*, double*, size_t);
+    void (*mul)(const double*, const double*, double*, size_t);
+    void (*div)(const double*, const double*, double*, size_t);
+    void (*scale)(const double*, double, double*, size_t);
+    void (*prefixSum)(const double*, double*, size_t);
+};
+
+// ---- 标量实现 ----
+namespace scalar {
+
+double dot(const double* a, const double* b, size_t n) {
+    double result = 0.0;
+    for (size_t i = 0; i < n; ++i) result += a[i] * b[i];
+    return result;
+}
+
+double sumSquares(const double* a, size_t n) { return dot(a, a, n); }
+
+double sum(const double* a, size_t n) {
+    double result = 0.0;
+    for (size_t i = 0; i < n; ++i) result += a[i];
+    return result;
+}
+
+double min(const double* a, size_t n) { return *std::min_element(a, a + n); }
+double max(const double* a, size_t n) { return *std::max_element(a, a + n); }
+
+void add(const double* a, const double* b, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] + b[i];
+}
+void sub(const double* a, const double* b, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] - b[i];
+}
+void mul(const double* a, const double* b, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] * b[i];
+}
+void div(const double* a, const double* b, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] / b[i];
+}
+void scale(const double* a, double k, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] * k;
+}
+
+void prefixSum(const double* a, double* out, size_t n) {
+    double running = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        running += a[i];
+        out[i] = running;
+    }
+}
+
+const Kernels kKernels = {dot, sumSquares, sum, min, max, add, sub, mul, div, scale, prefixSum};
+
+} // namespace scalar
+
+#ifdef RUMINA_SIMD_X86
+
+// 逐元素运算：向量主循环 + 标量收尾
+#define RUMINA_SIMD_BINARY(attr, name, width, load, store, op, scalar_op) \
+    attr void name(const double* a, const double* b, double* out, size_t n) { \
+        size_t i = 0; \
+        for (; i + width <= n; i += width) store(out + i, op(load(a + i), load(b + i))); \
+        for (; i < n; ++i) out[i] = a[i] scalar_op b[i]; \
+    }
+
+// ---- SSE2（x86-64 的基线指令集，不需要检测）----
+namespace sse2 {
+
+inline double hsum(__m128d v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+double dot(const double* a, const double* b, size_t n) {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    double result = hsum(_mm_add_pd(acc0, acc1));
+    for (; i < n; ++i) result += a[i] * b[i];
+    return result;
+}
+
+double sumSquares(const double* a, size_t n) { return dot(a, a, n); }
+
+double sum(const double* a, size_t n) {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_loadu_pd(a + i));
+        acc1 = _mm_add_pd(acc1, _mm_loadu_pd(a + i + 2));
+    }
+    double result = hsum(_mm_add_pd(acc0, acc1));
+    for (; i < n; ++i) result += a[i];
+    return result;
+}
+
+double min(const double* a, size_t n) {
+    if (n < 2) return a[0];
+    __m128d acc = _mm_loadu_pd(a);
+    size_t i = 2;
+    for (; i + 2 <= n; i += 2) acc = _mm_min_pd(acc, _mm_loadu_pd(a + i));
+    double result = std::min(_mm_cvtsd_f64(acc), _mm_cvtsd_f64(_mm_unpackhi_pd(acc, acc)));
+    for (; i < n; ++i) result = std::min(result, a[i]);
+    return result;
+}
+
+double max(const double* a, size_t n) {
+    if (n < 2) return a[0];
+    __m128d acc = _mm_loadu_pd(a);
+    size_t i = 2;
+    for (; i + 2 <= n; i += 2) acc = _mm_max_pd(acc, _mm_loadu_pd(a + i));
+    double result = std::max(_mm_cvtsd_f64(acc), _mm_cvtsd_f64(_mm_unpackhi_pd(acc, acc)));
+    for (; i < n; ++i) result = std::max(result, a[i]);
+    return result;
+}
+
+RUMINA_SIMD_BINARY(, add, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_add_pd, +)
+RUMINA_SIMD_BINARY(, sub, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_sub_pd, -)
+RUMINA_SIMD_BINARY(, mul, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_mul_pd, *)
+RUMINA_SIMD_BINARY(, div, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_div_pd, /)
+
+void scale(const double* a, double k, double* out, size_t n) {
+    __m128d factor = _mm_set1_pd(k);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(a + i), factor));
+    for (; i < n; ++i) out[i] = a[i] * k;
+}
+
+// 每两个元素做一次寄存器内扫描，再加上之前的累计值
+void prefixSum(const double* a, double* out, size_t n) {
+    __m128d carry = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d x = _mm_loadu_pd(a + i);                        // [a0, a1]
+        x = _mm_add_pd(x, _mm_unpacklo_pd(_mm_setzero_pd(), x));  // [a0, a0 + a1]
+        x = _mm_add_pd(x, carry);
+        _mm_storeu_pd(out + i, x);
+        carry = _mm_unpackhi_pd(x, x);
+    }
+    double running = _mm_cvtsd_f64(carry);
+    for (; i < n; ++i) {
+        running += a[i];
+        out[i] = running;
+    }
+}
+
+const Kernels kKernels = {dot, sumSquares, sum, min, max, add, sub, mul, div, scale, prefixSum};
+
+} // namespace sse2
+
+// ---- AVX2（函数级 target 属性，整个程序不需要 -mavx2）----
+namespace avx2 {
+
+#define RUMINA_AVX2 __attribute__((target("avx2")))
+
+RUMINA_AVX2 inline double hsum(__m256d v) {
+    __m128d lo = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+RUMINA_AVX2 double dot(const double* a, const double* b, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    double result = hsum(_mm256_add_pd(acc0, acc1));
+    for (; i < n; ++i) result += a[i] * b[i];
+    return result;
+}
+
+RUMINA_AVX2 double sumSquares(const double* a, size_t n) { return dot(a, a, n); }
+
+RUMINA_AVX2 double sum(const double* a, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(a + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(a + i + 4));
+    }
+    double result = hsum(_mm256_add_pd(acc0, acc1));
+    for (; i < n; ++i) result += a[i];
+    return result;
+}
+
+RUMINA_AVX2 double min(const double* a, size_t n) {
+    if (n < 4) return scalar::min(a, n);
+    __m256d acc = _mm256_loadu_pd(a);
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) acc = _mm256_min_pd(acc, _mm256_loadu_pd(a + i));
+    __m128d half = _mm_min_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    double result = std::min(_mm_cvtsd_f64(half), _mm_cvtsd_f64(_mm_unpackhi_pd(half, half)));
+    for (; i < n; ++i) result = std::min(result, a[i]);
+    return result;
+}
+
+RUMINA_AVX2 double max(const double* a, size_t n) {
+    if (n < 4) return scalar::max(a, n);
+    __m256d acc = _mm256_loadu_pd(a);
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) acc = _mm256_max_pd(acc, _mm256_loadu_pd(a + i));
+    __m128d half = _mm_max_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    double result = std::max(_mm_cvtsd_f64(half), _mm_cvtsd_f64(_mm_unpackhi_pd(half, half)));
+    for (; i < n; ++i) result = std::max(result, a[i]);
+    return result;
+}
+
+RUMINA_SIMD_BINARY(RUMINA_AVX2, add, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd, +)
+RUMINA_SIMD_BINARY(RUMINA_AVX2, sub, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_sub_pd, -)
+RUMINA_SIMD_BINARY(RUMINA_AVX2, mul, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_mul_pd, *)
+RUMINA_SIMD_BINARY(RUMINA_AVX2, div, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_div_pd, /)
+
+RUMINA_AVX2 void scale(const double* a, double k, double* out, size_t n) {
+    __m256d factor = _mm256_set1_pd(k);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), factor));
+    for (; i < n; ++i) out[i] = a[i] * k;
+}
+
+// 每四个元素做两轮移位相加得到块内前缀和，再广播上一块的末尾作为进位
+RUMINA_AVX2 void prefixSum(const double* a, double* out, size_t n) {
+    const __m256d zero = _mm256_setzero_pd();
+    __m256d carry = zero;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(a + i);
+        // [0, x0, x1, x2]
+        x = _mm256_add_pd(x, _mm256_blend_pd(_mm256_permute4x64_pd(x, 0x90), zero, 0x1));
+        // [0, 0, x0, x1]
+        x = _mm256_add_pd(x, _mm256_blend_pd(_mm256_permute4x64_pd(x, 0x40), zero, 0x3));
+        x = _mm256_add_pd(x, carry);
+        _mm256_storeu_pd(out + i, x);
+        carry = _mm256_permute4x64_pd(x, 0xFF);
+    }
+    double running = _mm_cvtsd_f64(_mm256_castpd256_pd128(carry));
+    for (; i < n; ++i) {
+        running += a[i];
+        out[i] = running;
+    }
+}
+
+#undef RUMINA_AVX2
+
+const Kernels kKernels = {dot, sumSquares, sum, min, max, add, sub, mul, div, scale, prefixSum};
+
+} // namespace avx2
+
+#undef RUMINA_SIMD_BINARY
+
+#endif // RUMINA_SIMD_X86
+
+Level detect() {
+#ifdef RUMINA_SIMD_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? Level::AVX2 : Level::SSE2;
+#else
+    return Level::Scalar;
+#endif
+}
+
+Level detected() {
+    static const Level supported = detect();
+    return supported;
+}
+
+std::atomic<Level>& current() {
+    static std::atomic<Level> active{detected()};
+    return active;
+}
+
+const Kernels& kernels() {
+    switch (current().load(std::memory_order_relaxed)) {
+#ifdef RUMINA_SIMD_X86
+        case Level::AVX2: return avx2::kKernels;
+        case Level::SSE2: return sse2::kKernels;
+#endif
+        default: return scalar::kKernels;
+    }
+}
+
+} // namespace
+
+Level level() {
+    return current().load(std::memory_order_relaxed);
+}
+
+const char* levelName(Level level) {
+    switch (level) {
+        case Level::AVX2: return "avx2";
+        case Level::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+Level setLevel(Level level) {
+    Level effective = std::min(level, detected());
+    current().store(effective, std::memory_order_relaxed);
+    return effective;
+}
+
+double dot(const double* a, const double* b, size_t n) { return kernels().dot(a, b, n); }
+double sumSquares(const double* a, size_t n) { return kernels().sumSquares(a, n); }
+double sum(const double* a, size_t n) { return kernels().sum(a, n); }
+double min(const double* a, size_t n) { return kernels().min(a, n); }
+double max(const double* a, size_t n) { return kernels().max(a, n); }
+
+void add(const double* a, const double* b, double* out, size_t n) { kernels().add(a, b, out, n); }
+void sub(const double* a, const double* b, double* out, size_t n) { kernels().sub(a, b, out, n); }
+void mul(const double* a, const double* b, double* out, size_t n) { kernels().mul(a, b, out, n); }
+void div(const double* a, const double* b, double* out, size_t n) { kernels().div(a, b, out, n); }
+void scale(const double* a, double k, double* out, size_t n) { kernels().scale(a, k, out, n); }
+void prefixSum(const double* a, double* out, size_t n) { kernels().prefixSum(a, out, n); }
+
+} // namespace simd
+} // namespace rumina
@@ -0,0 +1,204 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+namespace rumina {
+
+namespace {
+
+// 当前线程所属的池和编号
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_index = 0;
+
+std::atomic<size_t> shared_threads{0};
+std::atomic<bool> shared_created{false};
+
+size_t default_threads() {
+    if (size_t configured = shared_threads.load()) return configured;
+    if (const char* env = std::getenv("RUMINA_THREADS")) {
+        try {
+            long long threads = std::stoll(env);
+            if (threads > 0) return static_cast<size_t>(threads);
+        } catch (const std::exception&) {
+            // 无法解析时按未设置处理
+        }
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool([] {
+        shared_created = true;
+        return default_threads();
+    }());
+    return pool;
+}
+
+bool ThreadPool::setSharedThreads(size_t threads) {
+    if (shared_created.load()) return false;
+    shared_threads = threads;
+    return true;
+}
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) threads = 1;
+    for (size_t i = 0; i <= threads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::currentIndex() const {
+    return current_pool == this ? current_index : size();
+}
+
+SchedulerStats ThreadPool::stats() const {
+    SchedulerStats stats;
+    stats.threads = size();
+    stats.queued = pending_.load(std::memory_order_relaxed);
+    stats.submitted = submitted_.load(std::memory_order_relaxed);
+    stats.completed = completed_.load(std::memory_order_relaxed);
+    stats.steals = steals_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ThreadPool::submit(Task task) {
+    // 先计数再入队：被唤醒的线程最多空转一下，不会错过任务
+    pending_.fetch_add(1, std::memory_order_acq_rel);
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    Queue& queue = *queues_[currentIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    // 经过一次 mutex_，正在判断是否休眠的线程一定能看到新的计数
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    wake_.notify_one();
+}
+
+bool ThreadPool::take(size_t self, Task& task) {
+    if (pending_.load(std::memory_order_acquire) == 0) return false;
+
+    const size_t inject = workers_.size();
+    if (self < inject) {
+        Queue& own = *queues_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pending_.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+    // 先取注入队列，再从下一个线程开始轮流窃取
+    if (popFront(*queues_[inject], task)) return true;
+    for (size_t k = 1; k <= inject; ++k) {
+        size_t victim = (self + k) % inject;
+        if (victim != self && popFront(*queues_[victim], task)) {
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::popFront(Queue& queue, Task& task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    pending_.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+void ThreadPool::execute(Task& task) {
+    task();
+    completed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool ThreadPool::runOne() {
+    Task task;
+    if (!take(currentIndex(), task)) return false;
+    execute(task);
+    return true;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    current_pool = this;
+    current_index = index;
+    for (;;) {
+        Task task;
+        if (take(index, task)) {
+            execute(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        if (pending_.load(std::memory_order_acquire) > 0) {
+            // 计数已加、任务还没入队
+            lock.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+        wake_.wait(lock, [this] { return stopping_ || pending_.load(std::memory_order_acquire) > 0; });
+    }
+}
+
+TaskGroup::~TaskGroup() {
+    // 任务引用着调用者的局部变量，析构前必须等它们结束
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    remaining_.fetch_add(1, std::memory_order_acq_rel);
+    pool_.submit([this, task = std::move(task)] {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) error_ = std::current_exception();
+        }
+        // 在锁内减计数：wait() 返回前还要拿一次锁，任务放开锁之前任务组不会被析构
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) done_.notify_all();
+    });
+}
+
+void TaskGroup::wait() {
+    while (remaining_.load(std::memory_order_acquire) > 0) {
+        if (pool_.runOne()) continue;
+        // 剩下的任务都在别的线程上执行，短暂休眠后再看有没有新任务可以帮忙
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait_for(lock, std::chrono::milliseconds(1),
+                       [this] { return remaining_.load(std::memory_order_acquire) == 0; });
+    }
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(error, error_);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+} // namespace rumina
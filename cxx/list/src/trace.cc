@@ -0,0 +1,596 @@
+#include "trace.h"
+#include "vm.h"
+
+#include <map>
+#include <optional>
+#include <utility>
+
+namespace rumina {
+
+namespace {
+
+// trace 指令：寄存器里是拆箱后的 Int（Bool 存为 0 / 1）
+enum class TraceOp : uint8_t {
+    Mov, Add, Sub, Mul, Mod, Neg,
+    Eq, Neq, Lt, Lte, Gt, Gte,
+    Not, And, Or,
+    GuardTrue,     // a 为假时从 exit 退出
+    GuardFalse,    // a 为真时从 exit 退出
+    GuardDivisor   // a 为 0 或 -1 时从 exit 退出（交给解释器报错或处理溢出）
+};
+
+struct TraceIns {
+    TraceOp op;
+    uint16_t dst;
+    uint16_t a;
+    uint16_t b;
+    uint32_t exit;
+};
+
+// 加减乘按补码回绕，与解释器的整数运算一致
+inline int64_t wrapAdd(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+inline int64_t wrapSub(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+}
+inline int64_t wrapMul(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+}
+
+bool isTraceable(Value::Type type) {
+    return type == Value::Type::Int || type == Value::Type::Bool;
+}
+
+int64_t unbox(const Value& value) {
+    return value.getType() == Value::Type::Bool ? (value.getBool() ? 1 : 0) : value.getInt();
+}
+
+Value box(int64_t raw, Value::Type type) {
+    return type == Value::Type::Bool ? Value(raw != 0) : Value(raw);
+}
+
+} // namespace
+
+// trace 涉及的变量：局部变量槽位或全局槽位，整个 trace 中类型不变
+struct TraceVar {
+    bool global;
+    uint32_t index;
+    uint16_t reg;
+    Value::Type type;
+    bool loaded_at_entry;       // 先读后写：进入时读取并检查类型
+    bool stored = false;
+    size_t first_store = 0;     // 第一次写入的指令位置
+};
+
+// 退出点：恢复执行的字节码位置和需要压回操作数栈的值
+struct TraceExit {
+    size_t ip;
+    size_t position;            // 守卫在 trace 指令中的位置
+    std::vector<std::pair<uint16_t, Value::Type>> stack;
+};
+
+struct Tracer::Trace {
+    std::vector<TraceIns> code;
+    std::vector<TraceVar> vars;
+    std::vector<std::pair<uint16_t, int64_t>> constants;  // 进入时写入的常量寄存器
+    std::vector<TraceExit> exits;
+    std::vector<int64_t> regs;
+    bool uses_globals = false;
+};
+
+struct Tracer::Loop {
+    uint32_t attempts = 0;
+    std::unique_ptr<Trace> trace;
+};
+
+// 录制一次迭代：符号栈记录每个操作数来自哪个寄存器或常量
+class Tracer::Recorder {
+public:
+    Recorder(VM& vm, size_t base_depth) : vm_(vm), base_depth_(base_depth) {}
+
+    // 因前面已有相同守卫而省掉的守卫数
+    size_t removedGuards() const { return removed_guards_; }
+
+    // 在解释器执行 op 之前观察操作数并生成 trace 指令，不支持时返回 false
+    bool observe(const Instruction& op, size_t ip) {
+        switch (op.type) {
+            case OpCodeType::PushConst:
+            case OpCodeType::PushConstPooled: {
+                const auto& constants = vm_.bytecode_.getConstants();
+                if (op.operand >= constants.size()) return false;
+                const Value& constant = constants[op.operand];
+                if (!isTraceable(constant.getType())) return false;
+                stack_.push_back(Ref::constant(unbox(constant), constant.getType()));
+                return true;
+            }
+            case OpCodeType::LoadLocal: {
+                const LocalSlot& slot = vm_.slots_[vm_.slot_base_ + op.operand];
+                if (!slot.assigned) return false;
+                return load(false, op.operand, slot.value);
+            }
+            case OpCodeType::LoadGlobal: {
+                if (!vm_.locals_.empty()) return false;
+                const Value* value = vm_.global_table_.get(op.operand);
+                if (!value) return false;
+                return load(true, op.operand, *value);
+            }
+            case OpCodeType::StoreLocal:
+                return store(false, op.operand);
+            case OpCodeType::StoreGlobal:
+                if (!vm_.locals_.empty() || vm_.global_table_.isImmutable(op.operand)) return false;
+                return store(true, op.operand);
+            case OpCodeType::Pop:
+                return pop().has_value();
+            case OpCodeType::Dup:
+                if (stack_.empty()) return false;
+                stack_.push_back(stack_.back());
+                return true;
+            case OpCodeType::Add:
+            case OpCodeType::Sub:
+            case OpCodeType::Mul:
+            case OpCodeType::Mod:
+            case OpCodeType::Eq:
+            case OpCodeType::Neq:
+            case OpCodeType::Lt:
+            case OpCodeType::Lte:
+            case OpCodeType::Gt:
+            case OpCodeType::Gte:
+            case OpCodeType::And:
+            case OpCodeType::Or:
+                return binary(op.type, ip);
+            case OpCodeType::Neg:
+            case OpCodeType::Not:
+                return unary(op.type);
+            case OpCodeType::JumpIfFalse:
+            case OpCodeType::JumpIfTrue:
+                return branch(op, ip);
+            default:
+                return false;
+        }
+    }
+
+    // 回到循环头时结束录制，栈不平衡时返回 nullptr
+    std::unique_ptr<Trace> finish() {
+        if (!stack_.empty()) return nullptr;
+        trace_->vars = vars_;
+        for (const auto& [key, reg] : constant_regs_) {
+            trace_->constants.emplace_back(reg, key.second);
+        }
+        trace_->regs.assign(next_reg_, 0);
+        return std::move(trace_);
+    }
+
+private:
+    struct Ref {
+        bool is_const;
+        uint16_t reg;
+        int64_t value;
+        Value::Type type;
+
+        static Ref constant(int64_t value, Value::Type type) { return Ref{true, 0, value, type}; }
+        static Ref inReg(uint16_t reg, Value::Type type) { return Ref{false, reg, 0, type}; }
+    };
+
+    std::optional<Ref> pop() {
+        // 不能消耗进入循环前已在栈上的值
+        if (stack_.empty()) return std::nullopt;
+        Ref ref = stack_.back();
+        stack_.pop_back();
+        return ref;
+    }
+
+    bool newReg(uint16_t& reg, bool temp = false) {
+        if (next_reg_ == UINT16_MAX) return false;
+        reg = next_reg_++;
+        is_temp_.push_back(temp);
+        return true;
+    }
+    bool newTemp(uint16_t& reg) { return newReg(reg, true); }
+
+    // 常量按值分配寄存器，进入 trace 时写入一次
+    uint16_t constReg(const Ref& ref) {
+        auto key = std::make_pair(static_cast<int>(ref.type), ref.value);
+        auto it = constant_regs_.find(key);
+        if (it != constant_regs_.end()) return it->second;
+        uint16_t reg = next_reg_++;
+        is_temp_.push_back(false);
+        constant_regs_.emplace(key, reg);
+        return reg;
+    }
+
+    uint16_t regOf(const Ref& ref) { return ref.is_const ? constReg(ref) : ref.reg; }
+
+    TraceVar* findVar(bool global, uint32_t index) {
+        for (TraceVar& var : vars_) {
+            if (var.global == global && var.index == index) return &var;
+        }
+        return nullptr;
+    }
+
+    bool load(bool global, uint32_t index, const Value& value) {
+        if (!isTraceable(value.getType())) return false;
+        TraceVar* var = findVar(global, index);
+        if (!var) {
+            uint16_t reg;
+            if (!newReg(reg)) return false;
+            vars_.push_back(TraceVar{global, index, reg, value.getType(), true});
+            var = &vars_.back();
+            trace_->uses_globals |= global;
+        }
+        if (var->type != value.getType()) return false;
+        stack_.push_back(Ref::inReg(var->reg, var->type));
+        return true;
+    }
+
+    bool store(bool global, uint32_t index) {
+        auto value = pop();
+        if (!value) return false;
+        TraceVar* var = findVar(global, index);
+        if (!var) {
+            uint16_t reg;
+            if (!newReg(reg)) return false;
+            vars_.push_back(TraceVar{global, index, reg, value->type, false});
+            var = &vars_.back();
+            trace_->uses_globals |= global;
+        }
+        // 变量类型在 trace 中保持不变，退出时才能按同一类型装箱
+        if (var->type != value->type) return false;
+
+        // 栈上仍引用旧值的位置先复制出来，之后才能覆盖变量寄存器
+        bool aliased = false;
+        for (Ref& ref : stack_) {
+            if (!ref.is_const && ref.reg == var->reg) {
+                uint16_t copy;
+                if (!newTemp(copy)) return false;
+                emit(TraceOp::Mov, copy, var->reg, 0);
+                ref.reg = copy;
+                aliased = true;
+            }
+        }
+
+        auto& code = trace_->code;
+        if (!aliased && !value->is_const && is_temp_[value->reg] && !code.empty() &&
+            code.back().dst == value->reg && !isGuard(code.back().op) && !onStack(value->reg)) {
+            // 结果直接写入变量寄存器，省掉一次 Mov
+            code.back().dst = var->reg;
+            define(var->reg);
+        } else {
+            emit(TraceOp::Mov, var->reg, regOf(*value), 0);
+        }
+        if (!var->stored) {
+            var->stored = true;
+            var->first_store = code.size() - 1;
+        }
+        return true;
+    }
+
+    bool onStack(uint16_t reg) const {
+        for (const Ref& ref : stack_) {
+            if (!ref.is_const && ref.reg == reg) return true;
+        }
+        return false;
+    }
+
+    static bool isGuard(TraceOp op) {
+        return op == TraceOp::GuardTrue || op == TraceOp::GuardFalse || op == TraceOp::GuardDivisor;
+    }
+
+    void emit(TraceOp op, uint16_t dst, uint16_t a, uint16_t b, uint32_t exit = 0) {
+        trace_->code.push_back(TraceIns{op, dst, a, b, exit});
+        if (!isGuard(op)) define(dst);
+    }
+
+    // 寄存器被重新写入，之前对它成立的守卫不再有效
+    void define(uint16_t reg) {
+        if (reg < guarded_.size()) guarded_[reg] = 0;
+    }
+
+    // trace 是线性的：寄存器通过某个守卫后、再次写入之前，同样的守卫必然成立，
+    // 可以不再生成。返回 true 表示需要生成守卫
+    bool needsGuard(TraceOp op, uint16_t reg) {
+        uint8_t bit = op == TraceOp::GuardTrue ? 1 : op == TraceOp::GuardFalse ? 2 : 4;
+        if (guarded_.size() <= reg) guarded_.resize(reg + 1, 0);
+        if (guarded_[reg] & bit) {
+            removed_guards_++;
+            return false;
+        }
+        guarded_[reg] |= bit;
+        return true;
+    }
+
+    // 记录退出快照：从 ip 继续，栈上依次是当前符号栈的值
+    uint32_t snapshot(size_t ip) {
+        TraceExit exit;
+        exit.ip = ip;
+        exit.position = trace_->code.size();
+        for (const Ref& ref : stack_) {
+            exit.stack.emplace_back(regOf(ref), ref.type);
+        }
+        trace_->exits.push_back(std::move(exit));
+        return static_cast<uint32_t>(trace_->exits.size() - 1);
+    }
+
+    bool binary(OpCodeType type, size_t ip) {
+        if (stack_.size() < 2) return false;
+        Ref rhs = stack_[stack_.size() - 1];
+        Ref lhs = stack_[stack_.size() - 2];
+
+        Value::Type operand_type = Value::Type::Int;
+        Value::Type result_type = Value::Type::Int;
+        TraceOp op = TraceOp::Add;
+        switch (type) {
+            case OpCodeType::Add: op = TraceOp::Add; break;
+            case OpCodeType::Sub: op = TraceOp::Sub; break;
+            case OpCodeType::Mul: op = TraceOp::Mul; break;
+            case OpCodeType::Mod: op = TraceOp::Mod; break;
+            case OpCodeType::Lt: op = TraceOp::Lt; result_type = Value::Type::Bool; break;
+            case OpCodeType::Lte: op = TraceOp::Lte; result_type = Value::Type::Bool; break;
+            case OpCodeType::Gt: op = TraceOp::Gt; result_type = Value::Type::Bool; break;
+            case OpCodeType::Gte: op = TraceOp::Gte; result_type = Value::Type::Bool; break;
+            case OpCodeType::Eq:
+            case OpCodeType::Neq:
+                // Int 之间或 Bool 之间比较
+                op = type == OpCodeType::Eq ? TraceOp::Eq : TraceOp::Neq;
+                operand_type = lhs.type;
+                result_type = Value::Type::Bool;
+                break;
+            case OpCodeType::And:
+            case OpCodeType::Or:
+                op = type == OpCodeType::And ? TraceOp::And : TraceOp::Or;
+                operand_type = Value::Type::Bool;
+                result_type = Value::Type::Bool;
+                break;
+            default:
+                return false;
+        }
+        if (lhs.type != operand_type || rhs.type != operand_type) return false;
+
+        if (op == TraceOp::Mod) {
+            if (rhs.is_const && (rhs.value == 0 || rhs.value == -1)) return false;
+            if (!rhs.is_const && needsGuard(TraceOp::GuardDivisor, rhs.reg)) {
+                // 守卫在弹出操作数之前，退出后由解释器重新执行这条 Mod
+                emit(TraceOp::GuardDivisor, 0, rhs.reg, 0, snapshot(ip));
+            }
+        }
+
+        stack_.pop_back();
+        stack_.pop_back();
+        if (lhs.is_const && rhs.is_const) {
+            // 常量折叠
+            stack_.push_back(Ref::constant(fold(op, lhs.value, rhs.value), result_type));
+            return true;
+        }
+        uint16_t dst;
+        if (!newTemp(dst)) return false;
+        emit(op, dst, regOf(lhs), regOf(rhs));
+        stack_.push_back(Ref::inReg(dst, result_type));
+        return true;
+    }
+
+    bool unary(OpCodeType type) {
+        auto operand = pop();
+        if (!operand) return false;
+        TraceOp op = type == OpCodeType::Neg ? TraceOp::Neg : TraceOp::Not;
+        Value::Type expected = op == TraceOp::Neg ? Value::Type::Int : Value::Type::Bool;
+        if (operand->type != expected) return false;
+        if (operand->is_const) {
+            stack_.push_back(Ref::constant(fold(op, operand->value, 0), expected));
+            return true;
+        }
+        uint16_t dst;
+        if (!newTemp(dst)) return false;
+        emit(op, dst, operand->reg, 0);
+        stack_.push_back(Ref::inReg(dst, expected));
+        return true;
+    }
+
+    // 按本次实际走向录制，另一方向成为守卫的退出点；常量条件不需要守卫
+    bool branch(const Instruction& op, size_t ip) {
+        if (vm_.stack_.size() <= base_depth_) return false;
+        auto cond = pop();
+        if (!cond) return false;
+        bool truthy = vm_.stack_.back().isTruthy();
+        bool jumps = op.type == OpCodeType::JumpIfFalse ? !truthy : truthy;
+        if (cond->is_const) return true;
+        TraceOp guard = truthy ? TraceOp::GuardTrue : TraceOp::GuardFalse;
+        if (!needsGuard(guard, cond->reg)) return true;
+        size_t other = jumps ? ip + 1 : op.operand;
+        emit(guard, 0, cond->reg, 0, snapshot(other));
+        return true;
+    }
+
+    static int64_t fold(TraceOp op, int64_t a, int64_t b) {
+        switch (op) {
+            case TraceOp::Add: return wrapAdd(a, b);
+            case TraceOp::Sub: return wrapSub(a, b);
+            case TraceOp::Mul: return wrapMul(a, b);
+            case TraceOp::Mod: return a % b;
+            case TraceOp::Neg: return wrapSub(0, a);
+            case TraceOp::Eq: return a == b;
+            case TraceOp::Neq: return a != b;
+            case TraceOp::Lt: return a < b;
+            case TraceOp::Lte: return a <= b;
+            case TraceOp::Gt: return a > b;
+            case TraceOp::Gte: return a >= b;
+            case TraceOp::Not: return !a;
+            case TraceOp::And: return a && b;
+            case TraceOp::Or: return a || b;
+            default: return 0;
+        }
+    }
+
+    VM& vm_;
+    size_t base_depth_;
+    std::unique_ptr<Trace> trace_ = std::make_unique<Trace>();
+    std::vector<Ref> stack_;
+    std::vector<TraceVar> vars_;
+    std::map<std::pair<int, int64_t>, uint16_t> constant_regs_;
+    uint16_t next_reg_ = 0;
+    std::vector<bool> is_temp_;  // 只被一条指令定义、只被使用一次的临时寄存器
+    std::vector<uint8_t> guarded_;  // 每个寄存器已通过的守卫：1 GuardTrue、2 GuardFalse、4 GuardDivisor
+    size_t removed_guards_ = 0;
+};
+
+Tracer::Tracer(VM& vm) : vm_(vm) {}
+
+Tracer::~Tracer() = default;
+
+void Tracer::reset() {
+    loops_.clear();
+    countdown_.clear();
+}
+
+bool Tracer::onBackEdge(size_t header) {
+    if (loops_.size() <= header) {
+        // 第一次回跳只分配计数，本次算作第一次
+        size_t size = vm_.bytecode_.getInstructions().size();
+        if (header >= size) return true;
+        loops_.resize(size);
+        countdown_.resize(size, kHotLoop - 1);
+        return true;
+    }
+    Loop& loop = loops_[header];
+    bool ok = true;
+    if (loop.trace) {
+        run(*loop.trace);
+    } else if (loop.attempts < kMaxAttempts) {
+        loop.attempts++;
+        ok = record(loop, header);
+    }
+    // 有 trace 的循环每次回跳都进入；放弃录制的循环不再回到这里
+    countdown_[header] = loop.trace ? 0 : loop.attempts < kMaxAttempts ? kHotLoop : UINT32_MAX;
+    return ok;
+}
+
+// 在解释器逐条执行一次迭代的同时录制；中止时解释器从当前位置照常继续。
+// 同一条指令第二次出现说明路径上还有内层循环，这种迭代不录制
+bool Tracer::record(Loop& loop, size_t header) {
+    const auto& code = vm_.bytecode_.getInstructions();
+    Recorder recorder(vm_, vm_.stack_.size());
+    std::vector<bool> visited(code.size(), false);
+    size_t ip = header;
+    for (size_t length = 0;; ++length) {
+        if (length >= kMaxTraceLength || ip >= code.size() || visited[ip]) {
+            stats_.aborted++;
+            return true;
+        }
+        visited[ip] = true;
+        Instruction op = code[ip];
+        // 已编译函数里的循环由本地代码的回跳交过来，入口指令按原指令录制
+        if (op.type == OpCodeType::JitEntry && vm_.jit_) op.type = vm_.jit_->originalOpCode(ip);
+        op.type = genericOpCode(fusedHeadOpCode(op.type));
+        if (op.type == OpCodeType::Jump) {
+            // 跳转本身不产生 trace 指令；不经过 executeInstruction 以免再次触发回跳计数
+            ip = op.operand;
+            vm_.ip_ = ip;
+            if (ip == header) break;
+            continue;
+        }
+        if (!recorder.observe(op, ip)) {
+            stats_.aborted++;
+            return true;
+        }
+        vm_.ip_ = ip + 1;
+        if (!vm_.executeInstruction(op, ip)) {
+            vm_.recordFault(ip);
+            return false;
+        }
+        ip = vm_.ip_;
+        if (ip == header) break;
+    }
+
+    auto trace = recorder.finish();
+    if (!trace) {
+        stats_.aborted++;
+        return true;
+    }
+    loop.trace = std::move(trace);
+    stats_.recorded++;
+    stats_.guards_removed += recorder.removedGuards();
+    return true;
+}
+
+void Tracer::run(Trace& trace) {
+    if (trace.uses_globals && !vm_.locals_.empty()) return;
+    int64_t* regs = trace.regs.data();
+
+    // 进入守卫：先读后写的变量必须仍是录制时的类型
+    for (const TraceVar& var : trace.vars) {
+        if (!var.loaded_at_entry) continue;
+        const Value* value;
+        if (var.global) {
+            value = vm_.global_table_.get(var.index);
+        } else {
+            const LocalSlot& slot = vm_.slots_[vm_.slot_base_ + var.index];
+            value = slot.assigned ? &slot.value : nullptr;
+        }
+        if (!value || value->getType() != var.type) return;
+        regs[var.reg] = unbox(*value);
+    }
+    for (const auto& [reg, value] : trace.constants) {
+        regs[reg] = value;
+    }
+    stats_.entries++;
+
+    const TraceIns* begin = trace.code.data();
+    const TraceIns* end = begin + trace.code.size();
+    uint32_t exit_index = 0;
+    bool first_iteration = true;
+    for (;;) {
+        for (const TraceIns* ins = begin; ins != end; ++ins) {
+            int64_t a = regs[ins->a];
+            int64_t b = regs[ins->b];
+            switch (ins->op) {
+                case TraceOp::Mov: regs[ins->dst] = a; break;
+                case TraceOp::Add: regs[ins->dst] = wrapAdd(a, b); break;
+                case TraceOp::Sub: regs[ins->dst] = wrapSub(a, b); break;
+                case TraceOp::Mul: regs[ins->dst] = wrapMul(a, b); break;
+                case TraceOp::Mod: regs[ins->dst] = a % b; break;
+                case TraceOp::Neg: regs[ins->dst] = wrapSub(0, a); break;
+                case TraceOp::Eq: regs[ins->dst] = a == b; break;
+                case TraceOp::Neq: regs[ins->dst] = a != b; break;
+                case TraceOp::Lt: regs[ins->dst] = a < b; break;
+                case TraceOp::Lte: regs[ins->dst] = a <= b; break;
+                case TraceOp::Gt: regs[ins->dst] = a > b; break;
+                case TraceOp::Gte: regs[ins->dst] = a >= b; break;
+                case TraceOp::Not: regs[ins->dst] = !a; break;
+                case TraceOp::And: regs[ins->dst] = a && b; break;
+                case TraceOp::Or: regs[ins->dst] = a || b; break;
+                case TraceOp::GuardTrue:
+                    if (!a) { exit_index = ins->exit; goto leave; }
+                    break;
+                case TraceOp::GuardFalse:
+                    if (a) { exit_index = ins->exit; goto leave; }
+                    break;
+                case TraceOp::GuardDivisor:
+                    if (a == 0 || a == -1) { exit_index = ins->exit; goto leave; }
+                    break;
+            }
+        }
+        first_iteration = false;
+    }
+
+leave:
+    const TraceExit& exit = trace.exits[exit_index];
+    stats_.side_exits++;
+    // 写回变量：第一次迭代中尚未执行到的写入不能写回
+    for (const TraceVar& var : trace.vars) {
+        if (!var.stored) continue;
+        if (!var.loaded_at_entry && first_iteration && var.first_store >= exit.position) continue;
+        Value value = box(regs[var.reg], var.type);
+        if (var.global) {
+            vm_.global_table_.set(var.index, value);
+        } else {
+            LocalSlot& slot = vm_.slots_[vm_.slot_base_ + var.index];
+            slot.value = std::move(value);
+            slot.assigned = true;
+        }
+    }
+    for (const auto& [reg, type] : exit.stack) {
+        vm_.stack_.push_back(box(regs[reg], type));
+    }
+    vm_.ip_ = exit.ip;
+}
+
+} // namespace rumina
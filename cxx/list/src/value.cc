@@ -1,9 +1,11 @@
 #include <value.h>
 #include <ast.h>
+#include <cycle_collector.h>
 
 #include <sstream>
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
 
 namespace rumina {
 
@@ -53,6 +55,223 @@ IrrationalValue IrrationalValue::makeSum(std::shared_ptr<IrrationalValue> left,
     return result;
 }
 
+// 字符串单元
+namespace detail {
+
+StringCell::StringCell(std::string text) : text_(std::move(text)), view_(text_) {}
+
+StringCell::StringCell(StringCell* base, size_t offset, size_t length)
+    : view_(std::string_view(base->text_).substr(offset, length)), base_(base) {
+    base_->retain();
+}
+
+StringCell::~StringCell() {
+    if (base_) base_->release();
+}
+
+StringCell* StringCell::makeBuffer(std::string_view head, std::string_view tail,
+                                   size_t capacity) {
+    StringCell* cell = new StringCell();
+    cell->buffer_ = true;
+    cell->text_.reserve(std::max(capacity, head.size() + tail.size()));
+    cell->text_.append(head).append(tail);
+    return cell;
+}
+
+bool StringCell::tryAppend(std::string_view view, std::string_view tail) {
+    // 跨线程共享的缓冲可能被另一个线程同时追加，不原地修改
+    if (!buffer_ || shared) return false;
+    if (view.data() + view.size() != text_.data() + text_.size()) return false;
+    if (text_.capacity() - text_.size() < tail.size()) return false;
+    text_.append(tail);  // 容量足够，不会重新分配，已有切片的字节不动
+    return true;
+}
+
+const std::string& StringCell::str() const {
+    if (base_) {
+        std::call_once(flatten_, [this] { text_.assign(view_); });
+    }
+    return text_;
+}
+
+size_t StringCell::hash() const {
+    size_t h = hash_.load(std::memory_order_relaxed);
+    if (h == 0) {
+        h = std::hash<std::string_view>()(view_) | 1;
+        hash_.store(h, std::memory_order_relaxed);
+    }
+    return h;
+}
+
+} // namespace detail
+
+// 比这更短的子串直接复制（落在 std::string 的内联缓冲里），不值得持有底层字符串
+static constexpr size_t kMinSliceLength = 16;
+
+Value Value::makeSlice(const Value& s, size_t offset, size_t length) {
+    const detail::StringCell* cell = s.stringCell();
+    if (offset == 0 && length == cell->view().size()) return s;
+    if (length == 1) return makeChar(static_cast<unsigned char>(cell->view()[offset]));
+    if (length < kMinSliceLength) return Value(cell->view().substr(offset, length));
+    
+    // 切片的切片直接指向最底层的平坦单元或构建缓冲
+    detail::StringCell* base = const_cast<detail::StringCell*>(cell);
+    if (base->base()) {
+        base = base->base();
+        offset += cell->offsetIn(base);
+    }
+    return fromStringCell(new detail::StringCell(base, offset, length));
+}
+
+// 结果短于此长度时直接拼成普通字符串
+static constexpr size_t kMinBufferLength = 64;
+
+Value Value::appendString(const Value& s, std::string_view tail) {
+    const detail::StringCell* cell = s.stringCell();
+    std::string_view head = cell->view();
+    size_t length = head.size() + tail.size();
+    if (tail.empty()) return s;
+    if (length < kMinBufferLength) {
+        std::string result;
+        result.reserve(length);
+        result.append(head).append(tail);
+        return Value(std::move(result));
+    }
+    
+    detail::StringCell* base = cell->base();
+    if (base && base->tryAppend(head, tail)) {
+        return fromStringCell(new detail::StringCell(base, cell->offsetIn(base), length));
+    }
+    
+    // 换一个容量加倍的新缓冲，复制的总量按几何级数均摊
+    detail::StringCell* buffer = detail::StringCell::makeBuffer(head, tail, length * 2);
+    Value result = fromStringCell(new detail::StringCell(buffer, 0, length));
+    buffer->release();  // 切片持有缓冲
+    return result;
+}
+
+Value Value::makeChar(unsigned char c) {
+    // 所有线程共用，计数必须是原子的；表本身从不释放
+    static detail::StringCell* const* table = [] {
+        auto* cells = new detail::StringCell*[256];
+        for (int i = 0; i < 256; ++i) {
+            cells[i] = new detail::StringCell(std::string(1, static_cast<char>(i)));
+            cells[i]->shared = true;
+        }
+        return cells;
+    }();
+    detail::StringCell* cell = table[c];
+    cell->retain();
+    return fromStringCell(cell);
+}
+
+// Value::makeStruct / makeModule
+Value Value::makeArray(std::vector<Value> elements) {
+    return boxed<ArrayObject>(Type::Array, std::move(elements));
+}
+
+Value Value::makeArray(ArrayObject array) {
+    return boxed<ArrayObject>(Type::Array, std::move(array));
+}
+
+Value Value::makeStruct(StructRef s) {
+    return adopt(Type::Struct, std::move(s));
+}
+
+Value Value::makeModule(StructRef module) {
+    return adopt(Type::Module, std::move(module));
+}
+
+Value Value::makeStruct(const std::shared_ptr<std::unordered_map<std::string, Value>>& s) {
+    return makeStruct(makeRef<StructObject>(*s));
+}
+
+Value Value::makeModule(const std::shared_ptr<std::unordered_map<std::string, Value>>& module) {
+    // 模块成员是内置的固定名字，驻留后模块走共享形状，成员访问可以命中内联缓存
+    for (const auto& entry : *module) {
+        AtomTable::intern(entry.first);
+    }
+    return makeModule(makeRef<StructObject>(*module));
+}
+
+// Value::makeLambda / getLambda（需要完整的 Upvalue 定义）
+Value Value::makeLambda(LambdaData data) {
+    return boxed<LambdaData>(Type::Lambda, std::move(data));
+}
+
+Value::LambdaData Value::getLambda() const {
+    if (type_ != Type::Lambda) throw std::runtime_error("Not a lambda");
+    return payload<LambdaData>();
+}
+
+// Value::share
+static void shareIrrational(const IrrationalValue& irr) {
+    for (const auto& value : {irr.getSqrtValue(), irr.getRootValue(), irr.getProductCoeff()}) {
+        if (value) value->share();
+    }
+    for (const auto& part : {irr.getProductIrr(), irr.getSumLeft(), irr.getSumRight()}) {
+        if (part) shareIrrational(*part);
+    }
+}
+
+void Value::share() const {
+    if (isImmediate(type_) || heap_->shared) return;
+    // 先标记再递归，自引用的数组和结构体不会无限展开
+    heap_->shared = true;
+    switch (type_) {
+        case Type::String:
+            // 切片析构时会释放底层单元，底层单元也要改为原子计数
+            if (detail::StringCell* base = stringCell()->base()) base->shared = true;
+            break;
+        case Type::Array: {
+            // 紧凑数组没有堆上的元素
+            const ArrayObject& array = payload<ArrayObject>();
+            if (array.kind() == ArrayObject::Kind::Generic) {
+                for (const Value& element : array.values()) element.share();
+            }
+            break;
+        }
+        case Type::Struct:
+        case Type::Module:
+            for (const auto& [key, value] : payload<StructObject>()) value.share();
+            break;
+        case Type::Complex: {
+            const auto& [re, im] = payload<ComplexData>();
+            if (re) re->share();
+            if (im) im->share();
+            break;
+        }
+        case Type::Irrational:
+            shareIrrational(payload<IrrationalValue>());
+            break;
+        case Type::Lambda: {
+            const LambdaData& lambda = payload<LambdaData>();
+            for (const Upvalue& upvalue : lambda.upvalues) upvalue.value.share();
+            if (lambda.closure) {
+                for (const auto& [name, value] : *lambda.closure) value.share();
+            }
+            break;
+        }
+        case Type::CurriedFunction: {
+            const CurriedFunctionData& curried = payload<CurriedFunctionData>();
+            if (curried.original) curried.original->share();
+            for (const Value& arg : curried.collected_args) arg.share();
+            break;
+        }
+        case Type::MemoizedFunction: {
+            const MemoizedFunctionData& memoized = payload<MemoizedFunctionData>();
+            if (memoized.original) memoized.original->share();
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+bool Value::isFrozen() const {
+    return !isImmediate(type_) && heap_->shared && CycleCollector::concurrent();
+}
+
 // Value::typeName
 std::string Value::typeName() const {
     switch (type_) {
@@ -151,7 +370,7 @@ bool Value::operator==(const Value& other) const {
         case Type::Bool:
             return getBool() == other.getBool();
         case Type::String:
-            return getString() == other.getString();
+            return heap_ == other.heap_ || getStringView() == other.getStringView();
         case Type::Null:
             return true;
         case Type::Complex: {
@@ -165,6 +384,29 @@ bool Value::operator==(const Value& other) const {
             return getRational() == other.getRational();
         case Type::Irrational:
             return getIrrational() == other.getIrrational();
+        case Type::Array: {
+            const ArrayObject& a = payload<ArrayObject>();
+            const ArrayObject& b = other.payload<ArrayObject>();
+            if (&a == &b) return true;
+            if (a.size() != b.size()) return false;
+            // 整数的文本表示与数值一一对应，两个整数数组可以直接比较
+            if (a.kind() == ArrayObject::Kind::Int64 && b.kind() == ArrayObject::Kind::Int64) {
+                return a.ints() == b.ints();
+            }
+            return toString() == other.toString();
+        }
+        case Type::Struct: {
+            // 字段集合相同即相等，与字段添加顺序无关
+            auto a = getStruct();
+            auto b = other.getStruct();
+            if (a == b) return true;
+            if (a->size() != b->size()) return false;
+            for (const auto& [key, value] : *a) {
+                auto it = b->find(key);
+                if (it == b->end() || !(value == it->second)) return false;
+            }
+            return true;
+        }
         default:
             return toString() == other.toString();
     }
@@ -172,6 +414,10 @@ bool Value::operator==(const Value& other) const {
 
 // Value::toString
 std::string Value::toString() const {
+    if (type_ == Type::String) {
+        return std::string(getStringView());
+    }
+    
     std::ostringstream oss;
 
     switch (type_) {
@@ -254,17 +500,17 @@ std::string Value::toString() const {
             oss << (getBool() ? "true" : "false");
             break;
         case Type::String:
-            oss << getString();
+            oss << getStringView();
             break;
         case Type::Null:
             oss << "null";
             break;
         case Type::Array: {
-            auto arr = getArray();
+            const ArrayObject& arr = payload<ArrayObject>();
             oss << "[";
-            for (size_t i = 0; i < arr->size(); ++i) {
+            for (size_t i = 0; i < arr.size(); ++i) {
                 if (i > 0) oss << ", ";
-                oss << (*arr)[i].toString();
+                oss << arr.get(i).toString();
             }
             oss << "]";
             break;
@@ -1,8 +1,8 @@
 #include <value_ops.h>
 #include <interpreter.h>
+#include <thread_pool.h>
 
 #include <cmath>
-#include <thread>
 #include <vector>
 #include <algorithm>
 
@@ -69,17 +69,16 @@ BigInt bigint_pow_parallel(const BigInt& base, uint32_t exponent) {
         return result;
     }
     
+    // 各块提交到共用调度器；递归产生的子块由等待的线程顺带执行，线程数不会随递归增长
     std::vector<BigInt> chunk_results(num_chunks);
-    std::vector<std::thread> threads;
-    
-    for (int i = 0; i < num_chunks; ++i) {
-        threads.emplace_back([&base, chunk_size, &chunk_results, i]() {
-            chunk_results[i] = bigint_pow_parallel(base, chunk_size);
-        });
-    }
-    
-    for (auto& t : threads) {
-        t.join();
+    {
+        TaskGroup group(ThreadPool::shared());
+        for (int i = 0; i < num_chunks; ++i) {
+            group.run([&base, chunk_size, &chunk_results, i]() {
+                chunk_results[i] = bigint_pow_parallel(base, chunk_size);
+            });
+        }
+        group.wait();
     }
     
     BigInt result = 1;
@@ -174,257 +173,260 @@ Result<Value> compute_power(double base, double exponent) {
 
 // 二进制操作
 Result<Value> value_binary_op(const Value& left, BinOp op, const Value& right) {
-    try {
-        // 整数快速路径
-        if (left.getType() == Value::Type::Int && right.getType() == Value::Type::Int) {
-            int64_t a = left.getInt();
-            int64_t b = right.getInt();
-            
-            switch (op) {
-                case BinOp::Add:
-                    return Ok(Value(static_cast<int64_t>(a + b)));
-                case BinOp::Sub:
-                    return Ok(Value(static_cast<int64_t>(a - b)));
-                case BinOp::Mul:
-                    return Ok(Value(static_cast<int64_t>(a * b)));
-                case BinOp::Div:
-                    if (b == 0) {
-                        return Err<Value>("Division by zero");
-                    }
-                    return Ok(Value(BigRational(static_cast<long>(a), static_cast<long>(b))));
-                case BinOp::Mod:
-                    return Ok(Value(static_cast<int64_t>(a % b)));
-                case BinOp::Pow: {
-                    if (b < 0) {
-                        double result = std::pow(static_cast<double>(a), static_cast<double>(b));
-                        return Ok(Value(result));
+    // 整数快速路径
+    if (left.getType() == Value::Type::Int && right.getType() == Value::Type::Int) {
+        int64_t a = left.getInt();
+        int64_t b = right.getInt();
+        
+        switch (op) {
+            case BinOp::Add:
+                return Ok(Value(static_cast<int64_t>(a + b)));
+            case BinOp::Sub:
+                return Ok(Value(static_cast<int64_t>(a - b)));
+            case BinOp::Mul:
+                return Ok(Value(static_cast<int64_t>(a * b)));
+            case BinOp::Div:
+                if (b == 0) {
+                    return Err<Value>("Division by zero");
+                }
+                return Ok(Value(BigRational(static_cast<long>(a), static_cast<long>(b))));
+            case BinOp::Mod:
+                if (b == 0) {
+                    return Err<Value>("Division by zero");
+                }
+                // INT64_MIN % -1 在 x86 上触发 SIGFPE，余数总是 0
+                if (b == -1) return Ok(Value(int64_t{0}));
+                return Ok(Value(static_cast<int64_t>(a % b)));
+            case BinOp::Pow: {
+                if (b < 0) {
+                    double result = std::pow(static_cast<double>(a), static_cast<double>(b));
+                    return Ok(Value(result));
+                } else {
+                    if (a == 0) return Ok(Value(static_cast<int64_t>(0)));
+                    if (a == 1) return Ok(Value(static_cast<int64_t>(1)));
+                    
+                    double log_result = std::log2(std::abs(static_cast<double>(a))) * b;
+                    if (log_result > 62) {
+                        BigInt a_big = BigInt(static_cast<long>(a));
+                        return Ok(Value(bigint_pow_optimized(a_big, static_cast<uint32_t>(b))));
                     } else {
-                        if (a == 0) return Ok(Value(static_cast<int64_t>(0)));
-                        if (a == 1) return Ok(Value(static_cast<int64_t>(1)));
-                        
-                        double log_result = std::log2(std::abs(static_cast<double>(a))) * b;
-                        if (log_result > 62) {
-                            BigInt a_big = BigInt(static_cast<long>(a));
-                            return Ok(Value(bigint_pow_optimized(a_big, static_cast<uint32_t>(b))));
-                        } else {
-                            int64_t result = 1;
-                            for (int32_t i = 0; i < b; ++i) {
-                                result *= a;
-                            }
-                            return Ok(Value(static_cast<int64_t>(result)));
+                        int64_t result = 1;
+                        for (int32_t i = 0; i < b; ++i) {
+                            result *= a;
                         }
+                        return Ok(Value(static_cast<int64_t>(result)));
                     }
                 }
-                case BinOp::Equal:
-                    return Ok(Value(a == b));
-                case BinOp::NotEqual:
-                    return Ok(Value(a != b));
-                case BinOp::Greater:
-                    return Ok(Value(a > b));
-                case BinOp::GreaterEq:
-                    return Ok(Value(a >= b));
-                case BinOp::Less:
-                    return Ok(Value(a < b));
-                case BinOp::LessEq:
-                    return Ok(Value(a <= b));
-                default:
-                    return Err<Value>("Unsupported operation: int " + std::to_string(static_cast<int>(op)) + " int");
             }
+            case BinOp::Equal:
+                return Ok(Value(a == b));
+            case BinOp::NotEqual:
+                return Ok(Value(a != b));
+            case BinOp::Greater:
+                return Ok(Value(a > b));
+            case BinOp::GreaterEq:
+                return Ok(Value(a >= b));
+            case BinOp::Less:
+                return Ok(Value(a < b));
+            case BinOp::LessEq:
+                return Ok(Value(a <= b));
+            default:
+                return Err<Value>("Unsupported operation: int " + std::to_string(static_cast<int>(op)) + " int");
         }
-        
-        // BigInt 快速路径
-        if (left.getType() == Value::Type::BigInt && right.getType() == Value::Type::BigInt) {
-            const BigInt& a = left.getBigInt();
-            const BigInt& b = right.getBigInt();
-            switch (op) {
-                case BinOp::Add:
-                    return Ok(Value(static_cast<const BigInt&>(a + b)));
-                case BinOp::Sub:
-                    return Ok(Value(static_cast<const BigInt&>(a - b)));
-                case BinOp::Mul:
-                    return Ok(Value(static_cast<const BigInt&>(a * b)));
-            /*
-                case BinOp::Add:
-                    return Ok(Value(a + b));
-                case BinOp::Sub:
-                    return Ok(Value(a - b));
-                case BinOp::Mul:
-                    return Ok(Value(a * b));
-            */
-                case BinOp::Div:
-                    if (b == 0) {
-                        return Err<Value>("Division by zero");
-                    }
-                    return Ok(Value(BigRational(a, b)));
-                case BinOp::Mod:
-                    if (b == 0) {
-                        return Err<Value>("Division by zero");
-                    }
-                    return Ok(Value(static_cast<const BigInt&>(a % b)));
-            /*
-                case BinOp::Mod:
-                    if (b == 0) {
-                        return Err<Value>("Division by zero");
-                    }
-                    return Ok(Value(a % b));
-            */
-                case BinOp::Pow: {
-                    if (b.fits_uint_p()) {
-                        unsigned long exp = b.get_ui();
-                        if (exp <= std::numeric_limits<uint32_t>::max()) {
-                            return Ok(Value(bigint_pow_optimized(a, static_cast<uint32_t>(exp))));
-                        }
+    }
+    
+    // BigInt 快速路径
+    if (left.getType() == Value::Type::BigInt && right.getType() == Value::Type::BigInt) {
+        const BigInt& a = left.getBigInt();
+        const BigInt& b = right.getBigInt();
+        switch (op) {
+            case BinOp::Add:
+                return Ok(Value(static_cast<const BigInt&>(a + b)));
+            case BinOp::Sub:
+                return Ok(Value(static_cast<const BigInt&>(a - b)));
+            case BinOp::Mul:
+                return Ok(Value(static_cast<const BigInt&>(a * b)));
+        /*
+            case BinOp::Add:
+                return Ok(Value(a + b));
+            case BinOp::Sub:
+                return Ok(Value(a - b));
+            case BinOp::Mul:
+                return Ok(Value(a * b));
+        */
+            case BinOp::Div:
+                if (b == 0) {
+                    return Err<Value>("Division by zero");
+                }
+                return Ok(Value(BigRational(a, b)));
+            case BinOp::Mod:
+                if (b == 0) {
+                    return Err<Value>("Division by zero");
+                }
+                return Ok(Value(static_cast<const BigInt&>(a % b)));
+        /*
+            case BinOp::Mod:
+                if (b == 0) {
+                    return Err<Value>("Division by zero");
+                }
+                return Ok(Value(a % b));
+        */
+            case BinOp::Pow: {
+                if (b.fits_uint_p()) {
+                    unsigned long exp = b.get_ui();
+                    if (exp <= std::numeric_limits<uint32_t>::max()) {
+                        return Ok(Value(bigint_pow_optimized(a, static_cast<uint32_t>(exp))));
                     }
-                    double a_float = a.get_d();
-                    double b_float = b.get_d();
-                    return Ok(Value(std::pow(a_float, b_float)));
                 }
-                case BinOp::Equal:
-                    return Ok(Value(a == b));
-                case BinOp::NotEqual:
-                    return Ok(Value(a != b));
-                case BinOp::Greater:
-                    return Ok(Value(a > b));
-                case BinOp::GreaterEq:
-                    return Ok(Value(a >= b));
-                case BinOp::Less:
-                    return Ok(Value(a < b));
-                case BinOp::LessEq:
-                    return Ok(Value(a <= b));
-                default:
-                    return Err<Value>("Unsupported operation: bigint " + std::to_string(static_cast<int>(op)) + " bigint");
+                double a_float = a.get_d();
+                double b_float = b.get_d();
+                return Ok(Value(std::pow(a_float, b_float)));
             }
+            case BinOp::Equal:
+                return Ok(Value(a == b));
+            case BinOp::NotEqual:
+                return Ok(Value(a != b));
+            case BinOp::Greater:
+                return Ok(Value(a > b));
+            case BinOp::GreaterEq:
+                return Ok(Value(a >= b));
+            case BinOp::Less:
+                return Ok(Value(a < b));
+            case BinOp::LessEq:
+                return Ok(Value(a <= b));
+            default:
+                return Err<Value>("Unsupported operation: bigint " + std::to_string(static_cast<int>(op)) + " bigint");
         }
+    }
+    
+    // 布尔运算快速路径
+    if (left.getType() == Value::Type::Bool && right.getType() == Value::Type::Bool) {
+        bool a = left.getBool();
+        bool b = right.getBool();
         
-        // 布尔运算快速路径
-        if (left.getType() == Value::Type::Bool && right.getType() == Value::Type::Bool) {
-            bool a = left.getBool();
-            bool b = right.getBool();
-            
-            switch (op) {
-                case BinOp::And:
-                    return Ok(Value(a && b));
-                case BinOp::Or:
-                    return Ok(Value(a || b));
-                case BinOp::Equal:
-                    return Ok(Value(a == b));
-                case BinOp::NotEqual:
-                    return Ok(Value(a != b));
-                default:
-                    return Err<Value>("Unsupported operation: bool " + std::to_string(static_cast<int>(op)) + " bool");
-            }
+        switch (op) {
+            case BinOp::And:
+                return Ok(Value(a && b));
+            case BinOp::Or:
+                return Ok(Value(a || b));
+            case BinOp::Equal:
+                return Ok(Value(a == b));
+            case BinOp::NotEqual:
+                return Ok(Value(a != b));
+            default:
+                return Err<Value>("Unsupported operation: bool " + std::to_string(static_cast<int>(op)) + " bool");
         }
-        
-        // Null 比较
-        if (left.getType() == Value::Type::Null && right.getType() == Value::Type::Null) {
-            switch (op) {
-                case BinOp::Equal:
-                    return Ok(Value(true));
-                case BinOp::NotEqual:
-                    return Ok(Value(false));
-                default:
-                    return Err<Value>("Unsupported operation: null " + std::to_string(static_cast<int>(op)) + " null");
-            }
+    }
+    
+    // Null 比较
+    if (left.getType() == Value::Type::Null && right.getType() == Value::Type::Null) {
+        switch (op) {
+            case BinOp::Equal:
+                return Ok(Value(true));
+            case BinOp::NotEqual:
+                return Ok(Value(false));
+            default:
+                return Err<Value>("Unsupported operation: null " + std::to_string(static_cast<int>(op)) + " null");
         }
+    }
 
-        // 字符串與任何類型的連接
-        if (op == BinOp::Add && (left.getType() == Value::Type::String || right.getType() == Value::Type::String)) {
-            // 只要有一方是字符串,就將兩邊都轉換為字符串並連接
-            std::string result = left.toString() + right.toString();
-            return Ok(Value(result));
+    // 字符串與任何類型的連接
+    if (op == BinOp::Add && (left.getType() == Value::Type::String || right.getType() == Value::Type::String)) {
+        // 只要有一方是字符串,就將兩邊都轉換為字符串並連接。
+        // 左邊是字符串時在它的構建緩衝後追加，循環裡 s = s + x 均攤 O(1)
+        if (left.getType() == Value::Type::String) {
+            if (right.getType() == Value::Type::String) {
+                return Ok(Value::appendString(left, right.getStringView()));
+            }
+            return Ok(Value::appendString(left, right.toString()));
         }
-
-        // 字符串操作
-        if (left.getType() == Value::Type::String && right.getType() == Value::Type::String) {
-            const std::string& a = left.getString();
-            const std::string& b = right.getString();
-            switch (op) {
-                case BinOp::Add:
-                    return Ok(Value(a + b));
-                case BinOp::Equal:
-                    return Ok(Value(a == b));
-                case BinOp::NotEqual:
-                    return Ok(Value(a != b));
-                case BinOp::Greater:
-                    return Ok(Value(a > b));
-                case BinOp::GreaterEq:
-                    return Ok(Value(a >= b));
-                case BinOp::Less:
-                    return Ok(Value(a < b));
-                case BinOp::LessEq:
-                    return Ok(Value(a <= b));
-                default:
-                    return Err<Value>("Unsupported operation: string " + 
-                                       std::to_string(static_cast<int>(op)) + " string");
+        std::string result = left.toString();
+        result.append(right.getStringView());
+        return Ok(Value(std::move(result)));
     }
+
+    // 字符串操作
+    if (left.getType() == Value::Type::String && right.getType() == Value::Type::String) {
+        std::string_view a = left.getStringView();
+        std::string_view b = right.getStringView();
+        switch (op) {
+            case BinOp::Equal:
+                return Ok(Value(left == right));
+            case BinOp::NotEqual:
+                return Ok(Value(!(left == right)));
+            case BinOp::Greater:
+                return Ok(Value(a > b));
+            case BinOp::GreaterEq:
+                return Ok(Value(a >= b));
+            case BinOp::Less:
+                return Ok(Value(a < b));
+            case BinOp::LessEq:
+                return Ok(Value(a <= b));
+            default:
+                return Err<Value>("Unsupported operation: string " + 
+                                   std::to_string(static_cast<int>(op)) + " string");
 }
-        
-        // Null 与非 Null 比较
-        if (left.getType() == Value::Type::Null || right.getType() == Value::Type::Null) {
-            switch (op) {
-                case BinOp::Equal:
-                    return Ok(Value(false));
-                case BinOp::NotEqual:
-                    return Ok(Value(true));
-                default:
-                    return Err<Value>("Unsupported operation: " + left.typeName() + 
-                               " " + std::to_string(static_cast<int>(op)) + " " + right.typeName());
-            }
+}
+    
+    // Null 与非 Null 比较
+    if (left.getType() == Value::Type::Null || right.getType() == Value::Type::Null) {
+        switch (op) {
+            case BinOp::Equal:
+                return Ok(Value(false));
+            case BinOp::NotEqual:
+                return Ok(Value(true));
+            default:
+                return Err<Value>("Unsupported operation: " + left.typeName() + 
+                           " " + std::to_string(static_cast<int>(op)) + " " + right.typeName());
         }
+    }
 /*
-        Interpreter interpreter;
-        auto result = interpreter.eval_binary_op(left, op, right);
-        if (result.is_error()) return Err<Value>(result.error());
-        return Ok(result.value());
+    Interpreter interpreter;
+    auto result = interpreter.eval_binary_op(left, op, right);
+    if (result.is_error()) return Err<Value>(result.error());
+    return Ok(result.value());
 */
-        return Err<Value>("Unsupported operation: " + left.typeName() + 
-                          " " + std::to_string(static_cast<int>(op)) + " " + right.typeName());
-    } catch (const std::exception& e) {
-        return Err<Value>(e.what());
-    }
+    return Err<Value>("Unsupported operation: " + left.typeName() + 
+                      " " + std::to_string(static_cast<int>(op)) + " " + right.typeName());
 }
 
 // 一元操作
 Result<Value> value_unary_op(UnaryOp op, const Value& val) {
-    try {
-        switch (op) {
-            case UnaryOp::Neg: {
-                switch (val.getType()) {
-                    case Value::Type::Int:
-                        return Ok(Value(static_cast<int64_t>(-val.getInt())));
-                    case Value::Type::Float:
-                        return Ok(Value(-val.getFloat()));
-                    case Value::Type::BigInt:
-                        // return Ok(Value(-val.getBigInt()));
-                        return Ok(Value(static_cast<const BigInt&>(-val.getBigInt())));
-                    case Value::Type::Rational:
-                        return Ok(Value(-val.getRational()));
-                    default: {
-                        // Interpreter interpreter;
-                        // auto result = interpreter.eval_unary_op(op, val);
-                        // if (result.is_error()) return Err<Value>(result.error());
-                        // return Ok(result.value());
-                        return Err<Value>("Cannot negate " + val.typeName());
-                    }
-                }
-            }
-            case UnaryOp::Not: {
-                if (val.getType() == Value::Type::Bool) {
-                    return Ok(Value(!val.getBool()));
+    switch (op) {
+        case UnaryOp::Neg: {
+            switch (val.getType()) {
+                case Value::Type::Int:
+                    return Ok(Value(static_cast<int64_t>(-val.getInt())));
+                case Value::Type::Float:
+                    return Ok(Value(-val.getFloat()));
+                case Value::Type::BigInt:
+                    // return Ok(Value(-val.getBigInt()));
+                    return Ok(Value(static_cast<const BigInt&>(-val.getBigInt())));
+                case Value::Type::Rational:
+                    return Ok(Value(-val.getRational()));
+                default: {
+                    // Interpreter interpreter;
+                    // auto result = interpreter.eval_unary_op(op, val);
+                    // if (result.is_error()) return Err<Value>(result.error());
+                    // return Ok(result.value());
+                    return Err<Value>("Cannot negate " + val.typeName());
                 }
-                return Err<Value>("Cannot apply 'not' to " + val.typeName());
             }
-            case UnaryOp::Factorial: {
-                Interpreter interpreter;
-                auto result = interpreter.eval_unary_op(op, val);
-                if (result.is_error()) return Err<Value>(result.error());
-                return Ok(result.value());
+        }
+        case UnaryOp::Not: {
+            if (val.getType() == Value::Type::Bool) {
+                return Ok(Value(!val.getBool()));
             }
+            return Err<Value>("Cannot apply 'not' to " + val.typeName());
+        }
+        case UnaryOp::Factorial: {
+            Interpreter interpreter;
+            auto result = interpreter.eval_unary_op(op, val);
+            if (result.is_error()) return Err<Value>(result.error());
+            return Ok(result.value());
         }
-        return Err<Value>("Unknown unary operation");
-    } catch (const std::exception& e) {
-        return Err<Value>(e.what());
     }
+    return Err<Value>("Unknown unary operation");
 }
 
 // 无理数乘法
@@ -1,19 +1,222 @@
 #include <vm.h>
 #include <vm_ops.h>
+#include <cycle_collector.h>
 #include <value_ops.h>
 #include <interpreter.h>
 
 #include <algorithm>
+#include <atomic>
 #include <sstream>
 #include <iomanip>
 #include <cstring>
+#include <utility>
 
 namespace rumina {
 
+OpCodeType genericOpCode(OpCodeType type) {
+    switch (type) {
+        case OpCodeType::AddIntInt: return OpCodeType::Add;
+        case OpCodeType::SubIntInt: return OpCodeType::Sub;
+        case OpCodeType::MulIntInt: return OpCodeType::Mul;
+        case OpCodeType::ModIntInt: return OpCodeType::Mod;
+        case OpCodeType::EqIntInt: return OpCodeType::Eq;
+        case OpCodeType::NeqIntInt: return OpCodeType::Neq;
+        case OpCodeType::GtIntInt: return OpCodeType::Gt;
+        case OpCodeType::GteIntInt: return OpCodeType::Gte;
+        case OpCodeType::LtIntInt: return OpCodeType::Lt;
+        case OpCodeType::LteIntInt: return OpCodeType::Lte;
+        default: return type;
+    }
+}
+
+OpCodeType fusedHeadOpCode(OpCodeType type) {
+    switch (type) {
+        case OpCodeType::IncLocal: return OpCodeType::LoadLocal;
+        case OpCodeType::IncGlobal: return OpCodeType::LoadGlobal;
+        case OpCodeType::AddLocalLocal: return OpCodeType::LoadLocal;
+        case OpCodeType::ArithConst: return OpCodeType::PushConstPooled;
+        case OpCodeType::CmpConstJumpIfFalse: return OpCodeType::PushConstPooled;
+        case OpCodeType::CmpLocalJumpIfFalse: return OpCodeType::LoadLocal;
+        default: return type;
+    }
+}
+
+size_t fusedLength(OpCodeType type) {
+    switch (type) {
+        case OpCodeType::IncLocal: return 4;
+        case OpCodeType::IncGlobal: return 4;
+        case OpCodeType::AddLocalLocal: return 3;
+        case OpCodeType::ArithConst: return 2;
+        case OpCodeType::CmpConstJumpIfFalse: return 3;
+        case OpCodeType::CmpLocalJumpIfFalse: return 3;
+        default: return 1;
+    }
+}
+
+const char* opCodeName(OpCodeType type) {
+    switch (type) {
+        case OpCodeType::PushConst: return "PushConst";
+        case OpCodeType::PushConstPooled: return "PushConstPooled";
+        case OpCodeType::PushVar: return "PushVar";
+        case OpCodeType::PopVar: return "PopVar";
+        case OpCodeType::LoadLocal: return "LoadLocal";
+        case OpCodeType::StoreLocal: return "StoreLocal";
+        case OpCodeType::LoadGlobal: return "LoadGlobal";
+        case OpCodeType::StoreGlobal: return "StoreGlobal";
+        case OpCodeType::MarkImmutable: return "MarkImmutable";
+        case OpCodeType::Dup: return "Dup";
+        case OpCodeType::Pop: return "Pop";
+        case OpCodeType::Add: return "Add";
+        case OpCodeType::Sub: return "Sub";
+        case OpCodeType::Mul: return "Mul";
+        case OpCodeType::Div: return "Div";
+        case OpCodeType::Mod: return "Mod";
+        case OpCodeType::Pow: return "Pow";
+        case OpCodeType::Neg: return "Neg";
+        case OpCodeType::Factorial: return "Factorial";
+        case OpCodeType::Not: return "Not";
+        case OpCodeType::And: return "And";
+        case OpCodeType::Or: return "Or";
+        case OpCodeType::Eq: return "Eq";
+        case OpCodeType::Neq: return "Neq";
+        case OpCodeType::Gt: return "Gt";
+        case OpCodeType::Gte: return "Gte";
+        case OpCodeType::Lt: return "Lt";
+        case OpCodeType::Lte: return "Lte";
+        case OpCodeType::Jump: return "Jump";
+        case OpCodeType::JumpIfFalse: return "JumpIfFalse";
+        case OpCodeType::JumpIfTrue: return "JumpIfTrue";
+        case OpCodeType::CallVar: return "CallVar";
+        case OpCodeType::Call: return "Call";
+        case OpCodeType::CallMethod: return "CallMethod";
+        case OpCodeType::Return: return "Return";
+        case OpCodeType::TailCall: return "TailCall";
+        case OpCodeType::MakeArray: return "MakeArray";
+        case OpCodeType::MakeStruct: return "MakeStruct";
+        case OpCodeType::Index: return "Index";
+        case OpCodeType::Member: return "Member";
+        case OpCodeType::IndexAssign: return "IndexAssign";
+        case OpCodeType::MemberAssign: return "MemberAssign";
+        case OpCodeType::MemberAssignVar: return "MemberAssignVar";
+        case OpCodeType::DefineFunc: return "DefineFunc";
+        case OpCodeType::MakeLambda: return "MakeLambda";
+        case OpCodeType::Break: return "Break";
+        case OpCodeType::Continue: return "Continue";
+        case OpCodeType::Halt: return "Halt";
+        case OpCodeType::AddIntInt: return "AddIntInt";
+        case OpCodeType::SubIntInt: return "SubIntInt";
+        case OpCodeType::MulIntInt: return "MulIntInt";
+        case OpCodeType::ModIntInt: return "ModIntInt";
+        case OpCodeType::EqIntInt: return "EqIntInt";
+        case OpCodeType::NeqIntInt: return "NeqIntInt";
+        case OpCodeType::GtIntInt: return "GtIntInt";
+        case OpCodeType::GteIntInt: return "GteIntInt";
+        case OpCodeType::LtIntInt: return "LtIntInt";
+        case OpCodeType::LteIntInt: return "LteIntInt";
+        case OpCodeType::IncLocal: return "IncLocal";
+        case OpCodeType::IncGlobal: return "IncGlobal";
+        case OpCodeType::AddLocalLocal: return "AddLocalLocal";
+        case OpCodeType::ArithConst: return "ArithConst";
+        case OpCodeType::CmpConstJumpIfFalse: return "CmpConstJumpIfFalse";
+        case OpCodeType::CmpLocalJumpIfFalse: return "CmpLocalJumpIfFalse";
+        case OpCodeType::JitEntry: return "JitEntry";
+        case OpCodeType::ConvertType: return "ConvertType";
+    }
+    return "Unknown";
+}
+
+// 通用算术/比较指令对应的整数特化形式，没有时原样返回
+static inline OpCodeType int_specialized(OpCodeType type) {
+    switch (type) {
+        case OpCodeType::Add: return OpCodeType::AddIntInt;
+        case OpCodeType::Sub: return OpCodeType::SubIntInt;
+        case OpCodeType::Mul: return OpCodeType::MulIntInt;
+        case OpCodeType::Mod: return OpCodeType::ModIntInt;
+        case OpCodeType::Eq: return OpCodeType::EqIntInt;
+        case OpCodeType::Neq: return OpCodeType::NeqIntInt;
+        case OpCodeType::Gt: return OpCodeType::GtIntInt;
+        case OpCodeType::Gte: return OpCodeType::GteIntInt;
+        case OpCodeType::Lt: return OpCodeType::LtIntInt;
+        case OpCodeType::Lte: return OpCodeType::LteIntInt;
+        default: return type;
+    }
+}
+
+// 特化整数运算，结果与 value_binary_op 的整数分支一致（加减乘按补码回绕）。
+// 不适合快速路径的情况（取模除数为 0 或 -1）返回 false 交给通用实现
+static inline bool int_fast_op(OpCodeType type, int64_t a, int64_t b, Value& out) {
+    switch (type) {
+        case OpCodeType::AddIntInt:
+            out = Value(static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b)));
+            return true;
+        case OpCodeType::SubIntInt:
+            out = Value(static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b)));
+            return true;
+        case OpCodeType::MulIntInt:
+            out = Value(static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b)));
+            return true;
+        case OpCodeType::ModIntInt:
+            if (b == 0 || b == -1) return false;
+            out = Value(static_cast<int64_t>(a % b));
+            return true;
+        case OpCodeType::EqIntInt: out = Value(a == b); return true;
+        case OpCodeType::NeqIntInt: out = Value(a != b); return true;
+        case OpCodeType::GtIntInt: out = Value(a > b); return true;
+        case OpCodeType::GteIntInt: out = Value(a >= b); return true;
+        case OpCodeType::LtIntInt: out = Value(a < b); return true;
+        case OpCodeType::LteIntInt: out = Value(a <= b); return true;
+        default: return false;
+    }
+}
+
 // ByteCode implementation
 
+uint32_t ByteCode::toOperand(size_t value) {
+    if (value > UINT32_MAX) {
+        throw std::runtime_error("Instruction operand out of range");
+    }
+    return static_cast<uint32_t>(value);
+}
+
 void ByteCode::emit(OpCode op, std::optional<size_t> line) {
-    instructions_.push_back(std::move(op));
+    Instruction ins{op.type, 0};
+    
+    switch (op.payload_type) {
+        case OpCode::PAYLOAD_NONE:
+            break;
+        case OpCode::PAYLOAD_VALUE:
+            ins.operand = toOperand(addConstant(op.payload.value));
+            break;
+        case OpCode::PAYLOAD_SIZE:
+            ins.operand = toOperand(op.payload.size);
+            break;
+        case OpCode::PAYLOAD_STRING:
+            ins.operand = toOperand(addName(op.payload.str));
+            break;
+        case OpCode::PAYLOAD_CALL_VAR:
+            ins.operand = toOperand(call_sites_.size());
+            call_sites_.push_back({toOperand(addName(op.payload.call_var.first)),
+                                   toOperand(op.payload.call_var.second)});
+            break;
+        case OpCode::PAYLOAD_MEMBER_ASSIGN:
+            ins.operand = toOperand(member_targets_.size());
+            member_targets_.push_back({toOperand(addName(op.payload.member_assign.first)),
+                                       toOperand(addName(op.payload.member_assign.second))});
+            break;
+        case OpCode::PAYLOAD_FUNC_INFO:
+            ins.operand = toOperand(functions_.size());
+            functions_.push_back(std::move(op.payload.func_info));
+            break;
+        case OpCode::PAYLOAD_LAMBDA_INFO:
+            ins.operand = toOperand(lambdas_.size());
+            lambdas_.push_back(std::move(op.payload.lambda_info));
+            break;
+        case OpCode::PAYLOAD_DECL_TYPE:
+            ins.operand = static_cast<uint32_t>(op.payload.decl_type);
+            break;
+    }
+    
+    instructions_.push_back(ins);
     line_numbers_.push_back(line);
 }
 
@@ -24,14 +227,11 @@ size_t ByteCode::currentAddress() const {
 void ByteCode::patchJump(size_t address, size_t target) {
     if (address >= instructions_.size()) return;
     
-    OpCode& op = instructions_[address];
+    Instruction& op = instructions_[address];
     if (op.type == OpCodeType::Jump ||
         op.type == OpCodeType::JumpIfFalse ||
         op.type == OpCodeType::JumpIfTrue) {
-        
-        if (op.payload_type == OpCode::PAYLOAD_SIZE) {
-            op.payload.size = target;
-        }
+        op.operand = toOperand(target);
     }
 }
 
@@ -72,10 +272,85 @@ size_t ByteCode::addConstant(const Value& value) {
     return index;
 }
 
+size_t ByteCode::addName(Atom name) {
+    auto it = name_index_.find(name);
+    if (it != name_index_.end()) {
+        return it->second;
+    }
+    
+    uint32_t index = toOperand(names_.size());
+    names_.push_back(name);
+    name_index_.emplace(name, index);
+    return index;
+}
+
+size_t ByteCode::addFunction(FuncDefInfo info) {
+    functions_.push_back(std::move(info));
+    return functions_.size() - 1;
+}
+
+ByteCode ByteCode::clone() const {
+    ByteCode copy;
+    copy.instructions_ = instructions_;
+    copy.line_numbers_ = line_numbers_;
+    copy.constants_ = constants_;
+    copy.names_ = names_;
+    copy.name_index_ = name_index_;
+    copy.call_sites_ = call_sites_;
+    copy.member_targets_ = member_targets_;
+    copy.functions_ = functions_;
+    copy.lambdas_ = lambdas_;
+    return copy;
+}
+
+// 序列化格式的版本。V2 起函数与 lambda 原型（含局部变量槽位）单独成节，
+// 指令按下标引用常量和原型；不认识的版本一律拒绝，不做兼容解析
+static const char* const kBytecodeHeader = "RUMINA-BYTECODE-V2";
+
+// 原型里的名字列表写成 [a,b,c]
+static void write_list(std::ostream& out, const std::vector<std::string>& items) {
+    out << "[";
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (i > 0) out << ",";
+        out << items[i];
+    }
+    out << "]";
+}
+
+static std::vector<std::string> parse_list(const std::string& text) {
+    if (text.size() < 2 || text.front() != '[' || text.back() != ']') {
+        throw std::runtime_error("Invalid list format: " + text);
+    }
+    std::vector<std::string> items;
+    std::string body = text.substr(1, text.size() - 2);
+    if (body.empty()) return items;
+    size_t start = 0;
+    while (true) {
+        size_t comma = body.find(',', start);
+        items.push_back(body.substr(start, comma - start));
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    return items;
+}
+
+// 按 ", " 切分原型的各字段（列表内部只用 "," 分隔）
+static std::vector<std::string> split_fields(const std::string& text) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t sep = text.find(", ", start);
+        fields.push_back(text.substr(start, sep - start));
+        if (sep == std::string::npos) break;
+        start = sep + 2;
+    }
+    return fields;
+}
+
 std::string ByteCode::serialize() const {
     std::ostringstream oss;
     
-    oss << "RUMINA-BYTECODE-V1\n";
+    oss << kBytecodeHeader << "\n";
     oss << "CONSTANTS: " << constants_.size() << "\n";
     
     for (size_t i = 0; i < constants_.size(); ++i) {
@@ -118,6 +393,40 @@ std::string ByteCode::serialize() const {
         oss << "\n";
     }
     
+    if (!names_.empty()) {
+        oss << "NAMES: " << names_.size() << "\n";
+        for (size_t i = 0; i < names_.size(); ++i) {
+            oss << "NAME[" << i << "]: " << getName(i) << "\n";
+        }
+    }
+    
+    oss << "FUNCTIONS: " << functions_.size() << "\n";
+    for (size_t i = 0; i < functions_.size(); ++i) {
+        const FuncDefInfo& func = functions_[i];
+        oss << "FUNC[" << i << "]: " << func.name << ", ";
+        write_list(oss, func.params);
+        oss << ", " << func.body_start << ", " << func.body_end << ", ";
+        write_list(oss, func.decorators);
+        oss << ", ";
+        std::vector<std::string> locals;
+        for (Atom local : func.locals) locals.push_back(AtomTable::name(local));
+        write_list(oss, locals);
+        oss << "\n";
+    }
+    
+    oss << "LAMBDAS: " << lambdas_.size() << "\n";
+    for (size_t i = 0; i < lambdas_.size(); ++i) {
+        const LambdaInfo& lambda = lambdas_[i];
+        oss << "LAMBDA[" << i << "]: ";
+        write_list(oss, lambda.params);
+        oss << ", " << lambda.body_start << ", " << lambda.body_end << ", [";
+        for (size_t j = 0; j < lambda.captures.size(); ++j) {
+            if (j > 0) oss << ",";
+            oss << lambda.captures[j].from << ":" << lambda.captures[j].to;
+        }
+        oss << "], " << lambda.function << "\n";
+    }
+    
     oss << "\nINSTRUCTIONS:\n";
     
     for (size_t i = 0; i < instructions_.size(); ++i) {
@@ -128,28 +437,36 @@ std::string ByteCode::serialize() const {
         oss << std::setw(4) << std::setfill('0') << i 
             << " [L" << line_str << "] ";
         
-        const OpCode& op = instructions_[i];
+        const Instruction& op = instructions_[i];
         
-        switch (op.type) {
+        // 特化指令是运行时状态，按通用形式输出
+        switch (genericOpCode(op.type)) {
             case OpCodeType::PushConst:
-                if (op.payload_type == OpCode::PAYLOAD_VALUE)
-                    oss << "PushConst(" << op.payload.value.toString() << ")";
+                oss << "PushConst(" << op.operand << ")";
                 break;
             case OpCodeType::PushConstPooled:
-                if (op.payload_type == OpCode::PAYLOAD_SIZE)
-                    oss << "PushConstPooled(" << op.payload.size << ")";
+                oss << "PushConstPooled(" << op.operand << ")";
                 break;
             case OpCodeType::PushVar:
-                if (op.payload_type == OpCode::PAYLOAD_STRING)
-                    oss << "PushVar(" << op.payload.str << ")";
+                oss << "PushVar(" << getName(op.operand) << ")";
                 break;
             case OpCodeType::PopVar:
-                if (op.payload_type == OpCode::PAYLOAD_STRING)
-                    oss << "PopVar(" << op.payload.str << ")";
+                oss << "PopVar(" << getName(op.operand) << ")";
+                break;
+            case OpCodeType::LoadLocal:
+                oss << "LoadLocal(" << op.operand << ")";
+                break;
+            case OpCodeType::StoreLocal:
+                oss << "StoreLocal(" << op.operand << ")";
+                break;
+            case OpCodeType::LoadGlobal:
+                oss << "LoadGlobal(" << op.operand << ")";
+                break;
+            case OpCodeType::StoreGlobal:
+                oss << "StoreGlobal(" << op.operand << ")";
                 break;
             case OpCodeType::MarkImmutable:
-                if (op.payload_type == OpCode::PAYLOAD_STRING)
-                    oss << "MarkImmutable(" << op.payload.str << ")";
+                oss << "MarkImmutable(" << getName(op.operand) << ")";
                 break;
             case OpCodeType::Dup: oss << "Dup"; break;
             case OpCodeType::Pop: oss << "Pop"; break;
@@ -171,97 +488,78 @@ std::string ByteCode::serialize() const {
             case OpCodeType::Lt: oss << "Lt"; break;
             case OpCodeType::Lte: oss << "Lte"; break;
             case OpCodeType::Jump:
-                if (op.payload_type == OpCode::PAYLOAD_SIZE)
-                    oss << "Jump(" << op.payload.size << ")";
+                oss << "Jump(" << op.operand << ")";
                 break;
             case OpCodeType::JumpIfFalse:
-                if (op.payload_type == OpCode::PAYLOAD_SIZE)
-                    oss << "JumpIfFalse(" << op.payload.size << ")";
+                oss << "JumpIfFalse(" << op.operand << ")";
                 break;
             case OpCodeType::JumpIfTrue:
-                if (op.payload_type == OpCode::PAYLOAD_SIZE)
-                    oss << "JumpIfTrue(" << op.payload.size << ")";
+                oss << "JumpIfTrue(" << op.operand << ")";
                 break;
             case OpCodeType::CallVar:
-                if (op.payload_type == OpCode::PAYLOAD_CALL_VAR)
-                    oss << "CallVar(" << op.payload.call_var.first << ", " << op.payload.call_var.second << ")";
+                oss << "CallVar(" << getName(call_sites_[op.operand].name) << ", " << call_sites_[op.operand].argc << ")";
                 break;
             case OpCodeType::Call:
-                if (op.payload_type == OpCode::PAYLOAD_SIZE)
-                    oss << "Call(" << op.payload.size << ")";
+                oss << "Call(" << op.operand << ")";
                 break;
             case OpCodeType::CallMethod:
-                if (op.payload_type == OpCode::PAYLOAD_SIZE)
-                    oss << "CallMethod(" << op.payload.size << ")";
+                oss << "CallMethod(" << op.operand << ")";
+                break;
+            case OpCodeType::TailCall:
+                oss << "TailCall(" << op.operand << ")";
                 break;
             case OpCodeType::Return: oss << "Return"; break;
             case OpCodeType::MakeArray:
-                if (op.payload_type == OpCode::PAYLOAD_SIZE)
-                    oss << "MakeArray(" << op.payload.size << ")";
+                oss << "MakeArray(" << op.operand << ")";
                 break;
             case OpCodeType::MakeStruct:
-                if (op.payload_type == OpCode::PAYLOAD_SIZE)
-                    oss << "MakeStruct(" << op.payload.size << ")";
+                oss << "MakeStruct(" << op.operand << ")";
                 break;
             case OpCodeType::Index: oss << "Index"; break;
             case OpCodeType::Member:
-                if (op.payload_type == OpCode::PAYLOAD_STRING)
-                    oss << "Member(" << op.payload.str << ")";
+                oss << "Member(" << getName(op.operand) << ")";
                 break;
             case OpCodeType::IndexAssign: oss << "IndexAssign"; break;
             case OpCodeType::MemberAssign:
-                if (op.payload_type == OpCode::PAYLOAD_STRING)
-                    oss << "MemberAssign(" << op.payload.str << ")";
+                oss << "MemberAssign(" << getName(op.operand) << ")";
                 break;
             case OpCodeType::MemberAssignVar:
-                if (op.payload_type == OpCode::PAYLOAD_MEMBER_ASSIGN)
-                    oss << "MemberAssignVar(" << op.payload.member_assign.first << ", " << op.payload.member_assign.second << ")";
+                oss << "MemberAssignVar(" << getName(member_targets_[op.operand].var) << ", " << getName(member_targets_[op.operand].member) << ")";
                 break;
             case OpCodeType::Break: oss << "Break"; break;
             case OpCodeType::Continue: oss << "Continue"; break;
             case OpCodeType::Halt: oss << "Halt"; break;
             case OpCodeType::DefineFunc:
-                if (op.payload_type == OpCode::PAYLOAD_FUNC_INFO) {
-                    oss << "DefineFunc(" << op.payload.func_info.name << ", [";
-                    for (size_t j = 0; j < op.payload.func_info.params.size(); ++j) {
-                        if (j > 0) oss << ",";
-                        oss << op.payload.func_info.params[j];
-                    }
-                    oss << "], " << op.payload.func_info.body_start << ", " << op.payload.func_info.body_end << ", [";
-                    for (size_t j = 0; j < op.payload.func_info.decorators.size(); ++j) {
-                        if (j > 0) oss << ",";
-                        oss << op.payload.func_info.decorators[j];
-                    }
-                    oss << "])";
-                }
+                oss << "DefineFunc(" << op.operand << ")";
                 break;
             case OpCodeType::MakeLambda:
-                if (op.payload_type == OpCode::PAYLOAD_LAMBDA_INFO) {
-                    oss << "MakeLambda([";
-                    for (size_t j = 0; j < op.payload.lambda_info.params.size(); ++j) {
-                        if (j > 0) oss << ",";
-                        oss << op.payload.lambda_info.params[j];
-                    }
-                    oss << "], " << op.payload.lambda_info.body_start << ", " << op.payload.lambda_info.body_end << ")";
-                }
+                oss << "MakeLambda(" << op.operand << ")";
+                break;
+            case OpCodeType::IncLocal:
+            case OpCodeType::IncGlobal:
+            case OpCodeType::AddLocalLocal:
+            case OpCodeType::ArithConst:
+            case OpCodeType::CmpConstJumpIfFalse:
+            case OpCodeType::CmpLocalJumpIfFalse:
+                oss << opCodeName(op.type) << "(" << op.operand << ")";
                 break;
             case OpCodeType::ConvertType:
-                if (op.payload_type == OpCode::PAYLOAD_DECL_TYPE) {
-                    const char* dt_str;
-                    switch (op.payload.decl_type) {
-                        case DeclaredType::Int: dt_str = "Int"; break;
-                        case DeclaredType::Float: dt_str = "Float"; break;
-                        case DeclaredType::Bool: dt_str = "Bool"; break;
-                        case DeclaredType::String: dt_str = "String"; break;
-                        case DeclaredType::Rational: dt_str = "Rational"; break;
-                        case DeclaredType::Irrational: dt_str = "Irrational"; break;
-                        case DeclaredType::Complex: dt_str = "Complex"; break;
-                        case DeclaredType::Array: dt_str = "Array"; break;
-                        case DeclaredType::BigInt: dt_str = "BigInt"; break;
-                        default: dt_str = "Unknown"; break;
-                    }
-                    oss << "ConvertType(" << dt_str << ")";
+                const char* dt_str;
+                switch (static_cast<DeclaredType>(op.operand)) {
+                    case DeclaredType::Int: dt_str = "Int"; break;
+                    case DeclaredType::Float: dt_str = "Float"; break;
+                    case DeclaredType::Bool: dt_str = "Bool"; break;
+                    case DeclaredType::String: dt_str = "String"; break;
+                    case DeclaredType::Rational: dt_str = "Rational"; break;
+                    case DeclaredType::Irrational: dt_str = "Irrational"; break;
+                    case DeclaredType::Complex: dt_str = "Complex"; break;
+                    case DeclaredType::Array: dt_str = "Array"; break;
+                    case DeclaredType::BigInt: dt_str = "BigInt"; break;
+                    default: dt_str = "Unknown"; break;
                 }
+                oss << "ConvertType(" << dt_str << ")";
+                break;
+            default:
                 break;
         }
         
@@ -283,7 +581,11 @@ ByteCode ByteCode::deserialize(const std::string& input) {
     
     size_t i = 0;
     
-    if (i >= lines.size() || lines[i] != "RUMINA-BYTECODE-V1") {
+    if (i >= lines.size() || lines[i] != kBytecodeHeader) {
+        if (i < lines.size() && lines[i].rfind("RUMINA-BYTECODE-V", 0) == 0) {
+            throw std::runtime_error("Unsupported bytecode version: " + lines[i].substr(15) +
+                                     " (expected " + std::string(kBytecodeHeader + 15) + ")");
+        }
         throw std::runtime_error("Invalid bytecode header");
     }
     i++;
@@ -346,6 +648,93 @@ ByteCode ByteCode::deserialize(const std::string& input) {
         i++;
     }
     
+    // 可选的名字表（LoadGlobal/StoreGlobal 的操作数引用它的下标）
+    if (i < lines.size() && lines[i].rfind("NAMES: ", 0) == 0) {
+        size_t name_count = std::stoul(lines[i].substr(7));
+        i++;
+        
+        for (size_t n = 0; n < name_count; ++n) {
+            if (i >= lines.size()) {
+                throw std::runtime_error("Unexpected end of names section");
+            }
+            
+            const std::string& line = lines[i];
+            size_t colon_pos = line.find("]: ");
+            if (colon_pos == std::string::npos || line.rfind("NAME[", 0) != 0) {
+                throw std::runtime_error("Invalid name format");
+            }
+            bytecode.addName(line.substr(colon_pos + 3));
+            i++;
+        }
+    }
+    
+    if (i >= lines.size() || lines[i].rfind("FUNCTIONS: ", 0) != 0) {
+        throw std::runtime_error("Missing functions section");
+    }
+    size_t func_count = std::stoul(lines[i].substr(11));
+    i++;
+    
+    for (size_t f = 0; f < func_count; ++f, ++i) {
+        if (i >= lines.size()) {
+            throw std::runtime_error("Unexpected end of functions section");
+        }
+        size_t colon_pos = lines[i].find("]: ");
+        if (colon_pos == std::string::npos || lines[i].rfind("FUNC[", 0) != 0) {
+            throw std::runtime_error("Invalid function format");
+        }
+        std::vector<std::string> fields = split_fields(lines[i].substr(colon_pos + 3));
+        if (fields.size() != 6) {
+            throw std::runtime_error("Invalid function format");
+        }
+        FuncDefInfo func;
+        func.name = fields[0];
+        func.params = parse_list(fields[1]);
+        func.body_start = std::stoul(fields[2]);
+        func.body_end = std::stoul(fields[3]);
+        func.decorators = parse_list(fields[4]);
+        for (const std::string& local : parse_list(fields[5])) {
+            func.locals.push_back(AtomTable::intern(local));
+        }
+        bytecode.functions_.push_back(std::move(func));
+    }
+    
+    if (i >= lines.size() || lines[i].rfind("LAMBDAS: ", 0) != 0) {
+        throw std::runtime_error("Missing lambdas section");
+    }
+    size_t lambda_count = std::stoul(lines[i].substr(9));
+    i++;
+    
+    for (size_t l = 0; l < lambda_count; ++l, ++i) {
+        if (i >= lines.size()) {
+            throw std::runtime_error("Unexpected end of lambdas section");
+        }
+        size_t colon_pos = lines[i].find("]: ");
+        if (colon_pos == std::string::npos || lines[i].rfind("LAMBDA[", 0) != 0) {
+            throw std::runtime_error("Invalid lambda format");
+        }
+        std::vector<std::string> fields = split_fields(lines[i].substr(colon_pos + 3));
+        if (fields.size() != 5) {
+            throw std::runtime_error("Invalid lambda format");
+        }
+        LambdaInfo lambda;
+        lambda.params = parse_list(fields[0]);
+        lambda.body_start = std::stoul(fields[1]);
+        lambda.body_end = std::stoul(fields[2]);
+        for (const std::string& capture : parse_list(fields[3])) {
+            size_t sep = capture.find(':');
+            if (sep == std::string::npos) {
+                throw std::runtime_error("Invalid lambda capture: " + capture);
+            }
+            lambda.captures.push_back({static_cast<uint32_t>(std::stoul(capture.substr(0, sep))),
+                                       static_cast<uint32_t>(std::stoul(capture.substr(sep + 1)))});
+        }
+        lambda.function = static_cast<uint32_t>(std::stoul(fields[4]));
+        if (lambda.function >= bytecode.functions_.size()) {
+            throw std::runtime_error("Invalid lambda function index");
+        }
+        bytecode.lambdas_.push_back(std::move(lambda));
+    }
+    
     while (i < lines.size() && (lines[i].empty() || lines[i] == "INSTRUCTIONS:")) {
         i++;
     }
@@ -403,16 +792,11 @@ ByteCode ByteCode::deserialize(const std::string& input) {
         else if (op_str == "Continue") op = OpCode(OpCodeType::Continue);
         else if (op_str == "Halt") op = OpCode(OpCodeType::Halt);
         else if (op_str.rfind("PushConst(", 0) == 0) {
-            std::string val_str = op_str.substr(10, op_str.length() - 11);
-            if (val_str.rfind("Int(", 0) == 0) {
-                int64_t n = std::stoll(val_str.substr(4, val_str.length() - 5));
-                op = OpCode(OpCodeType::PushConst, Value(static_cast<int64_t>(n)));
-            } else if (val_str.rfind("Float(", 0) == 0) {
-                double f = std::stod(val_str.substr(6, val_str.length() - 7));
-                op = OpCode(OpCodeType::PushConst, Value(f));
-            } else {
-                op = OpCode(OpCodeType::PushConst, Value());
+            size_t idx = std::stoul(op_str.substr(10, op_str.length() - 11));
+            if (idx >= bytecode.constants_.size()) {
+                throw std::runtime_error("Invalid constant index: " + op_str);
             }
+            op = OpCode(OpCodeType::PushConst, idx);
         } else if (op_str.rfind("PushConstPooled(", 0) == 0) {
             size_t idx = std::stoul(op_str.substr(16, op_str.length() - 17));
             op = OpCode(OpCodeType::PushConstPooled, idx);
@@ -422,6 +806,30 @@ ByteCode ByteCode::deserialize(const std::string& input) {
         } else if (op_str.rfind("PopVar(", 0) == 0) {
             std::string name = op_str.substr(7, op_str.length() - 8);
             op = OpCode(OpCodeType::PopVar, name);
+        } else if (op_str.rfind("LoadLocal(", 0) == 0) {
+            size_t slot = std::stoul(op_str.substr(10, op_str.length() - 11));
+            op = OpCode(OpCodeType::LoadLocal, slot);
+        } else if (op_str.rfind("StoreLocal(", 0) == 0) {
+            size_t slot = std::stoul(op_str.substr(11, op_str.length() - 12));
+            op = OpCode(OpCodeType::StoreLocal, slot);
+        } else if (op_str.rfind("LoadGlobal(", 0) == 0) {
+            size_t idx = std::stoul(op_str.substr(11, op_str.length() - 12));
+            op = OpCode(OpCodeType::LoadGlobal, idx);
+        } else if (op_str.rfind("StoreGlobal(", 0) == 0) {
+            size_t idx = std::stoul(op_str.substr(12, op_str.length() - 13));
+            op = OpCode(OpCodeType::StoreGlobal, idx);
+        } else if (op_str.rfind("IncLocal(", 0) == 0) {
+            op = OpCode(OpCodeType::IncLocal, static_cast<size_t>(std::stoul(op_str.substr(9, op_str.length() - 10))));
+        } else if (op_str.rfind("IncGlobal(", 0) == 0) {
+            op = OpCode(OpCodeType::IncGlobal, static_cast<size_t>(std::stoul(op_str.substr(10, op_str.length() - 11))));
+        } else if (op_str.rfind("AddLocalLocal(", 0) == 0) {
+            op = OpCode(OpCodeType::AddLocalLocal, static_cast<size_t>(std::stoul(op_str.substr(14, op_str.length() - 15))));
+        } else if (op_str.rfind("ArithConst(", 0) == 0) {
+            op = OpCode(OpCodeType::ArithConst, static_cast<size_t>(std::stoul(op_str.substr(11, op_str.length() - 12))));
+        } else if (op_str.rfind("CmpConstJumpIfFalse(", 0) == 0) {
+            op = OpCode(OpCodeType::CmpConstJumpIfFalse, static_cast<size_t>(std::stoul(op_str.substr(20, op_str.length() - 21))));
+        } else if (op_str.rfind("CmpLocalJumpIfFalse(", 0) == 0) {
+            op = OpCode(OpCodeType::CmpLocalJumpIfFalse, static_cast<size_t>(std::stoul(op_str.substr(20, op_str.length() - 21))));
         } else if (op_str.rfind("MarkImmutable(", 0) == 0) {
             std::string name = op_str.substr(14, op_str.length() - 15);
             op = OpCode(OpCodeType::MarkImmutable, name);
@@ -443,6 +851,9 @@ ByteCode ByteCode::deserialize(const std::string& input) {
         } else if (op_str.rfind("Call(", 0) == 0) {
             size_t argc = std::stoul(op_str.substr(5, op_str.length() - 6));
             op = OpCode(OpCodeType::Call, argc);
+        } else if (op_str.rfind("TailCall(", 0) == 0) {
+            size_t argc = std::stoul(op_str.substr(9, op_str.length() - 10));
+            op = OpCode(OpCodeType::TailCall, argc);
         } else if (op_str.rfind("CallMethod(", 0) == 0) {
             size_t argc = std::stoul(op_str.substr(11, op_str.length() - 12));
             op = OpCode(OpCodeType::CallMethod, argc);
@@ -464,10 +875,37 @@ ByteCode ByteCode::deserialize(const std::string& input) {
             std::string var_name = args_str.substr(0, comma_pos);
             std::string member_name = args_str.substr(comma_pos + 2);
             op = OpCode(OpCodeType::MemberAssignVar, std::make_pair(var_name, member_name));
+        } else if (op_str.rfind("DefineFunc(", 0) == 0) {
+            size_t idx = std::stoul(op_str.substr(11, op_str.length() - 12));
+            if (idx >= bytecode.functions_.size()) {
+                throw std::runtime_error("Invalid function index: " + op_str);
+            }
+            op = OpCode(OpCodeType::DefineFunc, idx);
+        } else if (op_str.rfind("MakeLambda(", 0) == 0) {
+            size_t idx = std::stoul(op_str.substr(11, op_str.length() - 12));
+            if (idx >= bytecode.lambdas_.size()) {
+                throw std::runtime_error("Invalid lambda index: " + op_str);
+            }
+            op = OpCode(OpCodeType::MakeLambda, idx);
+        } else if (op_str.rfind("ConvertType(", 0) == 0) {
+            std::string name = op_str.substr(12, op_str.length() - 13);
+            DeclaredType type;
+            if (name == "Int") type = DeclaredType::Int;
+            else if (name == "Float") type = DeclaredType::Float;
+            else if (name == "Bool") type = DeclaredType::Bool;
+            else if (name == "String") type = DeclaredType::String;
+            else if (name == "Rational") type = DeclaredType::Rational;
+            else if (name == "Irrational") type = DeclaredType::Irrational;
+            else if (name == "Complex") type = DeclaredType::Complex;
+            else if (name == "Array") type = DeclaredType::Array;
+            else if (name == "BigInt") type = DeclaredType::BigInt;
+            else throw std::runtime_error("Unknown declared type: " + name);
+            op = OpCode(OpCodeType::ConvertType, type);
+        } else {
+            throw std::runtime_error("Unknown instruction: " + op_str);
         }
         
-        bytecode.instructions_.push_back(op);
-        bytecode.line_numbers_.push_back(line_num);
+        bytecode.emit(std::move(op), line_num);
         
         i++;
     }
@@ -478,28 +916,101 @@ ByteCode ByteCode::deserialize(const std::string& input) {
 // VM implementation
 
 VM::VM(std::shared_ptr<std::unordered_map<std::string, Value>> globals)
-    : globals_(globals) {
+    : globals_(globals), global_table_(globals), tracer_(std::make_unique<Tracer>(*this)) {
     stack_.reserve(256);
     call_stack_.reserve(64);
     loop_stack_.reserve(8);
 }
 
 void VM::load(ByteCode bytecode) {
+    if (jit_) jit_->reset();
+    if (tracer_) tracer_->reset();
     bytecode_ = std::move(bytecode);
+    
+    // 把字节码内的全局名字下标换成 VM 全局表的稳定槽位
+    const auto& names = bytecode_.getNames();
+    for (Instruction& op : bytecode_.getInstructions()) {
+        if (op.type == OpCodeType::LoadGlobal || op.type == OpCodeType::StoreGlobal ||
+            op.type == OpCodeType::IncGlobal) {
+            if (op.operand >= names.size()) {
+                throw std::runtime_error("Invalid global index");
+            }
+            op.operand = static_cast<uint32_t>(global_table_.resolve(names[op.operand]));
+        }
+    }
+    call_site_globals_.clear();
+    for (size_t i = 0; i < bytecode_.getCallSiteCount(); ++i) {
+        call_site_globals_.push_back(static_cast<uint32_t>(
+            global_table_.resolve(names[bytecode_.getCallSite(i).name])));
+    }
+    
+    // 函数原型表
+    static std::atomic<uint32_t> next_program_id{1};
+    program_id_ = next_program_id.fetch_add(1, std::memory_order_relaxed);
+    protos_.clear();
+    for (const FuncDefInfo& info : bytecode_.getFunctions()) {
+        protos_.push_back(FunctionProto{
+            &info,
+            static_cast<uint32_t>(info.params.size()),
+            static_cast<uint32_t>(std::max(info.locals.size(), info.params.size())),
+            info.body_start,
+            info.body_end
+        });
+    }
+    
+    // 每条成员访问指令分配一个内联缓存
+    inline_caches_.clear();
+    for (Instruction& op : bytecode_.getInstructions()) {
+        if (op.type == OpCodeType::Member || op.type == OpCodeType::MemberAssign ||
+            op.type == OpCodeType::MemberAssignVar) {
+            InlineCache cache;
+            cache.operand = op.operand;
+            cache.name = op.type == OpCodeType::MemberAssignVar
+                ? bytecode_.getMemberTarget(op.operand).member : op.operand;
+            op.operand = static_cast<uint32_t>(inline_caches_.size());
+            inline_caches_.push_back(cache);
+        }
+    }
+    
     ip_ = 0;
     halted_ = false;
 }
 
+namespace {
+
+thread_local VM* current_vm = nullptr;
+
+// run / call 期间把 VM 登记为当前线程的 VM，嵌套调用结束后恢复外层
+class CurrentVMScope {
+public:
+    explicit CurrentVMScope(VM* vm) : saved_(current_vm) { current_vm = vm; }
+    ~CurrentVMScope() { current_vm = saved_; }
+
+private:
+    VM* saved_;
+};
+
+} // namespace
+
+VM* VM::current() {
+    return current_vm;
+}
+
+bool VM::dispatch() {
+#if RUMINA_THREADED_DISPATCH
+    if (dispatch_mode_ == DispatchMode::Threaded) {
+        return dispatchThreaded();
+    }
+#endif
+    return dispatchSwitch();
+}
+
 Result<std::optional<Value>> VM::run() {
-    while (!halted_ && ip_ < bytecode_.getInstructions().size()) {
-        size_t current_ip = ip_;
-        ip_++;
-        
-        try {
-            executeInstructionAt(current_ip);
-        } catch (const std::exception& e) {
-            return Err<std::optional<Value>>(e.what());
-        }
+    CurrentVMScope scope(this);
+    error_ = VMError();
+    fault_located_ = false;
+    if (!dispatch()) {
+        return Err<std::optional<Value>>(error_.toString());
     }
     
     if (!stack_.empty()) {
@@ -510,305 +1021,687 @@ Result<std::optional<Value>> VM::run() {
     return Ok(std::optional<Value>(std::nullopt));
 }
 
-void VM::executeInstructionAt(size_t ip) {
-    const OpCode& op = bytecode_.getInstructions()[ip];
+Result<Value> VM::call(const Value& callee, NativeArgs args) {
+    if (callee.getType() == Value::Type::NativeFunction) {
+        try {
+            return Ok(callee.get<Value::NativeFunctionData>()->call(args));
+        } catch (const std::exception& e) {
+            error_ = VMError();
+            fail(e);
+            return Err<Value>(error_.message);
+        }
+    }
+    
+    CurrentVMScope scope(this);
+    // callee 和实参可能就在栈上，压栈扩容前先复制
+    Value function = callee;
+    const size_t base = stack_.size();
+    const size_t depth = call_stack_.size();
+    const size_t slot_count = slots_.size();
+    const size_t loop_depth = loop_stack_.size();
+    const size_t recursion = recursion_depth_;
+    const size_t saved_ip = ip_;
+    const bool saved_halted = halted_;
+    if (stack_.capacity() - base < args.size()) {
+        std::vector<Value> copied(args.begin(), args.end());
+        for (Value& arg : copied) stack_.push_back(std::move(arg));
+    } else {
+        for (const Value& arg : args) stack_.push_back(arg);
+    }
+    
+    // 返回地址设为指令流末尾，被调用者返回后分发循环随之结束
+    ip_ = bytecode_.getInstructions().size();
+    halted_ = false;
+    error_ = VMError();
+    fault_located_ = false;
+    bool ok = invoke(function, args.size(), base, nullptr) && dispatch();
+    if (ok && (call_stack_.size() != depth || stack_.size() != base + 1)) {
+        ok = fail("Callback did not return normally");
+    }
+    Value result = ok ? std::move(stack_.back()) : Value();
+    
+    // 出错时被调用者的帧还在栈上，恢复到调用前的状态
+    if (call_stack_.size() > depth) {
+        CallFrame& frame = call_stack_[depth];
+        locals_ = std::move(frame.locals);
+        immutable_locals_ = std::move(frame.immutable_locals);
+        slot_base_ = frame.slot_base;
+        current_func_ = frame.function;
+        call_stack_.erase(call_stack_.begin() + depth, call_stack_.end());
+    }
+    slots_.resize(slot_count);
+    stack_.resize(base);
+    loop_stack_.resize(loop_depth);
+    recursion_depth_ = recursion;
+    ip_ = saved_ip;
+    halted_ = saved_halted;
+    
+    // 只返回错误信息，带位置的完整错误留在 error_ 中，原生函数可以用 ScriptError 传出去
+    if (!ok) return Err<Value>(error_.message);
+    return Ok(std::move(result));
+}
+
+std::unique_ptr<VM> VM::fork() const {
+    // 快照里的值会被多个线程复制，先改为原子计数
+    auto globals = std::make_shared<std::unordered_map<std::string, Value>>(*globals_);
+    for (const auto& [name, value] : *globals) {
+        value.share();
+    }
+    
+    auto worker = std::make_unique<VM>(globals);
+    worker->worker_ = true;
+    worker->dispatch_mode_ = dispatch_mode_;
+    worker->quickening_ = quickening_;
+    worker->bytecode_ = bytecode_.clone();
+    for (const Value& constant : worker->bytecode_.getConstants()) {
+        constant.share();
+    }
+    // 副本没有本地代码，JitEntry 还原为原指令
+    if (jit_) {
+        auto& code = worker->bytecode_.getInstructions();
+        for (size_t ip = 0; ip < code.size(); ++ip) {
+            if (code[ip].type == OpCodeType::JitEntry) code[ip].type = jit_->originalOpCode(ip);
+        }
+    }
+    
+    // 指令里的全局槽位、调用点、内联缓存下标在 load 时已经改写，沿用同样的编号
+    worker->global_table_ = global_table_.rebind(globals);
+    worker->call_site_globals_ = call_site_globals_;
+    worker->inline_caches_ = inline_caches_;
+    for (InlineCache& cache : worker->inline_caches_) {
+        cache.hits = 0;
+        cache.misses = 0;
+    }
+    worker->program_id_ = program_id_;
+    worker->protos_ = protos_;
+    for (size_t i = 0; i < worker->protos_.size(); ++i) {
+        worker->protos_[i].info = &worker->bytecode_.getFunction(i);
+    }
+    worker->ip_ = worker->bytecode_.getInstructions().size();
+    return worker;
+}
+
+bool VM::setJitEnabled(bool enabled, const JitOptions& options) {
+    jit_.reset();
+    if (enabled) jit_ = Jit::create(*this, options);
+    return jit_ != nullptr;
+}
+
+void VM::setTracing(bool enabled) {
+    if (!enabled) {
+        tracer_.reset();
+    } else if (!tracer_) {
+        tracer_ = std::make_unique<Tracer>(*this);
+    }
+}
+
+bool VM::fail(std::string message) {
+    error_.message = std::move(message);
+    fault_located_ = false;
+    return false;
+}
+
+bool VM::fail(const std::exception& e) {
+    auto script = dynamic_cast<const ScriptError*>(&e);
+    if (!script || !script->error.line) return fail(e.what());
+    error_ = script->error;
+    fault_located_ = true;
+    return false;
+}
+
+void VM::recordFault(size_t ip) {
+    if (fault_located_) return;
+    fault_located_ = true;
+    error_.ip = ip;
+    const auto& lines = bytecode_.getLineNumbers();
+    error_.line = ip < lines.size() ? lines[ip] : std::nullopt;
+}
+
+// 指令通过返回值报告错误；try 只用于原生函数等宿主代码抛出的异常（嵌入边界），
+// 整个循环只有一个
+bool VM::dispatchSwitch() {
+    size_t current_ip = ip_;
+    try {
+        while (!halted_ && ip_ < bytecode_.getInstructions().size()) {
+            current_ip = ip_;
+            ip_++;
+            if (!executeInstructionAt(current_ip)) {
+                recordFault(current_ip);
+                return false;
+            }
+        }
+    } catch (const std::exception& e) {
+        fail(e);
+        recordFault(current_ip);
+        return false;
+    }
+    return true;
+}
+
+#if RUMINA_THREADED_DISPATCH
+// 线程化分发：每条指令处理完直接跳到下一条指令的标签，不回到循环头。
+// 热点指令在这里内联并通过 fail + goto fault 报错；其余指令以及
+// 热点指令的慢路径交给 executeInstructionAt（op_generic）。
+bool VM::dispatchThreaded() {
+    void* labels[kOpCodeCount];
+    for (auto& label : labels) {
+        label = &&op_generic;
+    }
+    labels[static_cast<size_t>(OpCodeType::PushConst)] = &&op_push_const;
+    labels[static_cast<size_t>(OpCodeType::PushConstPooled)] = &&op_push_const_pooled;
+    labels[static_cast<size_t>(OpCodeType::LoadLocal)] = &&op_load_local;
+    labels[static_cast<size_t>(OpCodeType::StoreLocal)] = &&op_store_local;
+    labels[static_cast<size_t>(OpCodeType::LoadGlobal)] = &&op_load_global;
+    labels[static_cast<size_t>(OpCodeType::StoreGlobal)] = &&op_store_global;
+    labels[static_cast<size_t>(OpCodeType::Dup)] = &&op_dup;
+    labels[static_cast<size_t>(OpCodeType::Pop)] = &&op_pop;
+    labels[static_cast<size_t>(OpCodeType::Add)] = &&op_add;
+    labels[static_cast<size_t>(OpCodeType::Sub)] = &&op_sub;
+    labels[static_cast<size_t>(OpCodeType::Mul)] = &&op_mul;
+    labels[static_cast<size_t>(OpCodeType::Div)] = &&op_div;
+    labels[static_cast<size_t>(OpCodeType::Mod)] = &&op_mod;
+    labels[static_cast<size_t>(OpCodeType::Eq)] = &&op_eq;
+    labels[static_cast<size_t>(OpCodeType::Neq)] = &&op_neq;
+    labels[static_cast<size_t>(OpCodeType::Gt)] = &&op_gt;
+    labels[static_cast<size_t>(OpCodeType::Gte)] = &&op_gte;
+    labels[static_cast<size_t>(OpCodeType::Lt)] = &&op_lt;
+    labels[static_cast<size_t>(OpCodeType::Lte)] = &&op_lte;
+    labels[static_cast<size_t>(OpCodeType::Jump)] = &&op_jump;
+    labels[static_cast<size_t>(OpCodeType::JumpIfFalse)] = &&op_jump_if_false;
+    labels[static_cast<size_t>(OpCodeType::JumpIfTrue)] = &&op_jump_if_true;
+    labels[static_cast<size_t>(OpCodeType::Halt)] = &&op_halt;
+    labels[static_cast<size_t>(OpCodeType::AddIntInt)] = &&op_add_int_int;
+    labels[static_cast<size_t>(OpCodeType::SubIntInt)] = &&op_sub_int_int;
+    labels[static_cast<size_t>(OpCodeType::MulIntInt)] = &&op_mul_int_int;
+    labels[static_cast<size_t>(OpCodeType::ModIntInt)] = &&op_mod_int_int;
+    labels[static_cast<size_t>(OpCodeType::EqIntInt)] = &&op_eq_int_int;
+    labels[static_cast<size_t>(OpCodeType::NeqIntInt)] = &&op_neq_int_int;
+    labels[static_cast<size_t>(OpCodeType::GtIntInt)] = &&op_gt_int_int;
+    labels[static_cast<size_t>(OpCodeType::GteIntInt)] = &&op_gte_int_int;
+    labels[static_cast<size_t>(OpCodeType::LtIntInt)] = &&op_lt_int_int;
+    labels[static_cast<size_t>(OpCodeType::LteIntInt)] = &&op_lte_int_int;
+    labels[static_cast<size_t>(OpCodeType::IncLocal)] = &&op_superinstruction;
+    labels[static_cast<size_t>(OpCodeType::IncGlobal)] = &&op_superinstruction;
+    labels[static_cast<size_t>(OpCodeType::AddLocalLocal)] = &&op_superinstruction;
+    labels[static_cast<size_t>(OpCodeType::ArithConst)] = &&op_superinstruction;
+    labels[static_cast<size_t>(OpCodeType::CmpConstJumpIfFalse)] = &&op_superinstruction;
+    labels[static_cast<size_t>(OpCodeType::CmpLocalJumpIfFalse)] = &&op_superinstruction;
+    labels[static_cast<size_t>(OpCodeType::Member)] = &&op_member;
     
+    const std::vector<Instruction>& code = bytecode_.getInstructions();
+    const std::vector<Value>& constants = bytecode_.getConstants();
+    const size_t count = code.size();
+    const Instruction* op = nullptr;
+
+#define RUMINA_DISPATCH()                                       \
+    do {                                                        \
+        if (ip_ >= count) goto done;                            \
+        op = &code[ip_++];                                      \
+        goto *labels[static_cast<size_t>(op->type)];            \
+    } while (0)
+
+#define RUMINA_BINARY_OP(label, binop)                                      \
+    label: {                                                                \
+        if (stack_.size() < 2) goto op_generic;                             \
+        quicken(ip_ - 1);                                                   \
+        auto result = value_binary_op(stack_[stack_.size() - 2], binop,     \
+                                      stack_.back());                       \
+        if (result.is_error()) {                                            \
+            fail(result.error());                                           \
+            goto fault;                                                     \
+        }                                                                   \
+        stack_.pop_back();                                                  \
+        stack_.back() = std::move(result.value());                          \
+        RUMINA_DISPATCH();                                                  \
+    }
+
+    // 守卫失败时走 op_generic，由 quickenedOp 改回通用指令
+#define RUMINA_INT_OP(label, type)                                          \
+    label: {                                                                \
+        size_t n = stack_.size();                                           \
+        if (n < 2) goto op_generic;                                         \
+        Value& lhs = stack_[n - 2];                                         \
+        const Value& rhs = stack_[n - 1];                                   \
+        if (lhs.getType() != Value::Type::Int ||                            \
+            rhs.getType() != Value::Type::Int ||                            \
+            !int_fast_op(type, lhs.getInt(), rhs.getInt(), lhs)) {          \
+            goto op_generic;                                                \
+        }                                                                   \
+        stack_.pop_back();                                                  \
+        RUMINA_DISPATCH();                                                  \
+    }
+
+    try {
+        if (halted_) goto done;
+        RUMINA_DISPATCH();
+        
+    op_generic:
+        if (!executeInstructionAt(static_cast<size_t>(op - code.data()))) goto fault;
+        if (halted_) goto done;
+        RUMINA_DISPATCH();
+        
+    op_push_const:
+    op_push_const_pooled: {
+        size_t index = op->operand;
+        if (index >= constants.size()) goto op_generic;
+        stack_.push_back(constants[index]);
+        RUMINA_DISPATCH();
+    }
+        
+    op_load_local: {
+        const LocalSlot& slot = slots_[slot_base_ + op->operand];
+        if (!slot.assigned) goto op_generic;
+        stack_.push_back(slot.value);
+        RUMINA_DISPATCH();
+    }
+        
+    op_store_local: {
+        if (stack_.empty()) goto op_generic;
+        LocalSlot& slot = slots_[slot_base_ + op->operand];
+        slot.value = std::move(stack_.back());
+        slot.assigned = true;
+        stack_.pop_back();
+        RUMINA_DISPATCH();
+    }
+        
+    op_load_global: {
+        if (!locals_.empty()) goto op_generic;
+        Value* value = global_table_.get(op->operand);
+        if (!value) goto op_generic;
+        stack_.push_back(*value);
+        RUMINA_DISPATCH();
+    }
+        
+    op_store_global: {
+        if (stack_.empty() || global_table_.isImmutable(op->operand)) goto op_generic;
+        global_table_.set(op->operand, stack_.back());
+        stack_.pop_back();
+        RUMINA_DISPATCH();
+    }
+        
+    op_dup:
+        if (stack_.empty()) goto op_generic;
+        stack_.push_back(stack_.back());
+        RUMINA_DISPATCH();
+        
+    op_pop:
+        if (stack_.empty()) goto op_generic;
+        stack_.pop_back();
+        RUMINA_DISPATCH();
+        
+    RUMINA_BINARY_OP(op_add, BinOp::Add)
+    RUMINA_BINARY_OP(op_sub, BinOp::Sub)
+    RUMINA_BINARY_OP(op_mul, BinOp::Mul)
+    RUMINA_BINARY_OP(op_div, BinOp::Div)
+    RUMINA_BINARY_OP(op_mod, BinOp::Mod)
+    RUMINA_BINARY_OP(op_eq, BinOp::Equal)
+    RUMINA_BINARY_OP(op_neq, BinOp::NotEqual)
+    RUMINA_BINARY_OP(op_gt, BinOp::Greater)
+    RUMINA_BINARY_OP(op_gte, BinOp::GreaterEq)
+    RUMINA_BINARY_OP(op_lt, BinOp::Less)
+    RUMINA_BINARY_OP(op_lte, BinOp::LessEq)
+        
+    RUMINA_INT_OP(op_add_int_int, OpCodeType::AddIntInt)
+    RUMINA_INT_OP(op_sub_int_int, OpCodeType::SubIntInt)
+    RUMINA_INT_OP(op_mul_int_int, OpCodeType::MulIntInt)
+    RUMINA_INT_OP(op_mod_int_int, OpCodeType::ModIntInt)
+    RUMINA_INT_OP(op_eq_int_int, OpCodeType::EqIntInt)
+    RUMINA_INT_OP(op_neq_int_int, OpCodeType::NeqIntInt)
+    RUMINA_INT_OP(op_gt_int_int, OpCodeType::GtIntInt)
+    RUMINA_INT_OP(op_gte_int_int, OpCodeType::GteIntInt)
+    RUMINA_INT_OP(op_lt_int_int, OpCodeType::LtIntInt)
+    RUMINA_INT_OP(op_lte_int_int, OpCodeType::LteIntInt)
+        
+    op_superinstruction:
+        if (!superinstruction(ip_ - 1)) goto op_generic;
+        RUMINA_DISPATCH();
+        
+    // 内联缓存命中时直接按槽位读取，未命中交给 loadMember 更新缓存
+    op_member: {
+        if (stack_.empty()) goto op_generic;
+        Value& top = stack_.back();
+        if (top.getType() != Value::Type::Struct && top.getType() != Value::Type::Module) {
+            goto op_generic;
+        }
+        InlineCache& cache = inline_caches_[op->operand];
+        const StructObject& fields = *std::as_const(top).get<StructObject>();
+        const InlineCache::Entry* entry = cache.find(fields.shape());
+        if (!entry) goto op_generic;
+        cache.hits++;
+        Value result = fields.slot(entry->slot);
+        top = std::move(result);
+        RUMINA_DISPATCH();
+    }
+        
+    op_jump:
+        // 回跳交给 JIT 计数，也是环回收的检查点；trace 只接手热点循环，其余回跳留在快速路径
+        if (op->operand < ip_ &&
+            (jit_ || CycleCollector::pending() || (tracer_ && tracer_->needsBackEdge(op->operand)))) {
+            goto op_generic;
+        }
+        ip_ = op->operand;
+        RUMINA_DISPATCH();
+        
+    op_jump_if_false: {
+        if (stack_.empty()) goto op_generic;
+        bool truthy = stack_.back().isTruthy();
+        stack_.pop_back();
+        if (!truthy) ip_ = op->operand;
+        RUMINA_DISPATCH();
+    }
+        
+    op_jump_if_true: {
+        if (stack_.empty()) goto op_generic;
+        bool truthy = stack_.back().isTruthy();
+        stack_.pop_back();
+        if (truthy) ip_ = op->operand;
+        RUMINA_DISPATCH();
+    }
+        
+    op_halt:
+        halted_ = true;
+        goto done;
+    } catch (const std::exception& e) {
+        fail(e);
+        goto fault;
+    }
+
+#undef RUMINA_INT_OP
+#undef RUMINA_BINARY_OP
+#undef RUMINA_DISPATCH
+
+done:
+    return true;
+fault:
+    recordFault(op ? static_cast<size_t>(op - code.data()) : ip_);
+    return false;
+}
+#endif
+
+bool VM::executeInstructionAt(size_t ip) {
+    return executeInstruction(bytecode_.getInstructions()[ip], ip);
+}
+
+bool VM::executeInstruction(const Instruction& op, size_t ip) {
     switch (op.type) {
         case OpCodeType::PushConst: {
-            if (op.payload_type == OpCode::PAYLOAD_VALUE) {
-                stack_.push_back(op.payload.value);
-            }
+            stack_.push_back(bytecode_.getConstant(op.operand));
             break;
         }
         
         case OpCodeType::PushConstPooled: {
-            if (op.payload_type == OpCode::PAYLOAD_SIZE) {
-                size_t index = op.payload.size;
-                if (index < bytecode_.getConstants().size()) {
-                    stack_.push_back(bytecode_.getConstants()[index]);
-                } else {
-                    throw std::runtime_error("Invalid constant pool index");
-                }
+            size_t index = op.operand;
+            if (index < bytecode_.getConstants().size()) {
+                stack_.push_back(bytecode_.getConstants()[index]);
+            } else {
+                return fail("Invalid constant pool index");
             }
             break;
         }
         
         case OpCodeType::PushVar: {
-            if (op.payload_type == OpCode::PAYLOAD_STRING) {
-                stack_.push_back(getVariable(op.payload.str));
-            }
+            Value value;
+            if (!getVariable(bytecode_.getAtom(op.operand), value)) return false;
+            stack_.push_back(std::move(value));
             break;
         }
         
         case OpCodeType::PopVar: {
-            if (op.payload_type == OpCode::PAYLOAD_STRING) {
-                if (stack_.empty()) throw std::runtime_error("Stack underflow");
-                Value val = stack_.back();
-                stack_.pop_back();
-                setVariableChecked(op.payload.str, val);
-            }
+            if (stack_.empty()) return fail("Stack underflow");
+            Value val = stack_.back();
+            stack_.pop_back();
+            if (!setVariableChecked(bytecode_.getAtom(op.operand), val)) return false;
             break;
         }
         
-        case OpCodeType::MarkImmutable: {
-            if (op.payload_type == OpCode::PAYLOAD_STRING) {
-                if (call_stack_.empty()) {
-                    immutable_globals_.insert(op.payload.str);
-                } else {
-                    immutable_locals_.insert(op.payload.str);
-                }
+        case OpCodeType::LoadLocal: {
+            const LocalSlot& slot = slots_[slot_base_ + op.operand];
+            if (slot.assigned) {
+                stack_.push_back(slot.value);
+            } else {
+                // 声明前读取：与按名字查找的语义保持一致（回退到全局）
+                if (!current_func_) return fail("LoadLocal outside of function");
+                Value value;
+                if (!getVariable(current_func_->locals[op.operand], value)) return false;
+                stack_.push_back(std::move(value));
             }
             break;
         }
         
-        case OpCodeType::Dup: {
-            if (stack_.empty()) throw std::runtime_error("Stack underflow");
-            stack_.push_back(stack_.back());
+        case OpCodeType::StoreLocal: {
+            if (stack_.empty()) return fail("Stack underflow");
+            LocalSlot& slot = slots_[slot_base_ + op.operand];
+            slot.value = std::move(stack_.back());
+            slot.assigned = true;
+            stack_.pop_back();
             break;
         }
         
-        case OpCodeType::Pop: {
-            if (stack_.empty()) throw std::runtime_error("Stack underflow");
-            stack_.pop_back();
+        case OpCodeType::LoadGlobal: {
+            size_t slot = op.operand;
+            // lambda 闭包和方法的 self 仍按名字绑定在 locals_ 中，优先于全局
+            if (!locals_.empty()) {
+                auto it = locals_.find(global_table_.atomOf(slot));
+                if (it != locals_.end()) {
+                    stack_.push_back(it->second);
+                    break;
+                }
+            }
+            Value* value = global_table_.get(slot);
+            if (!value) {
+                return fail("Undefined variable: " + global_table_.nameOf(slot));
+            }
+            stack_.push_back(*value);
             break;
         }
         
-        case OpCodeType::Add: {
-            binaryOp([](const Value& a, const Value& b) {
-                auto result = value_binary_op(a, BinOp::Add, b);
-                if (result.is_error()) throw std::runtime_error(result.error());
-                return result.value();
-            });
+        case OpCodeType::StoreGlobal: {
+            if (stack_.empty()) return fail("Stack underflow");
+            size_t slot = op.operand;
+            if (global_table_.isImmutable(slot)) {
+                return fail("Cannot assign to immutable variable '" + 
+                    global_table_.nameOf(slot) + "'");
+            }
+            global_table_.set(slot, stack_.back());
+            stack_.pop_back();
             break;
         }
         
-        case OpCodeType::Sub: {
-            binaryOp([](const Value& a, const Value& b) {
-                auto result = value_binary_op(a, BinOp::Sub, b);
-                if (result.is_error()) throw std::runtime_error(result.error());
-                return result.value();
-            });
+        case OpCodeType::MarkImmutable: {
+            if (call_stack_.empty()) {
+                global_table_.markImmutable(global_table_.resolve(bytecode_.getAtom(op.operand)));
+            } else {
+                immutable_locals_.insert(bytecode_.getAtom(op.operand));
+            }
             break;
         }
         
-        case OpCodeType::Mul: {
-            binaryOp([](const Value& a, const Value& b) {
-                auto result = value_binary_op(a, BinOp::Mul, b);
-                if (result.is_error()) throw std::runtime_error(result.error());
-                return result.value();
-            });
+        case OpCodeType::Dup: {
+            if (stack_.empty()) return fail("Stack underflow");
+            stack_.push_back(stack_.back());
             break;
         }
         
-        case OpCodeType::Div: {
-            binaryOp([](const Value& a, const Value& b) {
-                auto result = value_binary_op(a, BinOp::Div, b);
-                if (result.is_error()) throw std::runtime_error(result.error());
-                return result.value();
-            });
+        case OpCodeType::Pop: {
+            if (stack_.empty()) return fail("Stack underflow");
+            stack_.pop_back();
             break;
         }
         
+        case OpCodeType::Add: {
+            quicken(ip);
+            return binaryOp(BinOp::Add);
+        }
+        
+        case OpCodeType::Sub: {
+            quicken(ip);
+            return binaryOp(BinOp::Sub);
+        }
+        
+        case OpCodeType::Mul: {
+            quicken(ip);
+            return binaryOp(BinOp::Mul);
+        }
+        
+        case OpCodeType::Div: {
+            return binaryOp(BinOp::Div);
+        }
+        
         case OpCodeType::Mod: {
-            binaryOp([](const Value& a, const Value& b) {
-                auto result = value_binary_op(a, BinOp::Mod, b);
-                if (result.is_error()) throw std::runtime_error(result.error());
-                return result.value();
-            });
-            break;
+            quicken(ip);
+            return binaryOp(BinOp::Mod);
         }
         
         case OpCodeType::Pow: {
-            binaryOp([](const Value& a, const Value& b) {
-                auto result = value_binary_op(a, BinOp::Pow, b);
-                if (result.is_error()) throw std::runtime_error(result.error());
-                return result.value();
-            });
-            break;
+            return binaryOp(BinOp::Pow);
         }
         
         case OpCodeType::Neg: {
-            if (stack_.empty()) throw std::runtime_error("Stack underflow");
+            if (stack_.empty()) return fail("Stack underflow");
             Value val = stack_.back();
             stack_.pop_back();
             auto result = value_unary_op(UnaryOp::Neg, val);
-            if (result.is_error()) throw std::runtime_error(result.error());
+            if (result.is_error()) return fail(result.error());
             stack_.push_back(result.value());
             break;
         }
         
         case OpCodeType::Not: {
-            if (stack_.empty()) throw std::runtime_error("Stack underflow");
+            if (stack_.empty()) return fail("Stack underflow");
             Value val = stack_.back();
             stack_.pop_back();
             auto result = value_unary_op(UnaryOp::Not, val);
-            if (result.is_error()) throw std::runtime_error(result.error());
+            if (result.is_error()) return fail(result.error());
             stack_.push_back(result.value());
             break;
         }
         
         case OpCodeType::Factorial: {
-            if (stack_.empty()) throw std::runtime_error("Stack underflow");
+            if (stack_.empty()) return fail("Stack underflow");
             Value val = stack_.back();
             stack_.pop_back();
             auto result = value_unary_op(UnaryOp::Factorial, val);
-            if (result.is_error()) throw std::runtime_error(result.error());
+            if (result.is_error()) return fail(result.error());
             stack_.push_back(result.value());
             break;
         }
         
         case OpCodeType::Eq: {
-            binaryOp([](const Value& a, const Value& b) {
-                auto result = value_binary_op(a, BinOp::Equal, b);
-                if (result.is_error()) throw std::runtime_error(result.error());
-                return result.value();
-            });
-            break;
+            quicken(ip);
+            return binaryOp(BinOp::Equal);
         }
         
         case OpCodeType::Neq: {
-            binaryOp([](const Value& a, const Value& b) {
-                auto result = value_binary_op(a, BinOp::NotEqual, b);
-                if (result.is_error()) throw std::runtime_error(result.error());
-                return result.value();
-            });
-            break;
+            quicken(ip);
+            return binaryOp(BinOp::NotEqual);
         }
         
         case OpCodeType::Gt: {
-            binaryOp([](const Value& a, const Value& b) {
-                auto result = value_binary_op(a, BinOp::Greater, b);
-                if (result.is_error()) throw std::runtime_error(result.error());
-                return result.value();
-            });
-            break;
+            quicken(ip);
+            return binaryOp(BinOp::Greater);
         }
         
         case OpCodeType::Gte: {
-            binaryOp([](const Value& a, const Value& b) {
-                auto result = value_binary_op(a, BinOp::GreaterEq, b);
-                if (result.is_error()) throw std::runtime_error(result.error());
-                return result.value();
-            });
-            break;
+            quicken(ip);
+            return binaryOp(BinOp::GreaterEq);
         }
         
         case OpCodeType::Lt: {
-            binaryOp([](const Value& a, const Value& b) {
-                auto result = value_binary_op(a, BinOp::Less, b);
-                if (result.is_error()) throw std::runtime_error(result.error());
-                return result.value();
-            });
-            break;
+            quicken(ip);
+            return binaryOp(BinOp::Less);
         }
         
         case OpCodeType::Lte: {
-            binaryOp([](const Value& a, const Value& b) {
-                auto result = value_binary_op(a, BinOp::LessEq, b);
-                if (result.is_error()) throw std::runtime_error(result.error());
-                return result.value();
-            });
-            break;
+            quicken(ip);
+            return binaryOp(BinOp::LessEq);
         }
         
         case OpCodeType::And: {
-            binaryOp([](const Value& a, const Value& b) {
-                auto result = value_binary_op(a, BinOp::And, b);
-                if (result.is_error()) throw std::runtime_error(result.error());
-                return result.value();
-            });
-            break;
+            return binaryOp(BinOp::And);
         }
         
         case OpCodeType::Or: {
-            binaryOp([](const Value& a, const Value& b) {
-                auto result = value_binary_op(a, BinOp::Or, b);
-                if (result.is_error()) throw std::runtime_error(result.error());
-                return result.value();
-            });
-            break;
+            return binaryOp(BinOp::Or);
         }
         
         case OpCodeType::Jump: {
-            if (op.payload_type == OpCode::PAYLOAD_SIZE) {
-                ip_ = op.payload.size;
+            ip_ = op.operand;
+            if (op.operand <= ip) {
+                if (CycleCollector::pending()) CycleCollector::collect();
+                if (jit_ && current_func_) jit_->countHot(protoIndex(current_func_));
+                if (tracer_ && tracer_->needsBackEdge(op.operand)) return tracer_->onBackEdge(op.operand);
             }
             break;
         }
         
         case OpCodeType::JumpIfFalse: {
-            if (op.payload_type == OpCode::PAYLOAD_SIZE) {
-                if (stack_.empty()) throw std::runtime_error("Stack underflow");
-                Value cond = stack_.back();
-                stack_.pop_back();
-                if (!cond.isTruthy()) {
-                    ip_ = op.payload.size;
-                }
+            if (stack_.empty()) return fail("Stack underflow");
+            Value cond = stack_.back();
+            stack_.pop_back();
+            if (!cond.isTruthy()) {
+                ip_ = op.operand;
             }
             break;
         }
         
         case OpCodeType::JumpIfTrue: {
-            if (op.payload_type == OpCode::PAYLOAD_SIZE) {
-                if (stack_.empty()) throw std::runtime_error("Stack underflow");
-                Value cond = stack_.back();
-                stack_.pop_back();
-                if (cond.isTruthy()) {
-                    ip_ = op.payload.size;
-                }
+            if (stack_.empty()) return fail("Stack underflow");
+            Value cond = stack_.back();
+            stack_.pop_back();
+            if (cond.isTruthy()) {
+                ip_ = op.operand;
             }
             break;
         }
         
         case OpCodeType::MakeArray: {
-            if (op.payload_type == OpCode::PAYLOAD_SIZE) {
-                size_t count = op.payload.size;
-                std::vector<Value> elements;
-                elements.reserve(count);
-                
-                for (size_t i = 0; i < count; ++i) {
-                    if (stack_.empty()) throw std::runtime_error("Stack underflow");
-                    elements.push_back(stack_.back());
-                    stack_.pop_back();
-                }
-                
-                std::reverse(elements.begin(), elements.end());
-                stack_.push_back(Value::makeArray(
-                    std::make_shared<std::vector<Value>>(std::move(elements))));
-            }
+            size_t count = op.operand;
+            if (stack_.size() < count) return fail("Stack underflow");
+            
+            // 元素全是 Int 或全是 Float 时得到紧凑数组
+            auto first = stack_.end() - static_cast<std::ptrdiff_t>(count);
+            std::vector<Value> elements(std::make_move_iterator(first),
+                                        std::make_move_iterator(stack_.end()));
+            stack_.erase(first, stack_.end());
+            stack_.push_back(Value::makeArray(std::move(elements)));
             break;
         }
         
         case OpCodeType::Index: {
-            if (stack_.size() < 2) throw std::runtime_error("Stack underflow");
-            
-            Value index = stack_.back();
-            stack_.pop_back();
-            Value array = stack_.back();
-            stack_.pop_back();
+            if (stack_.size() < 2) return fail("Stack underflow");
             
-            if (array.getType() == Value::Type::Array) {
-                auto arr = array.getArray();
-                if (index.getType() != Value::Type::Int) {
-                    throw std::runtime_error("Array index must be an integer");
-                }
-                
-                int64_t idx = index.getInt();
-                size_t len = arr->size();
+            // 数组按整数下标读取：直接在栈上取元素，不复制数组值；紧凑数组的元素是立即数
+            if (stack_[stack_.size() - 2].getType() == Value::Type::Array &&
+                stack_.back().getType() == Value::Type::Int) {
+                const ArrayObject& arr = *std::as_const(stack_[stack_.size() - 2]).get<ArrayObject>();
+                int64_t idx = stack_.back().getInt();
+                size_t len = arr.size();
                 
                 if (idx < 0) {
                     idx = len + idx;
                 }
                 
                 if (idx < 0 || static_cast<size_t>(idx) >= len) {
-                    throw std::runtime_error("Array index out of bounds");
+                    return fail("Array index out of bounds");
                 }
                 
-                stack_.push_back((*arr)[idx]);
+                Value element = arr.get(static_cast<size_t>(idx));
+                stack_.pop_back();
+                stack_.back() = std::move(element);
+                break;
+            }
+            
+            Value index = stack_.back();
+            stack_.pop_back();
+            Value array = stack_.back();
+            stack_.pop_back();
+            
+            if (array.getType() == Value::Type::Array) {
+                return fail("Array index must be an integer");
             } else if (array.getType() == Value::Type::String) {
-                const std::string& s = array.getString();
+                std::string_view s = array.getStringView();
                 if (index.getType() != Value::Type::Int) {
-                    throw std::runtime_error("String index must be an integer");
+                    return fail("String index must be an integer");
                 }
                 
                 int64_t idx = index.getInt();
@@ -819,76 +1712,42 @@ void VM::executeInstructionAt(size_t ip) {
                 }
                 
                 if (idx < 0 || static_cast<size_t>(idx) >= len) {
-                    throw std::runtime_error("String index out of bounds");
+                    return fail("String index out of bounds");
                 }
                 
-                stack_.push_back(Value(std::string(1, s[idx])));
+                stack_.push_back(Value::makeChar(static_cast<unsigned char>(s[idx])));
             } else {
-                throw std::runtime_error("Cannot index type " + array.typeName());
+                return fail("Cannot index type " + array.typeName());
             }
             break;
         }
         
         case OpCodeType::Member: {
-            size_t cache_addr = ip;
-            
-            if (stack_.empty()) throw std::runtime_error("Stack underflow");
-            Value object = stack_.back();
-            stack_.pop_back();
-            
-            if (op.payload_type != OpCode::PAYLOAD_STRING) break;
-            const std::string& member = op.payload.str;
-            
-            if (object.getType() == Value::Type::Struct ||
-                object.getType() == Value::Type::Module) {
-                
-                auto struct_map = (object.getType() == Value::Type::Struct) 
-                    ? object.getStruct() : object.getModule();
-                
-                auto it = struct_map->find(member);
-                if (it != struct_map->end()) {
-                    auto cache_it = member_cache_.find(cache_addr);
-                    if (cache_it != member_cache_.end()) {
-                        cache_it->second.hits++;
-                    } else {
-                        member_cache_[cache_addr] = InlineCache{member, 0, 0};
-                    }
-                    
-                    stack_.push_back(it->second);
-                } else {
-                    auto cache_it = member_cache_.find(cache_addr);
-                    if (cache_it != member_cache_.end()) {
-                        cache_it->second.misses++;
-                    } else {
-                        member_cache_[cache_addr] = InlineCache{member, 0, 1};
-                    }
-                    
-                    throw std::runtime_error(object.typeName() + 
-                        " does not have member '" + member + "'");
-                }
-            } else {
-                auto cache_it = member_cache_.find(cache_addr);
-                if (cache_it != member_cache_.end()) {
-                    cache_it->second.misses++;
-                } else {
-                    member_cache_[cache_addr] = InlineCache{member, 0, 1};
-                }
-                
-                throw std::runtime_error("Cannot access member of type " + object.typeName());
-            }
+            if (stack_.empty()) return fail("Stack underflow");
+            Value result;
+            if (!loadMember(inline_caches_[op.operand], stack_.back(), result)) return false;
+            stack_.back() = std::move(result);
             break;
         }
         
         case OpCodeType::Return: {
             if (!call_stack_.empty()) {
-                CallFrame frame = call_stack_.back();
+                CallFrame frame = std::move(call_stack_.back());
                 call_stack_.pop_back();
                 
                 recursion_depth_ = recursion_depth_ > 0 ? recursion_depth_ - 1 : 0;
                 
+                // 丢弃被调用者遗留在栈上的临时值，只保留返回值
+                Value result = stack_.size() > frame.base_pointer ? std::move(stack_.back()) : Value();
+                stack_.resize(frame.base_pointer);
+                stack_.push_back(std::move(result));
+                
                 ip_ = frame.return_address;
                 locals_ = std::move(frame.locals);
                 immutable_locals_ = std::move(frame.immutable_locals);
+                slots_.resize(slot_base_);
+                slot_base_ = frame.slot_base;
+                current_func_ = frame.function;
             } else {
                 halted_ = true;
             }
@@ -899,7 +1758,7 @@ void VM::executeInstructionAt(size_t ip) {
             if (!loop_stack_.empty()) {
                 ip_ = loop_stack_.back().second;
             } else {
-                throw std::runtime_error("Break outside of loop");
+                return fail("Break outside of loop");
             }
             break;
         }
@@ -908,532 +1767,223 @@ void VM::executeInstructionAt(size_t ip) {
             if (!loop_stack_.empty()) {
                 ip_ = loop_stack_.back().first;
             } else {
-                throw std::runtime_error("Continue outside of loop");
+                return fail("Continue outside of loop");
             }
             break;
         }
         
         case OpCodeType::DefineFunc: {
-            if (op.payload_type == OpCode::PAYLOAD_FUNC_INFO) {
-                const FuncDefInfo& info = op.payload.func_info;
-                functions_[info.name] = FuncDefInfo{info.name, info.params, 
-                                                    info.body_start, info.body_end, info.decorators};
-                
-                Value::FunctionData func_data;
-                func_data.name = info.name;
-                func_data.params = info.params;
-                func_data.body = nullptr;
-                func_data.decorators = info.decorators;
-                
-                Value func = Value::makeFunction(func_data);
-                (*globals_)[info.name] = func;
-            }
+            const FuncDefInfo& info = bytecode_.getFunction(op.operand);
+            
+            Value::FunctionData func_data;
+            func_data.name = info.name;
+            func_data.params = info.params;
+            func_data.body = nullptr;
+            func_data.decorators = info.decorators;
+            func_data.proto = op.operand;
+            func_data.program = program_id_;
+            
+            Value func = Value::makeFunction(func_data);
+            (*globals_)[info.name] = func;
             break;
         }
         
         case OpCodeType::CallVar: {
-            if (op.payload_type != OpCode::PAYLOAD_CALL_VAR) break;
-            
-            const std::string& func_name = op.payload.call_var.first;
-            size_t arg_count = op.payload.call_var.second;
-            
-            Value func = getVariable(func_name);
+            const CallSite& site = bytecode_.getCallSite(op.operand);
+            size_t arg_count = site.argc;
+            if (stack_.size() < arg_count) return fail("Stack underflow");
+            size_t base = stack_.size() - arg_count;
             
-            std::vector<Value> args;
-            args.reserve(arg_count);
-            for (size_t i = 0; i < arg_count; ++i) {
-                if (stack_.empty()) throw std::runtime_error("Stack underflow");
-                args.push_back(stack_.back());
-                stack_.pop_back();
+            Value* global = locals_.empty() ? global_table_.get(call_site_globals_[op.operand]) : nullptr;
+            Value func;
+            if (global) {
+                func = *global;
+            } else if (!getVariable(bytecode_.getAtom(site.name), func)) {
+                return false;
             }
-            std::reverse(args.begin(), args.end());
             
             if (func.getType() == Value::Type::NativeFunction) {
-                auto nf = func.getNativeFunction();
-                Value result = nf.func(args);
-                stack_.push_back(result);
-            } else if (func.getType() == Value::Type::Function) {
-                auto f = func.getFunction();
-                
-                auto it = functions_.find(f.name);
-                if (it == functions_.end()) {
-                    throw std::runtime_error("Function '" + f.name + "' not found");
-                }
-                
-                const FuncDefInfo& info = it->second;
-                
-                if (args.size() != info.params.size()) {
-                    throw std::runtime_error("Function '" + func_name + 
-                        "' expects " + std::to_string(info.params.size()) + 
-                        " arguments, got " + std::to_string(args.size()));
-                }
-                
-                if (recursion_depth_ >= MAX_RECURSION_DEPTH) {
-                    throw std::runtime_error("Maximum recursion depth exceeded");
-                }
-                
-                size_t body_start = info.body_start;
-                
-                CallFrame frame;
-                frame.return_address = ip_;
-                frame.base_pointer = stack_.size();
-                frame.function_name = func_name;
-                frame.locals = std::move(locals_);
-                frame.immutable_locals = std::move(immutable_locals_);
-                
-                call_stack_.push_back(std::move(frame));
-                recursion_depth_++;
-                
-                locals_.clear();
-                for (size_t i = 0; i < info.params.size(); ++i) {
-                    locals_[info.params[i]] = args[i];
-                }
-                immutable_locals_.clear();
-                
-                ip_ = body_start;
-            } else if (func.getType() == Value::Type::Lambda) {
-                auto lambda = func.getLambda();
-                
-                if (args.size() != lambda.params.size()) {
-                    throw std::runtime_error("Lambda expects " + 
-                        std::to_string(lambda.params.size()) + 
-                        " arguments, got " + std::to_string(args.size()));
-                }
-                
-                if (recursion_depth_ >= MAX_RECURSION_DEPTH) {
-                    throw std::runtime_error("Maximum recursion depth exceeded");
-                }
-                
-                std::string lambda_id;
-                if (lambda.body) {
-                    auto include_stmt = dynamic_cast<IncludeStmt*>(lambda.body.get());
-                    if (include_stmt) {
-                        lambda_id = include_stmt->path;
-                    } else {
-                        lambda_id = "__lambda_" + std::to_string(reinterpret_cast<uintptr_t>(lambda.body.get()));
-                    }
-                } else {
-                    for (const auto& [name, _] : functions_) {
-                        if (name.rfind("__lambda_", 0) == 0) {
-                            lambda_id = name;
-                            break;
-                        }
-                    }
-                }
-                
-                auto it = functions_.find(lambda_id);
-                if (it == functions_.end()) {
-                    throw std::runtime_error("Lambda not found");
-                }
-                
-                const FuncDefInfo& info = it->second;
-                
-                CallFrame frame;
-                frame.return_address = ip_;
-                frame.base_pointer = stack_.size();
-                frame.function_name = lambda_id;
-                frame.locals = std::move(locals_);
-                frame.immutable_locals = std::move(immutable_locals_);
-                
-                call_stack_.push_back(std::move(frame));
-                recursion_depth_++;
-                
-                locals_.clear();
-                if (lambda.closure) {
-                    for (const auto& [k, v] : *lambda.closure) {
-                        locals_[k] = v;
-                    }
-                }
-                for (size_t i = 0; i < lambda.params.size(); ++i) {
-                    locals_[lambda.params[i]] = args[i];
-                }
-                immutable_locals_.clear();
-                
-                ip_ = info.body_start;
+                // 实参直接以栈上视图传入，不复制；func 与全局槽共享，按 const 访问以免写时复制
+                Value result = std::as_const(func).get<Value::NativeFunctionData>()->call(
+                    NativeArgs(stack_.data() + base, arg_count));
+                stack_.resize(base);
+                stack_.push_back(std::move(result));
             } else {
-                throw std::runtime_error("Cannot call type " + func.typeName());
+                if (!invoke(func, arg_count, base, nullptr)) return false;
             }
             break;
         }
         
         case OpCodeType::Call: {
-            if (op.payload_type != OpCode::PAYLOAD_SIZE) break;
-            size_t arg_count = op.payload.size;
+            size_t arg_count = op.operand;
+            if (stack_.size() < arg_count + 1) return fail("Stack underflow");
+            size_t base = stack_.size() - arg_count - 1;
+            const Value& func = stack_[base];
             
-            std::vector<Value> args;
-            args.reserve(arg_count);
-            for (size_t i = 0; i < arg_count; ++i) {
-                if (stack_.empty()) throw std::runtime_error("Stack underflow");
-                args.push_back(stack_.back());
-                stack_.pop_back();
+            if (func.getType() == Value::Type::NativeFunction) {
+                Value result = func.get<Value::NativeFunctionData>()->call(
+                    NativeArgs(stack_.data() + base + 1, arg_count));
+                stack_.resize(base);
+                stack_.push_back(std::move(result));
+            } else {
+                if (!invoke(func, arg_count, base, nullptr)) return false;
             }
-            std::reverse(args.begin(), args.end());
-            
-            if (stack_.empty()) throw std::runtime_error("Stack underflow");
-            Value func = stack_.back();
-            stack_.pop_back();
+            break;
+        }
+        
+        case OpCodeType::TailCall: {
+            size_t arg_count = op.operand;
+            if (stack_.size() < arg_count + 1) return fail("Stack underflow");
+            size_t base = stack_.size() - arg_count - 1;
+            const Value& func = stack_[base];
             
             if (func.getType() == Value::Type::NativeFunction) {
-                auto nf = func.getNativeFunction();
-                Value result = nf.func(args);
-                stack_.push_back(result);
-            } else if (func.getType() == Value::Type::Function) {
-                auto f = func.getFunction();
-                
-                auto it = functions_.find(f.name);
-                if (it == functions_.end()) {
-                    throw std::runtime_error("Function '" + f.name + "' not found");
-                }
-                
-                const FuncDefInfo& info = it->second;
-                
-                if (args.size() != info.params.size()) {
-                    throw std::runtime_error("Function '" + f.name + 
-                        "' expects " + std::to_string(info.params.size()) + 
-                        " arguments, got " + std::to_string(args.size()));
-                }
-                
-                if (recursion_depth_ >= MAX_RECURSION_DEPTH) {
-                    throw std::runtime_error("Maximum recursion depth exceeded");
-                }
-                
-                CallFrame frame;
-                frame.return_address = ip_;
-                frame.base_pointer = stack_.size();
-                frame.function_name = f.name;
-                frame.locals = std::move(locals_);
-                frame.immutable_locals = std::move(immutable_locals_);
-                
-                call_stack_.push_back(std::move(frame));
-                recursion_depth_++;
-                
-                locals_.clear();
-                for (size_t i = 0; i < info.params.size(); ++i) {
-                    locals_[info.params[i]] = args[i];
-                }
-                immutable_locals_.clear();
-                
-                ip_ = info.body_start;
-            } else if (func.getType() == Value::Type::Lambda) {
-                auto lambda = func.getLambda();
-                
-                if (args.size() != lambda.params.size()) {
-                    throw std::runtime_error("Lambda expects " + 
-                        std::to_string(lambda.params.size()) + 
-                        " arguments, got " + std::to_string(args.size()));
-                }
-                
-                if (recursion_depth_ >= MAX_RECURSION_DEPTH) {
-                    throw std::runtime_error("Maximum recursion depth exceeded");
-                }
-                
-                std::string lambda_id;
-                if (lambda.body) {
-                    auto include_stmt = dynamic_cast<IncludeStmt*>(lambda.body.get());
-                    if (include_stmt) {
-                        lambda_id = include_stmt->path;
-                    } else {
-                        lambda_id = "__lambda_" + std::to_string(reinterpret_cast<uintptr_t>(lambda.body.get()));
-                    }
-                } else {
-                    for (const auto& [name, _] : functions_) {
-                        if (name.rfind("__lambda_", 0) == 0) {
-                            lambda_id = name;
-                            break;
-                        }
-                    }
-                }
-                
-                auto it = functions_.find(lambda_id);
-                if (it == functions_.end()) {
-                    throw std::runtime_error("Lambda not found");
-                }
-                
-                const FuncDefInfo& info = it->second;
-                
-                CallFrame frame;
-                frame.return_address = ip_;
-                frame.base_pointer = stack_.size();
-                frame.function_name = lambda_id;
-                frame.locals = std::move(locals_);
-                frame.immutable_locals = std::move(immutable_locals_);
-                
-                call_stack_.push_back(std::move(frame));
-                recursion_depth_++;
-                
-                locals_.clear();
-                if (lambda.closure) {
-                    for (const auto& [k, v] : *lambda.closure) {
-                        locals_[k] = v;
-                    }
-                }
-                for (size_t i = 0; i < lambda.params.size(); ++i) {
-                    locals_[lambda.params[i]] = args[i];
-                }
-                immutable_locals_.clear();
-                
-                ip_ = info.body_start;
+                Value result = func.get<Value::NativeFunctionData>()->call(
+                    NativeArgs(stack_.data() + base + 1, arg_count));
+                stack_.resize(base);
+                stack_.push_back(std::move(result));
+            } else if (call_stack_.empty()) {
+                if (!invoke(func, arg_count, base, nullptr)) return false;
             } else {
-                throw std::runtime_error("Cannot call type " + func.typeName());
+                if (!tailInvoke(func, arg_count)) return false;
             }
             break;
         }
         
         case OpCodeType::CallMethod: {
-            if (op.payload_type != OpCode::PAYLOAD_SIZE) break;
-            size_t arg_count = op.payload.size;
-            
-            std::vector<Value> args;
-            args.reserve(arg_count);
-            for (size_t i = 0; i < arg_count; ++i) {
-                if (stack_.empty()) throw std::runtime_error("Stack underflow");
-                args.push_back(stack_.back());
-                stack_.pop_back();
-            }
-            std::reverse(args.begin(), args.end());
-            
-            if (stack_.empty()) throw std::runtime_error("Stack underflow");
-            Value method = stack_.back();
-            stack_.pop_back();
-            
-            if (stack_.empty()) throw std::runtime_error("Stack underflow");
-            Value object = stack_.back();
-            stack_.pop_back();
+            // 栈布局：object, method, args...
+            size_t arg_count = op.operand;
+            if (stack_.size() < arg_count + 2) return fail("Stack underflow");
+            size_t base = stack_.size() - arg_count - 2;
+            const Value& method = stack_[base + 1];
             
-            if (method.getType() == Value::Type::Lambda) {
-                auto lambda = method.getLambda();
-                
-                if (args.size() != lambda.params.size()) {
-                    throw std::runtime_error("Method expects " + 
-                        std::to_string(lambda.params.size()) + 
-                        " arguments, got " + std::to_string(args.size()));
-                }
-                
-                if (recursion_depth_ >= MAX_RECURSION_DEPTH) {
-                    throw std::runtime_error("Maximum recursion depth exceeded");
-                }
-                
-                std::string lambda_id;
-                if (lambda.body) {
-                    auto include_stmt = dynamic_cast<IncludeStmt*>(lambda.body.get());
-                    if (include_stmt) {
-                        lambda_id = include_stmt->path;
-                    } else {
-                        lambda_id = "__lambda_" + std::to_string(reinterpret_cast<uintptr_t>(lambda.body.get()));
-                    }
-                } else {
-                    for (const auto& [name, _] : functions_) {
-                        if (name.rfind("__lambda_", 0) == 0) {
-                            lambda_id = name;
-                            break;
-                        }
-                    }
-                }
-                
-                auto it = functions_.find(lambda_id);
-                if (it == functions_.end()) {
-                    throw std::runtime_error("Lambda not found");
-                }
-                
-                const FuncDefInfo& info = it->second;
-                
-                CallFrame frame;
-                frame.return_address = ip_;
-                frame.base_pointer = stack_.size();
-                frame.function_name = lambda_id;
-                frame.locals = std::move(locals_);
-                frame.immutable_locals = std::move(immutable_locals_);
-                
-                call_stack_.push_back(std::move(frame));
-                recursion_depth_++;
-                
-                locals_.clear();
-                if (lambda.closure) {
-                    for (const auto& [k, v] : *lambda.closure) {
-                        locals_[k] = v;
-                    }
-                }
-                locals_["self"] = object;
-                for (size_t i = 0; i < lambda.params.size(); ++i) {
-                    locals_[lambda.params[i]] = args[i];
-                }
-                immutable_locals_.clear();
-                
-                ip_ = info.body_start;
-            } else if (method.getType() == Value::Type::Function) {
-                auto f = method.getFunction();
-                
-                auto it = functions_.find(f.name);
-                if (it == functions_.end()) {
-                    throw std::runtime_error("Function '" + f.name + "' not found");
-                }
-                
-                const FuncDefInfo& info = it->second;
-                
-                if (args.size() != info.params.size()) {
-                    throw std::runtime_error("Function '" + f.name + 
-                        "' expects " + std::to_string(info.params.size()) + 
-                        " arguments, got " + std::to_string(args.size()));
-                }
-                
-                if (recursion_depth_ >= MAX_RECURSION_DEPTH) {
-                    throw std::runtime_error("Maximum recursion depth exceeded");
-                }
-                
-                CallFrame frame;
-                frame.return_address = ip_;
-                frame.base_pointer = stack_.size();
-                frame.function_name = f.name;
-                frame.locals = std::move(locals_);
-                frame.immutable_locals = std::move(immutable_locals_);
-                
-                call_stack_.push_back(std::move(frame));
-                recursion_depth_++;
-                
-                locals_.clear();
-                locals_.reserve(info.params.size() + 1);
-                locals_["self"] = object;
-                for (size_t i = 0; i < info.params.size(); ++i) {
-                    locals_[info.params[i]] = args[i];
-                }
-                immutable_locals_.clear();
-                
-                ip_ = info.body_start;
-            } else if (method.getType() == Value::Type::NativeFunction) {
-                auto nf = method.getNativeFunction();
-                std::vector<Value> native_args;
-                native_args.reserve(args.size() + 1);
-                native_args.push_back(object);
-                native_args.insert(native_args.end(), args.begin(), args.end());
-                Value result = nf.func(native_args);
-                stack_.push_back(result);
+            if (method.getType() == Value::Type::NativeFunction) {
+                // 把方法移出，对象挪到它的位置，self 和实参就在栈上连续存放
+                Value native = std::move(stack_[base + 1]);
+                stack_[base + 1] = std::move(stack_[base]);
+                Value result = native.get<Value::NativeFunctionData>()->call(
+                    NativeArgs(stack_.data() + base + 1, arg_count + 1));
+                stack_.resize(base);
+                stack_.push_back(std::move(result));
             } else {
-                throw std::runtime_error("Cannot call method of type " + method.typeName());
+                if (!invoke(method, arg_count, base, &stack_[base])) return false;
             }
             break;
         }
         
         case OpCodeType::MakeStruct: {
-            if (op.payload_type == OpCode::PAYLOAD_SIZE) {
-                size_t field_count = op.payload.size;
-                auto fields = std::make_shared<std::unordered_map<std::string, Value>>();
-                
-                for (size_t i = 0; i < field_count; ++i) {
-                    if (stack_.size() < 2) throw std::runtime_error("Stack underflow");
-                    
-                    Value value = stack_.back();
-                    stack_.pop_back();
-                    Value key_val = stack_.back();
-                    stack_.pop_back();
-                    
-                    if (key_val.getType() != Value::Type::String) {
-                        throw std::runtime_error("Struct key must be a string");
-                    }
-                    
-                    (*fields)[key_val.getString()] = value;
+            size_t field_count = op.operand;
+            if (stack_.size() < field_count * 2) return fail("Stack underflow");
+            
+            // 按字面量顺序添加字段，相同写法的结构体共享同一个形状
+            auto fields = makeRef<StructObject>();
+            size_t base = stack_.size() - field_count * 2;
+            for (size_t i = base; i < stack_.size(); i += 2) {
+                const Value& key_val = stack_[i];
+                if (key_val.getType() != Value::Type::String) {
+                    return fail("Struct key must be a string");
                 }
-                
-                stack_.push_back(Value::makeStruct(fields));
+                fields->set(key_val.getString(), std::move(stack_[i + 1]));
             }
+            stack_.resize(base);
+            
+            stack_.push_back(Value::makeStruct(fields));
             break;
         }
         
         case OpCodeType::MakeLambda: {
-            if (op.payload_type != OpCode::PAYLOAD_LAMBDA_INFO) break;
-            
-            if (stack_.empty()) throw std::runtime_error("Stack underflow");
-            Value lambda_id_val = stack_.back();
-            stack_.pop_back();
+            const LambdaInfo& info = bytecode_.getLambda(op.operand);
+            Value::LambdaData lambda_data;
+            lambda_data.params = info.params;
+            lambda_data.proto = info.function;
+            lambda_data.program = program_id_;
             
-            if (lambda_id_val.getType() != Value::Type::String) {
-                throw std::runtime_error("Expected lambda ID as string");
+            // 只复制捕获分析列出的槽位；未赋值的槽位不捕获，调用时回退到按名字查找
+            if (current_func_ && !info.captures.empty()) {
+                lambda_data.upvalues.reserve(info.captures.size());
+                for (const LambdaCapture& capture : info.captures) {
+                    const LocalSlot& slot = slots_[slot_base_ + capture.from];
+                    if (slot.assigned) {
+                        lambda_data.upvalues.push_back(Upvalue{capture.to, slot.value});
+                    }
+                }
             }
-            std::string lambda_id = lambda_id_val.getString();
-            
-            auto closure = std::make_shared<std::unordered_map<std::string, Value>>();
+            // 方法中的 self 等按名字绑定的变量仍整体复制，通常只有一两个。
+            // 闭包表与解释器共用，按名字字符串保存
             if (!locals_.empty()) {
-                *closure = locals_;
-            } else {
-                closure = globals_;
+                auto closure = std::make_shared<std::unordered_map<std::string, Value>>();
+                for (const auto& [atom, value] : locals_) {
+                    closure->emplace(AtomTable::name(atom), value);
+                }
+                lambda_data.closure = std::move(closure);
             }
             
-            Value::LambdaData lambda_data;
-            lambda_data.params = op.payload.lambda_info.params;
-            lambda_data.body = std::make_shared<IncludeStmt>(lambda_id);
-            lambda_data.closure = closure;
-            
-            stack_.push_back(Value::makeLambda(lambda_data));
+            stack_.push_back(Value::makeLambda(std::move(lambda_data)));
             break;
         }
         
         case OpCodeType::MemberAssign: {
-            if (op.payload_type != OpCode::PAYLOAD_STRING) break;
             
-            if (stack_.size() < 2) throw std::runtime_error("Stack underflow");
+            if (stack_.size() < 2) return fail("Stack underflow");
             
             Value value = stack_.back();
             stack_.pop_back();
             Value object = stack_.back();
             stack_.pop_back();
             
-            const std::string& member = op.payload.str;
-            
+            if (object.isFrozen()) {
+                return fail("cannot mutate shared " + object.typeName() + " inside parallel callback");
+            }
             if (object.getType() == Value::Type::Struct ||
                 object.getType() == Value::Type::Module) {
-                
-                auto struct_map = (object.getType() == Value::Type::Struct) 
-                    ? object.getStruct() : object.getModule();
-                
-                (*struct_map)[member] = value;
+                storeMember(inline_caches_[op.operand], *object.get<StructObject>(),
+                            std::move(value));
             } else {
-                throw std::runtime_error("Cannot assign member to " + object.typeName());
+                return fail("Cannot assign member to " + object.typeName());
             }
             break;
         }
         
         case OpCodeType::MemberAssignVar: {
-            if (op.payload_type != OpCode::PAYLOAD_MEMBER_ASSIGN) break;
             
-            const std::string& var_name = op.payload.member_assign.first;
-            const std::string& member = op.payload.member_assign.second;
+            InlineCache& cache = inline_caches_[op.operand];
+            Atom var_name = bytecode_.getAtom(bytecode_.getMemberTarget(cache.operand).var);
             
-            ensureMutable(var_name);
+            if (!ensureMutable(var_name)) return false;
             
-            if (stack_.empty()) throw std::runtime_error("Stack underflow");
+            if (stack_.empty()) return fail("Stack underflow");
             Value value = stack_.back();
             stack_.pop_back();
             
-            Value object = getVariable(var_name);
+            Value object;
+            if (!getVariable(var_name, object)) return false;
+            if (object.isFrozen()) {
+                return fail("cannot mutate shared " + object.typeName() + " inside parallel callback");
+            }
             
             if (object.getType() == Value::Type::Struct ||
                 object.getType() == Value::Type::Module) {
-                
-                auto struct_map = (object.getType() == Value::Type::Struct) 
-                    ? object.getStruct() : object.getModule();
-                
-                (*struct_map)[member] = value;
+                storeMember(cache, *object.get<StructObject>(), std::move(value));
             } else if (object.getType() == Value::Type::Null) {
-                ensureMutable(var_name);
-                auto new_struct = std::make_shared<std::unordered_map<std::string, Value>>();
-                (*new_struct)[member] = value;
-                setVariableChecked(var_name, Value::makeStruct(new_struct));
+                auto new_struct = makeRef<StructObject>();
+                new_struct->set(bytecode_.getAtom(cache.name), std::move(value));
+                if (!setVariableChecked(var_name, Value::makeStruct(new_struct))) return false;
             } else {
-                throw std::runtime_error("Cannot assign member to " + object.typeName());
+                return fail("Cannot assign member to " + object.typeName());
             }
             break;
         }
         
         case OpCodeType::IndexAssign:
-            throw std::runtime_error("IndexAssign not yet implemented");
+            return fail("IndexAssign not yet implemented");
         
         case OpCodeType::ConvertType: {
-            if (op.payload_type != OpCode::PAYLOAD_DECL_TYPE) break;
             
-            if (stack_.empty()) throw std::runtime_error("Stack underflow");
+            if (stack_.empty()) return fail("Stack underflow");
             Value val = stack_.back();
             stack_.pop_back();
             
-            Value converted = convertToType(val, op.payload.decl_type);
+            Value converted = convertToType(val, static_cast<DeclaredType>(op.operand));
             stack_.push_back(converted);
             break;
         }
@@ -1441,59 +1991,423 @@ void VM::executeInstructionAt(size_t ip) {
         case OpCodeType::Halt:
             halted_ = true;
             break;
+        
+        case OpCodeType::AddIntInt:
+        case OpCodeType::SubIntInt:
+        case OpCodeType::MulIntInt:
+        case OpCodeType::ModIntInt:
+        case OpCodeType::EqIntInt:
+        case OpCodeType::NeqIntInt:
+        case OpCodeType::GtIntInt:
+        case OpCodeType::GteIntInt:
+        case OpCodeType::LtIntInt:
+        case OpCodeType::LteIntInt:
+            if (!quickenedOp(ip)) {
+                // 已改回通用指令，重新执行一次
+                return executeInstructionAt(ip);
+            }
+            break;
+        
+        case OpCodeType::IncLocal:
+        case OpCodeType::IncGlobal:
+        case OpCodeType::AddLocalLocal:
+        case OpCodeType::ArithConst:
+        case OpCodeType::CmpConstJumpIfFalse:
+        case OpCodeType::CmpLocalJumpIfFalse:
+            if (!superinstruction(ip)) {
+                // 只执行首条指令，序列其余部分照常逐条执行
+                return executeInstruction(Instruction{fusedHeadOpCode(op.type), op.operand}, ip);
+            }
+            break;
+        
+        case OpCodeType::JitEntry:
+            if (!jit_) return fail("Invalid JIT entry");
+            return jit_->enter(ip);
     }
+    return true;
 }
 
-template<typename F>
-void VM::binaryOp(F&& f) {
-    if (stack_.size() < 2) throw std::runtime_error("Stack underflow");
+bool VM::binaryOp(BinOp op) {
+    if (stack_.size() < 2) return fail("Stack underflow");
     
-    Value right = stack_.back();
-    stack_.pop_back();
-    Value left = stack_.back();
+    auto result = value_binary_op(stack_[stack_.size() - 2], op, stack_.back());
+    if (result.is_error()) return fail(result.error());
     stack_.pop_back();
+    stack_.back() = std::move(result.value());
+    return true;
+}
+
+void VM::quicken(size_t ip) {
+    if (!quickening_ || stack_.size() < 2) return;
+    if (stack_[stack_.size() - 2].getType() != Value::Type::Int ||
+        stack_.back().getType() != Value::Type::Int) {
+        return;
+    }
+    
+    Instruction& op = bytecode_.getInstructions()[ip];
+    op.type = int_specialized(op.type);
+}
+
+bool VM::quickenedOp(size_t ip) {
+    Instruction& op = bytecode_.getInstructions()[ip];
+    size_t n = stack_.size();
+    if (n >= 2) {
+        Value& lhs = stack_[n - 2];
+        const Value& rhs = stack_[n - 1];
+        if (lhs.getType() == Value::Type::Int && rhs.getType() == Value::Type::Int &&
+            int_fast_op(op.type, lhs.getInt(), rhs.getInt(), lhs)) {
+            stack_.pop_back();
+            return true;
+        }
+    }
+    
+    // 守卫失败：退回通用指令，之后再次观察到整数操作数时会重新特化
+    op.type = genericOpCode(op.type);
+    return false;
+}
+
+bool VM::superinstruction(size_t ip) {
+    const std::vector<Instruction>& code = bytecode_.getInstructions();
+    const Instruction& op = code[ip];
+    
+    switch (op.type) {
+        case OpCodeType::IncLocal: {
+            LocalSlot& slot = slots_[slot_base_ + op.operand];
+            const Value& step = bytecode_.getConstant(code[ip + 1].operand);
+            if (!slot.assigned || slot.value.getType() != Value::Type::Int ||
+                step.getType() != Value::Type::Int) {
+                return false;
+            }
+            int_fast_op(OpCodeType::AddIntInt, slot.value.getInt(), step.getInt(), slot.value);
+            ip_ = ip + 4;
+            return true;
+        }
+        
+        case OpCodeType::IncGlobal: {
+            if (!locals_.empty() || global_table_.isImmutable(op.operand)) return false;
+            Value* value = global_table_.get(op.operand);
+            const Value& step = bytecode_.getConstant(code[ip + 1].operand);
+            if (!value || value->getType() != Value::Type::Int ||
+                step.getType() != Value::Type::Int) {
+                return false;
+            }
+            int_fast_op(OpCodeType::AddIntInt, value->getInt(), step.getInt(), *value);
+            ip_ = ip + 4;
+            return true;
+        }
+        
+        case OpCodeType::AddLocalLocal: {
+            const LocalSlot& a = slots_[slot_base_ + op.operand];
+            const LocalSlot& b = slots_[slot_base_ + code[ip + 1].operand];
+            if (!a.assigned || !b.assigned ||
+                a.value.getType() != Value::Type::Int || b.value.getType() != Value::Type::Int) {
+                return false;
+            }
+            Value sum;
+            int_fast_op(OpCodeType::AddIntInt, a.value.getInt(), b.value.getInt(), sum);
+            stack_.push_back(std::move(sum));
+            ip_ = ip + 3;
+            return true;
+        }
+        
+        case OpCodeType::ArithConst: {
+            if (stack_.empty()) return false;
+            Value& lhs = stack_.back();
+            const Value& rhs = bytecode_.getConstant(op.operand);
+            if (lhs.getType() != Value::Type::Int || rhs.getType() != Value::Type::Int ||
+                !int_fast_op(int_specialized(genericOpCode(code[ip + 1].type)),
+                             lhs.getInt(), rhs.getInt(), lhs)) {
+                return false;
+            }
+            ip_ = ip + 2;
+            return true;
+        }
+        
+        case OpCodeType::CmpConstJumpIfFalse: {
+            if (stack_.empty()) return false;
+            const Value& lhs = stack_.back();
+            const Value& rhs = bytecode_.getConstant(op.operand);
+            Value cond;
+            if (lhs.getType() != Value::Type::Int || rhs.getType() != Value::Type::Int ||
+                !int_fast_op(int_specialized(genericOpCode(code[ip + 1].type)),
+                             lhs.getInt(), rhs.getInt(), cond)) {
+                return false;
+            }
+            stack_.pop_back();
+            ip_ = cond.getBool() ? ip + 3 : code[ip + 2].operand;
+            return true;
+        }
+        
+        case OpCodeType::CmpLocalJumpIfFalse: {
+            if (stack_.empty()) return false;
+            const Value& lhs = stack_.back();
+            const LocalSlot& rhs = slots_[slot_base_ + op.operand];
+            Value cond;
+            if (!rhs.assigned ||
+                lhs.getType() != Value::Type::Int || rhs.value.getType() != Value::Type::Int ||
+                !int_fast_op(int_specialized(genericOpCode(code[ip + 1].type)),
+                             lhs.getInt(), rhs.value.getInt(), cond)) {
+                return false;
+            }
+            stack_.pop_back();
+            ip_ = cond.getBool() ? ip + 3 : code[ip + 2].operand;
+            return true;
+        }
+        
+        default:
+            return false;
+    }
+}
+
+void VM::InlineCache::add(const Shape* shape, const Shape* next, uint32_t slot) {
+    // 字典模式的形状不共享，不能作为缓存键
+    if (megamorphic || !shape->isShared() || (next && !next->isShared())) return;
+    if (size == kMaxEntries) {
+        megamorphic = true;
+        return;
+    }
+    entries[size++] = Entry{shape, next, slot};
+}
+
+bool VM::loadMember(InlineCache& cache, const Value& object, Value& out) {
+    if (object.getType() != Value::Type::Struct && object.getType() != Value::Type::Module) {
+        cache.misses++;
+        return fail("Cannot access member of type " + object.typeName());
+    }
     
-    Value result = f(left, right);
-    stack_.push_back(result);
+    const StructObject& fields = *object.get<StructObject>();
+    const Shape* shape = fields.shape();
+    if (const InlineCache::Entry* entry = cache.find(shape)) {
+        cache.hits++;
+        out = fields.slot(entry->slot);
+        return true;
+    }
+    
+    cache.misses++;
+    Atom member = bytecode_.getAtom(cache.name);
+    int32_t slot = shape->slotOf(member);
+    if (slot < 0) {
+        return fail(object.typeName() + " does not have member '" + AtomTable::name(member) + "'");
+    }
+    cache.add(shape, nullptr, static_cast<uint32_t>(slot));
+    out = fields.slot(slot);
+    return true;
 }
 
-Value VM::getVariable(const std::string& name) const {
+void VM::storeMember(InlineCache& cache, StructObject& object, Value value) {
+    const Shape* shape = object.shape();
+    if (const InlineCache::Entry* entry = cache.find(shape)) {
+        cache.hits++;
+        if (entry->next) {
+            object.appendWithShape(entry->next, std::move(value));
+        } else {
+            object.slot(entry->slot) = std::move(value);
+        }
+        return;
+    }
+    
+    cache.misses++;
+    size_t slot = object.set(bytecode_.getAtom(cache.name), std::move(value));
+    const Shape* next = object.shape();
+    cache.add(shape, next == shape ? nullptr : next, static_cast<uint32_t>(slot));
+}
+
+bool VM::getVariable(Atom name, Value& out) {
+    const LocalSlot* slot = findLocalSlot(name);
+    if (slot && slot->assigned) {
+        out = slot->value;
+        return true;
+    }
+    
     auto it = locals_.find(name);
     if (it != locals_.end()) {
-        return it->second;
+        out = it->second;
+        return true;
     }
     
-    auto git = globals_->find(name);
-    if (git != globals_->end()) {
-        return git->second;
+    if (const Value* global = global_table_.lookup(name)) {
+        out = *global;
+        return true;
     }
     
-    throw std::runtime_error("Undefined variable: " + name);
+    return fail("Undefined variable: " + AtomTable::name(name));
 }
 
-void VM::setVariable(const std::string& name, const Value& value) {
+void VM::setVariable(Atom name, const Value& value) {
     if (call_stack_.empty()) {
-        (*globals_)[name] = value;
+        global_table_.set(global_table_.resolve(name), value);
+    } else if (LocalSlot* slot = findLocalSlot(name)) {
+        slot->value = value;
+        slot->assigned = true;
     } else {
         locals_[name] = value;
     }
 }
 
-void VM::ensureMutable(const std::string& name) const {
-    if (call_stack_.empty()) {
-        if (immutable_globals_.find(name) != immutable_globals_.end()) {
-            throw std::runtime_error("Cannot assign to immutable variable '" + name + "'");
+void VM::bindCaptures(const Value::LambdaData& lambda) {
+    for (const Upvalue& upvalue : lambda.upvalues) {
+        LocalSlot& slot = slots_[slot_base_ + upvalue.slot];
+        slot.value = upvalue.value;
+        slot.assigned = true;
+    }
+    if (lambda.closure) {
+        for (const auto& [k, v] : *lambda.closure) {
+            locals_[AtomTable::intern(k)] = v;
         }
-    } else {
-        if (immutable_locals_.find(name) != immutable_locals_.end()) {
-            throw std::runtime_error("Cannot assign to immutable variable '" + name + "'");
+    }
+}
+
+const VM::FunctionProto* VM::resolveCallee(const Value& callee, size_t argc, bool method,
+                                           const Value::LambdaData*& lambda) {
+    lambda = nullptr;
+    if (const auto* f = callee.get<Value::FunctionData>()) {
+        if (f->program != program_id_ || f->proto >= protos_.size()) {
+            fail("Function '" + f->name + "' not found");
+            return nullptr;
+        }
+        const FunctionProto& proto = protos_[f->proto];
+        if (argc != proto.arity) {
+            fail("Function '" + f->name + 
+                "' expects " + std::to_string(proto.arity) + 
+                " arguments, got " + std::to_string(argc));
+            return nullptr;
+        }
+        return &proto;
+    }
+    if ((lambda = callee.get<Value::LambdaData>())) {
+        if (lambda->program != program_id_ || lambda->proto >= protos_.size()) {
+            fail("Lambda not found");
+            return nullptr;
+        }
+        const FunctionProto& proto = protos_[lambda->proto];
+        if (argc != proto.arity) {
+            fail(std::string(method ? "Method" : "Lambda") + " expects " + 
+                std::to_string(proto.arity) + 
+                " arguments, got " + std::to_string(argc));
+            return nullptr;
+        }
+        return &proto;
+    }
+    fail(std::string(method ? "Cannot call method of type " : "Cannot call type ") + 
+        callee.typeName());
+    return nullptr;
+}
+
+bool VM::invoke(const Value& callee, size_t argc, size_t base, const Value* self) {
+    // 调用是环回收的检查点：callee 和实参都在栈上，不会被当作垃圾
+    if (CycleCollector::pending()) CycleCollector::collect();
+    
+    const Value::LambdaData* lambda = nullptr;
+    const FunctionProto* proto = resolveCallee(callee, argc, self != nullptr, lambda);
+    if (!proto) return false;
+    
+    if (recursion_depth_ >= MAX_RECURSION_DEPTH) {
+        return fail("Maximum recursion depth exceeded");
+    }
+    
+    CallFrame frame;
+    frame.return_address = ip_;
+    frame.base_pointer = base;
+    frame.slot_base = slot_base_;
+    frame.function = current_func_;
+    frame.locals = std::move(locals_);
+    frame.immutable_locals = std::move(immutable_locals_);
+    
+    call_stack_.push_back(std::move(frame));
+    recursion_depth_++;
+    
+    locals_.clear();
+    immutable_locals_.clear();
+    
+    slot_base_ = slots_.size();
+    slots_.resize(slot_base_ + proto->slot_count);
+    current_func_ = proto->info;
+    
+    // callee 和 self 可能就在栈上，截断栈之前完成绑定
+    if (lambda) {
+        bindCaptures(*lambda);
+    }
+    if (self) {
+        static const Atom self_atom = AtomTable::intern("self");
+        locals_[self_atom] = *self;
+    }
+    // 参数占据前 arity 个槽位，直接从栈上移入
+    size_t first_arg = stack_.size() - argc;
+    for (size_t i = 0; i < argc; ++i) {
+        LocalSlot& slot = slots_[slot_base_ + i];
+        slot.value = std::move(stack_[first_arg + i]);
+        slot.assigned = true;
+    }
+    stack_.resize(base);
+    
+    if (jit_) jit_->countHot(static_cast<size_t>(proto - protos_.data()));
+    ip_ = proto->body_start;
+    return true;
+}
+
+bool VM::tailInvoke(const Value& callee, size_t argc) {
+    const Value::LambdaData* lambda = nullptr;
+    const FunctionProto* found = resolveCallee(callee, argc, false, lambda);
+    if (!found) return false;
+    const FunctionProto& proto = *found;
+    
+    // 当前帧的返回地址、调用者状态保持不变，只替换被调用者的局部状态。
+    // callee 和实参还在栈上，截断栈之前完成绑定
+    locals_.clear();
+    immutable_locals_.clear();
+    slots_.resize(slot_base_);
+    slots_.resize(slot_base_ + proto.slot_count);
+    current_func_ = proto.info;
+    
+    if (lambda) {
+        bindCaptures(*lambda);
+    }
+    size_t first_arg = stack_.size() - argc;
+    for (size_t i = 0; i < argc; ++i) {
+        LocalSlot& slot = slots_[slot_base_ + i];
+        slot.value = std::move(stack_[first_arg + i]);
+        slot.assigned = true;
+    }
+    stack_.resize(call_stack_.back().base_pointer);
+    
+    if (jit_) jit_->countHot(static_cast<size_t>(found - protos_.data()));
+    ip_ = proto.body_start;
+    return true;
+}
+
+const LocalSlot* VM::findLocalSlot(Atom name) const {
+    if (!current_func_) return nullptr;
+    const auto& names = current_func_->locals;
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) {
+            return &slots_[slot_base_ + i];
         }
     }
+    return nullptr;
+}
+
+LocalSlot* VM::findLocalSlot(Atom name) {
+    return const_cast<LocalSlot*>(std::as_const(*this).findLocalSlot(name));
+}
+
+bool VM::ensureMutable(Atom name) {
+    bool immutable;
+    if (call_stack_.empty()) {
+        auto slot = global_table_.find(name);
+        immutable = slot && global_table_.isImmutable(*slot);
+    } else {
+        immutable = immutable_locals_.find(name) != immutable_locals_.end();
+    }
+    if (immutable) {
+        return fail("Cannot assign to immutable variable '" + AtomTable::name(name) + "'");
+    }
+    return true;
 }
 
-void VM::setVariableChecked(const std::string& name, const Value& value) {
-    ensureMutable(name);
+bool VM::setVariableChecked(Atom name, const Value& value) {
+    if (!ensureMutable(name)) return false;
     setVariable(name, value);
+    return true;
 }
 
 Value VM::convertToType(const Value& val, DeclaredType dtype) const {
@@ -1525,7 +2439,7 @@ std::pair<size_t, size_t> VM::getCacheStats() const {
     size_t total_hits = 0;
     size_t total_misses = 0;
     
-    for (const auto& [_, cache] : member_cache_) {
+    for (const auto& cache : inline_caches_) {
         total_hits += cache.hits;
         total_misses += cache.misses;
     }
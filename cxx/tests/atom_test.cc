@@ -0,0 +1,142 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <atom.h>
+#include <interpreter.h>
+#include <lexer.h>
+#include <parser.h>
+#include <shape.h>
+#include <vm.h>
+#include <thread>
+#include <vector>
+
+using namespace rumina;
+using namespace rumina::test;
+
+void test_intern_is_stable() {
+    Atom a = AtomTable::intern("atom_test_name");
+    Atom b = AtomTable::intern(std::string("atom_test_") + "name");
+    assert_eq(a, b);
+    assert_true(a != AtomTable::intern("atom_test_other"));
+    assert_eq(AtomTable::name(a), std::string("atom_test_name"));
+
+    // 名字的地址在表增长后保持不变
+    const std::string* address = &AtomTable::name(a);
+    for (int i = 0; i < 3000; ++i) {
+        AtomTable::intern("atom_test_fill_" + std::to_string(i));
+    }
+    assert_true(address == &AtomTable::name(a));
+    assert_eq(AtomTable::find("atom_test_name"), a);
+    assert_eq(AtomTable::find("atom_test_never_interned"), kNoAtom);
+}
+
+void test_lexer_and_parser_intern() {
+    Lexer lexer("point.x + counter;");
+    auto tokens = lexer.tokenize();
+    assert_eq(tokens[0].atom, AtomTable::intern("point"));
+    assert_eq(tokens[2].atom, AtomTable::intern("x"));
+    assert_eq(tokens[4].atom, AtomTable::intern("counter"));
+
+    Parser parser(tokens);
+    auto ast = parser.parse();
+    assert_eq(ast.size(), static_cast<size_t>(1));
+    assert_true(ast[0]->toString().find("counter") != std::string::npos);
+}
+
+void test_struct_fields_by_atom() {
+    StructObject object;
+    Atom x = AtomTable::intern("x");
+    Atom y = AtomTable::intern("y");
+    object.set(x, Value(static_cast<int64_t>(1)));
+    // 已驻留的名字按字符串设置与按原子设置相同
+    object["y"] = Value(static_cast<int64_t>(2));
+
+    assert_eq(object.find(x)->second.getInt(), 1);
+    assert_eq(object.find("y")->second.getInt(), 2);
+    assert_eq(object.shape()->atomAt(1), y);
+    assert_true(object.shape()->isShared());
+    // 按字符串查找从未驻留过的名字不会向原子表添加条目
+    size_t before = AtomTable::size();
+    assert_true(object.find("atom_test_missing_field") == object.end());
+    assert_eq(object.erase("atom_test_missing_field"), static_cast<size_t>(0));
+    assert_eq(AtomTable::size(), before);
+}
+
+void test_runtime_keys_are_not_interned() {
+    size_t before = AtomTable::size();
+    StructObject object;
+    object.set(AtomTable::intern("x"), Value(static_cast<int64_t>(0)));
+    for (int i = 0; i < 1000; ++i) {
+        object.set("atom_test_key_" + std::to_string(i), Value(static_cast<int64_t>(i)));
+    }
+    object["atom_test_key_7"] = Value(static_cast<int64_t>(70));
+    // 只有 "x" 进入原子表，其余键以字符串保存在字典形状里
+    assert_true(AtomTable::size() <= before + 1);
+    assert_true(!object.shape()->isShared());
+    assert_eq(object.size(), static_cast<size_t>(1001));
+    assert_eq(object.find("atom_test_key_7")->second.getInt(), 70);
+
+    // 之后才驻留的名字仍能按原子找到字符串键
+    Atom late = AtomTable::intern("atom_test_key_999");
+    assert_eq(object.find(late)->second.getInt(), 999);
+    object.set(late, Value(static_cast<int64_t>(-1)));
+    assert_eq(object.size(), static_cast<size_t>(1001));
+
+    StructObject copy(object);
+    assert_eq(copy.erase("atom_test_key_0"), static_cast<size_t>(1));
+    assert_eq(copy.size(), static_cast<size_t>(1000));
+    assert_eq(copy.find("atom_test_key_999")->second.getInt(), -1);
+    assert_true(copy.find("atom_test_key_0") == copy.end());
+    assert_eq(object.find("atom_test_key_0")->second.getInt(), 0);
+
+    size_t index = 0;
+    for (const auto& [key, value] : copy) {
+        if (index++ == 1) assert_eq(key, std::string("atom_test_key_1"));
+    }
+}
+
+void test_concurrent_intern() {
+    std::vector<std::vector<Atom>> results(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < results.size(); ++t) {
+        threads.emplace_back([&results, t] {
+            for (int i = 0; i < 500; ++i) {
+                results[t].push_back(AtomTable::intern("atom_test_shared_" + std::to_string(i)));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (size_t t = 1; t < results.size(); ++t) {
+        assert_true(results[t] == results[0]);
+    }
+}
+
+void test_vm_names() {
+    // 闭包、方法 self 和按名字回退的变量都以原子为键
+    auto result = run_vm(
+        "func counter() { var n = 0; var bump = |d| n + d; return bump(5); }"
+        "var obj = {v = 3};"
+        "obj.times = |k| self.v * k;"
+        "var later = 0;"
+        "func read() { return later; }"
+        "later = 7;"
+        "[counter(), obj.times(2), read()];");
+    assert_ok(result);
+    assert_eq(result.value()->toString(), std::string("[5, 6, 7]"));
+
+    auto missing = run_vm("func f() { return nowhere; } f();");
+    assert_error(missing);
+    assert_true(missing.error().find("nowhere") != std::string::npos);
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("intern_is_stable", test_intern_is_stable);
+    runner.add_test("lexer_and_parser_intern", test_lexer_and_parser_intern);
+    runner.add_test("struct_fields_by_atom", test_struct_fields_by_atom);
+    runner.add_test("runtime_keys_are_not_interned", test_runtime_keys_are_not_interned);
+    runner.add_test("concurrent_intern", test_concurrent_intern);
+    runner.add_test("vm_names", test_vm_names);
+
+    return runner.run_all();
+}
@@ -0,0 +1,86 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <interpreter.h>
+#include <vm.h>
+
+using namespace rumina;
+using namespace rumina::test;
+
+// 外层函数有很多局部变量，lambda 只用到其中一个
+const char* LAMBDA_IN_LOOP = R"(
+func pipeline(n) {
+    var a = 1; var b = 2; var c = 3; var d = 4; var e = 5;
+    var f = 6; var g = 7; var h = 8; var k = 9; var m = 10;
+    var scale = 3;
+    var total = 0;
+    var i = 0;
+    while (i < n) {
+        var mul = |x| x * scale;
+        total = total + mul(i);
+        i = i + 1;
+    }
+    return total + a + b + c + d + e + f + g + h + k + m;
+}
+pipeline(20000);
+)";
+
+static Value run_value(const std::string& code, long long* elapsed_ms = nullptr) {
+    auto result = run_vm(code, elapsed_ms);
+    assert_ok(result);
+    assert_true(result.value().has_value());
+    return result.value().value();
+}
+
+void test_only_referenced_locals_are_captured() {
+    auto compiled = compile_code(LAMBDA_IN_LOOP);
+    assert_ok(compiled);
+    ByteCode& bytecode = compiled.value();
+    assert_eq(bytecode.getLambdas().size(), static_cast<size_t>(1));
+    assert_eq(bytecode.getLambdas()[0].captures.size(), static_cast<size_t>(1));
+
+    // 顶层 lambda 直接读全局，不需要捕获
+    auto top = compile_code("var y = 2; var f = |x| x + y; f(1);");
+    assert_ok(top);
+    assert_true(top.value().getLambdas()[0].captures.empty());
+}
+
+void test_capture_is_snapshot() {
+    // 与原有语义一致：捕获创建时的值，lambda 内的赋值不影响外层
+    Value result = run_value(
+        "func mk(n) { var base = n * 2; var g = |x| x + base; base = 1000; return g; }"
+        "func counter() { var c = 0; var inc = do |d| { c = c + 1; return c; }; inc(0); inc(0); return c * 10 + inc(0); }"
+        "mk(5)(1) * 100 + counter();"
+    );
+    assert_eq(result.getInt(), 1101);
+}
+
+void test_nested_lambda_captures_through_outer() {
+    Value result = run_value(
+        "func nest(a) {"
+        "    var b = a + 1;"
+        "    var outer = do |p| { var inner = |q| q + a + b + p; return inner(1); };"
+        "    return outer(10);"
+        "}"
+        "nest(1);"
+    );
+    assert_eq(result.getInt(), 14);
+}
+
+void test_lambda_in_loop() {
+    long long elapsed = 0;
+    Value result = run_value(LAMBDA_IN_LOOP, &elapsed);
+    assert_eq(result.getInt(), 3 * (19999LL * 20000 / 2) + 55);
+
+    std::cout << "Lambda creation loop: " << elapsed << "ms\n";
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("only_referenced_locals_are_captured", test_only_referenced_locals_are_captured);
+    runner.add_test("capture_is_snapshot", test_capture_is_snapshot);
+    runner.add_test("nested_lambda_captures_through_outer", test_nested_lambda_captures_through_outer);
+    runner.add_test("lambda_in_loop", test_lambda_in_loop);
+
+    return runner.run_all();
+}
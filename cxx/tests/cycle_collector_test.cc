@@ -0,0 +1,151 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <cycle_collector.h>
+#include <interpreter.h>
+#include <vm.h>
+#include <string>
+#include <utility>
+
+using namespace rumina;
+using namespace rumina::test;
+
+void test_collects_unreachable_cycles() {
+    CycleCollector::collect();
+    size_t before = CycleCollector::stats().tracked;
+    {
+        Value a = Value::makeStruct(makeRef<StructObject>());
+        Value b = Value::makeStruct(makeRef<StructObject>());
+        (*a.getStruct())["other"] = b;
+        (*b.getStruct())["other"] = a;
+        Value list = Value::makeArray({a});
+        list.getArray()->push_back(list);
+    }
+    // 两个结构体和一个自引用数组只被环引用，引用计数释放不了
+    assert_eq(CycleCollector::stats().tracked, before + 3);
+    assert_eq(CycleCollector::collect(), static_cast<size_t>(3));
+    assert_eq(CycleCollector::stats().tracked, before);
+    assert_eq(CycleCollector::stats().last_collected, static_cast<size_t>(3));
+}
+
+void test_keeps_reachable_cycles() {
+    Value a = Value::makeStruct(makeRef<StructObject>());
+    {
+        Value b = Value::makeStruct(makeRef<StructObject>());
+        (*a.getStruct())["other"] = b;
+        (*b.getStruct())["other"] = a;
+        (*b.getStruct())["name"] = Value("b");
+    }
+    // 环上的 b 只能经由外部持有的 a 到达
+    CycleCollector::collect();
+    const Value& b = (*a.getStruct())["other"];
+    assert_eq((*b.getStruct())["name"].getString(), std::string("b"));
+    assert_true((*b.getStruct())["other"].getStruct() == a.getStruct());
+
+    // 断开外部引用后整个环成为垃圾
+    ArrayRef holder = makeRef<ArrayObject>();
+    holder->push_back(a);
+    a = Value();
+    assert_eq(CycleCollector::collect(), static_cast<size_t>(0));
+    holder->clear();
+    assert_eq(CycleCollector::collect(), static_cast<size_t>(2));
+}
+
+void test_closure_cycles() {
+    // lambda 捕获的结构体又保存着这个 lambda
+    CycleCollector::collect();
+    size_t before = CycleCollector::stats().tracked;
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    auto result = run_vm(vm,
+        "func make(i) {\n"
+        "    var box = {};\n"
+        "    box.value = i;\n"
+        "    var get = |x| box.value + x;\n"
+        "    box.get = get;\n"
+        "    return get(0);\n"
+        "}\n"
+        "var total = 0;\n"
+        "for (var i = 0; i < 1000; i = i + 1) { total = total + make(i); }\n"
+        "total;");
+    assert_ok(result);
+    assert_eq(result.value()->getInt(), 499500);
+    CycleCollector::collect();
+    // 全局表里的函数和模块等仍然存活，1000 个结构体和 lambda 都已释放
+    assert_true(CycleCollector::stats().tracked < before + 100);
+}
+
+void test_automatic_collection_keeps_memory_flat() {
+    size_t saved = CycleCollector::threshold();
+    CycleCollector::setThreshold(500);
+    CycleCollector::collect();
+    GcStats start = CycleCollector::stats();
+
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    auto result = run_vm(vm,
+        "func link(i) { var a = {}; var b = {}; a.next = b; b.next = a; a.id = i; return a.id; }\n"
+        "var s = 0;\n"
+        "var i = 0;\n"
+        "while (i < 20000) { s = s + link(i); i = i + 1; }\n"
+        "s;");
+    assert_ok(result);
+    assert_eq(result.value()->getInt(), 199990000);
+
+    GcStats end = CycleCollector::stats();
+    assert_true(end.collections > start.collections);
+    assert_true(end.collected - start.collected >= 39000);
+    // 存活的容器单元不随迭代次数增长
+    assert_true(end.tracked < start.tracked + 2000);
+    std::cout << "collections: " << end.collections - start.collections
+              << ", collected: " << end.collected - start.collected
+              << ", pause: " << end.total_pause_us - start.total_pause_us << "us\n";
+    CycleCollector::setThreshold(saved);
+}
+
+void test_pending_deferred_while_concurrent() {
+    size_t saved = CycleCollector::threshold();
+    CycleCollector::setThreshold(100);
+    CycleCollector::collect();
+    {
+        CycleCollector::ConcurrentScope scope;
+        for (int i = 0; i < 3000; ++i) {
+            Value a = Value::makeStruct(makeRef<StructObject>());
+            (*a.getStruct())["self"] = a;
+        }
+        // 并行期间不回收，也不让回跳一直走慢路径
+        assert_false(CycleCollector::pending());
+        assert_eq(CycleCollector::collect(), static_cast<size_t>(0));
+        assert_false(CycleCollector::pending());
+    }
+    assert_true(CycleCollector::pending());
+    assert_true(CycleCollector::collect() >= 3000);
+    assert_false(CycleCollector::pending());
+    CycleCollector::setThreshold(saved);
+}
+
+void test_gc_module() {
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    auto result = run_vm(vm,
+        "include \"rumina:gc\";\n"
+        "var a = {};\n"
+        "a.self = a;\n"
+        "a = null;\n"
+        "var freed = gc.collect();\n"
+        "[freed >= 1, gc.stats().collections > 0];");
+    assert_ok(result);
+    assert_eq(result.value()->toString(), std::string("[true, true]"));
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("collects_unreachable_cycles", test_collects_unreachable_cycles);
+    runner.add_test("keeps_reachable_cycles", test_keeps_reachable_cycles);
+    runner.add_test("closure_cycles", test_closure_cycles);
+    runner.add_test("automatic_collection_keeps_memory_flat", test_automatic_collection_keeps_memory_flat);
+    runner.add_test("pending_deferred_while_concurrent", test_pending_deferred_while_concurrent);
+    runner.add_test("gc_module", test_gc_module);
+
+    return runner.run_all();
+}
@@ -0,0 +1,106 @@
+#include <test_framework.h>
+#include <compiler.h>
+#include <interpreter.h>
+#include <lexer.h>
+#include <parser.h>
+#include <vm.h>
+#include <chrono>
+
+using namespace rumina;
+using namespace rumina::test;
+
+const char* LOOP_CODE = R"(
+var sum = 0;
+var i = 0;
+while (i < 200000) {
+    sum = sum + i;
+    i = i + 1;
+}
+sum;
+)";
+
+const char* CALL_CODE = R"(
+func fib(n) {
+    if (n <= 1) {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
+fib(22);
+)";
+
+// 在指定分发方式下运行，返回结果和耗时（毫秒）
+static std::pair<Value, long long> run_with_dispatch(const char* code, DispatchMode mode) {
+    Lexer lexer(code);
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    auto ast = parser.parse();
+    Compiler compiler;
+    auto bytecode = compiler.compile(ast);
+    assert_true(bytecode.is_ok());
+
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    vm.setDispatchMode(mode);
+    vm.load(std::move(bytecode.value()));
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto result = vm.run();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    assert_ok(result);
+    assert_true(result.value().has_value());
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    return {result.value().value(), elapsed};
+}
+
+static void compare_dispatch(const char* label, const char* code, int64_t expected) {
+    auto [switch_val, switch_time] = run_with_dispatch(code, DispatchMode::Switch);
+    auto [threaded_val, threaded_time] = run_with_dispatch(code, DispatchMode::Threaded);
+
+    assert_eq(switch_val.getInt(), expected);
+    assert_eq(threaded_val.getInt(), expected);
+
+    std::cout << label << ": switch " << switch_time << "ms, "
+              << "threaded " << threaded_time << "ms\n";
+}
+
+void test_dispatch_loop() {
+    compare_dispatch("Loop", LOOP_CODE, 19999900000);
+}
+
+void test_dispatch_calls() {
+    compare_dispatch("Calls", CALL_CODE, 17711);
+}
+
+void test_dispatch_error_status() {
+    auto run = [](DispatchMode mode) {
+        Lexer lexer("var a = 1; a / 0;");
+        auto tokens = lexer.tokenize();
+        Parser parser(tokens);
+        auto ast = parser.parse();
+        Compiler compiler;
+        auto bytecode = compiler.compile(ast);
+        Interpreter interp;
+        VM vm(interp.getGlobals());
+        vm.setDispatchMode(mode);
+        vm.load(std::move(bytecode.value()));
+        return vm.run();
+    };
+
+    auto switch_result = run(DispatchMode::Switch);
+    auto threaded_result = run(DispatchMode::Threaded);
+    assert_true(switch_result.is_error());
+    assert_true(threaded_result.is_error());
+    assert_eq(switch_result.error(), threaded_result.error());
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("dispatch_loop", test_dispatch_loop);
+    runner.add_test("dispatch_calls", test_dispatch_calls);
+    runner.add_test("dispatch_error_status", test_dispatch_error_status);
+
+    return runner.run_all();
+}
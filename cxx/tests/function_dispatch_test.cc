@@ -0,0 +1,96 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <interpreter.h>
+#include <vm.h>
+
+using namespace rumina;
+using namespace rumina::test;
+
+void test_recursive_calls() {
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    long long elapsed = 0;
+    auto result = run_vm(vm, "func fib(n) { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); } fib(24);",
+                         &elapsed);
+    assert_ok(result);
+    assert_eq(result.value().value().getInt(), 46368);
+
+    std::cout << "fib(24): " << elapsed << "ms\n";
+}
+
+void test_lambda_and_method_calls() {
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    auto result = run_vm(vm,
+        "var twice = |f, x| f(f(x));"
+        "var inc = |x| x + 1;"
+        "var obj = {v = 40};"
+        "obj.get = |d| self.v + d;"
+        "twice(inc, obj.get(0));"
+    );
+    assert_ok(result);
+    assert_eq(result.value().value().getInt(), 42);
+}
+
+void test_arity_errors() {
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    auto result = run_vm(vm, "func add(a, b) { return a + b; } add(1);");
+    assert_error(result);
+    assert_true(result.error().find("expects 2 arguments, got 1") != std::string::npos);
+
+    VM vm2(interp.getGlobals());
+    auto lambda_result = run_vm(vm2, "var f = |x| x; f(1, 2);");
+    assert_error(lambda_result);
+    assert_true(lambda_result.error().find("Lambda expects 1") != std::string::npos);
+}
+
+void test_function_from_other_program() {
+    // 函数值只记录本程序的原型下标，换一个程序后不能按下标误调用
+    Interpreter interp;
+    VM first(interp.getGlobals());
+    assert_ok(run_vm(first, "func answer() { return 42; } answer();"));
+
+    VM second(interp.getGlobals());
+    auto result = run_vm(second, "func other() { return 1; } answer();");
+    assert_error(result);
+}
+
+void test_global_calls_use_call_sites() {
+    auto bytecode = compile_code(
+        "func twice(x) { return x * 2; }"
+        "func apply(f, x) { var y = f(x); return y; }"
+        "var r = twice(3) + apply(twice, 4);"
+        "func twice(x) { return x * 3; }"
+        "r + twice(1);"
+    );
+    assert_ok(bytecode);
+    // 全局函数名的调用走调用点缓存，作为参数的局部 f 仍按槽位取出后 Call
+    size_t call_var = 0, call = 0;
+    for (const Instruction& op : bytecode.value().getInstructions()) {
+        if (op.type == OpCodeType::CallVar) call_var++;
+        if (op.type == OpCodeType::Call) call++;
+    }
+    assert_eq(call_var, static_cast<size_t>(3));
+    assert_eq(call, static_cast<size_t>(1));
+
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    vm.load(std::move(bytecode.value()));
+    auto result = vm.run();
+    assert_ok(result);
+    // 重新定义后调用点读到新的绑定
+    assert_eq(result.value().value().getInt(), 6 + 8 + 3);
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("recursive_calls", test_recursive_calls);
+    runner.add_test("lambda_and_method_calls", test_lambda_and_method_calls);
+    runner.add_test("arity_errors", test_arity_errors);
+    runner.add_test("function_from_other_program", test_function_from_other_program);
+    runner.add_test("global_calls_use_call_sites", test_global_calls_use_call_sites);
+
+    return runner.run_all();
+}
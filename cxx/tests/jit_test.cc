@@ -0,0 +1,181 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <cycle_collector.h>
+#include <interpreter.h>
+#include <vm.h>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+using namespace rumina;
+using namespace rumina::test;
+
+const char* HOT_FUNCTIONS = R"(
+func fib(n) { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); }
+func steps(n) {
+    var i = 0;
+    var acc = 0;
+    while (true) {
+        i = i + 1;
+        if (i % 2 == 0) { continue; }
+        if (i > n) { break; }
+        acc = acc + i;
+    }
+    return acc;
+}
+func text(n) { var s = ""; var i = 0; while (i < n) { s = s + i % 10; i = i + 1; } return s; }
+func scaled(x) { var h = |y| y * x + 1; return h(x) + [1, 2, 3][x % 3]; }
+var total = 0;
+var k = 0;
+while (k < 300) { total = total + steps(k % 40) + scaled(k) + fib(k % 12); k = k + 1; }
+[total, text(25), fib(20)];
+)";
+
+static JitOptions low_threshold() {
+    JitOptions options;
+    options.threshold = 2;
+    return options;
+}
+
+void test_matches_interpreter() {
+    Interpreter interp;
+    VM plain(interp.getGlobals());
+    auto expected = run_vm(plain, HOT_FUNCTIONS);
+    assert_ok(expected);
+
+    VM jitted(interp.getGlobals());
+    bool enabled = jitted.setJitEnabled(true, low_threshold());
+    auto actual = run_vm(jitted, HOT_FUNCTIONS);
+    assert_ok(actual);
+    assert_eq(actual.value()->toString(), expected.value()->toString());
+
+#if RUMINA_JIT
+    assert_true(enabled);
+    assert_eq(jitted.getJitStats().compiled_functions, static_cast<size_t>(5));
+    assert_true(jitted.getJitStats().native_entries > 0);
+#else
+    assert_false(enabled);
+#endif
+}
+
+void test_loop_compiles_on_back_edges() {
+    // 只调用一次的函数由循环回跳触发编译，之后从循环头进入本地代码。
+    // 关闭 trace，否则这个循环会先被录制成 trace，回跳不再计数
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    vm.setTracing(false);
+    vm.setJitEnabled(true);
+    long long elapsed = 0;
+    auto result = run_vm(vm,
+        "func sum(n) { var s = 0; var i = 0; while (i < n) { s = s + i % 7; i = i + 1; } return s; }"
+        "sum(2000000);", &elapsed);
+    assert_ok(result);
+    assert_eq(result.value()->getInt(), 5999995);
+#if RUMINA_JIT
+    assert_eq(vm.getJitStats().compiled_functions, static_cast<size_t>(1));
+#endif
+
+    std::cout << "JIT loop: " << elapsed << "ms\n";
+}
+
+void test_native_back_edges_collect_cycles() {
+    // 循环体里没有调用，只有回跳能触发环回收
+    size_t saved = CycleCollector::threshold();
+    CycleCollector::setThreshold(500);
+    CycleCollector::collect();
+    GcStats start = CycleCollector::stats();
+
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    vm.setTracing(false);
+    vm.setJitEnabled(true, low_threshold());
+    auto result = run_vm(vm,
+        "func churn(n) {\n"
+        "    var i = 0;\n"
+        "    while (i < n) { var a = {}; var b = {}; a.next = b; b.next = a; i = i + 1; }\n"
+        "    return i;\n"
+        "}\n"
+        "churn(20000);");
+    assert_ok(result);
+    assert_eq(result.value()->getInt(), 20000);
+
+    GcStats end = CycleCollector::stats();
+    assert_true(end.collections > start.collections);
+    assert_true(end.tracked < start.tracked + 2000);
+#if RUMINA_JIT
+    assert_eq(vm.getJitStats().compiled_functions, static_cast<size_t>(1));
+#endif
+    CycleCollector::setThreshold(saved);
+}
+
+void test_native_loops_hand_off_to_traces() {
+    // 函数先被编译，循环在本地代码里变热后录制成 trace
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    vm.setJitEnabled(true, low_threshold());
+    auto result = run_vm(vm,
+        "func sum(n) { var s = 0; var i = 0; while (i < n) { s = s + i % 7; i = i + 1; } return s; }"
+        "sum(200000);");
+    assert_ok(result);
+    assert_eq(result.value()->getInt(), 599994);
+#if RUMINA_JIT
+    assert_eq(vm.getJitStats().compiled_functions, static_cast<size_t>(1));
+    assert_eq(vm.getTraceStats().recorded, static_cast<size_t>(1));
+    assert_true(vm.getTraceStats().entries > 0);
+#endif
+}
+
+void test_errors_keep_source_lines() {
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    vm.setJitEnabled(true, low_threshold());
+    auto result = run_vm(vm,
+        "func bad(n) {\n"
+        "    var z = n - n;\n"
+        "    return n % z;\n"
+        "}\n"
+        "func safe(n) { if (n > 5) { return bad(n); } return n; }\n"
+        "var i = 0;\n"
+        "while (i < 10) { safe(i); i = i + 1; }\n");
+    assert_error(result);
+    assert_true(result.error().find("Division by zero") != std::string::npos);
+    assert_eq(vm.getLastError().line.value_or(0), static_cast<size_t>(3));
+
+    // 出错后重新载入的程序不受影响
+    auto again = run_vm(vm, "func one() { return 1; } one() + one() + one();");
+    assert_ok(again);
+    assert_eq(again.value()->getInt(), 3);
+}
+
+void test_perf_map() {
+#if RUMINA_JIT
+    std::string path = "/tmp/perf-" + std::to_string(getpid()) + ".map";
+    std::remove(path.c_str());
+
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    JitOptions options = low_threshold();
+    options.perf_map = true;
+    vm.setJitEnabled(true, options);
+    assert_ok(run_vm(vm, "func twice(x) { return x * 2; } twice(1) + twice(2) + twice(3);"));
+
+    std::ifstream map(path);
+    std::string line;
+    assert_true(static_cast<bool>(std::getline(map, line)));
+    assert_true(line.find(" rumina::twice") != std::string::npos);
+    std::remove(path.c_str());
+#endif
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("matches_interpreter", test_matches_interpreter);
+    runner.add_test("loop_compiles_on_back_edges", test_loop_compiles_on_back_edges);
+    runner.add_test("native_back_edges_collect_cycles", test_native_back_edges_collect_cycles);
+    runner.add_test("native_loops_hand_off_to_traces", test_native_loops_hand_off_to_traces);
+    runner.add_test("errors_keep_source_lines", test_errors_keep_source_lines);
+    runner.add_test("perf_map", test_perf_map);
+
+    return runner.run_all();
+}
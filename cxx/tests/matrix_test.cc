@@ -0,0 +1,128 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <builtin/array.h>
+#include <builtin/matrix.h>
+#include <interpreter.h>
+#include <vm.h>
+#include <cmath>
+#include <vector>
+
+using namespace rumina;
+using namespace rumina::test;
+
+static Value int_matrix(std::vector<std::vector<int64_t>> rows) {
+    std::vector<Value> out;
+    for (auto& row : rows) out.push_back(Value::makeArray(ArrayObject::fromInts(std::move(row))));
+    return Value::makeArray(std::move(out));
+}
+
+void test_lu_determinant() {
+    Value m = Value::makeArray({
+        Value::makeArray(ArrayObject::fromFloats({2.0, -1.0, 0.0})),
+        Value::makeArray(ArrayObject::fromFloats({-1.0, 2.0, -1.0})),
+        Value::makeArray(ArrayObject::fromFloats({0.0, -1.0, 2.0}))});
+    assert_true(std::abs(builtin::matrix::det(std::vector<Value>{m}).getFloat() - 4.0) < 1e-12);
+    // 第一列主元为 0，需要换行
+    Value swapped = Value::makeArray({
+        Value::makeArray(ArrayObject::fromFloats({0.0, 1.0})),
+        Value::makeArray(ArrayObject::fromFloats({1.0, 0.0}))});
+    assert_eq(builtin::matrix::det(std::vector<Value>{swapped}).getFloat(), -1.0);
+
+    // 整数矩阵走 Bareiss，结果是精确的 Int
+    Value ints = int_matrix({{2, -1, 0}, {-1, 2, -1}, {0, -1, 2}});
+    assert_eq(builtin::matrix::det(std::vector<Value>{ints}).getInt(), 4);
+    assert_eq(builtin::matrix::det(std::vector<Value>{int_matrix({{0, 1}, {1, 0}})}).getInt(), -1);
+    assert_eq(builtin::matrix::det(std::vector<Value>{int_matrix({{1, 2}, {2, 4}})}).getInt(), 0);
+    Value big = builtin::array::det(std::vector<Value>{int_matrix({{1, 2}, {3, 4}})});
+    assert_true(big.getType() == Value::Type::Int);
+    assert_eq(big.toString(), std::string("-2"));
+    // double 在这里已经丢了末位
+    Value wide = int_matrix({{3037000499, 1}, {1, 3037000499}});
+    assert_eq(builtin::matrix::det(std::vector<Value>{wide}).toString(), std::string("9223372030926249000"));
+
+    // 余子式展开是 O(n!)，这个规模只有 LU 能算
+    const size_t n = 200;
+    builtin::matrix::DenseMatrix tri(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        tri(i, i) = 1.0 + (i % 2);
+        for (size_t j = 0; j < i; ++j) tri(i, j) = 0.5;
+    }
+    assert_eq(builtin::matrix::determinant(tri), std::pow(2.0, 100));
+}
+
+void test_solve_inverse_transpose() {
+    Value a = int_matrix({{4, 3}, {6, 3}});
+    Value b = Value::makeArray({Value(10.0), Value(12.0)});
+    Value x = builtin::matrix::solve(std::vector<Value>{a, b});
+    assert_true(std::abs(x.getArray()->get(0).getFloat() - 1.0) < 1e-12);
+    assert_true(std::abs(x.getArray()->get(1).getFloat() - 2.0) < 1e-12);
+
+    Value inv = builtin::matrix::inverse(std::vector<Value>{int_matrix({{2, 0}, {0, 4}})});
+    assert_eq(inv.toString(), std::string("[[0.5, 0], [0, 0.25]]"));
+
+    Value t = builtin::matrix::transpose(std::vector<Value>{int_matrix({{1, 2, 3}, {4, 5, 6}})});
+    assert_eq(t.toString(), std::string("[[1, 4], [2, 5], [3, 6]]"));
+    assert_true(t.getArray()->get(0).getArray()->kind() == ArrayObject::Kind::Int64);
+
+    bool threw = false;
+    try {
+        builtin::matrix::inverse(std::vector<Value>{int_matrix({{1, 2}, {2, 4}})});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert_true(threw);
+}
+
+void test_matmul_matches_naive() {
+    // 超过分线程的阈值，且行数不是分块边长的整数倍
+    const size_t n = 203;
+    builtin::matrix::DenseMatrix a(n, n);
+    builtin::matrix::DenseMatrix b(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            a(i, j) = static_cast<double>((i * 7 + j * 3) % 11) - 5.0;
+            b(i, j) = static_cast<double>((i * 5 + j * 2) % 13) - 6.0;
+        }
+    }
+    builtin::matrix::DenseMatrix c = builtin::matrix::multiply(a, b);
+    for (size_t i = 0; i < n; i += 17) {
+        for (size_t j = 0; j < n; j += 13) {
+            double expected = 0.0;
+            for (size_t k = 0; k < n; ++k) expected += a(i, k) * b(k, j);
+            assert_eq(c(i, j), expected);
+        }
+    }
+
+    Value v = builtin::matrix::matmul(std::vector<Value>{int_matrix({{1, 2}, {3, 4}}), Value::makeArray({Value(int64_t(1)), Value(int64_t(1))})});
+    assert_eq(v.toString(), std::string("[3, 7]"));
+}
+
+void test_exact_rational_path() {
+    std::vector<BigInt> ints = {2, 3, 1, 4, 1, -3, -2, 5, 8};
+    assert_eq(builtin::matrix::bareissDeterminant(ints, 3), BigInt(-10));
+    // 左上角为 0 时换行
+    ints[0] = 0;
+    assert_eq(builtin::matrix::bareissDeterminant(ints, 3), BigInt(-56));
+
+    auto result = run_vm(
+        "var m = [[1/2, 1/3], [1/4, 1/5]];"
+        "[matrix::det(m), matrix::inverse(m), matrix::solve(m, [1, 1]), det([[1/2, 0], [0, 4]])];");
+    assert_ok(result);
+    assert_eq(result.value()->toString(), std::string("[1/60, [[12, -20], [-15, 30]], [-8, 15], 2]"));
+
+    // 混入 Float 时按 double 计算
+    auto mixed = run_vm("matrix::det([[1/2, 0], [0, float(2)]]);");
+    assert_ok(mixed);
+    assert_true(mixed.value()->getType() == Value::Type::Float);
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("lu_determinant", test_lu_determinant);
+    runner.add_test("solve_inverse_transpose", test_solve_inverse_transpose);
+    runner.add_test("matmul_matches_naive", test_matmul_matches_naive);
+    runner.add_test("exact_rational_path", test_exact_rational_path);
+
+    return runner.run_all();
+}
@@ -0,0 +1,93 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <interpreter.h>
+#include <vm.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace rumina;
+using namespace rumina::test;
+
+// 统计堆分配次数，用来确认原生调用不再为实参分配内存
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static Value sum_args(NativeArgs args) {
+    int64_t total = 0;
+    for (const Value& arg : args) {
+        total += arg.getInt();
+    }
+    return Value(total);
+}
+
+static Value add_offset(void* context, NativeArgs args) {
+    return Value(args[0].getInt() + *static_cast<int64_t*>(context));
+}
+
+void test_native_args_view() {
+    std::vector<Value> values = {Value(static_cast<int64_t>(1)), Value(static_cast<int64_t>(2))};
+    assert_eq(sum_args(values).getInt(), 3);
+    Value pair[2] = {Value(static_cast<int64_t>(4)), Value(static_cast<int64_t>(5))};
+    assert_eq(sum_args(NativeArgs(pair, 2)).getInt(), 9);
+    assert_eq(sum_args({}).getInt(), 0);
+
+    NativeArgs view(values);
+    assert_eq(view.subspan(1).size(), static_cast<size_t>(1));
+    assert_eq(view.subspan(1)[0].getInt(), 2);
+    assert_true(view.subspan(5).empty());
+}
+
+void test_registration_forms() {
+    Interpreter interp;
+    auto globals = interp.getGlobals();
+    (*globals)["sum_args"] = Value::makeNativeFunction("sum_args", sum_args);
+    (*globals)["add_offset"] = Value::makeNativeFunction(
+        "add_offset", add_offset, std::make_shared<int64_t>(100));
+    // 旧签名通过 std::function 适配
+    (*globals)["legacy"] = Value::makeNativeFunction("legacy",
+        NativeFunction([](const std::vector<Value>& args) {
+            return Value(static_cast<int64_t>(args.size()));
+        }));
+
+    VM vm(globals);
+    auto result = run_vm(vm, "sum_args(1, 2, 3) + add_offset(5) + legacy(1, 2);");
+    assert_ok(result);
+    assert_eq(result.value().value().getInt(), 6 + 105 + 2);
+}
+
+void test_builtin_calls_do_not_allocate() {
+    Interpreter interp;
+    auto count = [&](int n) {
+        VM vm(interp.getGlobals());
+        std::string code = "var i = 0; var t = 0; while (i < " + std::to_string(n) +
+                           ") { t = t + abs(0 - i) + sum_args(i, 1, 2); i = i + 1; } t;";
+        (*interp.getGlobals())["sum_args"] = Value::makeNativeFunction("sum_args", sum_args);
+        size_t before = allocations.load();
+        auto result = run_vm(vm, code);
+        assert_ok(result);
+        return allocations.load() - before;
+    };
+    count(10);  // 预热静态数据
+    // 分配次数与循环次数无关
+    size_t short_loop = count(1000);
+    size_t long_loop = count(5000);
+    assert_eq(short_loop, long_loop);
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("native_args_view", test_native_args_view);
+    runner.add_test("registration_forms", test_registration_forms);
+    runner.add_test("builtin_calls_do_not_allocate", test_builtin_calls_do_not_allocate);
+
+    return runner.run_all();
+}
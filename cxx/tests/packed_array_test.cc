@@ -0,0 +1,134 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <builtin/array.h>
+#include <builtin/buffer.h>
+#include <cycle_collector.h>
+#include <interpreter.h>
+#include <vm.h>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+using namespace rumina;
+using namespace rumina::test;
+
+// 统计本进程的堆分配次数
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static ArrayObject::Kind kind_of(const Value& array) {
+    return array.getArray()->kind();
+}
+
+void test_homogeneous_arrays_are_packed() {
+    Value ints = Value::makeArray({Value(int64_t(1)), Value(int64_t(2)), Value(int64_t(3))});
+    Value floats = Value::makeArray({Value(1.5), Value(2.5)});
+    Value mixed = Value::makeArray({Value(int64_t(1)), Value(2.5)});
+    assert_true(kind_of(ints) == ArrayObject::Kind::Int64);
+    assert_true(kind_of(floats) == ArrayObject::Kind::Float64);
+    assert_true(kind_of(mixed) == ArrayObject::Kind::Generic);
+    assert_eq(ints.toString(), std::string("[1, 2, 3]"));
+    assert_eq(floats.toString(), std::string("[1.5, 2.5]"));
+
+    // 一百万个 double 只占一块连续缓冲区
+    size_t before = g_allocations.load();
+    Value big = Value::makeArray(ArrayObject::fromFloats(std::vector<double>(1000000, 0.5)));
+    assert_eq(g_allocations.load() - before, static_cast<size_t>(2));
+    assert_eq(big.getArray()->floats().size(), static_cast<size_t>(1000000));
+}
+
+void test_fallback_to_generic() {
+    Value array = builtin::array::range(std::vector<Value>{Value(int64_t(4))});
+    ArrayRef alias = array.getArray();
+    assert_true(alias->kind() == ArrayObject::Kind::Int64);
+
+    alias->push_back(Value(int64_t(4)));
+    assert_true(alias->kind() == ArrayObject::Kind::Int64);
+
+    // 写入不匹配的值后转为通用存储，所有副本看到同样的内容
+    alias->set(1, Value("one"));
+    assert_true(kind_of(array) == ArrayObject::Kind::Generic);
+    assert_eq(array.toString(), std::string("[0, one, 2, 3, 4]"));
+
+    alias->pop_back();
+    alias->push_back(Value(1.5));
+    assert_eq(array.toString(), std::string("[0, one, 2, 3, 1.5]"));
+
+    // 空数组由第一个元素决定存储
+    ArrayObject empty;
+    empty.push_back(Value(2.0));
+    assert_true(empty.kind() == ArrayObject::Kind::Float64);
+    empty.clear();
+    empty.push_back(Value(true));
+    assert_true(empty.kind() == ArrayObject::Kind::Generic);
+}
+
+void test_vector_builtins() {
+    Value a = Value::makeArray({Value(int64_t(1)), Value(int64_t(2)), Value(int64_t(3))});
+    Value b = Value::makeArray({Value(4.0), Value(5.0), Value(6.0)});
+    Value c = Value::makeArray({Value(int64_t(4)), Value(5.0), Value(int64_t(6))});
+
+    assert_true(std::abs(builtin::array::dot(std::vector<Value>{a, b}).getFloat() - 32.0) < 1e-12);
+    assert_true(std::abs(builtin::array::dot(std::vector<Value>{a, c}).getFloat() - 32.0) < 1e-12);
+    assert_true(std::abs(builtin::array::norm(std::vector<Value>{a}).getFloat() - std::sqrt(14.0)) < 1e-12);
+
+    Value cross = builtin::array::cross(std::vector<Value>{a, b});
+    assert_true(kind_of(cross) == ArrayObject::Kind::Float64);
+    assert_eq(cross.toString(), std::string("[-3, 6, -3]"));
+
+    Value joined = builtin::array::concat(std::vector<Value>{a, a});
+    assert_true(kind_of(joined) == ArrayObject::Kind::Int64);
+    assert_eq(joined.toString(), std::string("[1, 2, 3, 1, 2, 3]"));
+    assert_eq(builtin::array::concat(std::vector<Value>{a, b}).toString(), std::string("[1, 2, 3, 4, 5, 6]"));
+
+    assert_true(a == Value::makeArray({Value(int64_t(1)), Value(int64_t(2)), Value(int64_t(3))}));
+    assert_true(a != joined);
+}
+
+void test_vm_index_and_literals() {
+    auto result = run_vm(
+        "var xs = range(1000);"
+        "var s = 0;"
+        "var i = 0;"
+        "while (i < 1000) { s = s + xs[i]; i = i + 1; }"
+        "var d = dot(xs, xs);"
+        "push(xs, \"end\");"
+        "[s, xs[-1], xs[-2], d, norm([3, 4])];");
+    assert_ok(result);
+    assert_eq(result.value()->toString(), std::string("[499500, end, 999, 332833500, 5]"));
+
+    auto bad = run_vm("var xs = [1, 2]; xs[2];");
+    assert_error(bad);
+}
+
+void test_buffer_bytes_round_trip() {
+    Value buffer = builtin::buffer::new_buffer_from_bytes({1, 2, 3});
+    std::vector<uint8_t> bytes = builtin::buffer::buffer_to_bytes(buffer);
+    assert_eq(bytes.size(), static_cast<size_t>(3));
+    assert_eq(static_cast<int>(bytes[2]), 3);
+    // 紧凑数组不含容器，环回收器无事可做
+    Value holder = Value::makeArray({buffer, buffer});
+    holder = Value();
+    assert_eq(CycleCollector::collect(), static_cast<size_t>(0));
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("homogeneous_arrays_are_packed", test_homogeneous_arrays_are_packed);
+    runner.add_test("fallback_to_generic", test_fallback_to_generic);
+    runner.add_test("vector_builtins", test_vector_builtins);
+    runner.add_test("vm_index_and_literals", test_vm_index_and_literals);
+    runner.add_test("buffer_bytes_round_trip", test_buffer_bytes_round_trip);
+
+    return runner.run_all();
+}
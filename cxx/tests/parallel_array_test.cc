@@ -0,0 +1,148 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <builtin/array.h>
+#include <interpreter.h>
+#include <thread_pool.h>
+#include <vm.h>
+#include <atomic>
+#include <stdexcept>
+
+using namespace rumina;
+using namespace rumina::test;
+
+void test_task_group() {
+    ThreadPool pool(4);
+    std::atomic<int> sum{0};
+    {
+        TaskGroup group(pool);
+        for (int i = 1; i <= 1000; ++i) {
+            group.run([&sum, i] { sum += i; });
+        }
+        group.wait();
+    }
+    assert_eq(sum.load(), 500500);
+
+    // 第一个异常在 wait() 中重新抛出，其余任务照常完成
+    std::atomic<int> finished{0};
+    bool threw = false;
+    try {
+        TaskGroup group(pool);
+        for (int i = 0; i < 100; ++i) {
+            group.run([&finished, i] {
+                if (i == 42) throw std::runtime_error("boom");
+                finished++;
+            });
+        }
+        group.wait();
+    } catch (const std::runtime_error& e) {
+        threw = std::string(e.what()) == "boom";
+    }
+    assert_true(threw);
+    assert_eq(finished.load(), 99);
+}
+
+void test_callbacks_in_vm() {
+    auto result = run_vm(
+        "var k = 3;"
+        "var seen = [];"
+        "foreach([1, 2, 3], |i, x| push(seen, i * x));"
+        "[map([1, 2, 3], |x| x * k), filter(range(10), |x| x % 3 == 0),"
+        " reduce([1, 2, 3, 4], |a, b| a + b), reduce([], |a, b| a + b, 7), seen];");
+    assert_ok(result);
+    assert_eq(result.value()->toString(), std::string("[[3, 6, 9], [0, 3, 6, 9], 10, 7, [0, 2, 6]]"));
+
+    assert_error(run_vm("map([1, 2], |x| x + undefined_name);"));
+    assert_error(run_vm("reduce([], |a, b| a + b);"));
+}
+
+void test_parallel_matches_serial() {
+    // 超过并行阈值；回调引用全局变量和另一个脚本函数
+    auto result = run_vm(
+        "var offset = 5;"
+        "func square(x) { return x * x; }"
+        "var xs = range(20000);"
+        "var ys = parallel_map(xs, |x| square(x) + offset);"
+        "var serial = map(xs, |x| square(x) + offset);"
+        "var same = true;"
+        "var i = 0;"
+        "while (i < 20000) { if (ys[i] != serial[i]) { same = false; } i = i + 1; }"
+        "[same, ys[19999], parallel_reduce(xs, |a, b| a + b), parallel_reduce(xs, |a, b| a + b, 100),"
+        " parallel_map([1, 2, 3], |x| x + 1)];");
+    assert_ok(result);
+    assert_eq(result.value()->toString(), std::string("[true, 399960006, 199990000, 199990100, [2, 3, 4]]"));
+}
+
+void test_parallel_nested_and_errors() {
+    // 工作线程里再调用并行函数时按顺序执行
+    auto nested = run_vm(
+        "var rows = parallel_map(range(2000), |i| parallel_reduce(range(4), |a, b| a + b, i));"
+        "[rows[0], rows[1999]];");
+    assert_ok(nested);
+    assert_eq(nested.value()->toString(), std::string("[6, 2005]"));
+
+    // 回调在某个工作线程上出错，错误传回调用者
+    assert_error(run_vm(
+        "func pick(x) { if (x == 4321) { return x + undefined_name; } return x; }"
+        "parallel_map(range(5000), pick);"));
+    assert_error(run_vm(
+        "func add(a, b) { if (b == 4321) { return a + undefined_name; } return a + b; }"
+        "parallel_reduce(range(5000), add);"));
+}
+
+void test_callback_error_location() {
+    // 报告回调里出错的行，而不是调用 map / parallel_map 的行
+    for (const char* name : {"map", "parallel_map"}) {
+        std::string code =
+            "func pick(x) {\n"
+            "    if (x == 4321) { return x + undefined_name; }\n"
+            "    return x;\n"
+            "}\n"
+            "var ys = " + std::string(name) + "(range(5000), pick);\n";
+        Interpreter interp;
+        VM vm(interp.getGlobals());
+        auto result = run_vm(vm, code);
+        assert_error(result);
+        assert_eq(result.error(), std::string("Undefined variable: undefined_name (line 2)"));
+        assert_eq(vm.getLastError().line.value(), static_cast<size_t>(2));
+    }
+}
+
+void test_shared_values_are_read_only() {
+    // 回调修改多个线程共享的数组或结构体时报错，而不是在线程之间产生数据竞争
+    auto pushed = run_vm(
+        "var acc = [];"
+        "var xs = range(200000);"
+        "parallel_map(xs, |x| push(acc, x));");
+    assert_error(pushed);
+    assert_true(pushed.error().find("cannot mutate shared array inside parallel callback") != std::string::npos);
+
+    auto stored = run_vm(
+        "var box = {n = 0};"
+        "func store(x) { box.n = x; return x; }"
+        "parallel_map(range(5000), store);");
+    assert_error(stored);
+    assert_true(stored.error().find("cannot mutate shared struct inside parallel callback") != std::string::npos);
+
+    // 回调自己创建的数组可以修改；并行调用结束后共享过的数组恢复可写
+    auto local = run_vm(
+        "func wrap(x) { var a = []; push(a, x); return a[0]; }"
+        "var xs = range(5000);"
+        "var total = parallel_reduce(parallel_map(xs, wrap), |a, b| a + b);"
+        "push(xs, 7);"
+        "[total, xs[5000]];");
+    assert_ok(local);
+    assert_eq(local.value()->toString(), std::string("[12497500, 7]"));
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("task_group", test_task_group);
+    runner.add_test("callbacks_in_vm", test_callbacks_in_vm);
+    runner.add_test("parallel_matches_serial", test_parallel_matches_serial);
+    runner.add_test("parallel_nested_and_errors", test_parallel_nested_and_errors);
+    runner.add_test("callback_error_location", test_callback_error_location);
+    runner.add_test("shared_values_are_read_only", test_shared_values_are_read_only);
+
+    return runner.run_all();
+}
@@ -0,0 +1,128 @@
+#include <test_framework.h>
+#include <value.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <utility>
+
+using namespace rumina;
+using namespace rumina::test;
+
+// 统计本进程的堆分配次数
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+void test_array_is_one_allocation() {
+    // 排除首次创建容器时的一次性初始化
+    Value::makeArray();
+    // 纯数值元素会打包成紧凑存储，这里用通用存储
+    std::vector<Value> elements = {Value(true), Value(int64_t(2)), Value(int64_t(3))};
+    size_t before = g_allocations.load();
+    Value array = Value::makeArray(std::move(elements));
+    // 对象头、计数和数组对象在同一个堆单元里，元素缓冲区是从 elements 移过来的
+    assert_eq(g_allocations.load() - before, static_cast<size_t>(1));
+
+    before = g_allocations.load();
+    Value copy = array;
+    ArrayRef ref = copy.getArray();
+    assert_eq(g_allocations.load() - before, static_cast<size_t>(0));
+    assert_eq(ref.use_count(), static_cast<uint32_t>(3));
+
+    // 引用语义：通过任一副本修改，所有副本可见
+    ref->push_back(Value(int64_t(4)));
+    assert_eq(array.getArray()->size(), static_cast<size_t>(4));
+    assert_true(array.getArray() == copy.getArray());
+}
+
+void test_struct_and_closure_share_cells() {
+    StructRef fields = makeRef<StructObject>();
+    (*fields)["x"] = Value(int64_t(1));
+    Value object = Value::makeStruct(fields);
+    Value alias = object;
+    (*alias.getStruct())["y"] = Value(int64_t(2));
+    assert_eq(object.getStruct()->size(), static_cast<size_t>(2));
+    assert_eq(fields.use_count(), static_cast<uint32_t>(3));
+
+    Value::LambdaData data;
+    data.upvalues.push_back(Upvalue{0, object});
+    Value lambda = Value::makeLambda(std::move(data));
+    size_t before = g_allocations.load();
+    Value lambda_copy = lambda;
+    assert_eq(g_allocations.load() - before, static_cast<size_t>(0));
+    assert_eq(std::as_const(lambda_copy).get<Value::LambdaData>()->upvalues.size(), static_cast<size_t>(1));
+
+    fields = nullptr;
+    object = Value();
+    alias = Value();
+    // 只剩 lambda 的捕获还引用结构体
+    const Value& captured = std::as_const(lambda).get<Value::LambdaData>()->upvalues[0].value;
+    assert_eq(captured.getStruct().use_count(), static_cast<uint32_t>(2));
+}
+
+void test_shared_values_count_atomically() {
+    Value inner = Value::makeArray({Value("text"), Value(int64_t(7))});
+    Value outer = Value::makeArray({inner, inner});
+    // 自引用不会让 share 无限递归
+    outer.getArray()->push_back(outer);
+    outer.share();
+
+    const int threads = 4;
+    const int rounds = 100000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&outer, rounds]() {
+            for (int i = 0; i < rounds; ++i) {
+                Value copy = outer;
+                Value element = copy.getArray()->get(0);
+                Value text = element.getArray()->get(0);
+                (void)text;
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    // outer 自身 + 数组里的自引用
+    assert_eq(outer.getArray().use_count(), static_cast<uint32_t>(3));
+    // inner 被 outer 的两个元素和本地变量引用
+    assert_eq(inner.getArray().use_count(), static_cast<uint32_t>(4));
+    outer.getArray()->pop_back();
+}
+
+void test_copy_throughput() {
+    const size_t count = 2000000;
+    Value array = Value::makeArray({Value(int64_t(1))});
+    std::vector<Value> stack;
+    stack.reserve(16);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        stack.push_back(array);
+        stack.pop_back();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    assert_eq(array.getArray().use_count(), static_cast<uint32_t>(2));
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    std::cout << "Push/pop of " << count << " array values: " << elapsed << "us\n";
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("array_is_one_allocation", test_array_is_one_allocation);
+    runner.add_test("struct_and_closure_share_cells", test_struct_and_closure_share_cells);
+    runner.add_test("shared_values_count_atomically", test_shared_values_count_atomically);
+    runner.add_test("copy_throughput", test_copy_throughput);
+
+    return runner.run_all();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <compiler.h>
+#include <interpreter.h>
+#include <lexer.h>
+#include <parser.h>
+#include <vm.h>
+#include <chrono>
+#include <optional>
+#include <string>
+
+namespace rumina {
+namespace test {
+
+// 词法、语法分析并编译成字节码
+inline Result<ByteCode> compile_code(const std::string& code) {
+    Lexer lexer(code);
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    auto ast = parser.parse();
+    Compiler compiler;
+    return compiler.compile(ast);
+}
+
+// 编译后在给定的 VM 上运行；elapsed_ms 非空时写入 run() 的耗时（毫秒），不含编译
+inline Result<std::optional<Value>> run_vm(VM& vm, const std::string& code, long long* elapsed_ms = nullptr) {
+    auto bytecode = compile_code(code);
+    if (bytecode.is_error()) {
+        return Err<std::optional<Value>>(bytecode.error());
+    }
+    vm.load(std::move(bytecode.value()));
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto result = vm.run();
+    auto end = std::chrono::high_resolution_clock::now();
+    if (elapsed_ms) {
+        *elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    }
+    return result;
+}
+
+// 在带全部内置函数的新 VM 上运行
+inline Result<std::optional<Value>> run_vm(const std::string& code, long long* elapsed_ms = nullptr) {
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    return run_vm(vm, code, elapsed_ms);
+}
+
+} // namespace test
+} // namespace rumina
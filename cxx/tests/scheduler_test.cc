@@ -0,0 +1,102 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <builtin/matrix.h>
+#include <interpreter.h>
+#include <thread_pool.h>
+#include <value_ops.h>
+#include <vm.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace rumina;
+using namespace rumina::test;
+
+void test_stats_and_steals() {
+    ThreadPool pool(2);
+    std::atomic<int> done{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool outer_done = false;
+
+    // 外层任务从池外提交，由某个工作线程执行；它把子任务压进自己的队列，
+    // 另一个工作线程只能靠窃取拿到。不用 TaskGroup 等外层任务，否则主线程会帮忙把它执行掉
+    pool.submit([&] {
+        TaskGroup inner(pool);
+        for (int i = 0; i < 32; ++i) {
+            inner.run([&done] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                done++;
+            });
+        }
+        inner.wait();
+        std::lock_guard<std::mutex> lock(mutex);
+        outer_done = true;
+        finished.notify_all();
+    });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return outer_done; });
+    }
+    assert_eq(done.load(), 32);
+
+    // 任务返回后才计入 completed，外层任务发出通知时自己还没算进去，等池空闲下来
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (pool.stats().completed < 33 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+
+    SchedulerStats stats = pool.stats();
+    assert_eq(stats.threads, size_t(2));
+    assert_eq(stats.queued, size_t(0));
+    assert_eq(stats.submitted, size_t(33));
+    assert_eq(stats.completed, size_t(33));
+    assert_true(stats.steals > 0);
+}
+
+void test_shared_scheduler() {
+    ThreadPool& shared = ThreadPool::shared();
+    assert_true(shared.size() >= 1);
+    // 已经创建后不能再改线程数
+    assert_true(!ThreadPool::setSharedThreads(shared.size() + 1));
+    assert_eq(ThreadPool::shared().size(), shared.size());
+
+    // 大数幂的分块和矩阵乘法的行块都提交到共用调度器
+    size_t before = shared.stats().submitted;
+    BigInt expected;
+    mpz_pow_ui(expected.get_mpz_t(), BigInt(3).get_mpz_t(), 120007);
+    assert_true(bigint_pow_parallel(BigInt(3), 120007) == expected);
+    size_t after_pow = shared.stats().submitted;
+    assert_true(after_pow > before);
+
+    const size_t n = 256;
+    builtin::matrix::DenseMatrix a(n, n);
+    for (size_t i = 0; i < n; ++i) a(i, i) = 2.0;
+    builtin::matrix::DenseMatrix c = builtin::matrix::multiply(a, a);
+    assert_eq(c(17, 17), 4.0);
+    assert_eq(c(17, 18), 0.0);
+    assert_true(shared.stats().submitted > after_pow);
+}
+
+void test_scheduler_module() {
+    auto result = run_vm(
+        "include \"rumina:scheduler\";\n"
+        "var before = scheduler.stats().submitted;\n"
+        "parallel_map(range(5000), |x| x + 1);\n"
+        "var stats = scheduler.stats();\n"
+        "[stats.submitted > before, stats.threads == scheduler.threads(), stats.queued];");
+    assert_ok(result);
+    assert_eq(result.value()->toString(), std::string("[true, true, 0]"));
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("stats_and_steals", test_stats_and_steals);
+    runner.add_test("shared_scheduler", test_shared_scheduler);
+    runner.add_test("scheduler_module", test_scheduler_module);
+
+    return runner.run_all();
+}
@@ -0,0 +1,122 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <builtin/vec.h>
+#include <interpreter.h>
+#include <simd.h>
+#include <vm.h>
+#include <cmath>
+#include <vector>
+
+using namespace rumina;
+using namespace rumina::test;
+
+static bool close(double a, double b) {
+    return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b));
+}
+
+// 对 CPU 支持的每一级实现各跑一遍，长度覆盖向量主循环和各种收尾
+template<typename F>
+static void for_each_level(F&& f) {
+    const simd::Level original = simd::level();
+    for (simd::Level level : {simd::Level::Scalar, simd::Level::SSE2, simd::Level::AVX2}) {
+        if (simd::setLevel(level) != level) continue;
+        for (size_t n : {1, 2, 3, 4, 5, 7, 8, 9, 17, 1000, 1003}) f(n);
+    }
+    simd::setLevel(original);
+}
+
+static std::vector<double> sample(size_t n, double seed) {
+    std::vector<double> xs(n);
+    for (size_t i = 0; i < n; ++i) xs[i] = std::sin(seed + static_cast<double>(i)) * 10.0;
+    return xs;
+}
+
+void test_reductions_match_scalar() {
+    for_each_level([](size_t n) {
+        auto a = sample(n, 1.0);
+        auto b = sample(n, 2.0);
+        double dot = 0.0, sum = 0.0, lo = a[0], hi = a[0];
+        for (size_t i = 0; i < n; ++i) {
+            dot += a[i] * b[i];
+            sum += a[i];
+            lo = std::min(lo, a[i]);
+            hi = std::max(hi, a[i]);
+        }
+        assert_true(close(simd::dot(a.data(), b.data(), n), dot));
+        assert_true(close(simd::sum(a.data(), n), sum));
+        assert_eq(simd::min(a.data(), n), lo);
+        assert_eq(simd::max(a.data(), n), hi);
+    });
+}
+
+void test_elementwise_and_prefix_sum() {
+    for_each_level([](size_t n) {
+        auto a = sample(n, 3.0);
+        auto b = sample(n, 4.0);
+        std::vector<double> out(n);
+
+        simd::sub(a.data(), b.data(), out.data(), n);
+        for (size_t i = 0; i < n; ++i) assert_eq(out[i], a[i] - b[i]);
+        simd::div(a.data(), b.data(), out.data(), n);
+        for (size_t i = 0; i < n; ++i) assert_eq(out[i], a[i] / b[i]);
+        simd::scale(a.data(), 2.5, out.data(), n);
+        for (size_t i = 0; i < n; ++i) assert_eq(out[i], a[i] * 2.5);
+
+        // 输出与输入在同一位置
+        std::vector<double> in_place = a;
+        simd::add(in_place.data(), b.data(), in_place.data(), n);
+        for (size_t i = 0; i < n; ++i) assert_eq(in_place[i], a[i] + b[i]);
+
+        simd::prefixSum(a.data(), out.data(), n);
+        double running = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            running += a[i];
+            assert_true(close(out[i], running));
+        }
+    });
+}
+
+void test_vec_builtins() {
+    Value ints = Value::makeArray({Value(int64_t(1)), Value(int64_t(2)), Value(int64_t(3))});
+    Value floats = Value::makeArray({Value(0.5), Value(1.5), Value(-2.0)});
+    Value mixed = Value::makeArray({Value(int64_t(1)), Value(2.5), Value(int64_t(-1))});
+
+    assert_eq(builtin::vec::dot(std::vector<Value>{ints, floats}).getFloat(), -2.5);
+    assert_eq(builtin::vec::norm(std::vector<Value>{Value::makeArray({Value(int64_t(3)), Value(int64_t(4))})}).getFloat(), 5.0);
+    assert_eq(builtin::vec::add(std::vector<Value>{ints, mixed}).toString(), std::string("[2, 4.5, 2]"));
+    assert_true(builtin::vec::mul(std::vector<Value>{ints, ints}).getArray()->kind() == ArrayObject::Kind::Float64);
+    assert_eq(builtin::vec::scale(std::vector<Value>{floats, Value(int64_t(2))}).toString(), std::string("[1, 3, -4]"));
+
+    // Int 数组的归约保持整数
+    assert_true(builtin::vec::sum(std::vector<Value>{ints}).getType() == Value::Type::Int);
+    assert_eq(builtin::vec::sum(std::vector<Value>{ints}).getInt(), int64_t(6));
+    assert_eq(builtin::vec::min(std::vector<Value>{floats}).getFloat(), -2.0);
+    assert_eq(builtin::vec::max(std::vector<Value>{mixed}).getFloat(), 2.5);
+    Value prefix = builtin::vec::cumsum(std::vector<Value>{ints});
+    assert_true(prefix.getArray()->kind() == ArrayObject::Kind::Int64);
+    assert_eq(prefix.toString(), std::string("[1, 3, 6]"));
+    assert_eq(builtin::vec::cumsum(std::vector<Value>{floats}).toString(), std::string("[0.5, 2, 0]"));
+}
+
+void test_vec_from_script() {
+    auto result = run_vm(
+        "var xs = range(100000);"
+        "var ys = vec::scale(xs, 0.5);"
+        "[vec::sum(xs), vec::sum(ys), vec::max(ys), vec::cumsum([1, 2, 3]), vec::dot([1, 2], [3, 4])];");
+    assert_ok(result);
+    assert_eq(result.value()->toString(), std::string("[4999950000, 2499975000, 49999.5, [1, 3, 6], 11]"));
+
+    assert_error(run_vm("vec::min([]);"));
+    assert_error(run_vm("vec::add([1, 2], [1]);"));
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("reductions_match_scalar", test_reductions_match_scalar);
+    runner.add_test("elementwise_and_prefix_sum", test_elementwise_and_prefix_sum);
+    runner.add_test("vec_builtins", test_vec_builtins);
+    runner.add_test("vec_from_script", test_vec_from_script);
+
+    return runner.run_all();
+}
@@ -0,0 +1,110 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <builtin/string.h>
+#include <interpreter.h>
+#include <value_ops.h>
+#include <vm.h>
+#include <string>
+
+using namespace rumina;
+using namespace rumina::test;
+
+void test_append_keeps_earlier_values() {
+    Value s(std::string(100, 'a'));
+    Value t = Value::appendString(s, "bbb");
+    Value u = Value::appendString(t, "ccc");
+    // t 不再是缓冲末尾，从它分叉会换一个新缓冲
+    Value v = Value::appendString(t, "ddd");
+    Value w = Value::appendString(u, "eee");
+
+    assert_eq(t.getString(), std::string(100, 'a') + "bbb");
+    assert_eq(u.getString(), std::string(100, 'a') + "bbbccc");
+    assert_eq(v.getString(), std::string(100, 'a') + "bbbddd");
+    assert_eq(w.getString(), std::string(100, 'a') + "bbbccceee");
+    // u 和 w 共用同一个缓冲
+    assert_true(u.getStringView().data() == w.getStringView().data());
+    assert_true(v.getStringView().data() != w.getStringView().data());
+
+    // 把自身追加到自身
+    Value twice = Value::appendString(w, w.getStringView());
+    assert_eq(twice.getString(), w.getString() + w.getString());
+}
+
+void test_shared_buffers_are_not_extended() {
+    Value s = Value::appendString(Value(std::string(100, 'a')), "b");
+    s.share();
+    Value t = Value::appendString(s, "c");
+    assert_true(t.getStringView().data() != s.getStringView().data());
+    assert_eq(s.getStringView().size(), static_cast<size_t>(101));
+    assert_eq(t.getString(), std::string(100, 'a') + "bc");
+}
+
+void test_binary_op_append_is_linear() {
+    Value s("");
+    for (int i = 0; i < 100000; ++i) {
+        auto next = value_binary_op(s, BinOp::Add, Value(static_cast<int64_t>(i % 10)));
+        assert_ok(next);
+        s = next.value();
+    }
+    assert_eq(s.getStringView().size(), static_cast<size_t>(100000));
+    assert_eq(s.getString().substr(0, 12), std::string("012345678901"));
+
+    // 非字符串在左边
+    auto mixed = value_binary_op(Value(static_cast<int64_t>(7)), BinOp::Add, Value("x"));
+    assert_ok(mixed);
+    assert_eq(mixed.value().getString(), std::string("7x"));
+}
+
+void test_loop_concatenation_speed() {
+    long long elapsed = 0;
+    auto result = run_vm(
+        "var s = \"\";"
+        "var i = 0;"
+        "while (i < 200000) { s = s + \"line \" + i + \"\\n\"; i = i + 1; }"
+        "string::length(s);", &elapsed);
+    assert_ok(result);
+    assert_eq(result.value()->getInt(), 2288890);
+    std::cout << "200000 appends: " << elapsed << "ms\n";
+    // 二次方的实现需要数十秒
+    assert_true(elapsed < 5000);
+}
+
+void test_string_builder_module() {
+    auto result = run_vm(
+        "include \"rumina:string_builder\";"
+        "var b = StringBuilder.new(\"items:\");"
+        "var i = 0;"
+        "while (i < 3) { b.append(\" \", i); i = i + 1; }"
+        "var before = b.toString();"
+        "b.appendLine(\";\").append(true);"
+        "var after = b.toString();"
+        "var n = b.length();"
+        "b.clear();"
+        "[before, after, n, b.append(\"x\").toString()];");
+    assert_ok(result);
+    assert_eq(result.value()->toString(), std::string("[items: 0 1 2, items: 0 1 2;\ntrue, 18, x]"));
+
+    auto bad = run_vm(
+        "include \"rumina:string_builder\";"
+        "var b = StringBuilder.new(1, 2);");
+    assert_error(bad);
+}
+
+void test_concat_builtin() {
+    Value result = builtin::string::concat(std::vector<Value>{Value("a"), Value(static_cast<int64_t>(1)),
+                                            Value(std::string(40, 'z')), Value(2.5)});
+    assert_eq(result.getString(), "a1" + std::string(40, 'z') + "2.5");
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("append_keeps_earlier_values", test_append_keeps_earlier_values);
+    runner.add_test("shared_buffers_are_not_extended", test_shared_buffers_are_not_extended);
+    runner.add_test("binary_op_append_is_linear", test_binary_op_append_is_linear);
+    runner.add_test("loop_concatenation_speed", test_loop_concatenation_speed);
+    runner.add_test("string_builder_module", test_string_builder_module);
+    runner.add_test("concat_builtin", test_concat_builtin);
+
+    return runner.run_all();
+}
@@ -0,0 +1,150 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <builtin/string.h>
+#include <interpreter.h>
+#include <vm.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+
+using namespace rumina;
+using namespace rumina::test;
+
+// 统计本进程的堆分配次数
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static Value int_value(int64_t n) { return Value(n); }
+
+void test_copies_share_bytes() {
+    Value text(std::string(4096, 'x'));
+    size_t before = g_allocations.load();
+    Value copy = text;
+    std::vector<Value> many(100, text);
+    assert_eq(g_allocations.load() - before, static_cast<size_t>(1));  // 只有 vector 的缓冲区
+    assert_true(copy.getStringView().data() == text.getStringView().data());
+}
+
+void test_chars_do_not_allocate() {
+    Value::makeChar('a');  // 排除首次建表
+    Value text("hello world");
+    size_t before = g_allocations.load();
+    for (size_t i = 0; i < 11; ++i) {
+        Value c = Value::makeSlice(text, i, 1);
+        assert_eq(c.getString(), std::string(1, "hello world"[i]));
+    }
+    assert_eq(g_allocations.load() - before, static_cast<size_t>(0));
+    assert_true(Value::makeChar('h') == Value("h"));
+}
+
+void test_slices() {
+    std::string raw;
+    for (int i = 0; i < 1000; ++i) raw += static_cast<char>('a' + i % 26);
+    Value text(raw);
+
+    // 长切片共享底层字节，只分配切片单元本身
+    size_t before = g_allocations.load();
+    Value middle = Value::makeSlice(text, 100, 500);
+    assert_eq(g_allocations.load() - before, static_cast<size_t>(1));
+    assert_true(middle.getStringView().data() == text.getStringView().data() + 100);
+    assert_true(middle.getStringView() == std::string_view(raw).substr(100, 500));
+
+    // 切片的切片直接指向原字符串
+    Value inner = Value::makeSlice(middle, 50, 200);
+    assert_true(inner.getStringView().data() == text.getStringView().data() + 150);
+    assert_eq(inner.getString(), raw.substr(150, 200));
+
+    // 短切片复制出来，不持有原字符串
+    Value small = Value::makeSlice(text, 3, 5);
+    assert_eq(small.getString(), raw.substr(3, 5));
+    assert_true(small.getStringView().data() != text.getStringView().data() + 3);
+
+    // 原字符串释放后切片仍然有效
+    text = Value();
+    assert_eq(inner.getString(), raw.substr(150, 200));
+}
+
+void test_hash_and_equality() {
+    Value a(std::string(100, 'q') + "tail");
+    Value b = Value::makeSlice(Value(std::string("xx") + std::string(100, 'q') + "tail"), 2, 104);
+    assert_true(a == b);
+    assert_eq(a.stringHash(), b.stringHash());
+    assert_eq(std::hash<Value>()(a), std::hash<Value>()(b));
+
+    std::unordered_set<Value> set;
+    set.insert(a);
+    assert_true(set.count(b) == 1);
+    assert_true(set.count(Value("other")) == 0);
+}
+
+void test_sub_builtin() {
+    Value text(std::string("0123456789abcdefghijklmnopqrstuvwxyz"));
+    assert_eq(builtin::string::sub(std::vector<Value>{text, int_value(10), int_value(20)}).getString(),
+              std::string("abcdefghijklmnopqrst"));
+    assert_eq(builtin::string::sub(std::vector<Value>{text, int_value(-3), int_value(2)}).getString(), std::string("xy"));
+    assert_eq(builtin::string::sub(std::vector<Value>{text, int_value(30), int_value(100)}).getString(), std::string("uvwxyz"));
+    assert_eq(builtin::string::sub(std::vector<Value>{text, int_value(34), int_value(-1)}).getString(), std::string("yz"));
+    assert_eq(builtin::string::at(std::vector<Value>{text, int_value(11)}).getString(), std::string("b"));
+}
+
+void test_shared_slices_across_threads() {
+    Value text(std::string(10000, 'z'));
+    std::vector<Value> slices;
+    for (size_t i = 0; i < 8; ++i) {
+        slices.push_back(Value::makeSlice(text, i * 100, 5000));
+    }
+    for (const Value& slice : slices) slice.share();
+    text = Value();
+
+    std::vector<std::thread> threads;
+    std::atomic<size_t> total{0};
+    for (const Value& slice : slices) {
+        threads.emplace_back([slice, &total] {
+            for (int i = 0; i < 1000; ++i) {
+                Value copy = slice;
+                Value part = Value::makeSlice(copy, 10, 3000);
+                total.fetch_add(part.getStringView().size(), std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    assert_eq(total.load(), static_cast<size_t>(8 * 1000 * 3000));
+}
+
+void test_vm_string_index() {
+    auto result = run_vm(
+        "var s = \"\";"
+        "var i = 0;"
+        "while (i < 500) { s = s + \"ab\"; i = i + 1; }"
+        "var n = 0;"
+        "var j = 0;"
+        "while (j < 1000) { if (s[j] == \"b\") { n = n + 1; } j = j + 1; }"
+        "[n, s[-1], s[0] + s[1]];");
+    assert_ok(result);
+    assert_eq(result.value()->toString(), std::string("[500, b, ab]"));
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("copies_share_bytes", test_copies_share_bytes);
+    runner.add_test("chars_do_not_allocate", test_chars_do_not_allocate);
+    runner.add_test("slices", test_slices);
+    runner.add_test("hash_and_equality", test_hash_and_equality);
+    runner.add_test("sub_builtin", test_sub_builtin);
+    runner.add_test("shared_slices_across_threads", test_shared_slices_across_threads);
+    runner.add_test("vm_string_index", test_vm_string_index);
+
+    return runner.run_all();
+}
@@ -0,0 +1,146 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <interpreter.h>
+#include <shape.h>
+#include <vm.h>
+
+using namespace rumina;
+using namespace rumina::test;
+
+const char* RECORD_LOOP = R"(
+func score(r) { return r.a * 3 + r.b - r.c; }
+var records = [{a = 1, b = 2, c = 3}, {a = 4, b = 5, c = 6}, {a = 7, b = 8, c = 9}];
+var total = 0;
+var i = 0;
+while (i < 60000) {
+    var r = records[i % 3];
+    total = total + score(r);
+    r.c = r.c + 1;
+    i = i + 1;
+}
+total;
+)";
+
+void test_shapes_are_shared() {
+    // 源码里出现过的名字已由词法分析驻留；按字符串设置时只有这样的名字走共享形状
+    AtomTable::intern("x");
+    AtomTable::intern("y");
+    StructObject a;
+    a.set("x", Value(static_cast<int64_t>(1)));
+    a.set("y", Value(static_cast<int64_t>(2)));
+    StructObject b;
+    b["x"] = Value(static_cast<int64_t>(3));
+    b["y"] = Value(static_cast<int64_t>(4));
+    assert_true(a.shape() == b.shape());
+    assert_true(a.shape()->isShared());
+    assert_eq(a.shape()->slotOf("y"), 1);
+
+    // 不同的添加顺序得到不同的形状
+    StructObject c;
+    c.set("y", Value(static_cast<int64_t>(5)));
+    c.set("x", Value(static_cast<int64_t>(6)));
+    assert_true(a.shape() != c.shape());
+
+    // 覆盖已有字段不改变形状
+    const Shape* before = a.shape();
+    a.set("x", Value(static_cast<int64_t>(7)));
+    assert_true(a.shape() == before);
+    assert_eq(a.find("x")->second.getInt(), 7);
+}
+
+void test_iteration_and_erase() {
+    StructObject obj;
+    obj.set("b", Value(static_cast<int64_t>(1)));
+    obj.set("a", Value(static_cast<int64_t>(2)));
+    obj.set("c", Value(static_cast<int64_t>(3)));
+
+    std::string order;
+    for (const auto& [key, value] : obj) {
+        order += key;
+    }
+    assert_eq(order, "bac");
+
+    assert_eq(obj.erase("a"), static_cast<size_t>(1));
+    assert_eq(obj.size(), static_cast<size_t>(2));
+    assert_true(obj.find("a") == obj.end());
+    assert_eq(obj.find("c")->second.getInt(), 3);
+}
+
+void test_dictionary_mode() {
+    StructObject obj;
+    for (size_t i = 0; i < Shape::kMaxSharedFields + 8; ++i) {
+        obj.set("f" + std::to_string(i), Value(static_cast<int64_t>(i)));
+    }
+    assert_false(obj.shape()->isShared());
+    assert_eq(obj.find("f70")->second.getInt(), 70);
+
+    StructObject copy(obj);
+    copy.set("extra", Value());
+    assert_eq(obj.count("extra"), static_cast<size_t>(0));
+    assert_eq(copy.count("extra"), static_cast<size_t>(1));
+}
+
+void test_polymorphic_member_site() {
+    auto result = run_vm(
+        "func getx(o) { return o.x; }"
+        "var a = {x = 1, y = 2};"
+        "var b = {y = 3, x = 4};"
+        "var c = {x = 5};"
+        "var sum = 0;"
+        "var i = 0;"
+        "while (i < 30) { sum = sum + getx(a) + getx(b) + getx(c); i = i + 1; }"
+        "sum;"
+    );
+    assert_ok(result);
+    assert_eq(result.value().value().getInt(), 300);
+}
+
+void test_member_assign_transitions() {
+    auto result = run_vm(
+        "var total = 0;"
+        "var i = 0;"
+        "while (i < 10) {"
+        "    var p = {x = i};"
+        "    p.y = i * 2;"
+        "    p.x = p.x + 1;"
+        "    total = total + p.x + p.y;"
+        "    i = i + 1;"
+        "}"
+        "total;"
+    );
+    assert_ok(result);
+    assert_eq(result.value().value().getInt(), 145);
+}
+
+void test_missing_member_errors() {
+    auto result = run_vm("var p = {x = 1}; p.y;");
+    assert_error(result);
+}
+
+void test_record_loop_hits_cache() {
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    long long elapsed = 0;
+    auto result = run_vm(vm, RECORD_LOOP, &elapsed);
+    assert_ok(result);
+
+    auto [hits, misses] = vm.getCacheStats();
+    assert_true(hits > misses * 100);
+
+    std::cout << "Record loop: " << elapsed << "ms, "
+              << hits << " cache hits, " << misses << " misses\n";
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("shapes_are_shared", test_shapes_are_shared);
+    runner.add_test("iteration_and_erase", test_iteration_and_erase);
+    runner.add_test("dictionary_mode", test_dictionary_mode);
+    runner.add_test("polymorphic_member_site", test_polymorphic_member_site);
+    runner.add_test("member_assign_transitions", test_member_assign_transitions);
+    runner.add_test("missing_member_errors", test_missing_member_errors);
+    runner.add_test("record_loop_hits_cache", test_record_loop_hits_cache);
+
+    return runner.run_all();
+}
@@ -0,0 +1,177 @@
+#include <test_framework.h>
+#include <bytecode_optimizer.h>
+#include <compiler.h>
+#include <interpreter.h>
+#include <lexer.h>
+#include <parser.h>
+#include <vm.h>
+#include <chrono>
+#include <sstream>
+
+using namespace rumina;
+using namespace rumina::test;
+
+const char* LOCAL_LOOP = R"(
+func work(n) {
+    var sum = 0;
+    var i = 0;
+    while (i < n) {
+        sum = sum + i;
+        i = i + 1;
+        if (i % 5 == 0) { continue; }
+        7;
+    }
+    return sum;
+}
+work(300000);
+)";
+
+static ByteCode compile_code(const std::string& code) {
+    Lexer lexer(code);
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    auto ast = parser.parse();
+    Compiler compiler;
+    auto bytecode = compiler.compile(ast);
+    assert_ok(bytecode);
+    return std::move(bytecode.value());
+}
+
+static Value run_bytecode(ByteCode bytecode, DispatchMode mode, long long* elapsed_ms = nullptr) {
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    vm.setDispatchMode(mode);
+    vm.load(std::move(bytecode));
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto result = vm.run();
+    auto end = std::chrono::high_resolution_clock::now();
+    if (elapsed_ms) {
+        *elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    }
+
+    assert_ok(result);
+    assert_true(result.value().has_value());
+    return result.value().value();
+}
+
+static size_t count_fused(const ByteCode& bytecode) {
+    size_t count = 0;
+    for (const auto& op : bytecode.getInstructions()) {
+        if (fusedLength(op.type) > 1) count++;
+    }
+    return count;
+}
+
+void test_loop_is_fused() {
+    ByteCode bytecode = compile_code(LOCAL_LOOP);
+    BytecodeOptimizer optimizer;
+    optimizer.optimize(bytecode);
+
+    // i < n、sum + i、i = i + 1、i % 5、== 0 都应被融合
+    assert_true(count_fused(bytecode) >= 5);
+}
+
+void test_fused_matches_unfused() {
+    ByteCode plain = compile_code(LOCAL_LOOP);
+    long long plain_time = 0;
+    Value expected = run_bytecode(std::move(plain), DispatchMode::Threaded, &plain_time);
+
+    for (DispatchMode mode : {DispatchMode::Switch, DispatchMode::Threaded}) {
+        ByteCode fused = compile_code(LOCAL_LOOP);
+        BytecodeOptimizer optimizer;
+        optimizer.optimize(fused);
+        long long fused_time = 0;
+        Value actual = run_bytecode(std::move(fused), mode, &fused_time);
+        assert_eq(actual.getInt(), expected.getInt());
+
+        if (mode == DispatchMode::Threaded) {
+            std::cout << "Local loop: unfused " << plain_time << "ms, "
+                      << "superinstructions " << fused_time << "ms\n";
+        }
+    }
+}
+
+void test_guard_failure_runs_sequence() {
+    // 同一条 IncLocal 先遇到字符串，再遇到整数
+    ByteCode bytecode = compile_code(
+        "func bump(x) { x = x + 1; return x; }"
+        "var s = bump(\"a\");"
+        "var n = bump(41);"
+        "s + n;"
+    );
+    BytecodeOptimizer optimizer;
+    optimizer.optimize(bytecode);
+    assert_true(count_fused(bytecode) >= 1);
+
+    Value result = run_bytecode(std::move(bytecode), DispatchMode::Threaded);
+    assert_eq(result.toString(), "a142");
+}
+
+void test_removal_remaps_jumps() {
+    // 0 PushConst; 1 Pop 被删除后，Jump(5) 必须改为 Jump(3)
+    ByteCode bytecode;
+    bytecode.emit(OpCode(OpCodeType::PushConst, Value(static_cast<int64_t>(1))), std::nullopt);
+    bytecode.emit(OpCode(OpCodeType::Pop), std::nullopt);
+    bytecode.emit(OpCode(OpCodeType::Jump, static_cast<size_t>(5)), std::nullopt);
+    bytecode.emit(OpCode(OpCodeType::PushConst, Value(static_cast<int64_t>(100))), std::nullopt);
+    bytecode.emit(OpCode(OpCodeType::Halt), std::nullopt);
+    bytecode.emit(OpCode(OpCodeType::PushConst, Value(static_cast<int64_t>(7))), std::nullopt);
+    bytecode.emit(OpCode(OpCodeType::Halt), std::nullopt);
+
+    BytecodeOptimizer optimizer;
+    optimizer.optimize(bytecode);
+    assert_eq(bytecode.getInstructions().size(), static_cast<size_t>(5));
+    assert_eq(bytecode.getInstructions()[0].operand, static_cast<uint32_t>(3));
+
+    Value result = run_bytecode(std::move(bytecode), DispatchMode::Threaded);
+    assert_eq(result.getInt(), 7);
+}
+
+void test_serialize_roundtrip_keeps_fused_ops() {
+    ByteCode bytecode = compile_code(LOCAL_LOOP);
+    BytecodeOptimizer optimizer;
+    optimizer.optimize(bytecode);
+
+    std::string text = bytecode.serialize();
+    assert_true(text.find("IncLocal(") != std::string::npos);
+
+    ByteCode restored = ByteCode::deserialize(text);
+    assert_eq(count_fused(restored), count_fused(bytecode));
+}
+
+void test_ngram_counts() {
+    ByteCode bytecode = compile_code(LOCAL_LOOP);
+    BytecodeOptimizer optimizer;
+    optimizer.setSuperinstructions(false);
+    optimizer.optimize(bytecode);
+
+    auto grams = BytecodeOptimizer::countNGrams(bytecode, 2);
+    assert_true(!grams.empty());
+    for (size_t i = 1; i < grams.size(); ++i) {
+        assert_true(grams[i - 1].second >= grams[i].second);
+    }
+
+    bool found = false;
+    for (const auto& [gram, count] : BytecodeOptimizer::countNGrams(bytecode, 3)) {
+        if (gram == "PushConstPooled Add StoreLocal") found = count >= 1;
+    }
+    assert_true(found);
+
+    std::ostringstream out;
+    BytecodeOptimizer::dumpNGrams(bytecode, 2, 5, out);
+    assert_true(out.str().find("2-grams") != std::string::npos);
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("loop_is_fused", test_loop_is_fused);
+    runner.add_test("fused_matches_unfused", test_fused_matches_unfused);
+    runner.add_test("guard_failure_runs_sequence", test_guard_failure_runs_sequence);
+    runner.add_test("removal_remaps_jumps", test_removal_remaps_jumps);
+    runner.add_test("serialize_roundtrip_keeps_fused_ops", test_serialize_roundtrip_keeps_fused_ops);
+    runner.add_test("ngram_counts", test_ngram_counts);
+
+    return runner.run_all();
+}
@@ -0,0 +1,68 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <interpreter.h>
+#include <vm.h>
+
+using namespace rumina;
+using namespace rumina::test;
+
+void test_tail_call_emitted() {
+    auto bytecode = compile_code(
+        "func sum(n, acc) { if (n == 0) { return acc; } return sum(n - 1, acc + n); }"
+        "func deep(n) { if (n == 0) { return 0; } return 1 + deep(n - 1); }"
+    );
+    assert_ok(bytecode);
+    size_t tail_calls = 0;
+    for (const auto& instruction : bytecode.value().getInstructions()) {
+        if (instruction.type == OpCodeType::TailCall) {
+            tail_calls++;
+        }
+    }
+    // 只有 sum 的 return 是尾调用
+    assert_eq(tail_calls, static_cast<size_t>(1));
+}
+
+void test_deep_tail_recursion() {
+    // 远超最大递归深度，尾调用不增加调用帧
+    auto result = run_vm(
+        "func sum(n, acc) { if (n == 0) { return acc; } return sum(n - 1, acc + n); }"
+        "sum(100000, 0);"
+    );
+    assert_ok(result);
+    assert_eq(result.value().value().getInt(), 5000050000LL);
+}
+
+void test_mutual_and_lambda_tail_calls() {
+    auto result = run_vm(
+        "func even(n) { if (n == 0) { return 1; } return odd(n - 1); }"
+        "func odd(n) { if (n == 0) { return 0; } return even(n - 1); }"
+        "var count = do |n, acc| { if (n == 0) { return acc; } return count(n - 1, acc + 2); };"
+        "even(50001) * 100000 + count(20000, 0);"
+    );
+    assert_ok(result);
+    assert_eq(result.value().value().getInt(), 40000LL);
+}
+
+void test_non_tail_recursion_still_limited() {
+    auto result = run_vm("func deep(n) { if (n == 0) { return 0; } return 1 + deep(n - 1); } deep(10000);");
+    assert_error(result);
+    assert_true(result.error().find("Maximum recursion depth") != std::string::npos);
+}
+
+void test_native_tail_call() {
+    auto result = run_vm("func f(x) { return abs(x); } f(-7) + f(3);");
+    assert_ok(result);
+    assert_eq(result.value().value().getInt(), 10);
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("tail_call_emitted", test_tail_call_emitted);
+    runner.add_test("deep_tail_recursion", test_deep_tail_recursion);
+    runner.add_test("mutual_and_lambda_tail_calls", test_mutual_and_lambda_tail_calls);
+    runner.add_test("non_tail_recursion_still_limited", test_non_tail_recursion_still_limited);
+    runner.add_test("native_tail_call", test_native_tail_call);
+
+    return runner.run_all();
+}
@@ -0,0 +1,154 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <interpreter.h>
+#include <vm.h>
+#include <string>
+
+using namespace rumina;
+using namespace rumina::test;
+
+const char* HOT_LOOPS = R"(
+var i = 0;
+var s = 0;
+var flag = false;
+while (i < 1000) {
+    var t = i * 3;
+    if (t % 2 == 0) { s = s + t; } else { s = s - 1; }
+    flag = !flag;
+    if (i == 700) { break; }
+    i = i + 1;
+}
+var j = 0;
+var acc = 0;
+while (j < 200) {
+    var k = 0;
+    while (k < 100) { k = k + 1; if (k % 3 == 0) { continue; } acc = acc + j * k % 13; }
+    j = j + 1;
+}
+func fib(n) {
+    var a = 0;
+    var b = 1;
+    for (var q = 0; q < n; q = q + 1) { var c = a + b; a = b; b = c % 1000007; }
+    return b;
+}
+[s, i, t, flag, acc, fib(100000)];
+)";
+
+void test_matches_interpreter() {
+    Interpreter interp;
+    VM plain(interp.getGlobals());
+    plain.setTracing(false);
+    auto expected = run_vm(plain, HOT_LOOPS);
+    assert_ok(expected);
+    assert_eq(plain.getTraceStats().recorded, static_cast<size_t>(0));
+
+    VM traced(interp.getGlobals());
+    auto actual = run_vm(traced, HOT_LOOPS);
+    assert_ok(actual);
+    assert_eq(actual.value()->toString(), expected.value()->toString());
+
+    const TraceStats& stats = traced.getTraceStats();
+    assert_true(stats.recorded >= 3);
+    assert_true(stats.entries > 0);
+    assert_true(stats.side_exits >= stats.entries);
+}
+
+void test_type_change_leaves_trace() {
+    // 循环中途变量变成字符串：守卫失败后由解释器继续，结果不变
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    auto result = run_vm(vm,
+        "var x = 0; var y = 5;"
+        "while (x < 300) { x = x + 1; if (x == 250) { y = \"str\"; } else { y = y; } }"
+        "[x, y];");
+    assert_ok(result);
+    assert_eq(result.value()->toString(), std::string("[300, str]"));
+}
+
+void test_errors_keep_source_lines() {
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    auto result = run_vm(vm,
+        "var m = 0;\n"
+        "var d = 3;\n"
+        "while (m < 200) {\n"
+        "    m = m + 1;\n"
+        "    if (m == 150) { d = 0; }\n"
+        "    var r = m % d;\n"
+        "}\n");
+    assert_error(result);
+    assert_true(result.error().find("Division by zero") != std::string::npos);
+    assert_eq(vm.getLastError().line.value_or(0), static_cast<size_t>(6));
+    assert_true(vm.getTraceStats().entries > 0);
+
+    // 守卫失败时写回的变量与解释器一致
+    auto state = run_vm(vm, "var m = 0; var d = 3; while (m < 200) { m = m + 1; if (m == 150) { d = 0; } } [m, d];");
+    assert_ok(state);
+    assert_eq(state.value()->toString(), std::string("[200, 0]"));
+}
+
+void test_repeated_guards_removed() {
+    // 同一变量上的分支和除数守卫只保留第一个
+    const char* code =
+        "var i = 0; var s = 0; var on = true; var d = 7;"
+        "while (i < 500) {"
+        "    if (on) { s = s + i % d; }"
+        "    if (on) { s = s + i % d; }"
+        "    i = i + 1;"
+        "}"
+        "s;";
+    Interpreter interp;
+    VM plain(interp.getGlobals());
+    plain.setTracing(false);
+    auto expected = run_vm(plain, code);
+
+    VM traced(interp.getGlobals());
+    auto actual = run_vm(traced, code);
+    assert_ok(actual);
+    assert_eq(actual.value()->getInt(), expected.value()->getInt());
+    assert_eq(traced.getTraceStats().recorded, static_cast<size_t>(1));
+    assert_eq(traced.getTraceStats().guards_removed, static_cast<size_t>(2));
+}
+
+void test_untraceable_loop_stops_recording() {
+    // 录制失败 kMaxAttempts 次后回跳不再进入 Tracer
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    auto result = run_vm(vm, "var s = \"\"; var i = 0; while (i < 1000) { s = s + \"a\"; i = i + 1; } i;");
+    assert_ok(result);
+    assert_eq(result.value()->getInt(), static_cast<int64_t>(1000));
+    assert_eq(vm.getTraceStats().recorded, static_cast<size_t>(0));
+    assert_eq(vm.getTraceStats().aborted, static_cast<size_t>(Tracer::kMaxAttempts));
+}
+
+void test_loop_speed() {
+    Interpreter interp;
+    const char* code = "var s = 0; var i = 0; while (i < 2000000) { s = s + i % 7; i = i + 1; } s;";
+
+    VM plain(interp.getGlobals());
+    plain.setTracing(false);
+    long long plain_ms = 0;
+    auto expected = run_vm(plain, code, &plain_ms);
+
+    VM traced(interp.getGlobals());
+    long long traced_ms = 0;
+    auto actual = run_vm(traced, code, &traced_ms);
+    assert_ok(actual);
+    assert_eq(actual.value()->getInt(), expected.value()->getInt());
+    assert_eq(traced.getTraceStats().recorded, static_cast<size_t>(1));
+
+    std::cout << "Interpreted loop: " << plain_ms << "ms, traced loop: " << traced_ms << "ms\n";
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("matches_interpreter", test_matches_interpreter);
+    runner.add_test("type_change_leaves_trace", test_type_change_leaves_trace);
+    runner.add_test("errors_keep_source_lines", test_errors_keep_source_lines);
+    runner.add_test("repeated_guards_removed", test_repeated_guards_removed);
+    runner.add_test("untraceable_loop_stops_recording", test_untraceable_loop_stops_recording);
+    runner.add_test("loop_speed", test_loop_speed);
+
+    return runner.run_all();
+}
@@ -0,0 +1,87 @@
+#include <test_framework.h>
+#include <value.h>
+#include <chrono>
+#include <utility>
+
+using namespace rumina;
+using namespace rumina::test;
+
+// 旧的 Type + std::variant 布局在 x86-64/libstdc++ 上 sizeof(Value) 为 128
+constexpr size_t LEGACY_VALUE_SIZE = 128;
+
+void test_value_is_compact() {
+    std::cout << "sizeof(Value): " << sizeof(Value)
+              << " (legacy layout: " << LEGACY_VALUE_SIZE << ")\n";
+    assert_true(sizeof(Value) <= 16);
+}
+
+void test_immediates_roundtrip() {
+    Value i(static_cast<int64_t>(-42));
+    Value f(2.5);
+    Value b(true);
+    Value n;
+
+    assert_eq(i.getInt(), -42);
+    assert_eq(f.getFloat(), 2.5);
+    assert_eq(b.getBool(), true);
+    assert_eq(n.getType(), Value::Type::Null);
+    assert_true(i.get<int64_t>() != nullptr);
+    assert_true(i.get<double>() == nullptr);
+}
+
+void test_heap_payload_sharing() {
+    // 字符串不可变，副本共享同一个单元
+    Value s("hello");
+    Value copy = s;
+    assert_eq(copy.getString(), "hello");
+    assert_true(std::as_const(copy).get<std::string>() == std::as_const(s).get<std::string>());
+
+    // 其余值语义的载荷在可写访问时分离
+    Value big(BigInt(7));
+    Value big_copy = big;
+    BigInt* number = big_copy.get<BigInt>();
+    assert_true(number != nullptr);
+    *number = 9;
+    assert_true(big.getBigInt() == 7);
+    assert_true(big_copy.getBigInt() == 9);
+
+    // 数组仍是引用语义：副本共享同一个数组对象
+    auto arr = makeRef<ArrayObject>();
+    Value a = Value::makeArray(arr);
+    Value a2 = a;
+    a2.getArray()->push_back(Value(static_cast<int64_t>(1)));
+    assert_eq(a.getArray()->size(), static_cast<size_t>(1));
+}
+
+void test_value_copy_throughput() {
+    const size_t count = 1000000;
+    std::vector<Value> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        values.push_back(Value(static_cast<int64_t>(i)));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<Value> copies = values;
+    int64_t sum = 0;
+    for (const auto& v : copies) {
+        sum += v.getInt();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    assert_eq(sum, static_cast<int64_t>(count * (count - 1) / 2));
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    std::cout << "Copy + sum of " << count << " int values: " << elapsed << "us, "
+              << (count * sizeof(Value)) / 1024 << " KiB\n";
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("value_is_compact", test_value_is_compact);
+    runner.add_test("immediates_roundtrip", test_immediates_roundtrip);
+    runner.add_test("heap_payload_sharing", test_heap_payload_sharing);
+    runner.add_test("value_copy_throughput", test_value_copy_throughput);
+
+    return runner.run_all();
+}
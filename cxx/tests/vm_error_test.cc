@@ -0,0 +1,112 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <interpreter.h>
+#include <vm.h>
+
+using namespace rumina;
+using namespace rumina::test;
+
+void test_error_records_line() {
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    auto result = run_vm(vm,
+        "var a = 1;\n"
+        "func f(x) {\n"
+        "    var y = x + 1;\n"
+        "    return y / 0;\n"
+        "}\n"
+        "f(a);\n"
+    );
+    assert_error(result);
+    assert_true(result.error().find("Division by zero (line 4)") != std::string::npos);
+
+    const VMError& error = vm.getLastError();
+    assert_eq(error.message, "Division by zero");
+    assert_true(error.line.has_value());
+    assert_eq(error.line.value(), static_cast<size_t>(4));
+}
+
+void test_same_location_in_both_dispatch_modes() {
+    const char* code =
+        "var total = 0;\n"
+        "var i = 0;\n"
+        "while (i < 10) {\n"
+        "    total = total + i % (5 - i);\n"
+        "    i = i + 1;\n"
+        "}\n";
+
+    Interpreter interp;
+    VM threaded(interp.getGlobals());
+    threaded.setDispatchMode(DispatchMode::Threaded);
+    VM switched(interp.getGlobals());
+    switched.setDispatchMode(DispatchMode::Switch);
+
+    auto threaded_result = run_vm(threaded, code);
+    auto switched_result = run_vm(switched, code);
+    assert_error(threaded_result);
+    assert_error(switched_result);
+    assert_eq(threaded_result.error(), switched_result.error());
+    assert_eq(threaded.getLastError().ip, switched.getLastError().ip);
+    assert_eq(threaded.getLastError().line.value(), static_cast<size_t>(4));
+}
+
+void test_native_exception_becomes_error() {
+    // 原生函数抛出的异常在嵌入边界转换为错误，同样带有出错位置
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    auto result = run_vm(vm, "var x = 1;\nvar y = sqrt(\"a\");\n");
+    assert_error(result);
+    assert_eq(vm.getLastError().line.value(), static_cast<size_t>(2));
+}
+
+void test_undefined_and_member_errors() {
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    auto result = run_vm(vm, "var p = {x = 1};\n\np.y;\n");
+    assert_error(result);
+    assert_eq(vm.getLastError().message, "struct does not have member 'y'");
+    assert_eq(vm.getLastError().line.value(), static_cast<size_t>(3));
+
+    VM vm2(interp.getGlobals());
+    auto undefined = run_vm(vm2, "missing + 1;");
+    assert_error(undefined);
+    assert_eq(vm2.getLastError().message, "Undefined variable: missing");
+}
+
+void test_min_int_mod_minus_one() {
+    // INT64_MIN % -1 不应触发 SIGFPE：通用路径、特化指令、trace 和 JIT 都得到 0
+    const char* code =
+        "var a = -9223372036854775807 - 1;\n"
+        "var b = -1;\n"
+        "func m(x, d) { return x % d; }\n"
+        "var s = 0;\n"
+        "var i = 0;\n"
+        "while (i < 200) { s = s + a % b + m(a, b) + m(7, 2); i = i + 1; }\n"
+        "[a % b, (-9223372036854775807 - 1) % -1, s];";
+
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    auto result = run_vm(vm, code);
+    assert_ok(result);
+    assert_eq(result.value()->toString(), std::string("[0, 0, 200]"));
+
+    VM jitted(interp.getGlobals());
+    JitOptions options;
+    options.threshold = 2;
+    jitted.setJitEnabled(true, options);
+    auto native = run_vm(jitted, code);
+    assert_ok(native);
+    assert_eq(native.value()->toString(), std::string("[0, 0, 200]"));
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("error_records_line", test_error_records_line);
+    runner.add_test("same_location_in_both_dispatch_modes", test_same_location_in_both_dispatch_modes);
+    runner.add_test("native_exception_becomes_error", test_native_exception_becomes_error);
+    runner.add_test("undefined_and_member_errors", test_undefined_and_member_errors);
+    runner.add_test("min_int_mod_minus_one", test_min_int_mod_minus_one);
+
+    return runner.run_all();
+}
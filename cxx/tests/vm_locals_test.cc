@@ -0,0 +1,120 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <interpreter.h>
+#include <vm.h>
+
+using namespace rumina;
+using namespace rumina::test;
+
+void test_locals_use_slots() {
+    auto result = run_vm(
+        "func sum(n) {"
+        "    var total = 0;"
+        "    var i = 0;"
+        "    while (i < n) { total = total + i; i = i + 1; }"
+        "    return total;"
+        "}"
+        "sum(100);"
+    );
+    assert_ok(result);
+    assert_eq(result.value().value().getInt(), 4950);
+}
+
+void test_let_inside_loop() {
+    auto result = run_vm(
+        "func f() {"
+        "    var s = 0;"
+        "    var i = 0;"
+        "    while (i < 3) { let k = i + 1; s = s + k; i = i + 1; }"
+        "    return s;"
+        "}"
+        "f();"
+    );
+    assert_ok(result);
+    assert_eq(result.value().value().getInt(), 6);
+}
+
+void test_global_read_before_local_assign() {
+    auto result = run_vm(
+        "var g = 10;"
+        "func h() { var before = g; g = before + 1; return g; }"
+        "h() * 100 + g;"
+    );
+    assert_ok(result);
+    assert_eq(result.value().value().getInt(), 1110);
+}
+
+void test_lambda_captures_slot_local() {
+    auto result = run_vm(
+        "func mk(n) { var base = n * 2; return |x| x + base; }"
+        "var add = mk(5);"
+        "add(1);"
+    );
+    assert_ok(result);
+    assert_eq(result.value().value().getInt(), 11);
+}
+
+void test_recursion_keeps_frames_separate() {
+    auto result = run_vm(
+        "func fib(n) { if (n <= 1) { return n; } var a = fib(n - 1); var b = fib(n - 2); return a + b; }"
+        "fib(15);"
+    );
+    assert_ok(result);
+    assert_eq(result.value().value().getInt(), 610);
+}
+
+void test_serialize_roundtrip_keeps_locals() {
+    auto bytecode = compile_code(
+        "func fib(n) { if (n <= 1) { return n; } var a = fib(n - 1); var b = fib(n - 2); return a + b; }"
+        "func mk(n) { var base = n * 2; return |x| x + base; }"
+        "var add = mk(5);"
+        "var label = \"fib \\\"10\\\"\\n\";"
+        "fib(10) + add(1);"
+    );
+    assert_ok(bytecode);
+    std::string text = bytecode.value().serialize();
+    assert_true(text.rfind("RUMINA-BYTECODE-V2\n", 0) == 0);
+
+    ByteCode restored = ByteCode::deserialize(text);
+    assert_eq(restored.getFunctions().size(), bytecode.value().getFunctions().size());
+    for (size_t i = 0; i < restored.getFunctions().size(); ++i) {
+        assert_true(restored.getFunctions()[i].locals == bytecode.value().getFunctions()[i].locals);
+    }
+    assert_eq(restored.serialize(), text);
+
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    vm.load(std::move(restored));
+    auto result = vm.run();
+    assert_ok(result);
+    assert_eq(result.value().value().getInt(), 66);
+}
+
+void test_deserialize_rejects_other_versions() {
+    auto bytecode = compile_code("var x = 1; x + 1;");
+    assert_ok(bytecode);
+    std::string text = bytecode.value().serialize();
+    text.replace(0, text.find('\n'), "RUMINA-BYTECODE-V1");
+
+    bool threw = false;
+    try {
+        ByteCode::deserialize(text);
+    } catch (const std::runtime_error& e) {
+        threw = std::string(e.what()).find("Unsupported bytecode version") != std::string::npos;
+    }
+    assert_true(threw);
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("locals_use_slots", test_locals_use_slots);
+    runner.add_test("let_inside_loop", test_let_inside_loop);
+    runner.add_test("global_read_before_local_assign", test_global_read_before_local_assign);
+    runner.add_test("lambda_captures_slot_local", test_lambda_captures_slot_local);
+    runner.add_test("recursion_keeps_frames_separate", test_recursion_keeps_frames_separate);
+    runner.add_test("serialize_roundtrip_keeps_locals", test_serialize_roundtrip_keeps_locals);
+    runner.add_test("deserialize_rejects_other_versions", test_deserialize_rejects_other_versions);
+
+    return runner.run_all();
+}
@@ -0,0 +1,78 @@
+#include <test_framework.h>
+#include <run_vm.h>
+#include <interpreter.h>
+#include <vm.h>
+
+using namespace rumina;
+using namespace rumina::test;
+
+// 按 quickening 开关在新 VM 上运行
+static Result<std::optional<Value>> run_quickened(const std::string& code, bool quickening,
+                                                  long long* elapsed_ms = nullptr) {
+    Interpreter interp;
+    VM vm(interp.getGlobals());
+    vm.setQuickening(quickening);
+    return run_vm(vm, code, elapsed_ms);
+}
+
+const char* ARITHMETIC_LOOP = R"(
+var sum = 0;
+var i = 0;
+while (i < 300000) {
+    sum = sum + i % 7;
+    i = i + 1;
+}
+sum;
+)";
+
+void test_quickened_loop_matches_generic() {
+    long long generic_time = 0;
+    long long quickened_time = 0;
+    auto generic = run_quickened(ARITHMETIC_LOOP, false, &generic_time);
+    auto quickened = run_quickened(ARITHMETIC_LOOP, true, &quickened_time);
+
+    assert_ok(generic);
+    assert_ok(quickened);
+    assert_eq(generic.value().value().getInt(), quickened.value().value().getInt());
+    assert_eq(quickened.value().value().getInt(), 899997);
+
+    std::cout << "Int loop: generic " << generic_time << "ms, "
+              << "quickened " << quickened_time << "ms\n";
+}
+
+void test_guard_failure_falls_back() {
+    // 同一个 Add 先特化为整数形式，随后遇到字符串时必须退回通用实现
+    auto result = run_quickened(
+        "func add(a, b) { return a + b; }"
+        "var x = add(1, 2);"
+        "var y = add(\"a\", \"b\");"
+        "var z = add(3, 4);"
+        "y + \":\" + x + \":\" + z;",
+        true
+    );
+    assert_ok(result);
+    assert_eq(result.value().value().toString(), "ab:3:7");
+}
+
+void test_comparison_guard() {
+    auto result = run_quickened(
+        "func less(a, b) { return a < b; }"
+        "var r1 = less(1, 2);"
+        "var r2 = less(\"b\", \"a\");"
+        "var r3 = less(5, 4);"
+        "r1 == true && r2 == false && r3 == false;",
+        true
+    );
+    assert_ok(result);
+    assert_true(result.value().value().getBool());
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.add_test("quickened_loop_matches_generic", test_quickened_loop_matches_generic);
+    runner.add_test("guard_failure_falls_back", test_guard_failure_falls_back);
+    runner.add_test("comparison_guard", test_comparison_guard);
+
+    return runner.run_all();
+}